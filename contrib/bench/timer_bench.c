@@ -0,0 +1,159 @@
+
+/*
+ * Event timer benchmark: rbtree vs timer wheel.
+ *
+ * Build from the top of a configured and built source tree:
+ *
+ *   cc -O2 -I src/core -I src/event -I src/event/modules -I src/os/unix \
+ *       -I objs -o objs/timer_bench contrib/bench/timer_bench.c \
+ *       src/event/ngx_event_timer.c src/core/ngx_rbtree.c
+ *
+ * Run:
+ *
+ *   for n in 10000 100000 1000000; do
+ *       objs/timer_bench $n 0; objs/timer_bench $n 1;
+ *   done
+ *
+ * The tree must be configured without --with-debug and --with-threads.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+
+
+volatile ngx_msec_t  ngx_current_msec;
+
+static ngx_event_t  *events;
+static ngx_msec_t   *expires;
+static ngx_uint_t    fired;
+static ngx_uint_t    late;
+
+
+static void
+ngx_bench_add_timer(ngx_uint_t i, ngx_msec_t timer)
+{
+    expires[i] = ngx_current_msec + timer;
+
+    ngx_event_add_timer(&events[i], timer);
+}
+
+
+static void
+ngx_bench_timer_handler(ngx_event_t *ev)
+{
+    ngx_msec_t  expire;
+
+    fired++;
+
+    /* ngx_rbtree_delete() clears the key, so compare with the saved one */
+
+    expire = expires[ev - events];
+
+    /* a timer must not fire early, nor more than 1ms late */
+
+    if ((ngx_msec_int_t) (expire - ngx_current_msec) > 0
+        || (ngx_msec_int_t) (ngx_current_msec - expire) > 1)
+    {
+        late++;
+    }
+}
+
+
+static double
+ngx_bench_now(void)
+{
+    struct timespec  ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    double             t0, t1, t2, t3;
+    ngx_msec_t         timer;
+    ngx_uint_t         n, i, k;
+    ngx_connection_t   c;
+
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s timers 0|1\n", argv[0]);
+        return 1;
+    }
+
+    n = strtoul(argv[1], NULL, 10);
+    ngx_use_timer_wheel = atoi(argv[2]);
+
+    events = calloc(n, sizeof(ngx_event_t));
+    expires = calloc(n, sizeof(ngx_msec_t));
+
+    if (events == NULL || expires == NULL) {
+        return 1;
+    }
+
+    ngx_memzero(&c, sizeof(ngx_connection_t));
+
+    for (i = 0; i < n; i++) {
+        events[i].handler = ngx_bench_timer_handler;
+        events[i].data = &c;
+    }
+
+    srand(1);
+    ngx_current_msec = 1000000;
+
+    if (ngx_event_timer_init(NULL) != NGX_OK) {
+        return 1;
+    }
+
+    /* random 1-76s timeouts */
+
+    t0 = ngx_bench_now();
+
+    for (i = 0; i < n; i++) {
+        ngx_bench_add_timer(i, 1000 + rand() % 75000);
+    }
+
+    t1 = ngx_bench_now();
+
+    /* keepalive style re-arming of random timers */
+
+    for (k = 0; k < 4 * n; k++) {
+        i = rand() % n;
+
+        if (events[i].timer_set) {
+            ngx_event_del_timer(&events[i]);
+        }
+
+        ngx_bench_add_timer(i, 1000 + rand() % 75000);
+    }
+
+    t2 = ngx_bench_now();
+
+    /* run the clock forward as the event loop does */
+
+    while (fired < n) {
+        timer = ngx_event_find_timer();
+
+        if (timer == NGX_TIMER_INFINITE) {
+            break;
+        }
+
+        ngx_current_msec += timer ? timer : 1;
+
+        ngx_event_expire_timers();
+    }
+
+    t3 = ngx_bench_now();
+
+    printf("%s timers: %lu, ns per op: insert %.1f, del+add %.1f, "
+           "expire %.1f, fired: %lu, late: %lu\n",
+           ngx_use_timer_wheel ? "wheel " : "rbtree", (unsigned long) n,
+           (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / (4 * n),
+           (t3 - t2) * 1e9 / n, (unsigned long) fired, (unsigned long) late);
+
+    return (fired == n && late == 0) ? 0 : 1;
+}
@@ -43,6 +43,9 @@ struct ngx_listening_s {
     /* should be here because of the deferred accept */
     ngx_msec_t          post_accept_timeout;
 
+    /* worker process that owns the socket if reuseport is set */
+    ngx_uint_t          worker;
+
     ngx_listening_t    *previous;
     ngx_connection_t   *connection;
 
@@ -58,6 +61,11 @@ struct ngx_listening_s {
     unsigned            shared:1;    /* shared between threads or processes */
     unsigned            addr_ntop:1;
 
+#if (NGX_HAVE_REUSEPORT)
+    unsigned            reuseport:1;
+    unsigned            add_reuseport:1;
+#endif
+
 #if (NGX_HAVE_INET6 && defined IPV6_V6ONLY)
     unsigned            ipv6only:2;
 #endif
@@ -158,6 +166,7 @@ struct ngx_connection_s {
 
     unsigned            sendfile:1;
     unsigned            sndlowat:1;
+    unsigned            need_last_buf:1;
     unsigned            tcp_nodelay:2;   /* ngx_connection_tcp_nodelay_e */
     unsigned            tcp_nopush:2;    /* ngx_connection_tcp_nopush_e */
 
@@ -170,6 +179,10 @@ struct ngx_connection_s {
     ngx_buf_t          *busy_sendfile;
 #endif
 
+#if (NGX_THREAD_POOL)
+    ngx_thread_task_t  *sendfile_task;
+#endif
+
 #if (NGX_THREADS)
     ngx_atomic_t        lock;
 #endif
@@ -178,6 +191,7 @@ struct ngx_connection_s {
 
 ngx_listening_t *ngx_create_listening(ngx_conf_t *cf, void *sockaddr,
     socklen_t socklen);
+ngx_int_t ngx_clone_listening(ngx_conf_t *cf, ngx_listening_t *ls);
 ngx_int_t ngx_set_inherited_sockets(ngx_cycle_t *cycle);
 ngx_int_t ngx_open_listening_sockets(ngx_cycle_t *cycle);
 void ngx_configure_listening_sockets(ngx_cycle_t *cycle);
@@ -29,6 +29,12 @@ struct ngx_file_s {
     ngx_event_aio_t           *aio; //
 #endif
 
+#if (NGX_THREAD_POOL)
+    ngx_int_t                (*thread_handler)(ngx_thread_task_t *task,
+                                               ngx_file_t *file);
+    void                      *thread_ctx;
+#endif
+
     unsigned                   valid_info:1;    //目前未使用
     unsigned                   directio:1;  //与配置文件中的directio配置项想对应，在发送大文件是可以设置为1
 };
@@ -245,6 +245,26 @@ ngx_hash_find_combined(ngx_hash_combined_t *hash, ngx_uint_t key, u_char *name,
 }
 
 
+void *
+ngx_hash_perfect_find(ngx_hash_perfect_t *hash, ngx_uint_t key, u_char *name,
+    size_t len)
+{
+    ngx_hash_perfect_elt_t  *elt;
+
+    elt = &hash->elts[((uint32_t) key * hash->mult) >> hash->shift];
+
+    if (elt->key != key || (size_t) elt->len != len) {
+        return NULL;
+    }
+
+    if (ngx_strncmp(elt->name, name, len) != 0) {
+        return NULL;
+    }
+
+    return elt->value;
+}
+
+
 #define NGX_HASH_ELT_SIZE(name)                                               \
     (sizeof(void *) + ngx_align((name)->key.len + 2, sizeof(void *)))
 
@@ -600,6 +620,109 @@ ngx_hash_wildcard_init(ngx_hash_init_t *hinit, ngx_hash_key_t *names,
 }
 
 
+/*
+ * looks for a multiplier that spreads the keys over a power of two table
+ * without collisions, starting from the smallest table able to hold them
+ */
+
+ngx_int_t
+ngx_hash_perfect_init(ngx_hash_init_t *hinit, ngx_hash_perfect_t *hash,
+    ngx_hash_key_t *names, ngx_uint_t nelts)
+{
+    u_char                  *test;
+    uint32_t                 mult;
+    ngx_uint_t               n, k, bits, size, try;
+    ngx_hash_perfect_elt_t  *elt;
+
+    for (n = 0; n < nelts; n++) {
+        if (names[n].key.len > 65535) {
+            ngx_log_error(NGX_LOG_EMERG, hinit->pool->log, 0,
+                          "could not build the %s, too long key \"%V\"",
+                          hinit->name, &names[n].key);
+            return NGX_ERROR;
+        }
+    }
+
+    test = ngx_alloc(hinit->max_size, hinit->pool->log);
+    if (test == NULL) {
+        return NGX_ERROR;
+    }
+
+    for (bits = 1; (ngx_uint_t) 1 << bits < nelts; bits++) {
+        /* void */
+    }
+
+    mult = 0x9e3779b1;
+
+    for ( /* void */ ; (ngx_uint_t) 1 << bits <= hinit->max_size; bits++) {
+
+        size = (ngx_uint_t) 1 << bits;
+
+        for (try = 0; try < NGX_HASH_PERFECT_TRIES; try++) {
+
+            ngx_memzero(test, size);
+
+            for (n = 0; n < nelts; n++) {
+                k = ((uint32_t) names[n].key_hash * mult) >> (32 - bits);
+
+                if (test[k]) {
+                    goto next;
+                }
+
+                test[k] = 1;
+            }
+
+            goto found;
+
+        next:
+
+            mult = mult * 1103515245 + 12345;
+            mult |= 1;
+        }
+    }
+
+    ngx_log_error(NGX_LOG_EMERG, hinit->pool->log, 0,
+                  "could not build the %s, you should increase "
+                  "%s_max_size: %i",
+                  hinit->name, hinit->name, hinit->max_size);
+
+    ngx_free(test);
+
+    return NGX_ERROR;
+
+found:
+
+    ngx_free(test);
+
+    hash->elts = ngx_pcalloc(hinit->pool,
+                             size * sizeof(ngx_hash_perfect_elt_t));
+    if (hash->elts == NULL) {
+        return NGX_ERROR;
+    }
+
+    hash->mult = mult;
+    hash->shift = 32 - bits;
+
+    for (n = 0; n < nelts; n++) {
+        k = ((uint32_t) names[n].key_hash * mult) >> hash->shift;
+        elt = &hash->elts[k];
+
+        elt->name = ngx_pnalloc(hinit->pool, names[n].key.len);
+        if (elt->name == NULL) {
+            return NGX_ERROR;
+        }
+
+        ngx_strlow(elt->name, names[n].key.data, names[n].key.len);
+
+        elt->key = names[n].key_hash;
+        elt->value = names[n].value;
+        elt->len = (u_short) names[n].key.len;
+    }
+
+    return NGX_OK;
+}
+
+
 ngx_uint_t
 ngx_hash_key(u_char *data, size_t len)
 {
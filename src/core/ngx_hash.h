@@ -39,6 +39,26 @@ typedef struct {
 } ngx_hash_key_t;
 
 
+typedef struct {
+    ngx_uint_t        key;
+    void             *value;
+    u_short           len;
+    u_char           *name;
+} ngx_hash_perfect_elt_t;
+
+
+/*
+ * a collision free hash of a fixed set of keys: a lookup is a single
+ * table index, the name is compared only if the whole key matches
+ */
+
+typedef struct {
+    ngx_hash_perfect_elt_t  *elts;
+    uint32_t                 mult;
+    ngx_uint_t               shift;
+} ngx_hash_perfect_t;
+
+
 typedef ngx_uint_t (*ngx_hash_key_pt) (u_char *data, size_t len);
 
 
@@ -68,6 +88,8 @@ typedef struct {
 #define NGX_HASH_LARGE_ASIZE      16384
 #define NGX_HASH_LARGE_HSIZE      10007
 
+#define NGX_HASH_PERFECT_TRIES    65536
+
 #define NGX_HASH_WILDCARD_KEY     1
 #define NGX_HASH_READONLY_KEY     2
 
@@ -105,11 +127,15 @@ void *ngx_hash_find_wc_head(ngx_hash_wildcard_t *hwc, u_char *name, size_t len);
 void *ngx_hash_find_wc_tail(ngx_hash_wildcard_t *hwc, u_char *name, size_t len);
 void *ngx_hash_find_combined(ngx_hash_combined_t *hash, ngx_uint_t key,
     u_char *name, size_t len);
+void *ngx_hash_perfect_find(ngx_hash_perfect_t *hash, ngx_uint_t key,
+    u_char *name, size_t len);
 
 ngx_int_t ngx_hash_init(ngx_hash_init_t *hinit, ngx_hash_key_t *names,
     ngx_uint_t nelts);
 ngx_int_t ngx_hash_wildcard_init(ngx_hash_init_t *hinit, ngx_hash_key_t *names,
     ngx_uint_t nelts);
+ngx_int_t ngx_hash_perfect_init(ngx_hash_init_t *hinit,
+    ngx_hash_perfect_t *hash, ngx_hash_key_t *names, ngx_uint_t nelts);
 
 #define ngx_hash(key, c)   ((ngx_uint_t) key * 31 + c)
 ngx_uint_t ngx_hash_key(u_char *data, size_t len);
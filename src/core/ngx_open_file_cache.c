@@ -8,6 +8,9 @@
 #include <ngx_config.h>
 #include <ngx_core.h>
 #include <ngx_event.h>
+#if (NGX_THREAD_POOL)
+#include <ngx_thread_pool.h>
+#endif
 
 
 /*
@@ -21,7 +24,30 @@
 #define NGX_MIN_READ_AHEAD  (128 * 1024)
 
 
+#if (NGX_THREAD_POOL)
+
+typedef struct {
+    u_char                   *name;
+    ngx_fd_t                  fd;
+    ngx_file_uniq_t           uniq;
+    ngx_uint_t                test_dir;
+
+    ngx_open_file_info_t      of;
+    ngx_int_t                 rc;
+} ngx_thread_open_file_ctx_t;
+
+#endif
+
+
 static void ngx_open_file_cache_cleanup(void *data);
+static ngx_int_t ngx_open_file_wrapper(ngx_str_t *name,
+    ngx_open_file_info_t *of, ngx_pool_t *pool, ngx_log_t *log);
+#if (NGX_THREAD_POOL)
+static ngx_int_t ngx_thread_open_and_stat_file(ngx_str_t *name,
+    ngx_open_file_info_t *of, ngx_pool_t *pool, ngx_log_t *log);
+static void ngx_thread_open_file_handler(void *data, ngx_log_t *log);
+static void ngx_thread_open_file_cleanup(void *data);
+#endif
 static ngx_int_t ngx_open_and_stat_file(u_char *name, ngx_open_file_info_t *of,
     ngx_log_t *log);
 static void ngx_open_file_add_event(ngx_open_file_cache_t *cache,
@@ -170,7 +196,7 @@ ngx_open_cached_file(ngx_open_file_cache_t *cache, ngx_str_t *name,
             return NGX_ERROR;
         }
 
-        rc = ngx_open_and_stat_file(name->data, of, pool->log);
+        rc = ngx_open_file_wrapper(name, of, pool, pool->log);
 
         if (rc == NGX_OK && !of->is_dir) {
             cln->handler = ngx_pool_cleanup_file;
@@ -205,7 +231,11 @@ ngx_open_cached_file(ngx_open_file_cache_t *cache, ngx_str_t *name,
 
             /* file was not used often enough to keep open */
 
-            rc = ngx_open_and_stat_file(name->data, of, pool->log);
+            rc = ngx_open_file_wrapper(name, of, pool, pool->log);
+
+            if (rc == NGX_AGAIN) {
+                goto again;
+            }
 
             if (rc != NGX_OK && (of->err == 0 || !of->errors)) {
                 goto failed;
@@ -263,7 +293,11 @@ ngx_open_cached_file(ngx_open_file_cache_t *cache, ngx_str_t *name,
         of->fd = file->fd;
         of->uniq = file->uniq;
 
-        rc = ngx_open_and_stat_file(name->data, of, pool->log);
+        rc = ngx_open_file_wrapper(name, of, pool, pool->log);
+
+        if (rc == NGX_AGAIN) {
+            goto again;
+        }
 
         if (rc != NGX_OK && (of->err == 0 || !of->errors)) {
             goto failed;
@@ -329,7 +363,11 @@ ngx_open_cached_file(ngx_open_file_cache_t *cache, ngx_str_t *name,
 
     /* not found */
 
-    rc = ngx_open_and_stat_file(name->data, of, pool->log);
+    rc = ngx_open_file_wrapper(name, of, pool, pool->log);
+
+    if (rc == NGX_AGAIN) {
+        return NGX_AGAIN;
+    }
 
     if (rc != NGX_OK && (of->err == 0 || !of->errors)) {
         goto failed;
@@ -424,6 +462,16 @@ found:
 
     return NGX_ERROR;
 
+again:
+
+    /* open() is offloaded to a thread, the lookup will be repeated */
+
+    file->uses--;
+
+    ngx_queue_insert_head(&cache->expire_queue, &file->queue);
+
+    return NGX_AGAIN;
+
 failed:
 
     if (file) {
@@ -460,6 +508,134 @@ failed:
 }
 
 
+static ngx_int_t
+ngx_open_file_wrapper(ngx_str_t *name, ngx_open_file_info_t *of,
+    ngx_pool_t *pool, ngx_log_t *log)
+{
+#if (NGX_THREAD_POOL)
+
+    if (of->thread_handler) {
+        return ngx_thread_open_and_stat_file(name, of, pool, log);
+    }
+
+#endif
+
+    return ngx_open_and_stat_file(name->data, of, log);
+}
+
+
+#if (NGX_THREAD_POOL)
+
+static ngx_int_t
+ngx_thread_open_and_stat_file(ngx_str_t *name, ngx_open_file_info_t *of,
+    ngx_pool_t *pool, ngx_log_t *log)
+{
+    ngx_pool_cleanup_t          *cln;
+    ngx_thread_task_t           *task;
+    ngx_thread_open_file_ctx_t  *ctx;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_CORE, log, 0,
+                   "thread open: \"%s\"", name->data);
+
+    task = *of->thread_task;
+
+    if (task == NULL) {
+        task = ngx_thread_task_alloc(pool, sizeof(ngx_thread_open_file_ctx_t));
+        if (task == NULL) {
+            return NGX_ERROR;
+        }
+
+        cln = ngx_pool_cleanup_add(pool, 0);
+        if (cln == NULL) {
+            return NGX_ERROR;
+        }
+
+        cln->handler = ngx_thread_open_file_cleanup;
+        cln->data = task;
+
+        task->handler = ngx_thread_open_file_handler;
+
+        *of->thread_task = task;
+    }
+
+    ctx = task->ctx;
+
+    if (task->event.active) {
+        return NGX_AGAIN;
+    }
+
+    if (task->event.complete) {
+        task->event.complete = 0;
+
+        if (ngx_strcmp(ctx->name, name->data) == 0
+            && ctx->fd == of->fd
+            && ctx->uniq == of->uniq
+            && ctx->test_dir == of->test_dir)
+        {
+            *of = ctx->of;
+            return ctx->rc;
+        }
+
+        /* the cached file was changed while the task was running */
+
+        if (ctx->of.fd != NGX_INVALID_FILE && ctx->of.fd != ctx->fd) {
+            if (ngx_close_file(ctx->of.fd) == NGX_FILE_ERROR) {
+                ngx_log_error(NGX_LOG_ALERT, log, ngx_errno,
+                              ngx_close_file_n " \"%s\" failed", ctx->name);
+            }
+        }
+    }
+
+    ctx->name = name->data;
+    ctx->fd = of->fd;
+    ctx->uniq = of->uniq;
+    ctx->test_dir = of->test_dir;
+    ctx->of = *of;
+
+    if (of->thread_handler(task, of) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    return NGX_AGAIN;
+}
+
+
+static void
+ngx_thread_open_file_handler(void *data, ngx_log_t *log)
+{
+    ngx_thread_open_file_ctx_t *ctx = data;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_CORE, log, 0, "thread open handler");
+
+    ctx->rc = ngx_open_and_stat_file(ctx->name, &ctx->of, log);
+}
+
+
+static void
+ngx_thread_open_file_cleanup(void *data)
+{
+    ngx_thread_task_t *task = data;
+
+    ngx_thread_open_file_ctx_t  *ctx;
+
+    ctx = task->ctx;
+
+    /* the result of a completed task was not used */
+
+    if (task->event.complete
+        && ctx->of.fd != NGX_INVALID_FILE
+        && ctx->of.fd != ctx->fd)
+    {
+        if (ngx_close_file(ctx->of.fd) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                          ngx_close_file_n " \"%s\" failed", ctx->name);
+        }
+    }
+}
+
+#endif
+
+
 static ngx_int_t
 ngx_open_and_stat_file(u_char *name, ngx_open_file_info_t *of, ngx_log_t *log)
 {
@@ -7,14 +7,76 @@
 
 #include <ngx_config.h>
 #include <ngx_core.h>
+#include <ngx_event.h>
+
+
+#define NGX_REGEX_JIT_STACK_MIN  (32 * 1024)
+#define NGX_REGEX_JIT_STACK_MAX  (1024 * 1024)
+
+
+typedef struct {
+    ngx_flag_t        pcre_jit;
+    ngx_list_t       *studies;
+#if (NGX_HAVE_PCRE_JIT)
+    pcre_jit_stack   *jit_stack;
+#endif
+} ngx_regex_conf_t;
 
 
 static void * ngx_libc_cdecl ngx_regex_malloc(size_t size);
 static void ngx_libc_cdecl ngx_regex_free(void *p);
+static void ngx_regex_cleanup(void *data);
+
+static ngx_int_t ngx_regex_module_init(ngx_cycle_t *cycle);
+
+static void *ngx_regex_create_conf(ngx_cycle_t *cycle);
+static char *ngx_regex_init_conf(ngx_cycle_t *cycle, void *conf);
+
+static char *ngx_regex_pcre_jit(ngx_conf_t *cf, void *post, void *data);
+static ngx_conf_post_t  ngx_regex_pcre_jit_post = { ngx_regex_pcre_jit };
+
+
+static ngx_command_t  ngx_regex_commands[] = {
+
+    { ngx_string("pcre_jit"),
+      NGX_MAIN_CONF|NGX_DIRECT_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      0,
+      offsetof(ngx_regex_conf_t, pcre_jit),
+      &ngx_regex_pcre_jit_post },
+
+      ngx_null_command
+};
+
+
+static ngx_core_module_t  ngx_regex_module_ctx = {
+    ngx_string("regex"),
+    ngx_regex_create_conf,
+    ngx_regex_init_conf
+};
+
+
+ngx_module_t  ngx_regex_module = {
+    NGX_MODULE_V1,
+    &ngx_regex_module_ctx,                 /* module context */
+    ngx_regex_commands,                    /* module directives */
+    NGX_CORE_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    ngx_regex_module_init,                 /* init module */
+    NULL,                                  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
 
 
 static ngx_pool_t  *ngx_pcre_pool;
 
+/* the regexes compiled while a configuration is read, studied on its init */
+static ngx_list_t  *ngx_pcre_studies;
+
 
 void
 ngx_regex_init(void)
@@ -63,10 +125,11 @@ ngx_regex_malloc_done(void)
 ngx_int_t
 ngx_regex_compile(ngx_regex_compile_t *rc)
 {
-    int           n, erroff;
-    char         *p;
-    const char   *errstr;
-    ngx_regex_t  *re;
+    int               n, erroff;
+    char             *p;
+    pcre             *re;
+    const char       *errstr;
+    ngx_regex_elt_t  *elt;
 
     ngx_regex_malloc_init(rc->pool);
 
@@ -93,7 +156,24 @@ ngx_regex_compile(ngx_regex_compile_t *rc)
         return NGX_ERROR;
     }
 
-    rc->regex = re;
+    rc->regex = ngx_pcalloc(rc->pool, sizeof(ngx_regex_t));
+    if (rc->regex == NULL) {
+        return NGX_ERROR;
+    }
+
+    rc->regex->code = re;
+
+    /* the regexes compiled at run time, e.g. by SSI, are not studied */
+
+    if (ngx_pcre_studies != NULL) {
+        elt = ngx_list_push(ngx_pcre_studies);
+        if (elt == NULL) {
+            return NGX_ERROR;
+        }
+
+        elt->regex = rc->regex;
+        elt->name = rc->pattern.data;
+    }
 
     n = pcre_fullinfo(re, NULL, PCRE_INFO_CAPTURECOUNT, &rc->captures);
     if (n < 0) {
@@ -137,6 +217,43 @@ failed:
 }
 
 
+#if (NGX_STAT_STUB)
+
+ngx_int_t
+ngx_regex_exec(ngx_regex_t *re, ngx_str_t *s, int *captures, ngx_uint_t size)
+{
+    int             rc;
+    ngx_int_t       usec;
+    struct timeval  start, end;
+
+    ngx_gettimeofday(&start);
+
+    rc = pcre_exec(re->code, re->extra, (const char *) s->data, s->len, 0, 0,
+                   captures, size);
+
+    ngx_gettimeofday(&end);
+
+    (void) ngx_atomic_fetch_add(ngx_stat_regex_exec, 1);
+
+    if (rc >= 0) {
+        (void) ngx_atomic_fetch_add(ngx_stat_regex_match, 1);
+    }
+
+    usec = (end.tv_sec - start.tv_sec) * 1000000
+           + (end.tv_usec - start.tv_usec);
+
+    /* the time of day may step back */
+
+    if (usec > 0) {
+        (void) ngx_atomic_fetch_add(ngx_stat_regex_time, usec);
+    }
+
+    return rc;
+}
+
+#endif
+
+
 ngx_int_t
 ngx_regex_exec_array(ngx_array_t *a, ngx_str_t *s, ngx_log_t *log)
 {
@@ -204,3 +321,236 @@ ngx_regex_free(void *p)
 {
     return;
 }
+
+
+static void
+ngx_regex_cleanup(void *data)
+{
+    ngx_regex_conf_t *rcf = data;
+
+#if (NGX_HAVE_PCRE_JIT)
+    ngx_uint_t        i;
+    ngx_list_part_t  *part;
+    ngx_regex_elt_t  *elts;
+
+    part = &rcf->studies->part;
+    elts = part->elts;
+
+    for (i = 0 ; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            elts = part->elts;
+            i = 0;
+        }
+
+        /*
+         * the JIT compiler keeps its code in mmap()ed memory,
+         * so the study data are freed explicitly
+         */
+
+        if (elts[i].regex->extra != NULL) {
+            pcre_free_study(elts[i].regex->extra);
+        }
+    }
+
+    if (rcf->jit_stack) {
+        pcre_jit_stack_free(rcf->jit_stack);
+    }
+#endif
+
+    /*
+     * the cycle the regexes were compiled for is being freed
+     * before ngx_regex_module_init() had a chance to study them
+     */
+
+    if (ngx_pcre_studies == rcf->studies) {
+        ngx_pcre_studies = NULL;
+    }
+}
+
+
+static ngx_int_t
+ngx_regex_module_init(ngx_cycle_t *cycle)
+{
+    int                opt;
+    const char        *errstr;
+    ngx_uint_t         i;
+    ngx_list_part_t   *part;
+    ngx_regex_elt_t   *elts;
+    ngx_regex_conf_t  *rcf;
+
+    opt = 0;
+
+    rcf = (ngx_regex_conf_t *) ngx_get_conf(cycle->conf_ctx, ngx_regex_module);
+
+#if (NGX_HAVE_PCRE_JIT)
+
+    if (rcf->pcre_jit) {
+        opt = PCRE_STUDY_JIT_COMPILE;
+    }
+
+#endif
+
+    ngx_regex_malloc_init(cycle->pool);
+
+    part = &rcf->studies->part;
+    elts = part->elts;
+
+    for (i = 0 ; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            elts = part->elts;
+            i = 0;
+        }
+
+        elts[i].regex->extra = pcre_study(elts[i].regex->code, opt, &errstr);
+
+        if (errstr != NULL) {
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, 0,
+                          "pcre_study() failed: %s in \"%s\"",
+                          errstr, elts[i].name);
+        }
+
+#if (NGX_HAVE_PCRE_JIT)
+        if (opt & PCRE_STUDY_JIT_COMPILE) {
+            int jit, n;
+
+            jit = 0;
+            n = pcre_fullinfo(elts[i].regex->code, elts[i].regex->extra,
+                              PCRE_INFO_JIT, &jit);
+
+            if (n != 0 || jit != 1) {
+                ngx_log_error(NGX_LOG_INFO, cycle->log, 0,
+                              "JIT compiler does not support pattern: \"%s\"",
+                              elts[i].name);
+                continue;
+            }
+
+            /*
+             * the stack is allocated in the master process and is
+             * inherited by each worker process as its own copy
+             */
+
+            if (rcf->jit_stack == NULL) {
+                rcf->jit_stack = pcre_jit_stack_alloc(NGX_REGEX_JIT_STACK_MIN,
+                                                      NGX_REGEX_JIT_STACK_MAX);
+                if (rcf->jit_stack == NULL) {
+                    ngx_log_error(NGX_LOG_WARN, cycle->log, 0,
+                                  "pcre_jit_stack_alloc() failed, "
+                                  "the default JIT stack is used");
+                    continue;
+                }
+            }
+
+            pcre_assign_jit_stack(elts[i].regex->extra, NULL,
+                                  rcf->jit_stack);
+        }
+#endif
+    }
+
+    ngx_regex_malloc_done();
+
+    ngx_pcre_studies = NULL;
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_regex_create_conf(ngx_cycle_t *cycle)
+{
+    ngx_regex_conf_t    *rcf;
+    ngx_pool_cleanup_t  *cln;
+
+    rcf = ngx_pcalloc(cycle->pool, sizeof(ngx_regex_conf_t));
+    if (rcf == NULL) {
+        return NULL;
+    }
+
+    rcf->pcre_jit = NGX_CONF_UNSET;
+
+    cln = ngx_pool_cleanup_add(cycle->pool, 0);
+    if (cln == NULL) {
+        return NULL;
+    }
+
+    cln->handler = ngx_regex_cleanup;
+    cln->data = rcf;
+
+    rcf->studies = ngx_list_create(cycle->pool, 8, sizeof(ngx_regex_elt_t));
+    if (rcf->studies == NULL) {
+        return NULL;
+    }
+
+    ngx_pcre_studies = rcf->studies;
+
+    return rcf;
+}
+
+
+static char *
+ngx_regex_init_conf(ngx_cycle_t *cycle, void *conf)
+{
+    ngx_regex_conf_t *rcf = conf;
+
+#if (NGX_HAVE_PCRE_JIT)
+    int  jit;
+
+    if (rcf->pcre_jit == NGX_CONF_UNSET) {
+
+        /* JIT is used by default if the library was built with it */
+
+        jit = 0;
+
+        if (pcre_config(PCRE_CONFIG_JIT, &jit) == 0 && jit == 1) {
+            rcf->pcre_jit = 1;
+        }
+    }
+#endif
+
+    ngx_conf_init_value(rcf->pcre_jit, 0);
+
+    return NGX_CONF_OK;
+}
+
+
+static char *
+ngx_regex_pcre_jit(ngx_conf_t *cf, void *post, void *data)
+{
+    ngx_flag_t  *fp = data;
+
+    if (*fp == 0) {
+        return NGX_CONF_OK;
+    }
+
+#if (NGX_HAVE_PCRE_JIT)
+    {
+    int  jit, r;
+
+    jit = 0;
+    r = pcre_config(PCRE_CONFIG_JIT, &jit);
+
+    if (r != 0 || jit != 1) {
+        ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                           "PCRE library does not support JIT");
+        *fp = 0;
+    }
+    }
+#else
+    ngx_conf_log_error(NGX_LOG_WARN, cf, 0,
+                       "nginx was built without PCRE JIT support");
+    *fp = 0;
+#endif
+
+    return NGX_CONF_OK;
+}
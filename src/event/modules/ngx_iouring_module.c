@@ -0,0 +1,1244 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+
+
+/*
+ * The module uses io_uring as a readiness notification mechanism:
+ * socket events are IORING_OP_POLL_ADD requests, multishot ones for
+ * the clear (edge-triggered) events and oneshot ones rearmed after
+ * every completion for the level-triggered events.  All the additions
+ * and deletions are queued to the submission ring and are passed to
+ * the kernel together with the wait in a single io_uring_enter() call.
+ *
+ * The connections are accepted by several IORING_OP_ACCEPT requests kept
+ * in flight on each listening socket, so ngx_event_accept() gets them
+ * without the accept() syscalls.  File AIO reads are posted as
+ * IORING_OP_READ requests to the same ring.
+ *
+ * Socket reads and writes still use ngx_os_io on readiness: nginx owns
+ * and reuses the buffers synchronously, e.g. an idle keepalive connection
+ * frees its buffer, while a completion-based request holds the buffer
+ * until the kernel returns it.
+ *
+ * The user_data of a request is a pointer to the event with the instance
+ * in the lowest bit and the request type in the next one, or a pointer
+ * to an accept slot with both bits set.
+ */
+
+#define NGX_IOURING_AIO_EVENT     2
+#define NGX_IOURING_ACCEPT_EVENT  3
+#define NGX_IOURING_DATA_MASK     3
+
+
+#define NGX_IOURING_ACCEPTS       8
+
+#define NGX_IOURING_ACCEPT_IDLE   0
+#define NGX_IOURING_ACCEPT_BUSY   1
+#define NGX_IOURING_ACCEPT_DONE   2
+
+
+typedef struct {
+    ngx_uint_t  entries;
+} ngx_iouring_conf_t;
+
+
+typedef struct ngx_iouring_accept_s  ngx_iouring_accept_t;
+
+typedef struct {
+    ngx_iouring_accept_t  *accept;
+    ngx_socket_t           fd;
+    ngx_err_t              err;
+    ngx_uint_t             state;
+    socklen_t              socklen;
+    u_char                 sockaddr[NGX_SOCKADDRLEN];
+} ngx_iouring_accept_slot_t;
+
+
+struct ngx_iouring_accept_s {
+    ngx_connection_t           *connection;
+    ngx_listening_t            *listening;
+    ngx_uint_t                  ready;
+    ngx_iouring_accept_slot_t   slots[NGX_IOURING_ACCEPTS];
+};
+
+
+typedef struct {
+    unsigned   *head;
+    unsigned   *tail;
+    unsigned    mask;
+    unsigned    entries;
+    unsigned   *array;
+    unsigned    local_tail;
+} ngx_iouring_sq_t;
+
+
+typedef struct {
+    unsigned              *head;
+    unsigned              *tail;
+    unsigned               mask;
+    struct io_uring_cqe   *cqes;
+} ngx_iouring_cq_t;
+
+
+static ngx_int_t ngx_iouring_init(ngx_cycle_t *cycle, ngx_msec_t timer);
+static ngx_int_t ngx_iouring_setup(ngx_cycle_t *cycle,
+    ngx_iouring_conf_t *iucf);
+static void ngx_iouring_done(ngx_cycle_t *cycle);
+static ngx_int_t ngx_iouring_add_event(ngx_event_t *ev, ngx_int_t event,
+    ngx_uint_t flags);
+static ngx_int_t ngx_iouring_del_event(ngx_event_t *ev, ngx_int_t event,
+    ngx_uint_t flags);
+static ngx_int_t ngx_iouring_add_connection(ngx_connection_t *c);
+static ngx_int_t ngx_iouring_del_connection(ngx_connection_t *c,
+    ngx_uint_t flags);
+#if (NGX_HAVE_EVENTFD)
+static ngx_int_t ngx_iouring_notify_init(ngx_log_t *log);
+static void ngx_iouring_notify_handler(ngx_event_t *ev);
+static ngx_int_t ngx_iouring_notify(ngx_event_handler_pt handler);
+#endif
+static ngx_int_t ngx_iouring_process_events(ngx_cycle_t *cycle,
+    ngx_msec_t timer, ngx_uint_t flags);
+
+static struct io_uring_sqe *ngx_iouring_get_sqe(ngx_log_t *log);
+static ngx_int_t ngx_iouring_submit(ngx_log_t *log);
+static ngx_int_t ngx_iouring_poll_add(ngx_event_t *ev, ngx_socket_t fd,
+    ngx_uint_t multishot);
+static ngx_int_t ngx_iouring_poll_remove(ngx_event_t *ev);
+static ngx_int_t ngx_iouring_accept_add(ngx_event_t *ev);
+static ngx_int_t ngx_iouring_accept_del(ngx_event_t *ev);
+static ngx_int_t ngx_iouring_accept_post(ngx_iouring_accept_slot_t *slot,
+    ngx_log_t *log);
+static void ngx_iouring_accept_complete(ngx_iouring_accept_slot_t *slot,
+    int res, ngx_uint_t flags);
+
+static void *ngx_iouring_create_conf(ngx_cycle_t *cycle);
+static char *ngx_iouring_init_conf(ngx_cycle_t *cycle, void *conf);
+
+
+extern ngx_event_module_t  ngx_epoll_module_ctx;
+
+
+static int                    ring = -1;
+static ngx_iouring_sq_t       sq;
+static ngx_iouring_cq_t       cq;
+static struct io_uring_sqe   *sqes;
+
+static void                  *ring_ptr = MAP_FAILED;
+static size_t                 ring_size;
+static size_t                 sqes_size;
+
+#if (NGX_HAVE_EVENTFD)
+static int                    notify_fd = -1;
+static ngx_event_t            notify_event;
+#endif
+
+#if (NGX_HAVE_FILE_AIO)
+ngx_uint_t                    ngx_iouring_file_aio;
+#endif
+
+static ngx_str_t      iouring_name = ngx_string("io_uring");
+
+static ngx_command_t  ngx_iouring_commands[] = {
+
+    { ngx_string("io_uring_entries"),
+      NGX_EVENT_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_num_slot,
+      0,
+      offsetof(ngx_iouring_conf_t, entries),
+      NULL },
+
+      ngx_null_command
+};
+
+
+ngx_event_module_t  ngx_iouring_module_ctx = {
+    &iouring_name,
+    ngx_iouring_create_conf,             /* create configuration */
+    ngx_iouring_init_conf,               /* init configuration */
+
+    {
+        ngx_iouring_add_event,           /* add an event */
+        ngx_iouring_del_event,           /* delete an event */
+        ngx_iouring_add_event,           /* enable an event */
+        ngx_iouring_del_event,           /* disable an event */
+        ngx_iouring_add_connection,      /* add an connection */
+        ngx_iouring_del_connection,      /* delete an connection */
+#if (NGX_HAVE_EVENTFD)
+        ngx_iouring_notify,              /* trigger a notify */
+#else
+        NULL,                            /* trigger a notify */
+#endif
+        NULL,                            /* process the changes */
+        ngx_iouring_process_events,      /* process the events */
+        ngx_iouring_init,                /* init the events */
+        ngx_iouring_done,                /* done the events */
+    }
+};
+
+ngx_module_t  ngx_iouring_module = {
+    NGX_MODULE_V1,
+    &ngx_iouring_module_ctx,             /* module context */
+    ngx_iouring_commands,                /* module directives */
+    NGX_EVENT_MODULE,                    /* module type */
+    NULL,                                /* init master */
+    NULL,                                /* init module */
+    NULL,                                /* init process */
+    NULL,                                /* init thread */
+    NULL,                                /* exit thread */
+    NULL,                                /* exit process */
+    NULL,                                /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+/*
+ * We call io_uring_setup() and io_uring_enter() directly as syscalls
+ * instead of liburing usage to avoid an external dependency.
+ */
+
+static int
+io_uring_setup(u_int entries, struct io_uring_params *p)
+{
+    return syscall(SYS_io_uring_setup, entries, p);
+}
+
+
+static int
+io_uring_enter(int fd, u_int to_submit, u_int min_complete, u_int flags,
+    void *arg, size_t argsz)
+{
+    return syscall(SYS_io_uring_enter, fd, to_submit, min_complete, flags,
+                   arg, argsz);
+}
+
+
+static ngx_int_t
+ngx_iouring_init(ngx_cycle_t *cycle, ngx_msec_t timer)
+{
+    ngx_iouring_conf_t  *iucf;
+
+    iucf = ngx_event_get_conf(cycle->conf_ctx, ngx_iouring_module);
+
+    if (ring == -1) {
+
+        if (ngx_iouring_setup(cycle, iucf) != NGX_OK) {
+            ngx_log_error(NGX_LOG_NOTICE, cycle->log, 0,
+                          "io_uring is not available, using epoll");
+
+            return ngx_epoll_module_ctx.actions.init(cycle, timer);
+        }
+
+#if (NGX_HAVE_EVENTFD)
+
+        if (ngx_iouring_notify_init(cycle->log) != NGX_OK) {
+            ngx_iouring_module_ctx.actions.notify = NULL;
+        }
+
+#endif
+
+#if (NGX_HAVE_FILE_AIO)
+        ngx_iouring_file_aio = 1;
+#endif
+    }
+
+    ngx_io = ngx_os_io;
+
+    ngx_event_actions = ngx_iouring_module_ctx.actions;
+
+    ngx_event_flags = NGX_USE_CLEAR_EVENT
+                      |NGX_USE_GREEDY_EVENT
+                      |NGX_USE_EPOLL_EVENT
+                      |NGX_USE_IOURING_EVENT;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_setup(ngx_cycle_t *cycle, ngx_iouring_conf_t *iucf)
+{
+    u_char                  *p;
+    ngx_err_t                err;
+    ngx_uint_t               i, level;
+    struct io_uring_params   params;
+
+    /*
+     * IORING_FEAT_EXT_ARG (Linux 5.11) is needed for the wait timeout,
+     * IORING_FEAT_RSRC_TAGS marks Linux 5.13 with the multishot poll
+     */
+
+#define NGX_IOURING_FEATURES  (IORING_FEAT_SINGLE_MMAP|IORING_FEAT_NODROP     \
+                               |IORING_FEAT_EXT_ARG|IORING_FEAT_RSRC_TAGS)
+
+    ngx_memzero(&params, sizeof(struct io_uring_params));
+
+    ring = io_uring_setup(iucf->entries, &params);
+
+    if (ring == -1) {
+        err = ngx_errno;
+
+        if (err == NGX_ENOSYS || err == NGX_EPERM) {
+            level = NGX_LOG_INFO;
+
+        } else {
+            level = NGX_LOG_ALERT;
+        }
+
+        ngx_log_error(level, cycle->log, err, "io_uring_setup() failed");
+        return NGX_ERROR;
+    }
+
+    if ((params.features & NGX_IOURING_FEATURES) != NGX_IOURING_FEATURES) {
+        ngx_log_error(NGX_LOG_INFO, cycle->log, 0,
+                      "io_uring features %08XD are not supported",
+                      NGX_IOURING_FEATURES & ~params.features);
+        goto failed;
+    }
+
+    ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+
+    if (ring_size < params.cq_off.cqes
+                    + params.cq_entries * sizeof(struct io_uring_cqe))
+    {
+        ring_size = params.cq_off.cqes
+                    + params.cq_entries * sizeof(struct io_uring_cqe);
+    }
+
+    ring_ptr = mmap(NULL, ring_size, PROT_READ|PROT_WRITE,
+                    MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+
+    if (ring_ptr == MAP_FAILED) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "mmap(IORING_OFF_SQ_RING) failed");
+        goto failed;
+    }
+
+    sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    sqes = mmap(NULL, sqes_size, PROT_READ|PROT_WRITE,
+                MAP_SHARED|MAP_POPULATE, ring, IORING_OFF_SQES);
+
+    if (sqes == MAP_FAILED) {
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                      "mmap(IORING_OFF_SQES) failed");
+        goto failed;
+    }
+
+    p = ring_ptr;
+
+    sq.head = (unsigned *) (p + params.sq_off.head);
+    sq.tail = (unsigned *) (p + params.sq_off.tail);
+    sq.mask = *(unsigned *) (p + params.sq_off.ring_mask);
+    sq.entries = *(unsigned *) (p + params.sq_off.ring_entries);
+    sq.array = (unsigned *) (p + params.sq_off.array);
+    sq.local_tail = *sq.tail;
+
+    for (i = 0; i < sq.entries; i++) {
+        sq.array[i] = i;
+    }
+
+    cq.head = (unsigned *) (p + params.cq_off.head);
+    cq.tail = (unsigned *) (p + params.cq_off.tail);
+    cq.mask = *(unsigned *) (p + params.cq_off.ring_mask);
+    cq.cqes = (struct io_uring_cqe *) (p + params.cq_off.cqes);
+
+    ngx_log_debug3(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                   "io_uring: fd:%d sq:%ud cq:%ud",
+                   ring, params.sq_entries, params.cq_entries);
+
+    return NGX_OK;
+
+failed:
+
+    ngx_iouring_done(cycle);
+
+    return NGX_ERROR;
+}
+
+
+static void
+ngx_iouring_done(ngx_cycle_t *cycle)
+{
+    if (sqes != NULL && sqes != MAP_FAILED) {
+        if (munmap(sqes, sqes_size) == -1) {
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                          "munmap(IORING_OFF_SQES) failed");
+        }
+    }
+
+    sqes = NULL;
+
+    if (ring_ptr != MAP_FAILED) {
+        if (munmap(ring_ptr, ring_size) == -1) {
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                          "munmap(IORING_OFF_SQ_RING) failed");
+        }
+
+        ring_ptr = MAP_FAILED;
+    }
+
+    if (ring != -1) {
+        if (close(ring) == -1) {
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                          "io_uring close() failed");
+        }
+
+        ring = -1;
+    }
+
+#if (NGX_HAVE_EVENTFD)
+
+    if (notify_fd != -1) {
+        if (close(notify_fd) == -1) {
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, ngx_errno,
+                          "eventfd close() failed");
+        }
+
+        notify_fd = -1;
+    }
+
+#endif
+
+#if (NGX_HAVE_FILE_AIO)
+    ngx_iouring_file_aio = 0;
+#endif
+}
+
+
+#if (NGX_HAVE_EVENTFD)
+
+static ngx_int_t
+ngx_iouring_notify_init(ngx_log_t *log)
+{
+    int  n;
+
+    notify_fd = syscall(SYS_eventfd, 0);
+
+    if (notify_fd == -1) {
+        ngx_log_error(NGX_LOG_EMERG, log, ngx_errno, "eventfd() failed");
+        return NGX_ERROR;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, log, 0,
+                   "notify eventfd: %d", notify_fd);
+
+    n = 1;
+
+    if (ioctl(notify_fd, FIONBIO, &n) == -1) {
+        ngx_log_error(NGX_LOG_EMERG, log, ngx_errno,
+                      "ioctl(eventfd, FIONBIO) failed");
+        goto failed;
+    }
+
+    notify_event.handler = ngx_iouring_notify_handler;
+    notify_event.log = log;
+
+    if (ngx_iouring_poll_add(&notify_event, notify_fd, 1) == NGX_OK) {
+        notify_event.active = 1;
+        return NGX_OK;
+    }
+
+failed:
+
+    if (close(notify_fd) == -1) {
+        ngx_log_error(NGX_LOG_ALERT, log, ngx_errno,
+                      "eventfd close() failed");
+    }
+
+    notify_fd = -1;
+
+    return NGX_ERROR;
+}
+
+
+static void
+ngx_iouring_notify_handler(ngx_event_t *ev)
+{
+    ssize_t               n;
+    uint64_t              count;
+    ngx_err_t             err;
+    ngx_event_handler_pt  handler;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_EVENT, ev->log, 0, "notify handler");
+
+    n = read(notify_fd, &count, sizeof(uint64_t));
+
+    err = ngx_errno;
+
+    if (n == -1 && err != NGX_EAGAIN) {
+        ngx_log_error(NGX_LOG_ALERT, ev->log, err, "read(eventfd) failed");
+    }
+
+    handler = ev->data;
+    handler(ev);
+}
+
+
+static ngx_int_t
+ngx_iouring_notify(ngx_event_handler_pt handler)
+{
+    static uint64_t  inc = 1;
+
+    /* the handler is the same for all the notifications */
+
+    notify_event.data = handler;
+
+    if ((size_t) write(notify_fd, &inc, sizeof(uint64_t)) != sizeof(uint64_t))
+    {
+        ngx_log_error(NGX_LOG_ALERT, notify_event.log, ngx_errno,
+                      "write() to eventfd %d failed", notify_fd);
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+#endif
+
+
+static struct io_uring_sqe *
+ngx_iouring_get_sqe(ngx_log_t *log)
+{
+    unsigned              head;
+    struct io_uring_sqe  *sqe;
+
+    head = *(volatile unsigned *) sq.head;
+
+    if (sq.local_tail - head >= sq.entries) {
+
+        /* the submission ring is full, pass the requests to the kernel */
+
+        if (ngx_iouring_submit(log) != NGX_OK) {
+            return NULL;
+        }
+
+        head = *(volatile unsigned *) sq.head;
+
+        if (sq.local_tail - head >= sq.entries) {
+            ngx_log_error(NGX_LOG_ALERT, log, 0,
+                          "io_uring submission queue overflow");
+            return NULL;
+        }
+    }
+
+    sqe = &sqes[sq.local_tail & sq.mask];
+
+    ngx_memzero(sqe, sizeof(struct io_uring_sqe));
+
+    sq.local_tail++;
+
+    return sqe;
+}
+
+
+static ngx_int_t
+ngx_iouring_submit(ngx_log_t *log)
+{
+    int        n;
+    unsigned   to_submit;
+    ngx_err_t  err;
+
+    ngx_memory_barrier();
+
+    *(volatile unsigned *) sq.tail = sq.local_tail;
+
+    to_submit = sq.local_tail - *(volatile unsigned *) sq.head;
+
+    if (to_submit == 0) {
+        return NGX_OK;
+    }
+
+    n = io_uring_enter(ring, to_submit, 0, 0, NULL, 0);
+
+    if (n == -1) {
+        err = ngx_errno;
+
+        if (err == NGX_EINTR || err == NGX_EAGAIN || err == NGX_EBUSY) {
+            return NGX_OK;
+        }
+
+        ngx_log_error(NGX_LOG_ALERT, log, err, "io_uring_enter() failed");
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_poll_add(ngx_event_t *ev, ngx_socket_t fd, ngx_uint_t multishot)
+{
+    struct io_uring_sqe  *sqe;
+
+    ngx_log_debug3(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                   "io_uring poll add: fd:%d w:%d m:%ui",
+                   fd, ev->write, multishot);
+
+    sqe = ngx_iouring_get_sqe(ev->log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = ev->write ? POLLOUT : POLLIN;
+    sqe->len = multishot ? IORING_POLL_ADD_MULTI : 0;
+    sqe->user_data = (uint64_t) ((uintptr_t) ev | ev->instance);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_poll_remove(ngx_event_t *ev)
+{
+    struct io_uring_sqe  *sqe;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                   "io_uring poll remove: %p", ev);
+
+    sqe = ngx_iouring_get_sqe(ev->log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    /* the completions of the removal requests have zero user_data */
+
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t) ((uintptr_t) ev | ev->instance);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_add_event(ngx_event_t *ev, ngx_int_t event, ngx_uint_t flags)
+{
+    ngx_connection_t  *c;
+
+    if (ev->active) {
+        return NGX_OK;
+    }
+
+    if (ev->accept) {
+        if (ngx_iouring_accept_add(ev) != NGX_OK) {
+            return NGX_ERROR;
+        }
+
+        ev->active = 1;
+
+        return NGX_OK;
+    }
+
+    c = ev->data;
+
+    /* the level-triggered events are rearmed after each completion */
+
+    ev->oneshot = (flags & NGX_CLEAR_EVENT) ? 0 : 1;
+
+    if (ngx_iouring_poll_add(ev, c->fd, !ev->oneshot) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    ev->active = 1;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_del_event(ngx_event_t *ev, ngx_int_t event, ngx_uint_t flags)
+{
+    /*
+     * unlike epoll, the closing of the file descriptor does not
+     * cancel the poll requests, so they are always removed explicitly
+     */
+
+    if (!ev->active) {
+        return NGX_OK;
+    }
+
+    ev->active = 0;
+
+    if (ev->accept) {
+        return ngx_iouring_accept_del(ev);
+    }
+
+    return ngx_iouring_poll_remove(ev);
+}
+
+
+static ngx_int_t
+ngx_iouring_add_connection(ngx_connection_t *c)
+{
+    if (ngx_iouring_add_event(c->read, NGX_READ_EVENT, NGX_CLEAR_EVENT)
+        != NGX_OK)
+    {
+        return NGX_ERROR;
+    }
+
+    return ngx_iouring_add_event(c->write, NGX_WRITE_EVENT, NGX_CLEAR_EVENT);
+}
+
+
+static ngx_int_t
+ngx_iouring_del_connection(ngx_connection_t *c, ngx_uint_t flags)
+{
+    if (ngx_iouring_del_event(c->read, NGX_READ_EVENT, flags) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    return ngx_iouring_del_event(c->write, NGX_WRITE_EVENT, flags);
+}
+
+
+static ngx_int_t
+ngx_iouring_accept_add(ngx_event_t *ev)
+{
+    ngx_uint_t             i;
+    ngx_connection_t      *lc;
+    ngx_iouring_accept_t  *a;
+
+    lc = ev->data;
+    a = lc->data;
+
+    if (a == NULL) {
+        a = ngx_pcalloc(ngx_cycle->pool, sizeof(ngx_iouring_accept_t));
+        if (a == NULL) {
+            return NGX_ERROR;
+        }
+
+        a->connection = lc;
+        a->listening = lc->listening;
+
+        for (i = 0; i < NGX_IOURING_ACCEPTS; i++) {
+            a->slots[i].accept = a;
+            a->slots[i].fd = (ngx_socket_t) -1;
+        }
+
+        lc->data = a;
+    }
+
+    /* the slots still busy with the cancelled requests are reposted later */
+
+    for (i = 0; i < NGX_IOURING_ACCEPTS; i++) {
+        if (a->slots[i].state == NGX_IOURING_ACCEPT_IDLE) {
+            if (ngx_iouring_accept_post(&a->slots[i], ev->log) != NGX_OK) {
+                return NGX_ERROR;
+            }
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_accept_del(ngx_event_t *ev)
+{
+    ngx_uint_t                  i;
+    ngx_connection_t           *lc;
+    struct io_uring_sqe        *sqe;
+    ngx_iouring_accept_t       *a;
+    ngx_iouring_accept_slot_t  *slot;
+
+    lc = ev->data;
+    a = lc->data;
+
+    if (ev->prev) {
+        ngx_delete_posted_event(ev);
+    }
+
+    if (a == NULL) {
+        return NGX_OK;
+    }
+
+    for (i = 0; i < NGX_IOURING_ACCEPTS; i++) {
+        slot = &a->slots[i];
+
+        if (slot->state != NGX_IOURING_ACCEPT_BUSY) {
+            continue;
+        }
+
+        ngx_log_debug1(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                       "io_uring accept cancel: %p", slot);
+
+        sqe = ngx_iouring_get_sqe(ev->log);
+        if (sqe == NULL) {
+            return NGX_ERROR;
+        }
+
+        /* the completions of the cancel requests have zero user_data */
+
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = (uint64_t) ((uintptr_t) slot | NGX_IOURING_ACCEPT_EVENT);
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_iouring_accept_post(ngx_iouring_accept_slot_t *slot, ngx_log_t *log)
+{
+    struct io_uring_sqe  *sqe;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_EVENT, log, 0,
+                   "io_uring accept add: fd:%d %p",
+                   slot->accept->connection->fd, slot);
+
+    sqe = ngx_iouring_get_sqe(log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    slot->state = NGX_IOURING_ACCEPT_BUSY;
+    slot->socklen = NGX_SOCKADDRLEN;
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = slot->accept->connection->fd;
+    sqe->addr = (uint64_t) (uintptr_t) slot->sockaddr;
+    sqe->addr2 = (uint64_t) (uintptr_t) &slot->socklen;
+    sqe->accept_flags = SOCK_NONBLOCK;
+    sqe->user_data = (uint64_t) ((uintptr_t) slot | NGX_IOURING_ACCEPT_EVENT);
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_iouring_accept_complete(ngx_iouring_accept_slot_t *slot, int res,
+    ngx_uint_t flags)
+{
+    ngx_err_t              err;
+    ngx_event_t           *ev;
+    ngx_connection_t      *lc;
+    ngx_iouring_accept_t  *a;
+
+    a = slot->accept;
+    lc = a->connection;
+    ev = lc->read;
+
+    slot->state = NGX_IOURING_ACCEPT_IDLE;
+
+    if (lc->fd == (ngx_socket_t) -1
+        || !ev->accept
+        || lc->listening != a->listening)
+    {
+        /* the listening socket was closed */
+
+        if (res >= 0 && ngx_close_socket(res) == -1) {
+            ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_socket_errno,
+                          ngx_close_socket_n " failed");
+        }
+
+        return;
+    }
+
+    if (res >= 0) {
+        slot->fd = res;
+        slot->err = 0;
+
+        if (slot->socklen > NGX_SOCKADDRLEN) {
+            slot->socklen = NGX_SOCKADDRLEN;
+        }
+
+    } else {
+        err = -res;
+
+        switch (err) {
+
+        case NGX_ECANCELED:
+        case NGX_EINTR:
+        case NGX_EAGAIN:
+
+            if (ev->active) {
+                (void) ngx_iouring_accept_post(slot, ev->log);
+            }
+
+            return;
+
+        case EBADF:
+        case NGX_EINVAL:
+        case ENOTSOCK:
+        case EOPNOTSUPP:
+
+            /* the request is not reposted to not spin on a bad socket */
+
+            ngx_log_error(NGX_LOG_ALERT, ev->log, err,
+                          "io_uring accept on %V failed",
+                          &a->listening->addr_text);
+            return;
+
+        default:
+            slot->fd = (ngx_socket_t) -1;
+            slot->err = err;
+        }
+    }
+
+    slot->state = NGX_IOURING_ACCEPT_DONE;
+    a->ready++;
+
+    ev->ready = 1;
+
+    if (flags & NGX_POST_EVENTS) {
+        ngx_locked_post_event(ev, &ngx_posted_accept_events);
+
+    } else {
+        ev->handler(ev);
+    }
+}
+
+
+ngx_socket_t
+ngx_iouring_accept(ngx_event_t *ev, struct sockaddr *sa, socklen_t *socklen)
+{
+    ngx_uint_t                  i;
+    ngx_socket_t                s;
+    ngx_connection_t           *lc;
+    ngx_iouring_accept_t       *a;
+    ngx_iouring_accept_slot_t  *slot;
+
+    lc = ev->data;
+    a = lc->data;
+
+    if (a == NULL || a->ready == 0) {
+        ngx_set_socket_errno(NGX_EAGAIN);
+        return (ngx_socket_t) -1;
+    }
+
+    slot = NULL;
+
+    for (i = 0; i < NGX_IOURING_ACCEPTS; i++) {
+        if (a->slots[i].state == NGX_IOURING_ACCEPT_DONE) {
+            slot = &a->slots[i];
+            break;
+        }
+    }
+
+    if (slot == NULL) {
+        ngx_log_error(NGX_LOG_ALERT, ev->log, 0,
+                      "io_uring accept slot not found");
+        a->ready = 0;
+        ngx_set_socket_errno(NGX_EAGAIN);
+        return (ngx_socket_t) -1;
+    }
+
+    s = slot->fd;
+
+    if (s == (ngx_socket_t) -1) {
+        ngx_set_socket_errno(slot->err);
+
+    } else {
+        ngx_memcpy(sa, slot->sockaddr, slot->socklen);
+        *socklen = slot->socklen;
+    }
+
+    slot->state = NGX_IOURING_ACCEPT_IDLE;
+    slot->fd = (ngx_socket_t) -1;
+    a->ready--;
+
+    if (ev->active) {
+        (void) ngx_iouring_accept_post(slot, ev->log);
+    }
+
+    if (a->ready) {
+
+        /*
+         * the connections already accepted do not generate new
+         * completions, so the event is posted again to get them
+         */
+
+        ngx_post_event(ev, &ngx_posted_accept_events);
+    }
+
+    return s;
+}
+
+
+#if (NGX_HAVE_FILE_AIO)
+
+ngx_int_t
+ngx_iouring_file_aio_read(ngx_event_aio_t *aio, u_char *buf, size_t size,
+    off_t offset)
+{
+    struct io_uring_sqe  *sqe;
+
+    sqe = ngx_iouring_get_sqe(aio->event.log);
+    if (sqe == NULL) {
+        return NGX_ERROR;
+    }
+
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = aio->fd;
+    sqe->addr = (uint64_t) (uintptr_t) buf;
+    sqe->len = (uint32_t) size;
+    sqe->off = (uint64_t) offset;
+    sqe->user_data = (uint64_t) ((uintptr_t) &aio->event
+                                 | NGX_IOURING_AIO_EVENT);
+
+    return NGX_OK;
+}
+
+#endif
+
+
+static ngx_int_t
+ngx_iouring_process_events(ngx_cycle_t *cycle, ngx_msec_t timer,
+    ngx_uint_t flags)
+{
+    int                              n, res;
+    unsigned                         head, tail, to_submit, cflags;
+    uintptr_t                        data;
+    ngx_int_t                        instance;
+    ngx_uint_t                       level;
+    ngx_err_t                        err;
+    ngx_event_t                     *ev, **queue;
+    ngx_connection_t                *c;
+    struct timespec                  ts;
+    struct io_uring_cqe             *cqe;
+    struct io_uring_getevents_arg    arg;
+#if (NGX_HAVE_FILE_AIO)
+    ngx_event_aio_t                 *aio;
+#endif
+
+    ngx_log_debug1(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                   "io_uring timer: %M", timer);
+
+    ngx_memory_barrier();
+
+    *(volatile unsigned *) sq.tail = sq.local_tail;
+
+    to_submit = sq.local_tail - *(volatile unsigned *) sq.head;
+
+    ngx_memzero(&arg, sizeof(struct io_uring_getevents_arg));
+
+    arg.sigmask_sz = _NSIG / 8;
+
+    if (timer != NGX_TIMER_INFINITE) {
+        ts.tv_sec = timer / 1000;
+        ts.tv_nsec = (timer % 1000) * 1000000;
+        arg.ts = (uint64_t) (uintptr_t) &ts;
+    }
+
+    n = io_uring_enter(ring, to_submit, 1,
+                       IORING_ENTER_GETEVENTS|IORING_ENTER_EXT_ARG,
+                       &arg, sizeof(struct io_uring_getevents_arg));
+
+    err = (n == -1) ? ngx_errno : 0;
+
+    if (flags & NGX_UPDATE_TIME || ngx_event_timer_alarm) {
+        ngx_time_update();
+    }
+
+    if (err) {
+        if (err == NGX_EINTR) {
+
+            if (ngx_event_timer_alarm) {
+                ngx_event_timer_alarm = 0;
+                return NGX_OK;
+            }
+
+            level = NGX_LOG_INFO;
+
+        } else if (err == ETIME || err == NGX_EBUSY || err == NGX_EAGAIN) {
+
+            /* the timeout or the completion ring overflow */
+
+            level = 0;
+
+        } else {
+            level = NGX_LOG_ALERT;
+        }
+
+        if (level) {
+            ngx_log_error(level, cycle->log, err, "io_uring_enter() failed");
+            return NGX_ERROR;
+        }
+    }
+
+    head = *(volatile unsigned *) cq.head;
+    tail = *(volatile unsigned *) cq.tail;
+
+    ngx_memory_barrier();
+
+    if (head == tail) {
+        if (timer != NGX_TIMER_INFINITE || err) {
+            return NGX_OK;
+        }
+
+        ngx_log_error(NGX_LOG_ALERT, cycle->log, 0,
+                      "io_uring_enter() returned no events without timeout");
+        return NGX_ERROR;
+    }
+
+    ngx_mutex_lock(ngx_posted_events_mutex);
+
+    while (head != tail) {
+        cqe = &cq.cqes[head & cq.mask];
+
+        data = (uintptr_t) cqe->user_data;
+        res = cqe->res;
+        cflags = cqe->flags;
+
+        head++;
+
+        ngx_memory_barrier();
+
+        *(volatile unsigned *) cq.head = head;
+
+        ngx_log_debug3(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                       "io_uring: d:%p res:%d f:%ud",
+                       (void *) data, res, cflags);
+
+        if (data == 0) {
+            continue;
+        }
+
+        if ((data & NGX_IOURING_DATA_MASK) == NGX_IOURING_ACCEPT_EVENT) {
+            ngx_iouring_accept_complete((ngx_iouring_accept_slot_t *)
+                                        (data & ~NGX_IOURING_DATA_MASK),
+                                        res, flags);
+            continue;
+        }
+
+#if (NGX_HAVE_FILE_AIO)
+
+        if (data & NGX_IOURING_AIO_EVENT) {
+            ev = (ngx_event_t *) (data & ~NGX_IOURING_DATA_MASK);
+
+            ev->complete = 1;
+            ev->active = 0;
+            ev->ready = 1;
+
+            aio = ev->data;
+            aio->res = res;
+
+            ngx_locked_post_event(ev, &ngx_posted_events);
+
+            continue;
+        }
+
+#endif
+
+        instance = data & 1;
+        ev = (ngx_event_t *) (data & ~NGX_IOURING_DATA_MASK);
+
+        if (res == -NGX_ECANCELED) {
+            continue;
+        }
+
+#if (NGX_HAVE_EVENTFD)
+
+        if (ev == &notify_event) {
+
+            if (!(cflags & IORING_CQE_F_MORE)) {
+                (void) ngx_iouring_poll_add(ev, notify_fd, 1);
+            }
+
+            if (flags & NGX_POST_EVENTS) {
+                ngx_locked_post_event(ev, &ngx_posted_events);
+
+            } else {
+                ev->handler(ev);
+            }
+
+            continue;
+        }
+
+#endif
+
+        c = ev->data;
+
+        if (c->fd == -1 || ev->instance != instance || !ev->active) {
+
+            /*
+             * the stale event from a file descriptor
+             * that was just closed or deleted in this iteration
+             */
+
+            ngx_log_debug1(NGX_LOG_DEBUG_EVENT, cycle->log, 0,
+                           "io_uring: stale event %p", ev);
+            continue;
+        }
+
+        if (res < 0) {
+
+            /*
+             * the failed poll request is not rearmed to not spin
+             * on a bad descriptor, the handler gets the error itself
+             */
+
+            ngx_log_error(NGX_LOG_ALERT, cycle->log, -res,
+                          "io_uring poll on fd:%d w:%d failed",
+                          c->fd, ev->write);
+
+            ev->active = 0;
+
+        } else if (!(cflags & IORING_CQE_F_MORE)) {
+
+            /* a oneshot request or a terminated multishot one */
+
+            if (ngx_iouring_poll_add(ev, c->fd, !ev->oneshot) != NGX_OK) {
+                ev->active = 0;
+            }
+        }
+
+        if ((flags & NGX_POST_THREAD_EVENTS) && !ev->accept) {
+            ev->posted_ready = 1;
+
+        } else {
+            ev->ready = 1;
+        }
+
+        if (flags & NGX_POST_EVENTS) {
+            queue = (ngx_event_t **) (ev->accept ?
+                           &ngx_posted_accept_events : &ngx_posted_events);
+
+            ngx_locked_post_event(ev, queue);
+
+        } else {
+            ev->handler(ev);
+        }
+    }
+
+    ngx_mutex_unlock(ngx_posted_events_mutex);
+
+    return NGX_OK;
+}
+
+
+static void *
+ngx_iouring_create_conf(ngx_cycle_t *cycle)
+{
+    ngx_iouring_conf_t  *iucf;
+
+    iucf = ngx_palloc(cycle->pool, sizeof(ngx_iouring_conf_t));
+    if (iucf == NULL) {
+        return NULL;
+    }
+
+    iucf->entries = NGX_CONF_UNSET;
+
+    return iucf;
+}
+
+
+static char *
+ngx_iouring_init_conf(ngx_cycle_t *cycle, void *conf)
+{
+    ngx_iouring_conf_t *iucf = conf;
+
+    ngx_conf_init_uint_value(iucf->entries, 1024);
+
+    return NGX_CONF_OK;
+}
@@ -73,6 +73,15 @@ ngx_atomic_t  *ngx_stat_reading = &ngx_stat_reading0;
 ngx_atomic_t   ngx_stat_writing0;
 ngx_atomic_t  *ngx_stat_writing = &ngx_stat_writing0;
 
+#if (NGX_PCRE)
+ngx_atomic_t   ngx_stat_regex_exec0;
+ngx_atomic_t  *ngx_stat_regex_exec = &ngx_stat_regex_exec0;
+ngx_atomic_t   ngx_stat_regex_match0;
+ngx_atomic_t  *ngx_stat_regex_match = &ngx_stat_regex_match0;
+ngx_atomic_t   ngx_stat_regex_time0;
+ngx_atomic_t  *ngx_stat_regex_time = &ngx_stat_regex_time0;
+#endif
+
 #endif
 
 
@@ -160,6 +169,13 @@ static ngx_command_t  ngx_event_core_commands[] = {
       offsetof(ngx_event_conf_t, accept_mutex_delay),
       NULL },
 
+    { ngx_string("timer_wheel"),
+      NGX_EVENT_CONF|NGX_CONF_FLAG,
+      ngx_conf_set_flag_slot,
+      0,
+      offsetof(ngx_event_conf_t, timer_wheel),
+      NULL },
+
     { ngx_string("debug_connection"),
       NGX_EVENT_CONF|NGX_CONF_TAKE1,
       ngx_event_debug_connection,
@@ -176,7 +192,7 @@ ngx_event_module_t  ngx_event_core_module_ctx = {
     ngx_event_create_conf,                 /* create configuration */
     ngx_event_init_conf,                   /* init configuration */
 
-    { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }
+    { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL }
 };
 
 
@@ -506,6 +522,14 @@ ngx_event_module_init(ngx_cycle_t *cycle)
            + cl          /* ngx_stat_reading */
            + cl;         /* ngx_stat_writing */
 
+#if (NGX_PCRE)
+
+    size += cl           /* ngx_stat_regex_exec */
+           + cl          /* ngx_stat_regex_match */
+           + cl;         /* ngx_stat_regex_time */
+
+#endif
+
 #endif
 
     shm.size = size;
@@ -551,6 +575,14 @@ ngx_event_module_init(ngx_cycle_t *cycle)
     ngx_stat_reading = (ngx_atomic_t *) (shared + 7 * cl);
     ngx_stat_writing = (ngx_atomic_t *) (shared + 8 * cl);
 
+#if (NGX_PCRE)
+
+    ngx_stat_regex_exec = (ngx_atomic_t *) (shared + 9 * cl);
+    ngx_stat_regex_match = (ngx_atomic_t *) (shared + 10 * cl);
+    ngx_stat_regex_time = (ngx_atomic_t *) (shared + 11 * cl);
+
+#endif
+
 #endif
 
     return NGX_OK;
@@ -602,6 +634,8 @@ ngx_event_process_init(ngx_cycle_t *cycle)
     }
 #endif
 
+    ngx_use_timer_wheel = ecf->timer_wheel;
+
     if (ngx_event_timer_init(cycle->log) == NGX_ERROR) {
         return NGX_ERROR;
     }
@@ -737,6 +771,15 @@ ngx_event_process_init(ngx_cycle_t *cycle)
     ls = cycle->listening.elts;
     for (i = 0; i < cycle->listening.nelts; i++) {
 
+#if (NGX_HAVE_REUSEPORT)
+        if (ls[i].reuseport
+            && ngx_process == NGX_PROCESS_WORKER
+            && ls[i].worker != ngx_worker)
+        {
+            continue;
+        }
+#endif
+
         c = ngx_get_connection(ls[i].fd, cycle->log);
 
         if (c == NULL) {
@@ -817,6 +860,21 @@ ngx_event_process_init(ngx_cycle_t *cycle)
 
         rev->handler = ngx_event_accept;
 
+#if (NGX_HAVE_REUSEPORT)
+
+        if (ls[i].reuseport) {
+
+            /* each worker accepts on its own socket, no accept mutex */
+
+            if (ngx_add_event(rev, NGX_READ_EVENT, 0) == NGX_ERROR) {
+                return NGX_ERROR;
+            }
+
+            continue;
+        }
+
+#endif
+
         if (ngx_use_accept_mutex) {
             continue;
         }
@@ -1129,6 +1187,7 @@ ngx_event_create_conf(ngx_cycle_t *cycle)
     ecf->multi_accept = NGX_CONF_UNSET;
     ecf->accept_mutex = NGX_CONF_UNSET;
     ecf->accept_mutex_delay = NGX_CONF_UNSET_MSEC;
+    ecf->timer_wheel = NGX_CONF_UNSET;
     ecf->name = (void *) NGX_CONF_UNSET;
 
 #if (NGX_DEBUG)
@@ -1244,6 +1303,18 @@ ngx_event_init_conf(ngx_cycle_t *cycle, void *conf)
     ngx_conf_init_value(ecf->multi_accept, 0);
     ngx_conf_init_value(ecf->accept_mutex, 1);
     ngx_conf_init_msec_value(ecf->accept_mutex_delay, 500);
+    ngx_conf_init_value(ecf->timer_wheel, 0);
+
+#if (NGX_THREADS)
+
+    if (ecf->timer_wheel) {
+        ngx_log_error(NGX_LOG_WARN, cycle->log, 0,
+                      "\"timer_wheel\" is not supported with threads, "
+                      "ignored");
+        ecf->timer_wheel = 0;
+    }
+
+#endif
 
 
 #if (NGX_HAVE_RTSIG)
@@ -139,6 +139,9 @@ struct ngx_event_s {
     unsigned         channel:1;
     unsigned         resolver:1;
 
+    /* the timer does not delay a graceful worker exit */
+    unsigned         cancelable:1;
+
 #if (NGX_THREADS)
 
     unsigned         locked:1;
@@ -218,6 +221,16 @@ struct ngx_event_aio_s {
     ngx_event_t                event;
 };
 
+
+#if (NGX_HAVE_IOURING)
+
+extern ngx_uint_t  ngx_iouring_file_aio;
+
+ngx_int_t ngx_iouring_file_aio_read(ngx_event_aio_t *aio, u_char *buf,
+    size_t size, off_t offset);
+
+#endif
+
 #endif
 
 
@@ -237,6 +250,8 @@ typedef struct {
     ngx_int_t  (*add_conn)(ngx_connection_t *c);
     ngx_int_t  (*del_conn)(ngx_connection_t *c, ngx_uint_t flags);
 
+    ngx_int_t  (*notify)(ngx_event_handler_pt handler);
+
     ngx_int_t  (*process_changes)(ngx_cycle_t *cycle, ngx_uint_t nowait);
     ngx_int_t  (*process_events)(ngx_cycle_t *cycle, ngx_msec_t timer,
                    ngx_uint_t flags);
@@ -329,6 +344,11 @@ extern ngx_event_actions_t   ngx_event_actions;
  */
 #define NGX_USE_VNODE_EVENT      0x00002000
 
+/*
+ * The connections are accepted by the event filter itself: io_uring.
+ */
+#define NGX_USE_IOURING_EVENT    0x00004000
+
 
 /*
  * The event filter is deleted just before the closing file.
@@ -454,6 +474,8 @@ extern ngx_event_actions_t   ngx_event_actions;
 #define ngx_add_conn         ngx_event_actions.add_conn
 #define ngx_del_conn         ngx_event_actions.del_conn
 
+#define ngx_notify           ngx_event_actions.notify
+
 #define ngx_add_timer        ngx_event_add_timer
 #define ngx_del_timer        ngx_event_del_timer
 
@@ -480,6 +502,8 @@ typedef struct {
 
     ngx_msec_t    accept_mutex_delay;
 
+    ngx_flag_t    timer_wheel;
+
     u_char       *name;
 
 #if (NGX_DEBUG)
@@ -518,6 +542,12 @@ extern ngx_atomic_t  *ngx_stat_active;
 extern ngx_atomic_t  *ngx_stat_reading;
 extern ngx_atomic_t  *ngx_stat_writing;
 
+#if (NGX_PCRE)
+extern ngx_atomic_t  *ngx_stat_regex_exec;
+extern ngx_atomic_t  *ngx_stat_regex_match;
+extern ngx_atomic_t  *ngx_stat_regex_time;     /* microseconds */
+#endif
+
 #endif
 
 
@@ -554,6 +584,12 @@ u_char *ngx_acceptex_log_error(ngx_log_t *log, u_char *buf, size_t len);
 #endif
 
 
+#if (NGX_HAVE_IOURING)
+ngx_socket_t ngx_iouring_accept(ngx_event_t *ev, struct sockaddr *sa,
+    socklen_t *socklen);
+#endif
+
+
 ngx_int_t ngx_send_lowat(ngx_connection_t *c, size_t lowat);
 
 
@@ -50,6 +50,13 @@ ngx_event_accept(ngx_event_t *ev)
     do {
         socklen = NGX_SOCKADDRLEN;
 
+#if (NGX_HAVE_IOURING)
+        if (ngx_event_flags & NGX_USE_IOURING_EVENT) {
+            s = ngx_iouring_accept(ev, (struct sockaddr *) sa, &socklen);
+
+        } else
+#endif
+
 #if (NGX_HAVE_ACCEPT4)
         if (use_accept4) {
             s = accept4(lc->fd, (struct sockaddr *) sa, &socklen,
@@ -342,6 +349,15 @@ ngx_enable_accept_events(ngx_cycle_t *cycle)
     ls = cycle->listening.elts;
     for (i = 0; i < cycle->listening.nelts; i++) {
 
+#if (NGX_HAVE_REUSEPORT)
+
+        /* reuseport sockets do not depend on the accept mutex */
+
+        if (ls[i].reuseport) {
+            continue;
+        }
+#endif
+
         c = ls[i].connection;
 
         if (ngx_event_flags & NGX_USE_RTSIG_EVENT) {
@@ -371,6 +387,12 @@ ngx_disable_accept_events(ngx_cycle_t *cycle)
     ls = cycle->listening.elts;
     for (i = 0; i < cycle->listening.nelts; i++) {
 
+#if (NGX_HAVE_REUSEPORT)
+        if (ls[i].reuseport) {
+            continue;
+        }
+#endif
+
         c = ls[i].connection;
 
         if (!c->read->active) {
@@ -15,9 +15,86 @@ ngx_mutex_t  *ngx_event_timer_mutex;
 #endif
 
 
+/*
+ * The hierarchical timer wheel: the first level has 256 slots of 1ms,
+ * each of the next four levels has 64 slots covering the whole previous
+ * level, so the wheel spans 2^32 milliseconds.  A slot is a circular
+ * list of the event timer nodes linked through the node's left (prev)
+ * and right (next) pointers, the node's color keeps the level number.
+ * Upper level slots are redistributed to lower levels when the first
+ * level wraps around.
+ */
+
+#define NGX_TIMER_WHEEL_TV1_BITS   8
+#define NGX_TIMER_WHEEL_TVN_BITS   6
+#define NGX_TIMER_WHEEL_TV1_SIZE   (1 << NGX_TIMER_WHEEL_TV1_BITS)
+#define NGX_TIMER_WHEEL_TVN_SIZE   (1 << NGX_TIMER_WHEEL_TVN_BITS)
+#define NGX_TIMER_WHEEL_TV1_MASK   (NGX_TIMER_WHEEL_TV1_SIZE - 1)
+#define NGX_TIMER_WHEEL_TVN_MASK   (NGX_TIMER_WHEEL_TVN_SIZE - 1)
+#define NGX_TIMER_WHEEL_LEVELS     4
+#define NGX_TIMER_WHEEL_MAX        (ngx_msec_t) 0xffffffff
+
+
+typedef struct {
+    /* the next tick to be expired */
+    ngx_msec_t                     current;
+
+    ngx_uint_t                     timers;
+    ngx_uint_t                     count[NGX_TIMER_WHEEL_LEVELS + 1];
+
+    ngx_rbtree_node_t              tv1[NGX_TIMER_WHEEL_TV1_SIZE];
+    ngx_rbtree_node_t              tvn[NGX_TIMER_WHEEL_LEVELS]
+                                      [NGX_TIMER_WHEEL_TVN_SIZE];
+} ngx_event_timer_wheel_t;
+
+
+#define ngx_timer_wheel_init_slot(h)                                          \
+    (h)->left = h;                                                            \
+    (h)->right = h
+
+#define ngx_timer_wheel_empty(h)                                              \
+    ((h)->right == h)
+
+#define ngx_timer_wheel_append(h, x)                                          \
+    (x)->left = (h)->left;                                                    \
+    (x)->left->right = x;                                                     \
+    (x)->right = h;                                                           \
+    (h)->left = x
+
+#define ngx_timer_wheel_unlink(x)                                             \
+    (x)->right->left = (x)->left;                                             \
+    (x)->left->right = (x)->right
+
+/* move all nodes of the slot h to the empty list l */
+
+#define ngx_timer_wheel_move(h, l)                                            \
+    if (ngx_timer_wheel_empty(h)) {                                           \
+        ngx_timer_wheel_init_slot(l);                                         \
+    } else {                                                                  \
+        (l)->left = (h)->left;                                                \
+        (l)->right = (h)->right;                                              \
+        (l)->left->right = l;                                                 \
+        (l)->right->left = l;                                                 \
+        ngx_timer_wheel_init_slot(h);                                         \
+    }
+
+
+static void ngx_event_timer_wheel_init(void);
+static void ngx_event_timer_wheel_link(ngx_rbtree_node_t *node);
+static void ngx_event_timer_wheel_cascade(ngx_uint_t level, ngx_uint_t n);
+static ngx_msec_t ngx_event_timer_wheel_find(void);
+static void ngx_event_timer_wheel_expire(void);
+static ngx_int_t ngx_event_no_timers_left_rbtree(ngx_rbtree_node_t *node,
+    ngx_rbtree_node_t *sentinel);
+static ngx_int_t ngx_event_no_timers_left_slot(ngx_rbtree_node_t *head);
+
+
 ngx_thread_volatile ngx_rbtree_t  ngx_event_timer_rbtree;
 static ngx_rbtree_node_t          ngx_event_timer_sentinel;
 
+ngx_uint_t                        ngx_use_timer_wheel;
+static ngx_event_timer_wheel_t    ngx_event_timer_wheel;
+
 /*
  * the event timer rbtree may contain the duplicate keys, however,
  * it should not be a problem, because we use the rbtree to find
@@ -30,6 +107,10 @@ ngx_event_timer_init(ngx_log_t *log)
     ngx_rbtree_init(&ngx_event_timer_rbtree, &ngx_event_timer_sentinel,
                     ngx_rbtree_insert_timer_value);
 
+    if (ngx_use_timer_wheel) {
+        ngx_event_timer_wheel_init();
+    }
+
 #if (NGX_THREADS)
 
     if (ngx_event_timer_mutex) {
@@ -54,6 +135,10 @@ ngx_event_find_timer(void)
     ngx_msec_int_t      timer;
     ngx_rbtree_node_t  *node, *root, *sentinel;
 
+    if (ngx_use_timer_wheel) {
+        return ngx_event_timer_wheel_find();
+    }
+
     if (ngx_event_timer_rbtree.root == &ngx_event_timer_sentinel) {
         return NGX_TIMER_INFINITE;
     }
@@ -79,6 +164,11 @@ ngx_event_expire_timers(void)
     ngx_event_t        *ev;
     ngx_rbtree_node_t  *node, *root, *sentinel;
 
+    if (ngx_use_timer_wheel) {
+        ngx_event_timer_wheel_expire();
+        return;
+    }
+
     sentinel = ngx_event_timer_rbtree.sentinel;
 
     for ( ;; ) {
@@ -157,3 +247,368 @@ ngx_event_expire_timers(void)
 
     ngx_mutex_unlock(ngx_event_timer_mutex);
 }
+
+
+/*
+ * returns NGX_OK if only timers of cancelable events, e.g. periodic
+ * background jobs, remain, so a gracefully exiting worker need not wait
+ */
+
+ngx_int_t
+ngx_event_no_timers_left(void)
+{
+    ngx_int_t                 rc;
+    ngx_uint_t                i, level;
+    ngx_event_timer_wheel_t  *w;
+
+    rc = NGX_OK;
+
+    ngx_mutex_lock(ngx_event_timer_mutex);
+
+    if (ngx_use_timer_wheel) {
+        w = &ngx_event_timer_wheel;
+
+        for (i = 0; rc == NGX_OK && i < NGX_TIMER_WHEEL_TV1_SIZE; i++) {
+            rc = ngx_event_no_timers_left_slot(&w->tv1[i]);
+        }
+
+        for (level = 0; level < NGX_TIMER_WHEEL_LEVELS; level++) {
+            for (i = 0; rc == NGX_OK && i < NGX_TIMER_WHEEL_TVN_SIZE; i++) {
+                rc = ngx_event_no_timers_left_slot(&w->tvn[level][i]);
+            }
+        }
+
+    } else if (ngx_event_timer_rbtree.root != &ngx_event_timer_sentinel) {
+        rc = ngx_event_no_timers_left_rbtree(ngx_event_timer_rbtree.root,
+                                             &ngx_event_timer_sentinel);
+    }
+
+    ngx_mutex_unlock(ngx_event_timer_mutex);
+
+    return rc;
+}
+
+
+static ngx_int_t
+ngx_event_no_timers_left_rbtree(ngx_rbtree_node_t *node,
+    ngx_rbtree_node_t *sentinel)
+{
+    ngx_event_t  *ev;
+
+    if (node == sentinel) {
+        return NGX_OK;
+    }
+
+    ev = (ngx_event_t *) ((char *) node - offsetof(ngx_event_t, timer));
+
+    if (!ev->cancelable) {
+        return NGX_AGAIN;
+    }
+
+    if (ngx_event_no_timers_left_rbtree(node->left, sentinel) != NGX_OK) {
+        return NGX_AGAIN;
+    }
+
+    return ngx_event_no_timers_left_rbtree(node->right, sentinel);
+}
+
+
+static ngx_int_t
+ngx_event_no_timers_left_slot(ngx_rbtree_node_t *head)
+{
+    ngx_event_t        *ev;
+    ngx_rbtree_node_t  *node;
+
+    for (node = head->right; node != head; node = node->right) {
+        ev = (ngx_event_t *) ((char *) node - offsetof(ngx_event_t, timer));
+
+        if (!ev->cancelable) {
+            return NGX_AGAIN;
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_event_timer_wheel_init(void)
+{
+    ngx_uint_t                i, level;
+    ngx_event_timer_wheel_t  *w;
+
+    w = &ngx_event_timer_wheel;
+
+    w->current = ngx_current_msec;
+    w->timers = 0;
+
+    for (level = 0; level <= NGX_TIMER_WHEEL_LEVELS; level++) {
+        w->count[level] = 0;
+    }
+
+    for (i = 0; i < NGX_TIMER_WHEEL_TV1_SIZE; i++) {
+        ngx_timer_wheel_init_slot(&w->tv1[i]);
+    }
+
+    for (level = 0; level < NGX_TIMER_WHEEL_LEVELS; level++) {
+        for (i = 0; i < NGX_TIMER_WHEEL_TVN_SIZE; i++) {
+            ngx_timer_wheel_init_slot(&w->tvn[level][i]);
+        }
+    }
+}
+
+
+void
+ngx_event_timer_wheel_insert(ngx_rbtree_node_t *node)
+{
+    ngx_event_timer_wheel.timers++;
+
+    ngx_event_timer_wheel_link(node);
+}
+
+
+void
+ngx_event_timer_wheel_delete(ngx_rbtree_node_t *node)
+{
+    ngx_timer_wheel_unlink(node);
+
+    ngx_event_timer_wheel.count[node->color]--;
+    ngx_event_timer_wheel.timers--;
+}
+
+
+static void
+ngx_event_timer_wheel_link(ngx_rbtree_node_t *node)
+{
+    ngx_uint_t                level, shift;
+    ngx_msec_t                expires, diff;
+    ngx_rbtree_node_t        *head;
+    ngx_event_timer_wheel_t  *w;
+
+    w = &ngx_event_timer_wheel;
+
+    expires = node->key;
+    diff = expires - w->current;
+
+    if ((ngx_msec_int_t) diff < 0) {
+
+        /* already expired, the earliest slot to run is the current one */
+
+        level = 0;
+        head = &w->tv1[w->current & NGX_TIMER_WHEEL_TV1_MASK];
+
+    } else if (diff < NGX_TIMER_WHEEL_TV1_SIZE) {
+        level = 0;
+        head = &w->tv1[expires & NGX_TIMER_WHEEL_TV1_MASK];
+
+    } else {
+
+        if (diff > NGX_TIMER_WHEEL_MAX) {
+            diff = NGX_TIMER_WHEEL_MAX;
+            expires = w->current + diff;
+        }
+
+        level = 1;
+        shift = NGX_TIMER_WHEEL_TV1_BITS;
+
+        while (level < NGX_TIMER_WHEEL_LEVELS
+               && diff >= (ngx_msec_t) 1 << (shift + NGX_TIMER_WHEEL_TVN_BITS))
+        {
+            level++;
+            shift += NGX_TIMER_WHEEL_TVN_BITS;
+        }
+
+        head = &w->tvn[level - 1][(expires >> shift) & NGX_TIMER_WHEEL_TVN_MASK];
+    }
+
+    node->color = (u_char) level;
+    w->count[level]++;
+
+    ngx_timer_wheel_append(head, node);
+}
+
+
+static void
+ngx_event_timer_wheel_cascade(ngx_uint_t level, ngx_uint_t n)
+{
+    ngx_rbtree_node_t        *node, list;
+    ngx_event_timer_wheel_t  *w;
+
+    w = &ngx_event_timer_wheel;
+
+    ngx_timer_wheel_move(&w->tvn[level - 1][n], &list);
+
+    while (!ngx_timer_wheel_empty(&list)) {
+        node = list.right;
+
+        ngx_timer_wheel_unlink(node);
+        w->count[level]--;
+
+        ngx_event_timer_wheel_link(node);
+    }
+}
+
+
+static ngx_msec_t
+ngx_event_timer_wheel_find(void)
+{
+    ngx_uint_t                i, n, level, shift;
+    ngx_msec_t                base, next, t;
+    ngx_msec_int_t            timer;
+    ngx_event_timer_wheel_t  *w;
+
+    w = &ngx_event_timer_wheel;
+
+    if (w->timers == 0) {
+        return NGX_TIMER_INFINITE;
+    }
+
+    next = w->current + NGX_TIMER_WHEEL_MAX;
+
+    if (w->count[0]) {
+        for (i = 0; i < NGX_TIMER_WHEEL_TV1_SIZE; i++) {
+            n = (w->current + i) & NGX_TIMER_WHEEL_TV1_MASK;
+
+            if (!ngx_timer_wheel_empty(&w->tv1[n])) {
+                next = w->current + i;
+                break;
+            }
+        }
+    }
+
+    /*
+     * timers of an upper level slot expire not earlier than the slot
+     * is cascaded, so the cascade time is a safe estimate
+     */
+
+    shift = NGX_TIMER_WHEEL_TV1_BITS;
+
+    for (level = 1; level <= NGX_TIMER_WHEEL_LEVELS; level++) {
+
+        if (w->count[level]) {
+            base = w->current >> shift;
+
+            for (i = 0; i < NGX_TIMER_WHEEL_TVN_SIZE; i++) {
+                n = (base + i) & NGX_TIMER_WHEEL_TVN_MASK;
+
+                if (ngx_timer_wheel_empty(&w->tvn[level - 1][n])) {
+                    continue;
+                }
+
+                if (i) {
+                    t = (base + i) << shift;
+
+                } else if ((w->current & (((ngx_msec_t) 1 << shift) - 1)) == 0)
+                {
+                    t = w->current;
+
+                } else {
+                    t = (base + NGX_TIMER_WHEEL_TVN_SIZE) << shift;
+                }
+
+                if ((ngx_msec_int_t) (t - next) < 0) {
+                    next = t;
+                }
+
+                if (i) {
+                    break;
+                }
+            }
+        }
+
+        shift += NGX_TIMER_WHEEL_TVN_BITS;
+    }
+
+    timer = (ngx_msec_int_t) (next - ngx_current_msec);
+
+    return (ngx_msec_t) (timer > 0 ? timer : 0);
+}
+
+
+static void
+ngx_event_timer_wheel_expire(void)
+{
+    ngx_uint_t                n, level, shift;
+    ngx_msec_t                next;
+    ngx_event_t              *ev;
+    ngx_rbtree_node_t        *node, expired;
+    ngx_event_timer_wheel_t  *w;
+
+    w = &ngx_event_timer_wheel;
+
+    while ((ngx_msec_int_t) (ngx_current_msec - w->current) >= 0) {
+
+        if (w->timers == 0) {
+            w->current = ngx_current_msec + 1;
+            return;
+        }
+
+        n = w->current & NGX_TIMER_WHEEL_TV1_MASK;
+
+        if (n == 0) {
+            shift = NGX_TIMER_WHEEL_TV1_BITS;
+
+            for (level = 1; level <= NGX_TIMER_WHEEL_LEVELS; level++) {
+                n = (w->current >> shift) & NGX_TIMER_WHEEL_TVN_MASK;
+
+                ngx_event_timer_wheel_cascade(level, n);
+
+                if (n) {
+                    break;
+                }
+
+                shift += NGX_TIMER_WHEEL_TVN_BITS;
+            }
+
+            n = 0;
+
+        } else if (w->count[0] == 0) {
+
+            /* skip to the next cascade */
+
+            next = (w->current | NGX_TIMER_WHEEL_TV1_MASK) + 1;
+
+            if ((ngx_msec_int_t) (ngx_current_msec - next) < 0) {
+                w->current = ngx_current_msec + 1;
+                return;
+            }
+
+            w->current = next;
+            continue;
+        }
+
+        /*
+         * move the slot to a local list and advance the wheel, so that
+         * timers added by the handlers are not linked to the list
+         * being expired
+         */
+
+        ngx_timer_wheel_move(&w->tv1[n], &expired);
+
+        w->current++;
+
+        while (!ngx_timer_wheel_empty(&expired)) {
+            node = expired.right;
+
+            ev = (ngx_event_t *) ((char *) node - offsetof(ngx_event_t, timer));
+
+            ngx_log_debug2(NGX_LOG_DEBUG_EVENT, ev->log, 0,
+                           "event timer del: %d: %M",
+                           ngx_event_ident(ev->data), ev->timer.key);
+
+            ngx_event_timer_wheel_delete(node);
+
+#if (NGX_DEBUG)
+            ev->timer.left = NULL;
+            ev->timer.right = NULL;
+            ev->timer.parent = NULL;
+#endif
+
+            ev->timer_set = 0;
+
+            ev->timedout = 1;
+
+            ev->handler(ev);
+        }
+    }
+}
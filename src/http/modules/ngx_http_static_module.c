@@ -10,7 +10,21 @@
 #include <ngx_http.h>
 
 
+#if (NGX_THREAD_POOL)
+
+typedef struct {
+    ngx_thread_task_t         *open_task;
+} ngx_http_static_ctx_t;
+
+#endif
+
+
 static ngx_int_t ngx_http_static_handler(ngx_http_request_t *r);
+#if (NGX_THREAD_POOL)
+static ngx_int_t ngx_http_static_thread_handler(ngx_thread_task_t *task,
+    ngx_open_file_info_t *of);
+static void ngx_http_static_thread_event_handler(ngx_event_t *ev);
+#endif
 static ngx_int_t ngx_http_static_init(ngx_conf_t *cf);
 
 
@@ -58,6 +72,9 @@ ngx_http_static_handler(ngx_http_request_t *r)
     ngx_chain_t                out;
     ngx_open_file_info_t       of;
     ngx_http_core_loc_conf_t  *clcf;
+#if (NGX_THREAD_POOL)
+    ngx_http_static_ctx_t     *ctx;
+#endif
 
     if (!(r->method & (NGX_HTTP_GET|NGX_HTTP_HEAD|NGX_HTTP_POST))) {
         return NGX_HTTP_NOT_ALLOWED;
@@ -95,9 +112,44 @@ ngx_http_static_handler(ngx_http_request_t *r)
     of.errors = clcf->open_file_cache_errors;
     of.events = clcf->open_file_cache_events;
 
-    if (ngx_open_cached_file(clcf->open_file_cache, &path, &of, r->pool)
-        != NGX_OK)
-    {
+#if (NGX_THREAD_POOL)
+
+    if (clcf->aio == NGX_HTTP_AIO_THREADS) {
+        ctx = ngx_http_get_module_ctx(r, ngx_http_static_module);
+
+        if (ctx == NULL) {
+            ctx = ngx_pcalloc(r->pool, sizeof(ngx_http_static_ctx_t));
+            if (ctx == NULL) {
+                return NGX_HTTP_INTERNAL_SERVER_ERROR;
+            }
+
+            ngx_http_set_ctx(r, ctx, ngx_http_static_module);
+        }
+
+        of.thread_handler = ngx_http_static_thread_handler;
+        of.thread_ctx = r;
+        of.thread_task = &ctx->open_task;
+    }
+
+#endif
+
+    rc = ngx_open_cached_file(clcf->open_file_cache, &path, &of, r->pool);
+
+#if (NGX_THREAD_POOL)
+
+    if (rc == NGX_AGAIN) {
+
+        /* the handler is called again when open() completes */
+
+        r->main->count++;
+        r->write_event_handler = ngx_http_core_run_phases;
+
+        return NGX_DONE;
+    }
+
+#endif
+
+    if (rc != NGX_OK) {
         switch (of.err) {
 
         case 0:
@@ -259,6 +311,53 @@ ngx_http_static_handler(ngx_http_request_t *r)
 }
 
 
+#if (NGX_THREAD_POOL)
+
+static ngx_int_t
+ngx_http_static_thread_handler(ngx_thread_task_t *task,
+    ngx_open_file_info_t *of)
+{
+    ngx_http_request_t        *r;
+    ngx_http_core_loc_conf_t  *clcf;
+
+    r = of->thread_ctx;
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    task->event.data = r;
+    task->event.handler = ngx_http_static_thread_event_handler;
+
+    if (ngx_thread_task_post(clcf->thread_pool, task) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    r->main->blocked++;
+    r->aio = 1;
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_static_thread_event_handler(ngx_event_t *ev)
+{
+    ngx_connection_t    *c;
+    ngx_http_request_t  *r;
+
+    r = ev->data;
+    c = r->connection;
+
+    r->main->blocked--;
+    r->aio = 0;
+
+    r->write_event_handler(r);
+
+    ngx_http_run_posted_requests(c);
+}
+
+#endif
+
+
 static ngx_int_t
 ngx_http_static_init(ngx_conf_t *cf)
 {
@@ -93,6 +93,11 @@ static ngx_int_t ngx_http_status_handler(ngx_http_request_t *r)
            + 6 + 3 * NGX_ATOMIC_T_LEN
            + sizeof("Reading:  Writing:  Waiting:  \n") + 3 * NGX_ATOMIC_T_LEN;
 
+#if (NGX_PCRE)
+    size += sizeof("Regex executions:  matched:  usec:  \n")
+            + 3 * NGX_ATOMIC_T_LEN;
+#endif
+
     b = ngx_create_temp_buf(r->pool, size);
     if (b == NULL) {
         return NGX_HTTP_INTERNAL_SERVER_ERROR;
@@ -118,6 +123,13 @@ static ngx_int_t ngx_http_status_handler(ngx_http_request_t *r)
     b->last = ngx_sprintf(b->last, "Reading: %uA Writing: %uA Waiting: %uA \n",
                           rd, wr, ac - (rd + wr));
 
+#if (NGX_PCRE)
+    b->last = ngx_sprintf(b->last,
+                          "Regex executions: %uA matched: %uA usec: %uA \n",
+                          *ngx_stat_regex_exec, *ngx_stat_regex_match,
+                          *ngx_stat_regex_time);
+#endif
+
     r->headers_out.status = NGX_HTTP_OK;
     r->headers_out.content_length_n = b->last - b->pos;
 
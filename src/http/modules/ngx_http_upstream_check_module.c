@@ -0,0 +1,960 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_event.h>
+#include <ngx_event_connect.h>
+#include <ngx_http.h>
+
+
+#define NGX_HTTP_CHECK_TCP             1
+#define NGX_HTTP_CHECK_HTTP            2
+#define NGX_HTTP_CHECK_SEND            3
+
+#define NGX_HTTP_CHECK_HTTP_2XX        0x0004
+#define NGX_HTTP_CHECK_HTTP_3XX        0x0008
+#define NGX_HTTP_CHECK_HTTP_4XX        0x0010
+#define NGX_HTTP_CHECK_HTTP_5XX        0x0020
+
+#define NGX_HTTP_CHECK_BUFFER_SIZE     1024
+
+/* the zone is sized in steps to be reused across reloads */
+#define NGX_HTTP_CHECK_ZONE_PEERS      256
+
+
+typedef struct {
+    ngx_uint_t                          type;
+
+    ngx_msec_t                          interval;
+    ngx_msec_t                          timeout;
+
+    ngx_uint_t                          fall;
+    ngx_uint_t                          rise;
+
+    ngx_str_t                           send;
+    ngx_str_t                           expect;
+    ngx_uint_t                          http_expect_alive;
+} ngx_http_upstream_check_srv_conf_t;
+
+
+typedef struct {
+    ngx_pid_t                           owner;
+    ngx_msec_t                          access_time;
+
+    ngx_uint_t                          fall_count;
+    ngx_uint_t                          rise_count;
+
+    ngx_uint_t                          down;
+
+    socklen_t                           socklen;
+    u_char                              sockaddr[NGX_SOCKADDRLEN];
+} ngx_http_upstream_check_peer_shm_t;
+
+
+typedef struct {
+    ngx_uint_t                          number;
+    ngx_http_upstream_check_peer_shm_t  peer[1];
+} ngx_http_upstream_check_peers_shm_t;
+
+
+typedef struct {
+    ngx_uint_t                          index;
+    ngx_addr_t                         *addr;
+    ngx_http_upstream_check_srv_conf_t *conf;
+
+    ngx_event_t                         event;
+    ngx_peer_connection_t               pc;
+
+    u_char                             *sent;
+    ngx_buf_t                           buffer;
+
+    ngx_http_upstream_check_peer_shm_t *shm;
+} ngx_http_upstream_check_peer_t;
+
+
+typedef struct {
+    ngx_array_t                         peers;
+
+    ngx_shm_zone_t                     *shm_zone;
+    ngx_slab_pool_t                    *shpool;
+    ngx_http_upstream_check_peers_shm_t *sh;
+} ngx_http_upstream_check_main_conf_t;
+
+
+static void ngx_http_upstream_check_begin_handler(ngx_event_t *ev);
+static void ngx_http_upstream_check_connect(
+    ngx_http_upstream_check_peer_t *peer);
+static void ngx_http_upstream_check_send_handler(ngx_event_t *wev);
+static void ngx_http_upstream_check_recv_handler(ngx_event_t *rev);
+static ngx_int_t ngx_http_upstream_check_parse(
+    ngx_http_upstream_check_peer_t *peer);
+static void ngx_http_upstream_check_finalize(
+    ngx_http_upstream_check_peer_t *peer, ngx_uint_t alive);
+
+static ngx_int_t ngx_http_upstream_check_init_zone(ngx_shm_zone_t *shm_zone,
+    void *data);
+static ngx_int_t ngx_http_upstream_check_init_process(ngx_cycle_t *cycle);
+static void ngx_http_upstream_check_exit_process(ngx_cycle_t *cycle);
+
+static void *ngx_http_upstream_check_create_main_conf(ngx_conf_t *cf);
+static void *ngx_http_upstream_check_create_srv_conf(ngx_conf_t *cf);
+static ngx_int_t ngx_http_upstream_check_init(ngx_conf_t *cf);
+
+static char *ngx_http_upstream_check(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+
+
+static ngx_conf_bitmask_t  ngx_http_upstream_check_http_masks[] = {
+    { ngx_string("http_2xx"), NGX_HTTP_CHECK_HTTP_2XX },
+    { ngx_string("http_3xx"), NGX_HTTP_CHECK_HTTP_3XX },
+    { ngx_string("http_4xx"), NGX_HTTP_CHECK_HTTP_4XX },
+    { ngx_string("http_5xx"), NGX_HTTP_CHECK_HTTP_5XX },
+    { ngx_null_string, 0 }
+};
+
+
+static ngx_command_t  ngx_http_upstream_check_commands[] = {
+
+    { ngx_string("check"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_ANY,
+      ngx_http_upstream_check,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      0,
+      NULL },
+
+    { ngx_string("check_send"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_str_slot,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      offsetof(ngx_http_upstream_check_srv_conf_t, send),
+      NULL },
+
+    { ngx_string("check_expect"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_TAKE1,
+      ngx_conf_set_str_slot,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      offsetof(ngx_http_upstream_check_srv_conf_t, expect),
+      NULL },
+
+    { ngx_string("check_http_expect_alive"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_1MORE,
+      ngx_conf_set_bitmask_slot,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      offsetof(ngx_http_upstream_check_srv_conf_t, http_expect_alive),
+      &ngx_http_upstream_check_http_masks },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_upstream_check_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    ngx_http_upstream_check_init,          /* postconfiguration */
+
+    ngx_http_upstream_check_create_main_conf, /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    ngx_http_upstream_check_create_srv_conf, /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_upstream_check_module = {
+    NGX_MODULE_V1,
+    &ngx_http_upstream_check_module_ctx,   /* module context */
+    ngx_http_upstream_check_commands,      /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    ngx_http_upstream_check_init_process,  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    ngx_http_upstream_check_exit_process,  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_str_t  ngx_http_upstream_check_default_send =
+    ngx_string("GET / HTTP/1.0" CRLF CRLF);
+
+
+ngx_uint_t
+ngx_http_upstream_check_add_peer(ngx_conf_t *cf,
+    ngx_http_upstream_srv_conf_t *us, ngx_addr_t *addr)
+{
+    ngx_http_upstream_check_peer_t       *peer;
+    ngx_http_upstream_check_srv_conf_t   *ucscf;
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    if (us->srv_conf == NULL) {
+        return (ngx_uint_t) NGX_ERROR;
+    }
+
+    ucscf = ngx_http_conf_upstream_srv_conf(us, ngx_http_upstream_check_module);
+
+    if (ucscf->type == 0) {
+        return (ngx_uint_t) NGX_ERROR;
+    }
+
+    if (ucscf->type == NGX_HTTP_CHECK_HTTP && ucscf->send.len == 0) {
+        ucscf->send = ngx_http_upstream_check_default_send;
+    }
+
+    if (ucscf->http_expect_alive == 0) {
+        ucscf->http_expect_alive = NGX_HTTP_CHECK_HTTP_2XX
+                                   |NGX_HTTP_CHECK_HTTP_3XX;
+    }
+
+    ucmcf = ngx_http_conf_get_module_main_conf(cf,
+                                               ngx_http_upstream_check_module);
+
+    peer = ngx_array_push(&ucmcf->peers);
+    if (peer == NULL) {
+        return (ngx_uint_t) NGX_ERROR;
+    }
+
+    ngx_memzero(peer, sizeof(ngx_http_upstream_check_peer_t));
+
+    peer->index = ucmcf->peers.nelts - 1;
+    peer->addr = addr;
+    peer->conf = ucscf;
+
+    return peer->index;
+}
+
+
+ngx_uint_t
+ngx_http_upstream_check_peer_down(ngx_uint_t index)
+{
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    ucmcf = ngx_http_cycle_get_module_main_conf(ngx_cycle,
+                                                ngx_http_upstream_check_module);
+
+    if (ucmcf == NULL || ucmcf->sh == NULL || index >= ucmcf->sh->number) {
+        return 0;
+    }
+
+    return ((volatile ngx_http_upstream_check_peer_shm_t *)
+               &ucmcf->sh->peer[index])->down;
+}
+
+
+static void
+ngx_http_upstream_check_begin_handler(ngx_event_t *ev)
+{
+    ngx_uint_t                           own;
+    ngx_msec_t                           elapsed;
+    ngx_http_upstream_check_peer_t      *peer;
+    ngx_http_upstream_check_peer_shm_t  *shm;
+    ngx_http_upstream_check_main_conf_t *ucmcf;
+
+    if (ngx_exiting) {
+        return;
+    }
+
+    peer = ev->data;
+    shm = peer->shm;
+
+    ngx_add_timer(ev, peer->conf->interval / 2);
+
+    if (peer->pc.connection) {
+        return;
+    }
+
+    ucmcf = ngx_http_cycle_get_module_main_conf(ngx_cycle,
+                                                ngx_http_upstream_check_module);
+
+    own = 0;
+
+    /* only one worker probes a peer at a time */
+
+    ngx_shmtx_lock(&ucmcf->shpool->mutex);
+
+    elapsed = ngx_current_msec - shm->access_time;
+
+    if (shm->owner == NGX_INVALID_PID) {
+
+        if (elapsed >= peer->conf->interval) {
+            own = 1;
+        }
+
+    } else if (elapsed > peer->conf->interval + peer->conf->timeout) {
+
+        /* the owner has exited in the middle of a check */
+
+        own = 1;
+    }
+
+    if (own) {
+        shm->owner = ngx_pid;
+        shm->access_time = ngx_current_msec;
+    }
+
+    ngx_shmtx_unlock(&ucmcf->shpool->mutex);
+
+    if (own) {
+        ngx_http_upstream_check_connect(peer);
+    }
+}
+
+
+static void
+ngx_http_upstream_check_connect(ngx_http_upstream_check_peer_t *peer)
+{
+    ngx_int_t          rc;
+    ngx_connection_t  *c;
+
+    ngx_memzero(&peer->pc, sizeof(ngx_peer_connection_t));
+
+    peer->pc.sockaddr = peer->addr->sockaddr;
+    peer->pc.socklen = peer->addr->socklen;
+    peer->pc.name = &peer->addr->name;
+    peer->pc.get = ngx_event_get_peer;
+    peer->pc.log = peer->event.log;
+    peer->pc.log_error = NGX_ERROR_ERR;
+
+    rc = ngx_event_connect_peer(&peer->pc);
+
+    if (rc == NGX_ERROR || rc == NGX_DECLINED || rc == NGX_BUSY) {
+        ngx_http_upstream_check_finalize(peer, 0);
+        return;
+    }
+
+    c = peer->pc.connection;
+
+    c->data = peer;
+    c->log = peer->pc.log;
+    c->sendfile = 0;
+    c->read->log = c->log;
+    c->write->log = c->log;
+
+    c->write->handler = ngx_http_upstream_check_send_handler;
+    c->read->handler = ngx_http_upstream_check_recv_handler;
+
+    peer->sent = peer->conf->send.data;
+    peer->buffer.pos = peer->buffer.start;
+    peer->buffer.last = peer->buffer.start;
+
+    /* the timer on the write event limits the whole check */
+
+    ngx_add_timer(c->write, peer->conf->timeout);
+
+    if (rc == NGX_OK) {
+        ngx_http_upstream_check_send_handler(c->write);
+    }
+}
+
+
+static void
+ngx_http_upstream_check_send_handler(ngx_event_t *wev)
+{
+    int                              err;
+    ssize_t                          n;
+    socklen_t                        len;
+    ngx_connection_t                *c;
+    ngx_http_upstream_check_peer_t  *peer;
+
+    c = wev->data;
+    peer = c->data;
+
+    if (wev->timedout) {
+        ngx_log_error(NGX_LOG_ERR, c->log, 0,
+                      "check timed out for upstream peer %V",
+                      &peer->addr->name);
+
+        ngx_http_upstream_check_finalize(peer, 0);
+        return;
+    }
+
+    if (peer->sent == peer->conf->send.data) {
+
+        err = 0;
+        len = sizeof(int);
+
+        if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, (void *) &err, &len) == -1)
+        {
+            err = ngx_socket_errno;
+        }
+
+        if (err) {
+            ngx_log_error(NGX_LOG_ERR, c->log, err,
+                          "connect() to upstream peer %V failed",
+                          &peer->addr->name);
+
+            ngx_http_upstream_check_finalize(peer, 0);
+            return;
+        }
+
+        if (peer->conf->type == NGX_HTTP_CHECK_TCP) {
+            ngx_http_upstream_check_finalize(peer, 1);
+            return;
+        }
+    }
+
+    while (peer->sent < peer->conf->send.data + peer->conf->send.len) {
+
+        n = c->send(c, peer->sent,
+                    peer->conf->send.data + peer->conf->send.len - peer->sent);
+
+        if (n == NGX_ERROR) {
+            ngx_http_upstream_check_finalize(peer, 0);
+            return;
+        }
+
+        if (n == NGX_AGAIN) {
+            if (ngx_handle_write_event(wev, 0) != NGX_OK) {
+                ngx_http_upstream_check_finalize(peer, 0);
+            }
+
+            return;
+        }
+
+        peer->sent += n;
+    }
+
+    if (peer->conf->type == NGX_HTTP_CHECK_SEND && peer->conf->expect.len == 0)
+    {
+        ngx_http_upstream_check_finalize(peer, 1);
+        return;
+    }
+
+    if (ngx_handle_write_event(wev, 0) != NGX_OK) {
+        ngx_http_upstream_check_finalize(peer, 0);
+        return;
+    }
+
+    if (c->read->ready) {
+        ngx_http_upstream_check_recv_handler(c->read);
+    }
+}
+
+
+static void
+ngx_http_upstream_check_recv_handler(ngx_event_t *rev)
+{
+    ssize_t                          n;
+    ngx_int_t                        rc;
+    ngx_buf_t                       *b;
+    ngx_connection_t                *c;
+    ngx_http_upstream_check_peer_t  *peer;
+
+    c = rev->data;
+    peer = c->data;
+    b = &peer->buffer;
+
+    if (peer->conf->type == NGX_HTTP_CHECK_TCP
+        || peer->sent < peer->conf->send.data + peer->conf->send.len)
+    {
+        /* the connection is checked by the write handler */
+        return;
+    }
+
+    for ( ;; ) {
+
+        n = c->recv(c, b->last, b->end - b->last);
+
+        if (n == NGX_AGAIN) {
+            if (ngx_handle_read_event(rev, 0) != NGX_OK) {
+                ngx_http_upstream_check_finalize(peer, 0);
+            }
+
+            return;
+        }
+
+        if (n == NGX_ERROR) {
+            ngx_http_upstream_check_finalize(peer, 0);
+            return;
+        }
+
+        b->last += n;
+
+        rc = ngx_http_upstream_check_parse(peer);
+
+        if (rc == NGX_AGAIN && n > 0 && b->last < b->end) {
+            continue;
+        }
+
+        if (rc != NGX_OK) {
+            ngx_log_error(NGX_LOG_ERR, c->log, 0,
+                          "check got unexpected response "
+                          "from upstream peer %V", &peer->addr->name);
+        }
+
+        ngx_http_upstream_check_finalize(peer, rc == NGX_OK);
+        return;
+    }
+}
+
+
+static ngx_int_t
+ngx_http_upstream_check_parse(ngx_http_upstream_check_peer_t *peer)
+{
+    u_char      *p, *last;
+    ngx_uint_t   status, mask;
+    ngx_str_t   *expect;
+
+    p = peer->buffer.pos;
+    last = peer->buffer.last;
+
+    if (peer->conf->type == NGX_HTTP_CHECK_SEND) {
+        expect = &peer->conf->expect;
+
+        for ( /* void */ ; p + expect->len <= last; p++) {
+            if (ngx_memcmp(p, expect->data, expect->len) == 0) {
+                return NGX_OK;
+            }
+        }
+
+        return NGX_AGAIN;
+    }
+
+    /* "HTTP/1.1 200 OK" */
+
+    if (last - p < (ssize_t) sizeof("HTTP/1.x 200") - 1) {
+        return NGX_AGAIN;
+    }
+
+    if (ngx_strncmp(p, "HTTP/", 5) != 0) {
+        return NGX_ERROR;
+    }
+
+    p = ngx_strlchr(p, last, ' ');
+
+    if (p == NULL || last - p < 4) {
+        return NGX_AGAIN;
+    }
+
+    p++;
+
+    if (p[0] < '1' || p[0] > '9'
+        || p[1] < '0' || p[1] > '9'
+        || p[2] < '0' || p[2] > '9')
+    {
+        return NGX_ERROR;
+    }
+
+    status = (p[0] - '0') * 100 + (p[1] - '0') * 10 + p[2] - '0';
+
+    switch (status / 100) {
+    case 2:
+        mask = NGX_HTTP_CHECK_HTTP_2XX;
+        break;
+    case 3:
+        mask = NGX_HTTP_CHECK_HTTP_3XX;
+        break;
+    case 4:
+        mask = NGX_HTTP_CHECK_HTTP_4XX;
+        break;
+    case 5:
+        mask = NGX_HTTP_CHECK_HTTP_5XX;
+        break;
+    default:
+        mask = 0;
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, peer->pc.log, 0,
+                   "check http status %ui from %V", status, &peer->addr->name);
+
+    return (mask & peer->conf->http_expect_alive) ? NGX_OK : NGX_ERROR;
+}
+
+
+static void
+ngx_http_upstream_check_finalize(ngx_http_upstream_check_peer_t *peer,
+    ngx_uint_t alive)
+{
+    ngx_http_upstream_check_peer_shm_t   *shm;
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    if (peer->pc.connection) {
+        ngx_close_connection(peer->pc.connection);
+        peer->pc.connection = NULL;
+    }
+
+    ucmcf = ngx_http_cycle_get_module_main_conf(ngx_cycle,
+                                                ngx_http_upstream_check_module);
+
+    shm = peer->shm;
+
+    ngx_shmtx_lock(&ucmcf->shpool->mutex);
+
+    if (alive) {
+        shm->fall_count = 0;
+        shm->rise_count++;
+
+        if (shm->down && shm->rise_count >= peer->conf->rise) {
+            shm->down = 0;
+
+            ngx_log_error(NGX_LOG_WARN, peer->event.log, 0,
+                          "upstream peer %V is up", &peer->addr->name);
+        }
+
+    } else {
+        shm->rise_count = 0;
+        shm->fall_count++;
+
+        if (!shm->down && shm->fall_count >= peer->conf->fall) {
+            shm->down = 1;
+
+            ngx_log_error(NGX_LOG_WARN, peer->event.log, 0,
+                          "upstream peer %V is down", &peer->addr->name);
+        }
+    }
+
+    shm->owner = NGX_INVALID_PID;
+    shm->access_time = ngx_current_msec;
+
+    ngx_shmtx_unlock(&ucmcf->shpool->mutex);
+}
+
+
+static ngx_int_t
+ngx_http_upstream_check_init_zone(ngx_shm_zone_t *shm_zone, void *data)
+{
+    ngx_http_upstream_check_main_conf_t  *oucmcf = data;
+
+    void                                 *prev;
+    size_t                                size;
+    ngx_uint_t                            i, n;
+    ngx_http_upstream_check_peer_t       *peer;
+    ngx_http_upstream_check_peers_shm_t  *sh, *osh;
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    ucmcf = shm_zone->data;
+
+    size = sizeof(ngx_http_upstream_check_peers_shm_t)
+           + (ucmcf->peers.nelts - 1)
+             * sizeof(ngx_http_upstream_check_peer_shm_t);
+
+    sh = ngx_http_upstream_rr_zone_alloc(shm_zone, oucmcf, size, &prev);
+    if (sh == NULL) {
+        return NGX_ERROR;
+    }
+
+    osh = prev;
+
+    sh->number = ucmcf->peers.nelts;
+
+    peer = ucmcf->peers.elts;
+
+    for (i = 0; i < ucmcf->peers.nelts; i++) {
+        sh->peer[i].owner = NGX_INVALID_PID;
+        sh->peer[i].socklen = peer[i].addr->socklen;
+        ngx_memcpy(sh->peer[i].sockaddr, peer[i].addr->sockaddr,
+                   peer[i].addr->socklen);
+
+        if (osh == NULL) {
+            continue;
+        }
+
+        /* keep the state of peers that survived the reload */
+
+        for (n = 0; n < osh->number; n++) {
+            if (osh->peer[n].socklen == sh->peer[i].socklen
+                && ngx_memcmp(osh->peer[n].sockaddr, sh->peer[i].sockaddr,
+                              sh->peer[i].socklen)
+                   == 0)
+            {
+                sh->peer[i].fall_count = osh->peer[n].fall_count;
+                sh->peer[i].rise_count = osh->peer[n].rise_count;
+                sh->peer[i].down = osh->peer[n].down;
+                break;
+            }
+        }
+    }
+
+    ucmcf->shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+    ucmcf->sh = sh;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_check_init_process(ngx_cycle_t *cycle)
+{
+    ngx_uint_t                            i;
+    ngx_http_upstream_check_peer_t       *peer;
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER
+        && ngx_process != NGX_PROCESS_SINGLE)
+    {
+        return NGX_OK;
+    }
+
+    ucmcf = ngx_http_cycle_get_module_main_conf(cycle,
+                                                ngx_http_upstream_check_module);
+
+    if (ucmcf == NULL || ucmcf->sh == NULL) {
+        return NGX_OK;
+    }
+
+    if (ngx_process == NGX_PROCESS_WORKER) {
+        ngx_http_upstream_rr_zone_hold(ucmcf->shpool, ucmcf->sh, 1);
+    }
+
+    peer = ucmcf->peers.elts;
+
+    for (i = 0; i < ucmcf->peers.nelts; i++) {
+        peer[i].shm = &ucmcf->sh->peer[i];
+
+        peer[i].buffer.start = ngx_pnalloc(cycle->pool,
+                                           NGX_HTTP_CHECK_BUFFER_SIZE);
+        if (peer[i].buffer.start == NULL) {
+            return NGX_ERROR;
+        }
+
+        peer[i].buffer.end = peer[i].buffer.start + NGX_HTTP_CHECK_BUFFER_SIZE;
+
+        peer[i].event.handler = ngx_http_upstream_check_begin_handler;
+        peer[i].event.data = &peer[i];
+        peer[i].event.log = cycle->log;
+        peer[i].event.cancelable = 1;
+
+        /* spread the first checks over the interval */
+
+        ngx_add_timer(&peer[i].event,
+                      ngx_random() % peer[i].conf->interval + 1);
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_upstream_check_exit_process(ngx_cycle_t *cycle)
+{
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER) {
+        return;
+    }
+
+    ucmcf = ngx_http_cycle_get_module_main_conf(cycle,
+                                                ngx_http_upstream_check_module);
+
+    if (ucmcf && ucmcf->sh) {
+        ngx_http_upstream_rr_zone_hold(ucmcf->shpool, ucmcf->sh, -1);
+    }
+}
+
+
+static void *
+ngx_http_upstream_check_create_main_conf(ngx_conf_t *cf)
+{
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    ucmcf = ngx_pcalloc(cf->pool, sizeof(ngx_http_upstream_check_main_conf_t));
+    if (ucmcf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     ucmcf->shm_zone = NULL;
+     *     ucmcf->shpool = NULL;
+     *     ucmcf->sh = NULL;
+     */
+
+    if (ngx_array_init(&ucmcf->peers, cf->pool, 16,
+                       sizeof(ngx_http_upstream_check_peer_t))
+        != NGX_OK)
+    {
+        return NULL;
+    }
+
+    return ucmcf;
+}
+
+
+static void *
+ngx_http_upstream_check_create_srv_conf(ngx_conf_t *cf)
+{
+    ngx_http_upstream_check_srv_conf_t  *ucscf;
+
+    ucscf = ngx_pcalloc(cf->pool, sizeof(ngx_http_upstream_check_srv_conf_t));
+    if (ucscf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     ucscf->type = 0;
+     *     ucscf->send = { 0, NULL };
+     *     ucscf->expect = { 0, NULL };
+     *     ucscf->http_expect_alive = 0;
+     */
+
+    return ucscf;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_check_init(ngx_conf_t *cf)
+{
+    size_t                                size;
+    ngx_str_t                             name;
+    ngx_uint_t                            n;
+    ngx_shm_zone_t                       *shm_zone;
+    ngx_http_upstream_check_main_conf_t  *ucmcf;
+
+    ucmcf = ngx_http_conf_get_module_main_conf(cf,
+                                               ngx_http_upstream_check_module);
+
+    if (ucmcf->peers.nelts == 0) {
+        return NGX_OK;
+    }
+
+    n = (ucmcf->peers.nelts + NGX_HTTP_CHECK_ZONE_PEERS - 1)
+        / NGX_HTTP_CHECK_ZONE_PEERS * NGX_HTTP_CHECK_ZONE_PEERS;
+
+    /* the peers arrays of the running and the previous configurations */
+
+    size = 8 * ngx_pagesize
+           + NGX_HTTP_UPSTREAM_RR_ZONE_CONFS
+             * (n * sizeof(ngx_http_upstream_check_peer_shm_t)
+                + ngx_pagesize);
+
+    ngx_str_set(&name, "upstream_check");
+
+    shm_zone = ngx_shared_memory_add(cf, &name, size,
+                                     &ngx_http_upstream_check_module);
+    if (shm_zone == NULL) {
+        return NGX_ERROR;
+    }
+
+    shm_zone->init = ngx_http_upstream_check_init_zone;
+    shm_zone->data = ucmcf;
+
+    ucmcf->shm_zone = shm_zone;
+
+    return NGX_OK;
+}
+
+
+static char *
+ngx_http_upstream_check(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_upstream_check_srv_conf_t  *ucscf = conf;
+
+    ngx_int_t   n;
+    ngx_str_t  *value, s;
+    ngx_uint_t  i;
+
+    if (ucscf->type) {
+        return "is duplicate";
+    }
+
+    ucscf->type = NGX_HTTP_CHECK_TCP;
+    ucscf->interval = 30000;
+    ucscf->timeout = 1000;
+    ucscf->fall = 5;
+    ucscf->rise = 2;
+
+    value = cf->args->elts;
+
+    for (i = 1; i < cf->args->nelts; i++) {
+
+        if (ngx_strncmp(value[i].data, "interval=", 9) == 0) {
+
+            s.len = value[i].len - 9;
+            s.data = &value[i].data[9];
+
+            ucscf->interval = ngx_parse_time(&s, 0);
+
+            if (ucscf->interval == (ngx_msec_t) NGX_ERROR
+                || ucscf->interval == 0)
+            {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "timeout=", 8) == 0) {
+
+            s.len = value[i].len - 8;
+            s.data = &value[i].data[8];
+
+            ucscf->timeout = ngx_parse_time(&s, 0);
+
+            if (ucscf->timeout == (ngx_msec_t) NGX_ERROR
+                || ucscf->timeout == 0)
+            {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "fall=", 5) == 0) {
+
+            n = ngx_atoi(&value[i].data[5], value[i].len - 5);
+
+            if (n == NGX_ERROR || n == 0) {
+                goto invalid;
+            }
+
+            ucscf->fall = n;
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "rise=", 5) == 0) {
+
+            n = ngx_atoi(&value[i].data[5], value[i].len - 5);
+
+            if (n == NGX_ERROR || n == 0) {
+                goto invalid;
+            }
+
+            ucscf->rise = n;
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "type=", 5) == 0) {
+
+            s.len = value[i].len - 5;
+            s.data = &value[i].data[5];
+
+            if (s.len == 3 && ngx_strncmp(s.data, "tcp", 3) == 0) {
+                ucscf->type = NGX_HTTP_CHECK_TCP;
+
+            } else if (s.len == 4 && ngx_strncmp(s.data, "http", 4) == 0) {
+                ucscf->type = NGX_HTTP_CHECK_HTTP;
+
+            } else if (s.len == 4 && ngx_strncmp(s.data, "send", 4) == 0) {
+                ucscf->type = NGX_HTTP_CHECK_SEND;
+
+            } else {
+                goto invalid;
+            }
+
+            continue;
+        }
+
+        goto invalid;
+    }
+
+    return NGX_CONF_OK;
+
+invalid:
+
+    ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                       "invalid parameter \"%V\"", &value[i]);
+
+    return NGX_CONF_ERROR;
+}
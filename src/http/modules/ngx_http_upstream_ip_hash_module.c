@@ -180,7 +180,7 @@ ngx_http_upstream_get_ip_hash_peer(ngx_peer_connection_t *pc, void *data)
 
             /* ngx_lock_mutex(iphp->rrp.peers->mutex); */
 
-            if (!peer->down) {
+            if (!peer->down && ngx_http_upstream_rr_peer_alive(peer)) {
 
                 if (peer->max_fails == 0 || peer->fails < peer->max_fails) {
                     break;
@@ -0,0 +1,696 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+/* the zone is sized in steps to be reused across reloads */
+#define NGX_HTTP_LEAST_CONN_ZONE_PEERS  256
+
+
+typedef struct {
+    ngx_atomic_t                              conns;
+
+    /* response time average, in 1/8 milliseconds */
+    ngx_atomic_t                              response_time;
+
+    socklen_t                                 socklen;
+    u_char                                    sockaddr[NGX_SOCKADDRLEN];
+} ngx_http_upstream_least_conn_peer_shm_t;
+
+
+typedef struct {
+    ngx_uint_t                                number;
+    ngx_http_upstream_least_conn_peer_shm_t   peer[1];
+} ngx_http_upstream_least_conn_shm_t;
+
+
+typedef struct {
+    ngx_uint_t                                least_time;
+                                                /* unsigned  least_time:1; */
+    ngx_uint_t                                base;
+    ngx_http_upstream_rr_peers_t             *peers;
+} ngx_http_upstream_least_conn_srv_conf_t;
+
+
+typedef struct {
+    ngx_uint_t                                number;
+    ngx_array_t                               upstreams;
+
+    ngx_slab_pool_t                          *shpool;
+    ngx_http_upstream_least_conn_shm_t       *sh;
+} ngx_http_upstream_least_conn_main_conf_t;
+
+
+typedef struct {
+    /* the round robin data must be first */
+    ngx_http_upstream_rr_peer_data_t          rrp;
+
+    ngx_http_upstream_least_conn_srv_conf_t  *conf;
+    ngx_http_upstream_least_conn_shm_t       *sh;
+
+    ngx_http_upstream_least_conn_peer_shm_t  *peer;
+    ngx_msec_t                                start;
+} ngx_http_upstream_least_conn_peer_data_t;
+
+
+static ngx_int_t ngx_http_upstream_init_least_conn(ngx_conf_t *cf,
+    ngx_http_upstream_srv_conf_t *us);
+static ngx_int_t ngx_http_upstream_init_least_conn_peer(ngx_http_request_t *r,
+    ngx_http_upstream_srv_conf_t *us);
+static ngx_int_t ngx_http_upstream_get_least_conn_peer(
+    ngx_peer_connection_t *pc, void *data);
+static void ngx_http_upstream_free_least_conn_peer(ngx_peer_connection_t *pc,
+    void *data, ngx_uint_t state);
+
+static ngx_int_t ngx_http_upstream_least_conn_init_zone(
+    ngx_shm_zone_t *shm_zone, void *data);
+static ngx_int_t ngx_http_upstream_least_conn_init_process(
+    ngx_cycle_t *cycle);
+static void ngx_http_upstream_least_conn_exit_process(ngx_cycle_t *cycle);
+static void *ngx_http_upstream_least_conn_create_main_conf(ngx_conf_t *cf);
+static void *ngx_http_upstream_least_conn_create_srv_conf(ngx_conf_t *cf);
+static ngx_int_t ngx_http_upstream_least_conn_init(ngx_conf_t *cf);
+
+static char *ngx_http_upstream_least_conn(ngx_conf_t *cf, ngx_command_t *cmd,
+    void *conf);
+
+
+static ngx_command_t  ngx_http_upstream_least_conn_commands[] = {
+
+    { ngx_string("least_conn"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_NOARGS,
+      ngx_http_upstream_least_conn,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      0,
+      NULL },
+
+    { ngx_string("least_time"),
+      NGX_HTTP_UPS_CONF|NGX_CONF_NOARGS,
+      ngx_http_upstream_least_conn,
+      NGX_HTTP_SRV_CONF_OFFSET,
+      1,
+      NULL },
+
+      ngx_null_command
+};
+
+
+static ngx_http_module_t  ngx_http_upstream_least_conn_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    ngx_http_upstream_least_conn_init,     /* postconfiguration */
+
+    ngx_http_upstream_least_conn_create_main_conf,
+                                           /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    ngx_http_upstream_least_conn_create_srv_conf,
+                                           /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_upstream_least_conn_module = {
+    NGX_MODULE_V1,
+    &ngx_http_upstream_least_conn_module_ctx, /* module context */
+    ngx_http_upstream_least_conn_commands, /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    ngx_http_upstream_least_conn_init_process, /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    ngx_http_upstream_least_conn_exit_process, /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_int_t
+ngx_http_upstream_init_least_conn(ngx_conf_t *cf,
+    ngx_http_upstream_srv_conf_t *us)
+{
+    ngx_http_upstream_rr_peers_t              *peers;
+    ngx_http_upstream_least_conn_srv_conf_t   *lcscf, **lcscfp;
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    if (ngx_http_upstream_init_round_robin(cf, us) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    us->peer.init = ngx_http_upstream_init_least_conn_peer;
+
+    lcscf = ngx_http_conf_upstream_srv_conf(us,
+                                         ngx_http_upstream_least_conn_module);
+    lcmcf = ngx_http_conf_get_module_main_conf(cf,
+                                         ngx_http_upstream_least_conn_module);
+
+    lcscfp = ngx_array_push(&lcmcf->upstreams);
+    if (lcscfp == NULL) {
+        return NGX_ERROR;
+    }
+
+    *lcscfp = lcscf;
+
+    /* the primary and backup peers are numbered one after another */
+
+    peers = us->peer.data;
+
+    lcscf->peers = peers;
+    lcscf->base = lcmcf->number;
+
+    lcmcf->number += peers->number;
+
+    if (peers->next) {
+        lcmcf->number += peers->next->number;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_init_least_conn_peer(ngx_http_request_t *r,
+    ngx_http_upstream_srv_conf_t *us)
+{
+    ngx_http_upstream_least_conn_peer_data_t  *lcp;
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    lcp = ngx_palloc(r->pool, sizeof(ngx_http_upstream_least_conn_peer_data_t));
+    if (lcp == NULL) {
+        return NGX_ERROR;
+    }
+
+    r->upstream->peer.data = &lcp->rrp;
+
+    if (ngx_http_upstream_init_round_robin_peer(r, us) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    r->upstream->peer.get = ngx_http_upstream_get_least_conn_peer;
+    r->upstream->peer.free = ngx_http_upstream_free_least_conn_peer;
+
+    lcmcf = ngx_http_get_module_main_conf(r,
+                                          ngx_http_upstream_least_conn_module);
+
+    lcp->conf = ngx_http_conf_upstream_srv_conf(us,
+                                          ngx_http_upstream_least_conn_module);
+    lcp->sh = lcmcf->sh;
+    lcp->peer = NULL;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_get_least_conn_peer(ngx_peer_connection_t *pc, void *data)
+{
+    ngx_http_upstream_least_conn_peer_data_t  *lcp = data;
+
+    time_t                                    now;
+    uintptr_t                                 m;
+    ngx_int_t                                 rc, total;
+    ngx_uint_t                                i, n, p, base, many;
+    ngx_uint_t                                load, best_load;
+    ngx_http_upstream_rr_peer_t              *peer, *best;
+    ngx_http_upstream_rr_peers_t             *peers;
+    ngx_http_upstream_least_conn_peer_shm_t  *shm;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                   "get least conn peer, try: %ui", pc->tries);
+
+    now = ngx_time();
+
+    pc->cached = 0;
+    pc->connection = NULL;
+
+    peers = lcp->rrp.peers;
+
+    base = lcp->conf->base;
+
+    if (peers != lcp->conf->peers) {
+        base += lcp->conf->peers->number;
+    }
+
+    shm = &lcp->sh->peer[base];
+
+    best = NULL;
+    best_load = 0;
+    many = 0;
+    p = 0;
+
+    /*
+     * the load of a peer is the number of active connections or,
+     * for least_time, the connections weighted by the average response
+     * time; peers are compared by the load divided by the weight
+     */
+
+    for (i = 0; i < peers->number; i++) {
+
+        n = i / (8 * sizeof(uintptr_t));
+        m = (uintptr_t) 1 << i % (8 * sizeof(uintptr_t));
+
+        if (lcp->rrp.tried[n] & m) {
+            continue;
+        }
+
+        peer = &peers->peer[i];
+
+        if (peer->down || !ngx_http_upstream_rr_peer_alive(peer)) {
+            continue;
+        }
+
+        if (peer->max_fails
+            && peer->fails >= peer->max_fails
+            && now - peer->accessed <= peer->fail_timeout)
+        {
+            continue;
+        }
+
+        load = shm[i].conns + 1;
+
+        if (lcp->conf->least_time) {
+            load *= shm[i].response_time + 8;
+        }
+
+        if (best == NULL || load * best->weight < best_load * peer->weight) {
+            best = peer;
+            best_load = load;
+            many = 0;
+            p = i;
+
+        } else if (load * best->weight == best_load * peer->weight) {
+            many = 1;
+        }
+    }
+
+    if (best == NULL) {
+        ngx_log_debug0(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                       "get least conn peer, no peer found");
+
+        goto failed;
+    }
+
+    if (many) {
+
+        /* spread equally loaded peers by weighted round robin */
+
+        total = 0;
+        peer = best;
+
+        for (i = p; i < peers->number; i++) {
+
+            n = i / (8 * sizeof(uintptr_t));
+            m = (uintptr_t) 1 << i % (8 * sizeof(uintptr_t));
+
+            if (lcp->rrp.tried[n] & m) {
+                continue;
+            }
+
+            if (peers->peer[i].down
+                || !ngx_http_upstream_rr_peer_alive(&peers->peer[i]))
+            {
+                continue;
+            }
+
+            if (peers->peer[i].max_fails
+                && peers->peer[i].fails >= peers->peer[i].max_fails
+                && now - peers->peer[i].accessed
+                   <= peers->peer[i].fail_timeout)
+            {
+                continue;
+            }
+
+            load = shm[i].conns + 1;
+
+            if (lcp->conf->least_time) {
+                load *= shm[i].response_time + 8;
+            }
+
+            if (load * peer->weight != best_load * peers->peer[i].weight) {
+                continue;
+            }
+
+            peers->peer[i].current_weight += peers->peer[i].weight;
+            total += peers->peer[i].weight;
+
+            if (peers->peer[i].current_weight > best->current_weight) {
+                best = &peers->peer[i];
+                p = i;
+            }
+        }
+
+        best->current_weight -= total;
+    }
+
+    if (now - best->accessed > best->fail_timeout) {
+        best->fails = 0;
+    }
+
+    lcp->rrp.current = p;
+
+    n = p / (8 * sizeof(uintptr_t));
+    m = (uintptr_t) 1 << p % (8 * sizeof(uintptr_t));
+
+    lcp->rrp.tried[n] |= m;
+
+    pc->sockaddr = best->sockaddr;
+    pc->socklen = best->socklen;
+    pc->name = &best->name;
+
+    lcp->peer = &shm[p];
+    lcp->start = ngx_current_msec;
+
+    (void) ngx_atomic_fetch_add(&lcp->peer->conns, 1);
+
+    if (pc->tries == 1 && peers->next) {
+        pc->tries += peers->next->number;
+
+        n = peers->next->number / (8 * sizeof(uintptr_t)) + 1;
+        for (i = 0; i < n; i++) {
+             lcp->rrp.tried[i] = 0;
+        }
+    }
+
+    return NGX_OK;
+
+failed:
+
+    if (peers->next) {
+
+        ngx_log_debug0(NGX_LOG_DEBUG_HTTP, pc->log, 0, "backup servers");
+
+        lcp->rrp.peers = peers->next;
+        pc->tries = lcp->rrp.peers->number;
+
+        n = lcp->rrp.peers->number / (8 * sizeof(uintptr_t)) + 1;
+        for (i = 0; i < n; i++) {
+             lcp->rrp.tried[i] = 0;
+        }
+
+        rc = ngx_http_upstream_get_least_conn_peer(pc, lcp);
+
+        if (rc != NGX_BUSY) {
+            return rc;
+        }
+    }
+
+    /* all peers failed, mark them as live for quick recovery */
+
+    for (i = 0; i < peers->number; i++) {
+        peers->peer[i].fails = 0;
+    }
+
+    pc->name = peers->name;
+
+    return NGX_BUSY;
+}
+
+
+static void
+ngx_http_upstream_free_least_conn_peer(ngx_peer_connection_t *pc,
+    void *data, ngx_uint_t state)
+{
+    ngx_http_upstream_least_conn_peer_data_t  *lcp = data;
+
+    ngx_msec_t            time;
+    ngx_atomic_uint_t     old, new;
+    ngx_atomic_t         *rt;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                   "free least conn peer %ui", state);
+
+    if (lcp->peer == NULL) {
+        ngx_http_upstream_free_round_robin_peer(pc, &lcp->rrp, state);
+        return;
+    }
+
+    (void) ngx_atomic_fetch_add(&lcp->peer->conns, -1);
+
+    if (lcp->conf->least_time && !(state & NGX_PEER_FAILED)) {
+
+        time = ngx_current_msec - lcp->start;
+        rt = &lcp->peer->response_time;
+
+        /* srtt-style average with the 1/8 gain, kept scaled by 8 */
+
+        do {
+            old = *rt;
+            new = old ? old - (old >> 3) + time : time << 3;
+
+        } while (!ngx_atomic_cmp_set(rt, old, new));
+
+        ngx_log_debug2(NGX_LOG_DEBUG_HTTP, pc->log, 0,
+                       "least time peer: %M, average: %uA/8",
+                       time, new);
+    }
+
+    lcp->peer = NULL;
+
+    ngx_http_upstream_free_round_robin_peer(pc, &lcp->rrp, state);
+}
+
+
+static ngx_int_t
+ngx_http_upstream_least_conn_init_zone(ngx_shm_zone_t *shm_zone, void *data)
+{
+    ngx_http_upstream_least_conn_main_conf_t  *olcmcf = data;
+
+    void                                      *prev;
+    size_t                                     size;
+    ngx_uint_t                                 i, j, k;
+    ngx_http_upstream_rr_peer_t               *peer;
+    ngx_http_upstream_rr_peers_t              *peers;
+    ngx_http_upstream_least_conn_shm_t        *sh, *osh;
+    ngx_http_upstream_least_conn_srv_conf_t  **lcscfp;
+    ngx_http_upstream_least_conn_peer_shm_t   *shm;
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    lcmcf = shm_zone->data;
+
+    size = sizeof(ngx_http_upstream_least_conn_shm_t)
+           + (lcmcf->number - 1)
+             * sizeof(ngx_http_upstream_least_conn_peer_shm_t);
+
+    sh = ngx_http_upstream_rr_zone_alloc(shm_zone, olcmcf, size, &prev);
+    if (sh == NULL) {
+        return NGX_ERROR;
+    }
+
+    osh = prev;
+
+    sh->number = lcmcf->number;
+
+    lcscfp = lcmcf->upstreams.elts;
+
+    for (i = 0; i < lcmcf->upstreams.nelts; i++) {
+
+        shm = &sh->peer[lcscfp[i]->base];
+
+        for (peers = lcscfp[i]->peers; peers; peers = peers->next) {
+
+            peer = peers->peer;
+
+            for (j = 0; j < peers->number; j++) {
+                shm[j].socklen = peer[j].socklen;
+                ngx_memcpy(shm[j].sockaddr, peer[j].sockaddr,
+                           peer[j].socklen);
+
+                if (osh == NULL) {
+                    continue;
+                }
+
+                /*
+                 * keep the response time of servers that survived
+                 * the reload; connections are counted anew
+                 */
+
+                for (k = 0; k < osh->number; k++) {
+                    if (osh->peer[k].socklen == shm[j].socklen
+                        && ngx_memcmp(osh->peer[k].sockaddr, shm[j].sockaddr,
+                                      shm[j].socklen)
+                           == 0)
+                    {
+                        shm[j].response_time = osh->peer[k].response_time;
+                        break;
+                    }
+                }
+            }
+
+            shm += peers->number;
+        }
+    }
+
+    lcmcf->shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+    lcmcf->sh = sh;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_least_conn_init_process(ngx_cycle_t *cycle)
+{
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER) {
+        return NGX_OK;
+    }
+
+    lcmcf = ngx_http_cycle_get_module_main_conf(cycle,
+                                          ngx_http_upstream_least_conn_module);
+
+    if (lcmcf && lcmcf->sh) {
+        ngx_http_upstream_rr_zone_hold(lcmcf->shpool, lcmcf->sh, 1);
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_upstream_least_conn_exit_process(ngx_cycle_t *cycle)
+{
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    if (ngx_process != NGX_PROCESS_WORKER) {
+        return;
+    }
+
+    lcmcf = ngx_http_cycle_get_module_main_conf(cycle,
+                                          ngx_http_upstream_least_conn_module);
+
+    if (lcmcf && lcmcf->sh) {
+        ngx_http_upstream_rr_zone_hold(lcmcf->shpool, lcmcf->sh, -1);
+    }
+}
+
+
+static void *
+ngx_http_upstream_least_conn_create_main_conf(ngx_conf_t *cf)
+{
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    lcmcf = ngx_pcalloc(cf->pool,
+                        sizeof(ngx_http_upstream_least_conn_main_conf_t));
+    if (lcmcf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     lcmcf->number = 0;
+     *     lcmcf->shpool = NULL;
+     *     lcmcf->sh = NULL;
+     */
+
+    if (ngx_array_init(&lcmcf->upstreams, cf->pool, 4,
+                       sizeof(ngx_http_upstream_least_conn_srv_conf_t *))
+        != NGX_OK)
+    {
+        return NULL;
+    }
+
+    return lcmcf;
+}
+
+
+static void *
+ngx_http_upstream_least_conn_create_srv_conf(ngx_conf_t *cf)
+{
+    ngx_http_upstream_least_conn_srv_conf_t  *lcscf;
+
+    lcscf = ngx_pcalloc(cf->pool,
+                        sizeof(ngx_http_upstream_least_conn_srv_conf_t));
+    if (lcscf == NULL) {
+        return NULL;
+    }
+
+    /*
+     * set by ngx_pcalloc():
+     *
+     *     lcscf->least_time = 0;
+     *     lcscf->base = 0;
+     *     lcscf->peers = NULL;
+     */
+
+    return lcscf;
+}
+
+
+static ngx_int_t
+ngx_http_upstream_least_conn_init(ngx_conf_t *cf)
+{
+    size_t                                     size;
+    ngx_str_t                                  name;
+    ngx_uint_t                                 n;
+    ngx_shm_zone_t                            *shm_zone;
+    ngx_http_upstream_least_conn_main_conf_t  *lcmcf;
+
+    lcmcf = ngx_http_conf_get_module_main_conf(cf,
+                                          ngx_http_upstream_least_conn_module);
+
+    if (lcmcf->number == 0) {
+        return NGX_OK;
+    }
+
+    n = (lcmcf->number + NGX_HTTP_LEAST_CONN_ZONE_PEERS - 1)
+        / NGX_HTTP_LEAST_CONN_ZONE_PEERS * NGX_HTTP_LEAST_CONN_ZONE_PEERS;
+
+    /* the peers arrays of the running and the previous configurations */
+
+    size = 8 * ngx_pagesize
+           + NGX_HTTP_UPSTREAM_RR_ZONE_CONFS
+             * (n * sizeof(ngx_http_upstream_least_conn_peer_shm_t)
+                + ngx_pagesize);
+
+    ngx_str_set(&name, "upstream_least_conn");
+
+    shm_zone = ngx_shared_memory_add(cf, &name, size,
+                                     &ngx_http_upstream_least_conn_module);
+    if (shm_zone == NULL) {
+        return NGX_ERROR;
+    }
+
+    shm_zone->init = ngx_http_upstream_least_conn_init_zone;
+    shm_zone->data = lcmcf;
+
+    return NGX_OK;
+}
+
+
+static char *
+ngx_http_upstream_least_conn(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
+{
+    ngx_http_upstream_least_conn_srv_conf_t  *lcscf = conf;
+
+    ngx_http_upstream_srv_conf_t  *uscf;
+
+    uscf = ngx_http_conf_get_module_srv_conf(cf, ngx_http_upstream_module);
+
+    if (uscf->peer.init_upstream) {
+        return "is duplicate or follows another balancer";
+    }
+
+    uscf->peer.init_upstream = ngx_http_upstream_init_least_conn;
+
+    uscf->flags = NGX_HTTP_UPSTREAM_CREATE
+                  |NGX_HTTP_UPSTREAM_WEIGHT
+                  |NGX_HTTP_UPSTREAM_MAX_FAILS
+                  |NGX_HTTP_UPSTREAM_FAIL_TIMEOUT
+                  |NGX_HTTP_UPSTREAM_DOWN
+                  |NGX_HTTP_UPSTREAM_BACKUP;
+
+    lcscf->least_time = cmd->offset;
+
+    return NGX_CONF_OK;
+}
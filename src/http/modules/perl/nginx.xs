@@ -252,7 +252,7 @@ header_in(r, key)
 
     cmcf = ngx_http_get_module_main_conf(r, ngx_http_core_module);
 
-    hh = ngx_hash_find(&cmcf->headers_in_hash, hash, lowcase_key, len);
+    hh = ngx_hash_perfect_find(&cmcf->headers_in_hash, hash, lowcase_key, len);
 
     if (hh) {
         if (hh->offset) {
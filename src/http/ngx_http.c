@@ -37,6 +37,11 @@ static ngx_int_t ngx_http_init_locations(ngx_conf_t *cf,
     ngx_http_core_srv_conf_t *cscf, ngx_http_core_loc_conf_t *pclcf);
 static ngx_int_t ngx_http_init_static_location_trees(ngx_conf_t *cf,
     ngx_http_core_loc_conf_t *pclcf);
+#if (NGX_PCRE)
+static ngx_int_t ngx_http_init_regex_prefilter(ngx_conf_t *cf,
+    ngx_http_core_loc_conf_t *pclcf, ngx_uint_t nregex);
+static size_t ngx_http_regex_literal(ngx_str_t *pattern, u_char *literal);
+#endif
 static ngx_int_t ngx_http_cmp_locations(const ngx_queue_t *one,
     const ngx_queue_t *two);
 static ngx_int_t ngx_http_join_exact_locations(ngx_conf_t *cf,
@@ -427,15 +432,18 @@ ngx_http_init_headers_in_hash(ngx_conf_t *cf, ngx_http_core_main_conf_t *cmcf)
         hk->value = header;
     }
 
-    hash.hash = &cmcf->headers_in_hash;
+    hash.hash = NULL;
     hash.key = ngx_hash_key_lc;
     hash.max_size = 512;
-    hash.bucket_size = ngx_align(64, ngx_cacheline_size);
+    hash.bucket_size = 0;
     hash.name = "headers_in_hash";
     hash.pool = cf->pool;
     hash.temp_pool = NULL;
 
-    if (ngx_hash_init(&hash, headers_in.elts, headers_in.nelts) != NGX_OK) {
+    if (ngx_hash_perfect_init(&hash, &cmcf->headers_in_hash,
+                              headers_in.elts, headers_in.nelts)
+        != NGX_OK)
+    {
         return NGX_ERROR;
     }
 
@@ -787,6 +795,10 @@ ngx_http_init_locations(ngx_conf_t *cf, ngx_http_core_srv_conf_t *cscf,
         *clcfp = NULL;
 
         ngx_queue_split(locations, regex, &tail);
+
+        if (ngx_http_init_regex_prefilter(cf, pclcf, r) != NGX_OK) {
+            return NGX_ERROR;
+        }
     }
 
 #endif
@@ -795,6 +807,462 @@ ngx_http_init_locations(ngx_conf_t *cf, ngx_http_core_srv_conf_t *cscf,
 }
 
 
+#if (NGX_PCRE)
+
+#define NGX_HTTP_REGEX_LITERAL_LEN  32
+
+
+static ngx_int_t
+ngx_http_init_regex_prefilter(ngx_conf_t *cf, ngx_http_core_loc_conf_t *pclcf,
+    ngx_uint_t nregex)
+{
+    u_char                      *literal, *p, class[256];
+    size_t                      *len;
+    u_short                     *next, *term, *fail, *queue, s, t;
+    ngx_uint_t                   i, c, k, n, nclasses, nstates, total;
+    ngx_uint_t                   head, tail, *cursor;
+    ngx_http_regex_prefilter_t  *pf;
+
+    literal = ngx_palloc(cf->temp_pool, nregex * NGX_HTTP_REGEX_LITERAL_LEN);
+    if (literal == NULL) {
+        return NGX_ERROR;
+    }
+
+    len = ngx_palloc(cf->temp_pool, nregex * sizeof(size_t));
+    if (len == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_memzero(class, 256);
+
+    nclasses = 0;
+    total = 1;
+    n = 0;
+
+    for (i = 0; i < nregex; i++) {
+        p = literal + i * NGX_HTTP_REGEX_LITERAL_LEN;
+
+        len[i] = ngx_http_regex_literal(&pclcf->regex_locations[i]->name, p);
+
+        ngx_log_debug3(NGX_LOG_DEBUG_HTTP, cf->log, 0,
+                       "regex location \"%V\" literal: \"%*s\"",
+                       &pclcf->regex_locations[i]->name, len[i], p);
+
+        if (len[i] == 0) {
+            continue;
+        }
+
+        n++;
+        total += len[i];
+
+        for (c = 0; c < len[i]; c++) {
+            if (class[p[c]] == 0) {
+                class[p[c]] = (u_char) ++nclasses;
+                class[ngx_toupper(p[c])] = (u_char) nclasses;
+            }
+        }
+    }
+
+    if (n == 0 || total > 0xffff) {
+        return NGX_OK;
+    }
+
+    pf = ngx_palloc(cf->pool, sizeof(ngx_http_regex_prefilter_t));
+    if (pf == NULL) {
+        return NGX_ERROR;
+    }
+
+    k = nclasses + 1;
+
+    pf->nlocations = nregex;
+    pf->nclasses = k;
+    ngx_memcpy(pf->class, class, 256);
+
+    pf->candidates = ngx_palloc(cf->pool, nregex);
+    if (pf->candidates == NULL) {
+        return NGX_ERROR;
+    }
+
+    /* the state 0 is the root, so 0 in the goto table means no edge */
+
+    next = ngx_pcalloc(cf->pool, total * k * sizeof(u_short));
+    if (next == NULL) {
+        return NGX_ERROR;
+    }
+
+    term = ngx_palloc(cf->temp_pool, nregex * sizeof(u_short));
+    if (term == NULL) {
+        return NGX_ERROR;
+    }
+
+    nstates = 1;
+
+    for (i = 0; i < nregex; i++) {
+        pf->candidates[i] = (len[i] == 0);
+
+        p = literal + i * NGX_HTTP_REGEX_LITERAL_LEN;
+        s = 0;
+
+        for (c = 0; c < len[i]; c++) {
+            t = next[s * k + class[p[c]]];
+
+            if (t == 0) {
+                t = (u_short) nstates++;
+                next[s * k + class[p[c]]] = t;
+            }
+
+            s = t;
+        }
+
+        term[i] = s;
+    }
+
+    fail = ngx_pcalloc(cf->temp_pool, nstates * sizeof(u_short));
+    if (fail == NULL) {
+        return NGX_ERROR;
+    }
+
+    queue = ngx_palloc(cf->temp_pool, nstates * sizeof(u_short));
+    if (queue == NULL) {
+        return NGX_ERROR;
+    }
+
+    /* build the failure links and complete the goto table breadth-first */
+
+    head = 0;
+    tail = 0;
+
+    for (c = 0; c < k; c++) {
+        if (next[c]) {
+            queue[tail++] = next[c];
+        }
+    }
+
+    while (head < tail) {
+        s = queue[head++];
+
+        for (c = 0; c < k; c++) {
+            t = next[s * k + c];
+
+            if (t) {
+                fail[t] = next[fail[s] * k + c];
+                queue[tail++] = t;
+
+            } else {
+                next[s * k + c] = next[fail[s] * k + c];
+            }
+        }
+    }
+
+    /*
+     * a state outputs the locations whose literals end in it
+     * and the locations output by its failure state
+     */
+
+    cursor = ngx_pcalloc(cf->temp_pool, (nstates + 1) * sizeof(ngx_uint_t));
+    if (cursor == NULL) {
+        return NGX_ERROR;
+    }
+
+    for (i = 0; i < nregex; i++) {
+        if (len[i]) {
+            cursor[term[i]]++;
+        }
+    }
+
+    for (i = 0; i < tail; i++) {
+        s = queue[i];
+        cursor[s] += cursor[fail[s]];
+    }
+
+    pf->output = ngx_palloc(cf->pool, (nstates + 1) * sizeof(ngx_uint_t));
+    if (pf->output == NULL) {
+        return NGX_ERROR;
+    }
+
+    pf->output[0] = 0;
+
+    for (i = 0; i < nstates; i++) {
+        pf->output[i + 1] = pf->output[i] + cursor[i];
+        cursor[i] = pf->output[i];
+    }
+
+    pf->match = ngx_palloc(cf->pool,
+                           pf->output[nstates] * sizeof(ngx_uint_t));
+    if (pf->match == NULL) {
+        return NGX_ERROR;
+    }
+
+    for (i = 0; i < nregex; i++) {
+        if (len[i]) {
+            pf->match[cursor[term[i]]++] = i;
+        }
+    }
+
+    for (i = 0; i < tail; i++) {
+        s = queue[i];
+
+        for (n = pf->output[fail[s]]; n < pf->output[fail[s] + 1]; n++) {
+            pf->match[cursor[s]++] = pf->match[n];
+        }
+    }
+
+    pf->next = next;
+
+    pclcf->regex_prefilter = pf;
+
+    ngx_log_debug3(NGX_LOG_DEBUG_HTTP, cf->log, 0,
+                   "regex prefilter: %ui locations, %ui states, %ui classes",
+                   nregex, nstates, k);
+
+    return NGX_OK;
+}
+
+
+/*
+ * returns the longest lowercased literal that any string matching
+ * the pattern must contain, or 0 if it is not known: only top level
+ * literals not followed by an optional quantifier are taken into account,
+ * and a top level alternation or the extended syntax disable the prefilter
+ */
+
+static size_t
+ngx_http_regex_literal(ngx_str_t *pattern, u_char *literal)
+{
+    u_char     *p, *q, *last, ch, run[NGX_HTTP_REGEX_LITERAL_LEN];
+    size_t      len, n;
+    ngx_int_t   depth;
+    ngx_uint_t  append;
+
+    p = pattern->data;
+    last = p + pattern->len;
+
+    depth = 0;
+    len = 0;
+    n = 0;
+
+    while (p < last) {
+
+        ch = *p++;
+        append = 0;
+
+        switch (ch) {
+
+        case '\\':
+            if (p == last) {
+                return 0;
+            }
+
+            ch = *p++;
+
+            /*
+             * "\E" and an empty "\Q\E" are ignored, so a quantifier
+             * after them applies to the preceding character
+             */
+
+            if (ch == 'E') {
+                return 0;
+            }
+
+            if (ch == 'Q') {
+
+                if (last - p >= 2 && p[0] == '\\' && p[1] == 'E') {
+                    return 0;
+                }
+
+                /* skip the quoted sequence up to "\E" */
+
+                while (p < last) {
+                    if (*p++ == '\\' && p < last && *p == 'E') {
+                        p++;
+                        break;
+                    }
+                }
+
+                break;
+            }
+
+            if ((ch >= '0' && ch <= '9')
+                || ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'z'))
+            {
+                /* a character type, an assertion, or a reference */
+
+                while (p < last
+                       && ((*p >= '0' && *p <= '9')
+                           || ((*p | 0x20) >= 'a' && (*p | 0x20) <= 'z')))
+                {
+                    p++;
+                }
+
+                if (p == last) {
+                    break;
+                }
+
+                if (*p == '{') {
+                    ch = '}';
+
+                } else if ((ch == 'g' || ch == 'k')
+                           && (*p == '<' || *p == '\''))
+                {
+                    ch = (u_char) (*p == '<' ? '>' : '\'');
+
+                } else {
+                    break;
+                }
+
+                for (p++; p < last && *p != ch; p++) {
+                    if (*p == '|' || *p == '(' || *p == ')' || *p == '['
+                        || *p == '\\')
+                    {
+                        return 0;
+                    }
+                }
+
+                if (p == last) {
+                    return 0;
+                }
+
+                p++;
+                break;
+            }
+
+            append = 1;
+            break;
+
+        case '[':
+            if (p < last && *p == '^') {
+                p++;
+            }
+
+            if (p < last && *p == ']') {
+                p++;
+            }
+
+            while (p < last && *p != ']') {
+
+                if (*p == '\\') {
+                    p++;
+
+                } else if (*p == '[' && p + 1 < last && p[1] == ':') {
+                    for (q = p + 2; q + 1 < last; q++) {
+                        if (q[0] == ':' && q[1] == ']') {
+                            p = q + 1;
+                            break;
+                        }
+                    }
+                }
+
+                p++;
+            }
+
+            if (p >= last) {
+                return 0;
+            }
+
+            p++;
+            break;
+
+        case '(':
+
+            /*
+             * "(*UTF8)" with caseless matching folds non-ASCII characters
+             * to ASCII ones, and verbs like "(*ACCEPT)" end a match early
+             */
+
+            if (p < last && *p == '*') {
+                return 0;
+            }
+
+            if (p < last && *p == '?') {
+                for (q = p + 1; q < last; q++) {
+                    if (*q == 'x' || *q == '#') {
+                        return 0;
+                    }
+
+                    if (!((*q | 0x20) >= 'a' && (*q | 0x20) <= 'z')
+                        && *q != '-')
+                    {
+                        break;
+                    }
+                }
+            }
+
+            depth++;
+            break;
+
+        case ')':
+            depth--;
+            break;
+
+        case '|':
+            if (depth == 0) {
+                return 0;
+            }
+
+            break;
+
+        case '{':
+            q = p;
+
+            while (q < last && ((*q >= '0' && *q <= '9') || *q == ',')) {
+                q++;
+            }
+
+            if (q == p || q == last || *q != '}') {
+                return 0;
+            }
+
+            p = q + 1;
+            break;
+
+        case '.':
+        case '^':
+        case '$':
+        case '*':
+        case '+':
+        case '?':
+            break;
+
+        default:
+            append = 1;
+        }
+
+        if (append
+            && depth == 0
+            && !(p < last && (*p == '*' || *p == '?' || *p == '{')))
+        {
+            if (n < NGX_HTTP_REGEX_LITERAL_LEN) {
+                run[n++] = ngx_tolower(ch);
+            }
+
+            if (p == last || *p != '+') {
+                continue;
+            }
+        }
+
+        if (n > len) {
+            ngx_memcpy(literal, run, n);
+            len = n;
+        }
+
+        n = 0;
+    }
+
+    if (depth != 0) {
+        return 0;
+    }
+
+    if (n > len) {
+        ngx_memcpy(literal, run, n);
+        len = n;
+    }
+
+    return len;
+}
+
+#endif
+
+
 static ngx_int_t
 ngx_http_init_static_location_trees(ngx_conf_t *cf,
     ngx_http_core_loc_conf_t *pclcf)
@@ -1225,6 +1693,9 @@ ngx_http_add_addresses(ngx_conf_t *cf, ngx_http_core_srv_conf_t *cscf,
 #if (NGX_HTTP_SSL)
     ngx_uint_t             ssl;
 #endif
+#if (NGX_HTTP_V2)
+    ngx_uint_t             http2;
+#endif
 
     /*
      * we cannot compare whole sockaddr struct's as kernel
@@ -1277,6 +1748,9 @@ ngx_http_add_addresses(ngx_conf_t *cf, ngx_http_core_srv_conf_t *cscf,
 #if (NGX_HTTP_SSL)
         ssl = lsopt->ssl || addr[i].opt.ssl;
 #endif
+#if (NGX_HTTP_V2)
+        http2 = lsopt->http2 || addr[i].opt.http2;
+#endif
 
         if (lsopt->set) {
 
@@ -1307,6 +1781,9 @@ ngx_http_add_addresses(ngx_conf_t *cf, ngx_http_core_srv_conf_t *cscf,
 #if (NGX_HTTP_SSL)
         addr[i].opt.ssl = ssl;
 #endif
+#if (NGX_HTTP_V2)
+        addr[i].opt.http2 = http2;
+#endif
 
         return NGX_OK;
     }
@@ -1712,6 +2189,10 @@ ngx_http_init_listening(ngx_conf_t *cf, ngx_http_conf_port_t *port)
             break;
         }
 
+        if (ngx_clone_listening(cf, ls) != NGX_OK) {
+            return NGX_ERROR;
+        }
+
         addr++;
         last--;
     }
@@ -1779,6 +2260,10 @@ ngx_http_add_listening(ngx_conf_t *cf, ngx_http_conf_addr_t *addr)
     ls->setfib = addr->opt.setfib;
 #endif
 
+#if (NGX_HAVE_REUSEPORT)
+    ls->reuseport = addr->opt.reuseport;
+#endif
+
     return ls;
 }
 
@@ -1808,6 +2293,9 @@ ngx_http_add_addrs(ngx_conf_t *cf, ngx_http_port_t *hport,
 #if (NGX_HTTP_SSL)
         addrs[i].conf.ssl = addr[i].opt.ssl;
 #endif
+#if (NGX_HTTP_V2)
+        addrs[i].conf.http2 = addr[i].opt.http2;
+#endif
 
         if (addr[i].hash.buckets == NULL
             && (addr[i].wc_head == NULL
@@ -1869,6 +2357,9 @@ ngx_http_add_addrs6(ngx_conf_t *cf, ngx_http_port_t *hport,
 #if (NGX_HTTP_SSL)
         addrs6[i].conf.ssl = addr[i].opt.ssl;
 #endif
+#if (NGX_HTTP_V2)
+        addrs6[i].conf.http2 = addr[i].opt.http2;
+#endif
 
         if (addr[i].hash.buckets == NULL
             && (addr[i].wc_head == NULL
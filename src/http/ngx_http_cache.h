@@ -19,10 +19,22 @@
 #define NGX_HTTP_CACHE_EXPIRED       3
 #define NGX_HTTP_CACHE_STALE         4
 #define NGX_HTTP_CACHE_UPDATING      5
-#define NGX_HTTP_CACHE_HIT           6
-#define NGX_HTTP_CACHE_SCARCE        7
+#define NGX_HTTP_CACHE_REVALIDATED   6
+#define NGX_HTTP_CACHE_HIT           7
+#define NGX_HTTP_CACHE_SCARCE        8
 
 #define NGX_HTTP_CACHE_KEY_LEN       16
+#define NGX_HTTP_CACHE_ETAG_LEN      42
+#define NGX_HTTP_CACHE_VARY_LEN      128
+
+#define NGX_HTTP_CACHE_VERSION       2
+
+#define NGX_HTTP_CACHE_POLICY_LRU      0
+#define NGX_HTTP_CACHE_POLICY_TINYLFU  1
+
+#define NGX_HTTP_CACHE_TIERS         4
+#define NGX_HTTP_CACHE_PROMOTE       64
+#define NGX_HTTP_CACHE_BANS          64
 
 
 typedef struct {
@@ -45,13 +57,19 @@ typedef struct {
     unsigned                         exists:1;
     unsigned                         updating:1;
     unsigned                         deleting:1;
-                                     /* 11 unused bits */
+    unsigned                         hot:1;
+    unsigned                         tier:2;
+    unsigned                         promote:1;
+    unsigned                         moving:1;
+    unsigned                         vary:1;
+                                     /* 5 unused bits */
 
     ngx_file_uniq_t                  uniq;
     time_t                           expire;
     time_t                           valid_sec;
     size_t                           body_start;
     off_t                            fs_size;
+    ngx_msec_t                       lock_time;
 } ngx_http_file_cache_node_t;
 
 
@@ -60,12 +78,19 @@ struct ngx_http_cache_s {
     ngx_array_t                      keys;
     uint32_t                         crc32;
     u_char                           key[NGX_HTTP_CACHE_KEY_LEN];
+    u_char                           main[NGX_HTTP_CACHE_KEY_LEN];
 
     ngx_file_uniq_t                  uniq;
     time_t                           valid_sec;
     time_t                           last_modified;
     time_t                           date;
 
+    ngx_str_t                        etag;
+    ngx_str_t                        vary;
+    u_char                           variant[NGX_HTTP_CACHE_KEY_LEN];
+
+    ngx_uint_t                       tier;
+
     size_t                           header_start;
     size_t                           body_start;
     off_t                            length;
@@ -80,14 +105,31 @@ struct ngx_http_cache_s {
     ngx_http_file_cache_t           *file_cache;
     ngx_http_file_cache_node_t      *node;
 
+    ngx_msec_t                       lock_timeout;
+    ngx_msec_t                       wait_time;
+
+    ngx_event_t                      wait_event;
+
+#if (NGX_THREAD_POOL)
+    ngx_thread_task_t               *thread_task;
+#endif
+
     unsigned                         updated:1;
     unsigned                         updating:1;
     unsigned                         exists:1;
     unsigned                         temp_file:1;
+    unsigned                         lock:1;
+    unsigned                         lock_updating:1;
+    unsigned                         waiting:1;
+    unsigned                         background:1;
+    unsigned                         memory:1;
+    unsigned                         secondary:1;
+    unsigned                         gzip:1;
 };
 
 
 typedef struct {
+    ngx_uint_t                       version;
     time_t                           valid_sec;
     time_t                           last_modified;
     time_t                           date;
@@ -95,6 +137,11 @@ typedef struct {
     u_short                          valid_msec;
     u_short                          header_start;
     u_short                          body_start;
+    u_char                           etag_len;
+    u_char                           etag[NGX_HTTP_CACHE_ETAG_LEN];
+    u_char                           vary_len;
+    u_char                           vary[NGX_HTTP_CACHE_VARY_LEN];
+    u_char                           variant[NGX_HTTP_CACHE_KEY_LEN];
 } ngx_http_file_cache_header_t;
 
 
@@ -105,24 +152,110 @@ typedef struct {
     ngx_atomic_t                     cold;
     ngx_atomic_t                     loading;
     off_t                            size;
+
+    ngx_queue_t                      protected;
+    off_t                            protected_size;
+
+    u_char                          *sketch;
+    ngx_uint_t                       sketch_mask;
+    ngx_uint_t                       sketch_samples;
+
+    ngx_uint_t                       hits;
+    ngx_uint_t                       misses;
+    ngx_uint_t                       admitted;
+    ngx_uint_t                       rejected;
+    ngx_uint_t                       evicted;
+
+    off_t                            tier_size[NGX_HTTP_CACHE_TIERS];
+    ngx_uint_t                       promoted;
+    ngx_uint_t                       demoted;
+
+    ngx_uint_t                       npromote;
+    u_char                           promote[NGX_HTTP_CACHE_PROMOTE]
+                                            [NGX_HTTP_CACHE_KEY_LEN];
+
+    ngx_queue_t                      bans;
+    ngx_uint_t                       nbans;
+    ngx_uint_t                       purged;
+
+    time_t                           purge_start;
+    ngx_uint_t                       purge_first;
+    ngx_uint_t                       purge_skipped;
+    u_char                           purge_key[NGX_HTTP_CACHE_KEY_LEN];
 } ngx_http_file_cache_sh_t;
 
 
+typedef struct {
+    ngx_queue_t                      queue;
+    time_t                           time;
+    ngx_uint_t                       type;
+    size_t                           len;
+    u_char                           data[1];
+} ngx_http_file_cache_ban_t;
+
+
+typedef struct {
+    ngx_path_t                      *path;
+    ngx_uint_t                       weight;
+    off_t                            max_size;
+} ngx_http_file_cache_tier_t;
+
+
+typedef struct {
+    ngx_rbtree_node_t                node;
+    ngx_queue_t                      queue;
+
+    u_char                           key[NGX_HTTP_CACHE_KEY_LEN
+                                         - sizeof(ngx_rbtree_key_t)];
+
+    ngx_file_uniq_t                  uniq;
+    size_t                           len;
+    u_char                           data[1];
+} ngx_http_file_cache_mem_node_t;
+
+
+typedef struct {
+    ngx_rbtree_t                     rbtree;
+    ngx_rbtree_node_t                sentinel;
+    ngx_queue_t                      queue;
+} ngx_http_file_cache_mem_sh_t;
+
+
 struct ngx_http_file_cache_s {
     ngx_http_file_cache_sh_t        *sh;
     ngx_slab_pool_t                 *shpool;
 
     ngx_path_t                      *path;
 
+    ngx_http_file_cache_tier_t       tiers[NGX_HTTP_CACHE_TIERS];
+    ngx_uint_t                       ntiers;
+    ngx_uint_t                       walk_tier;
+    ngx_uint_t                       promote;
+    size_t                           name_len;
+
     off_t                            max_size;
     size_t                           bsize;
 
     time_t                           inactive;
 
+    ngx_uint_t                       policy;
+    time_t                           stats_next;
+
     ngx_msec_t                       last;
     ngx_uint_t                       files;
 
+    ngx_str_t                        index;
+    ngx_str_t                        index_temp;
+    time_t                           index_interval;
+    time_t                           index_next;
+    time_t                           index_time;
+
+    ngx_http_file_cache_mem_sh_t    *mem;
+    ngx_slab_pool_t                 *mpool;
+    size_t                           mem_max;
+
     ngx_shm_zone_t                  *shm_zone;
+    ngx_shm_zone_t                  *mem_zone;
 };
 
 
@@ -130,8 +263,10 @@ ngx_int_t ngx_http_file_cache_new(ngx_http_request_t *r);
 ngx_int_t ngx_http_file_cache_create(ngx_http_request_t *r);
 void ngx_http_file_cache_create_key(ngx_http_request_t *r);
 ngx_int_t ngx_http_file_cache_open(ngx_http_request_t *r);
-void ngx_http_file_cache_set_header(ngx_http_request_t *r, u_char *buf);
+ngx_int_t ngx_http_file_cache_purge(ngx_http_request_t *r);
+ngx_int_t ngx_http_file_cache_set_header(ngx_http_request_t *r, u_char *buf);
 void ngx_http_file_cache_update(ngx_http_request_t *r, ngx_temp_file_t *tf);
+void ngx_http_file_cache_update_header(ngx_http_request_t *r);
 ngx_int_t ngx_http_cache_send(ngx_http_request_t *);
 void ngx_http_file_cache_free(ngx_http_cache_t *c, ngx_temp_file_t *tf);
 time_t ngx_http_file_cache_valid(ngx_array_t *cache_valid, ngx_uint_t status);
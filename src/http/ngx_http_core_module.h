@@ -13,6 +13,10 @@
 #include <ngx_core.h>
 #include <ngx_http.h>
 
+#if (NGX_THREAD_POOL)
+#include <ngx_thread_pool.h>
+#endif
+
 
 #define NGX_HTTP_GZIP_PROXIED_OFF       0x0002
 #define NGX_HTTP_GZIP_PROXIED_EXPIRED   0x0004
@@ -28,6 +32,7 @@
 #define NGX_HTTP_AIO_OFF                0
 #define NGX_HTTP_AIO_ON                 1
 #define NGX_HTTP_AIO_SENDFILE           2
+#define NGX_HTTP_AIO_THREADS            3
 
 
 #define NGX_HTTP_SATISFY_ALL            0
@@ -75,9 +80,15 @@ typedef struct {
 #if (NGX_HTTP_SSL)
     unsigned                   ssl:1;
 #endif
+#if (NGX_HTTP_V2)
+    unsigned                   http2:1;
+#endif
 #if (NGX_HAVE_INET6 && defined IPV6_V6ONLY)
     unsigned                   ipv6only:2;
 #endif
+#if (NGX_HAVE_REUSEPORT)
+    unsigned                   reuseport:1;
+#endif
 
     int                        backlog;
     int                        rcvbuf;
@@ -148,7 +159,7 @@ typedef struct {
 
     ngx_http_phase_engine_t    phase_engine;
 
-    ngx_hash_t                 headers_in_hash;
+    ngx_hash_perfect_t         headers_in_hash;
 
     ngx_hash_t                 variables_hash;
 
@@ -204,16 +215,19 @@ typedef struct {
 /* list of structures to find core_srv_conf quickly at run time */
 
 
-typedef struct {
+struct ngx_http_addr_conf_s {
     /* the default server configuration for this address:port */
     ngx_http_core_srv_conf_t  *default_server;
 
     ngx_http_virtual_names_t  *virtual_names;
 
 #if (NGX_HTTP_SSL)
-    ngx_uint_t                 ssl;   /* unsigned  ssl:1; */
+    unsigned                   ssl:1;
+#endif
+#if (NGX_HTTP_V2)
+    unsigned                   http2:1;
 #endif
-} ngx_http_addr_conf_t;
+};
 
 
 typedef struct {
@@ -291,6 +305,26 @@ typedef struct {
 } ngx_http_try_file_t;
 
 
+#if (NGX_PCRE)
+
+/*
+ * an Aho-Corasick automaton over the required literals of regex locations,
+ * the locations whose literals do not occur in URI are not tested
+ */
+
+typedef struct {
+    ngx_uint_t                 nlocations;
+    ngx_uint_t                 nclasses;
+    u_char                    *candidates;  /* locations without literal */
+    u_short                   *next;        /* states x classes */
+    ngx_uint_t                *output;      /* states + 1 */
+    ngx_uint_t                *match;
+    u_char                     class[256];
+} ngx_http_regex_prefilter_t;
+
+#endif
+
+
 struct ngx_http_core_loc_conf_s {
     ngx_str_t     name;          /* location name */
 
@@ -306,6 +340,9 @@ struct ngx_http_core_loc_conf_s {
     unsigned      noregex:1;
 
     unsigned      auto_redirect:1;
+#if (NGX_HTTP_GUNZIP)
+    unsigned      gunzip:1;   /* the handler requires gunzip */
+#endif
 #if (NGX_HTTP_GZIP)
     unsigned      gzip_disable_msie6:2;
 #if (NGX_HTTP_DEGRADATION)
@@ -316,6 +353,7 @@ struct ngx_http_core_loc_conf_s {
     ngx_http_location_tree_node_t   *static_locations;
 #if (NGX_PCRE)
     ngx_http_core_loc_conf_t       **regex_locations;
+    ngx_http_regex_prefilter_t      *regex_prefilter;
 #endif
 
     /* pointer to the modules' loc_conf */
@@ -373,8 +411,11 @@ struct ngx_http_core_loc_conf_s {
                                            /* client_body_in_singe_buffer */
     ngx_flag_t    internal;                /* internal */
     ngx_flag_t    sendfile;                /* sendfile */
-#if (NGX_HAVE_FILE_AIO)
+#if (NGX_HAVE_FILE_AIO || NGX_THREAD_POOL)
     ngx_flag_t    aio;                     /* aio */
+#endif
+#if (NGX_THREAD_POOL)
+    ngx_thread_pool_t  *thread_pool;       /* aio threads=pool */
 #endif
     ngx_flag_t    tcp_nopush;              /* tcp_nopush */
     ngx_flag_t    tcp_nodelay;             /* tcp_nodelay */
@@ -11,13 +11,78 @@
 #include <ngx_md5.h>
 
 
+#define NGX_HTTP_FILE_CACHE_INDEX_MAGIC  0x78646e69    /* "indx" */
+#define NGX_HTTP_FILE_CACHE_INDEX_BATCH  1024
+
+#define NGX_HTTP_FILE_CACHE_SKETCH_DEPTH  4
+#define NGX_HTTP_FILE_CACHE_SKETCH_MAX    15
+
+#define NGX_HTTP_FILE_CACHE_MOVE_BATCH    32
+#define NGX_HTTP_FILE_CACHE_MOVE_SCAN     1000
+
+#define NGX_HTTP_FILE_CACHE_PURGE_BATCH   100
+#define NGX_HTTP_FILE_CACHE_PURGE_TIME    200
+
+#define NGX_HTTP_FILE_CACHE_BAN_PREFIX    0
+#define NGX_HTTP_FILE_CACHE_BAN_TAG       1
+#define NGX_HTTP_FILE_CACHE_BAN_KEY       2
+
+
+typedef struct {
+    uint32_t                         magic;
+    uint32_t                         version;
+    ngx_uint_t                       entry_size;
+    ngx_uint_t                       level[3];
+    ngx_uint_t                       tiers;
+    size_t                           bsize;
+    time_t                           time;
+    ngx_uint_t                       entries;
+} ngx_http_file_cache_index_header_t;
+
+
+typedef struct {
+    u_char                           key[NGX_HTTP_CACHE_KEY_LEN];
+    ngx_file_uniq_t                  uniq;
+    off_t                            fs_size;
+    size_t                           body_start;
+    ngx_uint_t                       tier;
+    ngx_uint_t                       vary;
+} ngx_http_file_cache_index_entry_t;
+
+
+typedef struct {
+    u_char                           key[NGX_HTTP_CACHE_KEY_LEN];
+    ngx_file_uniq_t                  uniq;
+    size_t                           body_start;
+    u_char                          *name;
+} ngx_http_file_cache_purge_entry_t;
+
+
+static ngx_int_t ngx_http_file_cache_lock(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
+static ngx_int_t ngx_http_file_cache_wait(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
+static void ngx_http_file_cache_lock_wait_handler(ngx_event_t *ev);
 static ngx_int_t ngx_http_file_cache_read(ngx_http_request_t *r,
     ngx_http_cache_t *c);
+static ngx_int_t ngx_http_file_cache_reopen(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
+static void ngx_http_file_cache_vary(ngx_http_request_t *r, u_char *vary,
+    size_t len, u_char *hash);
+static void ngx_http_file_cache_vary_header(ngx_http_request_t *r,
+    ngx_md5_t *md5, ngx_str_t *name);
+static ngx_int_t ngx_http_file_cache_update_variant(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
 static ssize_t ngx_http_file_cache_aio_read(ngx_http_request_t *r,
     ngx_http_cache_t *c);
 #if (NGX_HAVE_FILE_AIO)
 static void ngx_http_cache_aio_event_handler(ngx_event_t *ev);
 #endif
+#if (NGX_THREAD_POOL)
+static ngx_int_t ngx_http_cache_thread_handler(ngx_thread_task_t *task,
+    ngx_file_t *file);
+static void ngx_http_cache_thread_event_handler(ngx_event_t *ev);
+#endif
 static ngx_int_t ngx_http_file_cache_exists(ngx_http_file_cache_t *cache,
     ngx_http_cache_t *c);
 static ngx_int_t ngx_http_file_cache_name(ngx_http_request_t *r,
@@ -26,11 +91,58 @@ static ngx_http_file_cache_node_t *
     ngx_http_file_cache_lookup(ngx_http_file_cache_t *cache, u_char *key);
 static void ngx_http_file_cache_rbtree_insert_value(ngx_rbtree_node_t *temp,
     ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
+static ngx_int_t ngx_http_file_cache_sketch_init(ngx_http_file_cache_t *cache,
+    ngx_shm_zone_t *shm_zone);
+static void ngx_http_file_cache_sketch_add(ngx_http_file_cache_t *cache,
+    u_char *key);
+static ngx_uint_t ngx_http_file_cache_sketch_estimate(
+    ngx_http_file_cache_t *cache, u_char *key);
+static ngx_uint_t ngx_http_file_cache_admit(ngx_http_file_cache_t *cache,
+    u_char *key);
+static void ngx_http_file_cache_access(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, ngx_uint_t hit);
+static ngx_int_t ngx_http_file_cache_memory_init(ngx_shm_zone_t *shm_zone,
+    void *data);
+static ngx_int_t ngx_http_file_cache_memory_open(ngx_http_request_t *r,
+    ngx_http_cache_t *c);
+static void ngx_http_file_cache_memory_store(ngx_http_file_cache_t *cache,
+    ngx_http_cache_t *c);
+static void ngx_http_file_cache_memory_update(ngx_http_file_cache_t *cache,
+    ngx_http_cache_t *c, ngx_http_file_cache_header_t *h);
+static void ngx_http_file_cache_memory_delete(ngx_http_file_cache_t *cache,
+    u_char *key);
+static ngx_http_file_cache_mem_node_t *ngx_http_file_cache_memory_lookup(
+    ngx_http_file_cache_t *cache, u_char *key);
+static void ngx_http_file_cache_memory_free(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_mem_node_t *mn);
+static void ngx_http_file_cache_memory_insert_value(ngx_rbtree_node_t *temp,
+    ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel);
+static ngx_int_t ngx_http_file_cache_ban(ngx_http_file_cache_t *cache,
+    ngx_uint_t type, u_char *data, size_t len);
+static ngx_uint_t ngx_http_file_cache_banned(ngx_http_file_cache_t *cache,
+    u_char *start, size_t size);
+static ngx_uint_t ngx_http_file_cache_tagged(ngx_str_t *tags, u_char *tag,
+    size_t len);
+static void ngx_http_file_cache_purge_node(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, u_char *name);
 static void ngx_http_file_cache_cleanup(void *data);
 static time_t ngx_http_file_cache_forced_expire(ngx_http_file_cache_t *cache);
 static time_t ngx_http_file_cache_expire(ngx_http_file_cache_t *cache);
+static time_t ngx_http_file_cache_expire_queue(ngx_http_file_cache_t *cache,
+    ngx_queue_t *queue, u_char *name);
 static void ngx_http_file_cache_delete(ngx_http_file_cache_t *cache,
     ngx_queue_t *q, u_char *name);
+static time_t ngx_http_file_cache_migrate(ngx_http_file_cache_t *cache);
+static ngx_http_file_cache_node_t *ngx_http_file_cache_coldest(
+    ngx_http_file_cache_t *cache, ngx_uint_t tier);
+static ngx_int_t ngx_http_file_cache_move(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, ngx_uint_t tier, u_char *name,
+    size_t len);
+static void ngx_http_file_cache_node_name(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, ngx_uint_t tier, u_char *name);
+static time_t ngx_http_file_cache_purge_walk(ngx_http_file_cache_t *cache);
+static void ngx_http_file_cache_purge_check(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_purge_entry_t *pe, u_char *buf, size_t size);
 static ngx_int_t
     ngx_http_file_cache_loader_sleep(ngx_http_file_cache_t *cache);
 static ngx_int_t ngx_http_file_cache_noop(ngx_tree_ctx_t *ctx,
@@ -43,6 +155,15 @@ static ngx_int_t ngx_http_file_cache_add(ngx_http_file_cache_t *cache,
     ngx_http_cache_t *c);
 static ngx_int_t ngx_http_file_cache_delete_file(ngx_tree_ctx_t *ctx,
     ngx_str_t *path);
+static void ngx_http_file_cache_log_stats(ngx_http_file_cache_t *cache);
+static void ngx_http_file_cache_write_index(ngx_http_file_cache_t *cache);
+static ngx_rbtree_node_t *ngx_http_file_cache_index_next(
+    ngx_http_file_cache_t *cache, u_char *key);
+static ngx_rbtree_node_t *ngx_http_file_cache_index_successor(
+    ngx_rbtree_t *tree, ngx_rbtree_node_t *node);
+static ngx_int_t ngx_http_file_cache_load_index(ngx_http_file_cache_t *cache);
+static ngx_int_t ngx_http_file_cache_skip_dir(ngx_tree_ctx_t *ctx,
+    ngx_str_t *path);
 
 
 ngx_str_t  ngx_http_cache_status[] = {
@@ -51,11 +172,13 @@ ngx_str_t  ngx_http_cache_status[] = {
     ngx_string("EXPIRED"),
     ngx_string("STALE"),
     ngx_string("UPDATING"),
+    ngx_string("REVALIDATED"),
     ngx_string("HIT")
 };
 
 
 static u_char  ngx_http_file_cache_key[] = { LF, 'K', 'E', 'Y', ':', ' ' };
+static u_char  ngx_http_file_cache_tag[] = "Cache-Tag:";
 
 
 static ngx_int_t
@@ -89,6 +212,19 @@ ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
             }
         }
 
+        for (n = 1; n < cache->ntiers || n < ocache->ntiers; n++) {
+            if (n >= cache->ntiers || n >= ocache->ntiers
+                || ngx_strcmp(cache->tiers[n].path->name.data,
+                              ocache->tiers[n].path->name.data)
+                   != 0)
+            {
+                ngx_log_error(NGX_LOG_EMERG, shm_zone->shm.log, 0,
+                              "cache \"%V\" had previously different tiers",
+                              &shm_zone->shm.name);
+                return NGX_ERROR;
+            }
+        }
+
         cache->sh = ocache->sh;
 
         cache->shpool = ocache->shpool;
@@ -96,10 +232,34 @@ ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
 
         cache->max_size /= cache->bsize;
 
+        for (n = 0; n < cache->ntiers; n++) {
+            cache->tiers[n].max_size /= cache->bsize;
+        }
+
         if (!cache->sh->cold || cache->sh->loading) {
             cache->path->loader = NULL;
         }
 
+        if (cache->policy == NGX_HTTP_CACHE_POLICY_TINYLFU) {
+            if (cache->sh->sketch == NULL) {
+                return ngx_http_file_cache_sketch_init(cache, shm_zone);
+            }
+
+            return NGX_OK;
+        }
+
+        if (cache->sh->sketch) {
+
+            /* the zone was used with "policy=tinylfu" before */
+
+            ngx_shmtx_lock(&cache->shpool->mutex);
+
+            ngx_slab_free_locked(cache->shpool, cache->sh->sketch);
+            cache->sh->sketch = NULL;
+
+            ngx_shmtx_unlock(&cache->shpool->mutex);
+        }
+
         return NGX_OK;
     }
 
@@ -123,15 +283,47 @@ ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
                     ngx_http_file_cache_rbtree_insert_value);
 
     ngx_queue_init(&cache->sh->queue);
+    ngx_queue_init(&cache->sh->protected);
 
     cache->sh->cold = 1;
     cache->sh->loading = 0;
     cache->sh->size = 0;
+    cache->sh->protected_size = 0;
+
+    cache->sh->sketch = NULL;
+    cache->sh->hits = 0;
+    cache->sh->misses = 0;
+    cache->sh->admitted = 0;
+    cache->sh->rejected = 0;
+    cache->sh->evicted = 0;
+
+    for (n = 0; n < NGX_HTTP_CACHE_TIERS; n++) {
+        cache->sh->tier_size[n] = 0;
+    }
+
+    cache->sh->promoted = 0;
+    cache->sh->demoted = 0;
+    cache->sh->npromote = 0;
+
+    ngx_queue_init(&cache->sh->bans);
+    cache->sh->nbans = 0;
+    cache->sh->purged = 0;
+    cache->sh->purge_start = 0;
+
+    if (cache->policy == NGX_HTTP_CACHE_POLICY_TINYLFU) {
+        if (ngx_http_file_cache_sketch_init(cache, shm_zone) != NGX_OK) {
+            return NGX_ERROR;
+        }
+    }
 
     cache->bsize = ngx_fs_bsize(cache->path->name.data);
 
     cache->max_size /= cache->bsize;
 
+    for (n = 0; n < cache->ntiers; n++) {
+        cache->tiers[n].max_size /= cache->bsize;
+    }
+
     len = sizeof(" in cache keys zone \"\"") + shm_zone->shm.name.len;
 
     cache->shpool->log_ctx = ngx_slab_alloc(cache->shpool, len);
@@ -146,6 +338,62 @@ ngx_http_file_cache_init(ngx_shm_zone_t *shm_zone, void *data)
 }
 
 
+static ngx_int_t
+ngx_http_file_cache_memory_init(ngx_shm_zone_t *shm_zone, void *data)
+{
+    ngx_http_file_cache_t  *ocache = data;
+
+    size_t                  len;
+    ngx_http_file_cache_t  *cache;
+
+    cache = shm_zone->data;
+
+    if (ocache) {
+        cache->mem = ocache->mem;
+        cache->mpool = ocache->mpool;
+
+        return NGX_OK;
+    }
+
+    cache->mpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+
+    if (shm_zone->shm.exists) {
+        cache->mem = cache->mpool->data;
+
+        return NGX_OK;
+    }
+
+    cache->mem = ngx_slab_alloc(cache->mpool,
+                                sizeof(ngx_http_file_cache_mem_sh_t));
+    if (cache->mem == NULL) {
+        return NGX_ERROR;
+    }
+
+    cache->mpool->data = cache->mem;
+
+    ngx_rbtree_init(&cache->mem->rbtree, &cache->mem->sentinel,
+                    ngx_http_file_cache_memory_insert_value);
+
+    ngx_queue_init(&cache->mem->queue);
+
+    /* running out of memory is expected, entries are evicted then */
+
+    cache->mpool->log_nomem = 0;
+
+    len = sizeof(" in cache memory zone \"\"") + shm_zone->shm.name.len;
+
+    cache->mpool->log_ctx = ngx_slab_alloc(cache->mpool, len);
+    if (cache->mpool->log_ctx == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_sprintf(cache->mpool->log_ctx, " in cache memory zone \"%V\"%Z",
+                &shm_zone->shm.name);
+
+    return NGX_OK;
+}
+
+
 ngx_int_t
 ngx_http_file_cache_new(ngx_http_request_t *r)
 {
@@ -190,7 +438,7 @@ ngx_http_file_cache_create(ngx_http_request_t *r)
     cln->handler = ngx_http_file_cache_cleanup;
     cln->data = c;
 
-    if (ngx_http_file_cache_name(r, cache->path) != NGX_OK) {
+    if (ngx_http_file_cache_name(r, cache->tiers[c->tier].path) != NGX_OK) {
         return NGX_ERROR;
     }
 
@@ -230,14 +478,17 @@ ngx_http_file_cache_create_key(ngx_http_request_t *r)
 
     ngx_crc32_final(c->crc32);
     ngx_md5_final(c->key, &md5);
+
+    ngx_memcpy(c->main, c->key, NGX_HTTP_CACHE_KEY_LEN);
 }
 
 
 ngx_int_t
 ngx_http_file_cache_open(ngx_http_request_t *r)
 {
+    size_t                     len;
     ngx_int_t                  rc, rv;
-    ngx_uint_t                 cold, test;
+    ngx_uint_t                 cold, test, tries;
     ngx_http_cache_t          *c;
     ngx_pool_cleanup_t        *cln;
     ngx_open_file_info_t       of;
@@ -246,15 +497,24 @@ ngx_http_file_cache_open(ngx_http_request_t *r)
 
     c = r->cache;
 
+    if (c->waiting) {
+        return NGX_AGAIN;
+    }
+
     if (c->buf) {
         return ngx_http_file_cache_read(r, c);
     }
 
     cache = c->file_cache;
 
-    cln = ngx_pool_cleanup_add(r->pool, 0);
-    if (cln == NULL) {
-        return NGX_ERROR;
+    if (c->node == NULL) {
+        cln = ngx_pool_cleanup_add(r->pool, 0);
+        if (cln == NULL) {
+            return NGX_ERROR;
+        }
+
+        cln->handler = ngx_http_file_cache_cleanup;
+        cln->data = c;
     }
 
     rc = ngx_http_file_cache_exists(cache, c);
@@ -266,9 +526,6 @@ ngx_http_file_cache_open(ngx_http_request_t *r)
         return rc;
     }
 
-    cln->handler = ngx_http_file_cache_cleanup;
-    cln->data = c;
-
     if (rc == NGX_AGAIN) {
         return NGX_HTTP_CACHE_SCARCE;
     }
@@ -303,12 +560,28 @@ ngx_http_file_cache_open(ngx_http_request_t *r)
         }
     }
 
-    if (ngx_http_file_cache_name(r, cache->path) != NGX_OK) {
+    tries = 0;
+
+tier:
+
+    if (ngx_http_file_cache_name(r, cache->tiers[c->tier].path) != NGX_OK) {
         return NGX_ERROR;
     }
 
-    if (!test) {
-        return NGX_DECLINED;
+    if (!test || tries == cache->ntiers) {
+        goto done;
+    }
+
+    if (cache->mem && c->uniq) {
+        rc = ngx_http_file_cache_memory_open(r, c);
+
+        if (rc == NGX_OK) {
+            return ngx_http_file_cache_read(r, c);
+        }
+
+        if (rc == NGX_ERROR) {
+            return rc;
+        }
     }
 
     clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
@@ -332,7 +605,19 @@ ngx_http_file_cache_open(ngx_http_request_t *r)
 
         case NGX_ENOENT:
         case NGX_ENOTDIR:
-            return rv;
+
+            /*
+             * until the loader is done the file may be in any tier,
+             * the tiers are tried in turn up to the original one again
+             */
+
+            if (cold && cache->ntiers > 1) {
+                c->tier = (c->tier + 1) % cache->ntiers;
+                tries++;
+                goto tier;
+            }
+
+            goto done;
 
         default:
             ngx_log_error(NGX_LOG_CRIT, r->connection->log, of.err,
@@ -350,12 +635,160 @@ ngx_http_file_cache_open(ngx_http_request_t *r)
     c->length = of.size;
     c->fs_size = (of.fs_size + cache->bsize - 1) / cache->bsize;
 
-    c->buf = ngx_create_temp_buf(r->pool, c->body_start);
+    /* small entries are read whole to be copied to the memory zone */
+
+    len = c->body_start;
+
+    if (cache->mem && c->length <= (off_t) cache->mem_max
+        && c->length > (off_t) len)
+    {
+        len = (size_t) c->length;
+    }
+
+    c->buf = ngx_create_temp_buf(r->pool, len);
     if (c->buf == NULL) {
         return NGX_ERROR;
     }
 
     return ngx_http_file_cache_read(r, c);
+
+done:
+
+    if (rv == NGX_DECLINED) {
+        return ngx_http_file_cache_lock(r, c);
+    }
+
+    return rv;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_lock(ngx_http_request_t *r, ngx_http_cache_t *c)
+{
+    ngx_msec_t              now;
+    ngx_http_file_cache_t  *cache;
+
+    if (!c->lock) {
+        return NGX_DECLINED;
+    }
+
+    cache = c->file_cache;
+
+    now = ngx_current_msec;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    /*
+     * the lock is held by the request populating the node; a lock older
+     * than the lock timeout is considered abandoned and is taken over
+     */
+
+    if (!c->node->updating
+        || (ngx_msec_int_t) (now - c->node->lock_time) >= 0)
+    {
+        c->node->updating = 1;
+        c->node->lock_time = now + c->lock_timeout;
+        c->updating = 1;
+    }
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache lock u:%d wt:%M",
+                   c->updating, c->wait_time);
+
+    if (c->updating) {
+        return NGX_DECLINED;
+    }
+
+    return ngx_http_file_cache_wait(r, c);
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_wait(ngx_http_request_t *r, ngx_http_cache_t *c)
+{
+    ngx_msec_int_t  timer;
+
+    if (c->wait_time == 0) {
+        c->wait_time = ngx_current_msec + c->lock_timeout;
+
+        c->wait_event.handler = ngx_http_file_cache_lock_wait_handler;
+        c->wait_event.data = r;
+        c->wait_event.log = r->connection->log;
+    }
+
+    timer = (ngx_msec_int_t) (c->wait_time - ngx_current_msec);
+
+    if (timer <= 0) {
+        timer = 1;
+    }
+
+    ngx_add_timer(&c->wait_event, (timer > 100) ? 100 : (ngx_msec_t) timer);
+
+    c->waiting = 1;
+    r->main->blocked++;
+
+    return NGX_AGAIN;
+}
+
+
+static void
+ngx_http_file_cache_lock_wait_handler(ngx_event_t *ev)
+{
+    ngx_uint_t              wait;
+    ngx_msec_t              now;
+    ngx_msec_int_t          timer;
+    ngx_http_cache_t       *c;
+    ngx_connection_t       *conn;
+    ngx_http_request_t     *r;
+    ngx_http_file_cache_t  *cache;
+
+    r = ev->data;
+    c = r->cache;
+
+    now = ngx_current_msec;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, ev->log, 0,
+                   "http file cache wait handler wt:%M cur:%M",
+                   c->wait_time, now);
+
+    timer = (ngx_msec_int_t) (c->wait_time - now);
+
+    if (timer <= 0) {
+        ngx_log_error(NGX_LOG_INFO, ev->log, 0, "cache lock timeout");
+        c->lock = 0;
+        goto wakeup;
+    }
+
+    cache = c->file_cache;
+    wait = 0;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    if (c->node->updating
+        && (ngx_msec_int_t) (now - c->node->lock_time) < 0)
+    {
+        wait = 1;
+    }
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    if (wait) {
+        ngx_add_timer(ev, (timer > 100) ? 100 : (ngx_msec_t) timer);
+        return;
+    }
+
+wakeup:
+
+    c->waiting = 0;
+    r->main->blocked--;
+
+    conn = r->connection;
+
+    r->write_event_handler(r);
+
+    ngx_http_run_posted_requests(conn);
 }
 
 
@@ -365,13 +798,20 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
     time_t                         now;
     ssize_t                        n;
     ngx_int_t                      rc;
+    ngx_uint_t                     banned;
+    ngx_msec_t                     msec;
     ngx_http_file_cache_t         *cache;
     ngx_http_file_cache_header_t  *h;
 
-    n = ngx_http_file_cache_aio_read(r, c);
+    if (c->memory) {
+        n = (ssize_t) c->length;
 
-    if (n < 0) {
-        return n;
+    } else {
+        n = ngx_http_file_cache_aio_read(r, c);
+
+        if (n < 0) {
+            return n;
+        }
     }
 
     if ((size_t) n < c->header_start) {
@@ -382,6 +822,12 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
 
     h = (ngx_http_file_cache_header_t *) c->buf->pos;
 
+    if (h->version != NGX_HTTP_CACHE_VERSION) {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "cache file \"%s\" version mismatch", c->file.name.data);
+        return NGX_DECLINED;
+    }
+
     if (h->crc32 != c->crc32) {
         ngx_log_error(NGX_LOG_CRIT, r->connection->log, 0,
                       "cache file \"%s\" has md5 collision", c->file.name.data);
@@ -395,6 +841,50 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
         return NGX_DECLINED;
     }
 
+    cache = c->file_cache;
+
+    if (h->vary_len > NGX_HTTP_CACHE_VARY_LEN) {
+        ngx_log_error(NGX_LOG_CRIT, r->connection->log, 0,
+                      "cache file \"%s\" has incorrect vary length",
+                      c->file.name.data);
+        return NGX_DECLINED;
+    }
+
+    if (h->vary_len) {
+
+        if (!c->node->vary) {
+            ngx_shmtx_lock(&cache->shpool->mutex);
+            c->node->vary = 1;
+            ngx_shmtx_unlock(&cache->shpool->mutex);
+        }
+
+        ngx_http_file_cache_vary(r, h->vary, h->vary_len, c->variant);
+
+        if (ngx_memcmp(c->variant, h->variant, NGX_HTTP_CACHE_KEY_LEN) != 0) {
+            return ngx_http_file_cache_reopen(r, c);
+        }
+    }
+
+    /*
+     * the entries stored before a prefix or tag purge are refused
+     * until the cache manager has walked the cache and deleted them
+     */
+
+    if (cache->sh->nbans) {
+        ngx_shmtx_lock(&cache->shpool->mutex);
+
+        banned = ngx_http_file_cache_banned(cache, c->buf->pos, n);
+
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+        if (banned) {
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "http file cache purged: \"%s\"",
+                           c->file.name.data);
+            return NGX_DECLINED;
+        }
+    }
+
     c->buf->last += n;
 
     c->valid_sec = h->valid_sec;
@@ -403,10 +893,16 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
     c->valid_msec = h->valid_msec;
     c->header_start = h->header_start;
     c->body_start = h->body_start;
+    c->etag.len = h->etag_len;
+    c->etag.data = h->etag;
 
     r->cached = 1;
 
-    cache = c->file_cache;
+    if (cache->mem && !c->memory && (off_t) n == c->length
+        && c->length <= (off_t) cache->mem_max)
+    {
+        ngx_http_file_cache_memory_store(cache, c);
+    }
 
     if (cache->sh->cold) {
 
@@ -418,8 +914,15 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
             c->node->exists = 1;
             c->node->uniq = c->uniq;
             c->node->fs_size = c->fs_size;
+            c->node->tier = c->tier;
 
             cache->sh->size += c->fs_size;
+            cache->sh->tier_size[c->tier] += c->fs_size;
+
+        } else if (c->node->tier != c->tier) {
+            cache->sh->tier_size[c->node->tier] -= c->node->fs_size;
+            cache->sh->tier_size[c->tier] += c->node->fs_size;
+            c->node->tier = c->tier;
         }
 
         ngx_shmtx_unlock(&cache->shpool->mutex);
@@ -429,13 +932,18 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
 
     if (c->valid_sec < now) {
 
+        msec = ngx_current_msec;
+
         ngx_shmtx_lock(&cache->shpool->mutex);
 
-        if (c->node->updating) {
+        if (c->node->updating
+            && (!c->lock || (ngx_msec_int_t) (msec - c->node->lock_time) < 0))
+        {
             rc = NGX_HTTP_CACHE_UPDATING;
 
         } else {
             c->node->updating = 1;
+            c->node->lock_time = msec + c->lock_timeout;
             c->updating = 1;
             rc = NGX_HTTP_CACHE_STALE;
         }
@@ -446,6 +954,20 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
                        "http file cache expired: %i %T %T",
                        rc, c->valid_sec, now);
 
+        if (rc == NGX_HTTP_CACHE_UPDATING && c->lock && c->lock_updating) {
+
+            /* wait for the entry to be updated and then reopen it */
+
+            ngx_pool_run_cleanup_file(r->pool, c->file.fd);
+
+            c->file.fd = NGX_INVALID_FILE;
+            c->buf = NULL;
+            c->memory = 0;
+            r->cached = 0;
+
+            return ngx_http_file_cache_wait(r, c);
+        }
+
         return rc;
     }
 
@@ -453,24 +975,234 @@ ngx_http_file_cache_read(ngx_http_request_t *r, ngx_http_cache_t *c)
 }
 
 
-static ssize_t
-ngx_http_file_cache_aio_read(ngx_http_request_t *r, ngx_http_cache_t *c)
+static ngx_int_t
+ngx_http_file_cache_reopen(ngx_http_request_t *r, ngx_http_cache_t *c)
 {
-#if (NGX_HAVE_FILE_AIO)
-    ssize_t                    n;
-    ngx_http_core_loc_conf_t  *clcf;
+    ngx_http_file_cache_t  *cache;
 
-    if (!ngx_file_aio) {
-        goto noaio;
-    }
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache reopen");
+
+    if (c->secondary) {
+        ngx_log_error(NGX_LOG_CRIT, r->connection->log, 0,
+                      "cache file \"%s\" has incorrect vary hash",
+                      c->file.name.data);
+        return NGX_DECLINED;
+    }
+
+    /*
+     * the response stored under the main key varies from the one
+     * requested, the other variants are stored under secondary keys
+     * made of the main key and the request headers listed in "Vary"
+     */
+
+    cache = c->file_cache;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    c->node->count--;
+    c->node = NULL;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_pool_run_cleanup_file(r->pool, c->file.fd);
+
+    c->file.fd = NGX_INVALID_FILE;
+    c->buf = NULL;
+    c->memory = 0;
+    c->secondary = 1;
+
+    ngx_memcpy(c->key, c->variant, NGX_HTTP_CACHE_KEY_LEN);
+
+    return ngx_http_file_cache_open(r);
+}
+
+
+static void
+ngx_http_file_cache_vary(ngx_http_request_t *r, u_char *vary, size_t len,
+    u_char *hash)
+{
+    u_char     *p, *last;
+    ngx_str_t   name;
+    ngx_md5_t   md5;
+    u_char      buf[NGX_HTTP_CACHE_VARY_LEN];
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache vary: \"%*s\"", len, vary);
+
+    ngx_md5_init(&md5);
+    ngx_md5_update(&md5, r->cache->main, NGX_HTTP_CACHE_KEY_LEN);
+
+    ngx_strlow(buf, vary, len);
+
+    p = buf;
+    last = buf + len;
+
+    while (p < last) {
+
+        while (p < last && (*p == ' ' || *p == ',')) {
+            p++;
+        }
+
+        name.data = p;
+
+        while (p < last && *p != ',' && *p != ' ') {
+            p++;
+        }
+
+        name.len = p - name.data;
+
+        if (name.len == 0) {
+            break;
+        }
+
+        ngx_md5_update(&md5, name.data, name.len);
+        ngx_md5_update(&md5, (u_char *) ":", sizeof(":") - 1);
+
+        ngx_http_file_cache_vary_header(r, &md5, &name);
+
+        ngx_md5_update(&md5, (u_char *) CRLF, sizeof(CRLF) - 1);
+    }
+
+    ngx_md5_final(hash, &md5);
+}
+
+
+static void
+ngx_http_file_cache_vary_header(ngx_http_request_t *r, ngx_md5_t *md5,
+    ngx_str_t *name)
+{
+    size_t            len;
+    u_char           *p, *start, *last;
+    ngx_uint_t        i, multiple, normalize;
+    ngx_list_part_t  *part;
+    ngx_table_elt_t  *header;
+
+    multiple = 0;
+    normalize = 0;
+
+    if (r->cache->gzip
+        && name->len == sizeof("accept-encoding") - 1
+        && ngx_strncmp(name->data, "accept-encoding", name->len) == 0)
+    {
+        /*
+         * the upstream is always asked for gzip, so the single stored
+         * representation serves every client, gunzip filter decodes it
+         * for the clients without gzip support
+         */
+
+        ngx_md5_update(md5, (u_char *) "gzip", sizeof("gzip") - 1);
+        return;
+    }
+
+    /* the spaces between the list elements do not make a new variant */
+
+    if ((name->len == sizeof("accept-charset") - 1
+         && ngx_strncmp(name->data, "accept-charset", name->len) == 0)
+        || (name->len == sizeof("accept-encoding") - 1
+            && ngx_strncmp(name->data, "accept-encoding", name->len) == 0)
+        || (name->len == sizeof("accept-language") - 1
+            && ngx_strncmp(name->data, "accept-language", name->len) == 0))
+    {
+        normalize = 1;
+    }
+
+    part = &r->headers_in.headers.part;
+    header = part->elts;
+
+    for (i = 0; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            header = part->elts;
+            i = 0;
+        }
+
+        if (header[i].key.len != name->len
+            || ngx_strncasecmp(header[i].key.data, name->data, name->len) != 0)
+        {
+            continue;
+        }
+
+        if (!normalize) {
+
+            if (multiple) {
+                ngx_md5_update(md5, (u_char *) ",", sizeof(",") - 1);
+            }
+
+            ngx_md5_update(md5, header[i].value.data, header[i].value.len);
+
+            multiple = 1;
+
+            continue;
+        }
+
+        p = header[i].value.data;
+        last = p + header[i].value.len;
+
+        while (p < last) {
+
+            while (p < last && (*p == ' ' || *p == ',')) {
+                p++;
+            }
+
+            start = p;
+
+            while (p < last && *p != ',' && *p != ' ') {
+                p++;
+            }
+
+            len = p - start;
+
+            if (len == 0) {
+                break;
+            }
+
+            if (multiple) {
+                ngx_md5_update(md5, (u_char *) ",", sizeof(",") - 1);
+            }
+
+            ngx_md5_update(md5, start, len);
+
+            multiple = 1;
+        }
+    }
+}
 
-    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
 
-    if (!clcf->aio) {
+static ssize_t
+ngx_http_file_cache_aio_read(ngx_http_request_t *r, ngx_http_cache_t *c)
+{
+#if (NGX_HAVE_FILE_AIO || NGX_THREAD_POOL)
+    ssize_t                    n;
+    ngx_http_core_loc_conf_t  *clcf;
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+#if (NGX_THREAD_POOL)
+
+    if (clcf->aio == NGX_HTTP_AIO_THREADS) {
+        c->file.thread_handler = ngx_http_cache_thread_handler;
+        c->file.thread_ctx = r;
+
+        return ngx_thread_read(&c->thread_task, &c->file, c->buf->pos,
+                               c->buf->end - c->buf->pos, 0, r->pool);
+    }
+
+#endif
+
+#if (NGX_HAVE_FILE_AIO)
+
+    if (!ngx_file_aio || clcf->aio == NGX_HTTP_AIO_OFF) {
         goto noaio;
     }
 
-    n = ngx_file_aio_read(&c->file, c->buf->pos, c->body_start, 0, r->pool);
+    n = ngx_file_aio_read(&c->file, c->buf->pos, c->buf->end - c->buf->pos,
+                          0, r->pool);
 
     if (n != NGX_AGAIN) {
         return n;
@@ -486,9 +1218,10 @@ ngx_http_file_cache_aio_read(ngx_http_request_t *r, ngx_http_cache_t *c)
 
 noaio:
 
+#endif
 #endif
 
-    return ngx_read_file(&c->file, c->buf->pos, c->body_start, 0);
+    return ngx_read_file(&c->file, c->buf->pos, c->buf->end - c->buf->pos, 0);
 }
 
 
@@ -498,6 +1231,7 @@ static void
 ngx_http_cache_aio_event_handler(ngx_event_t *ev)
 {
     ngx_event_aio_t     *aio;
+    ngx_connection_t    *c;
     ngx_http_request_t  *r;
 
     aio = ev->data;
@@ -506,7 +1240,58 @@ ngx_http_cache_aio_event_handler(ngx_event_t *ev)
     r->main->blocked--;
     r->aio = 0;
 
-    r->connection->write->handler(r->connection->write);
+    c = r->connection;
+
+    r->write_event_handler(r);
+
+    ngx_http_run_posted_requests(c);
+}
+
+#endif
+
+
+#if (NGX_THREAD_POOL)
+
+static ngx_int_t
+ngx_http_cache_thread_handler(ngx_thread_task_t *task, ngx_file_t *file)
+{
+    ngx_http_request_t        *r;
+    ngx_http_core_loc_conf_t  *clcf;
+
+    r = file->thread_ctx;
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    task->event.data = r;
+    task->event.handler = ngx_http_cache_thread_event_handler;
+
+    if (ngx_thread_task_post(clcf->thread_pool, task) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    r->main->blocked++;
+    r->aio = 1;
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_cache_thread_event_handler(ngx_event_t *ev)
+{
+    ngx_connection_t    *c;
+    ngx_http_request_t  *r;
+
+    r = ev->data;
+
+    r->main->blocked--;
+    r->aio = 0;
+
+    c = r->connection;
+
+    r->write_event_handler(r);
+
+    ngx_http_run_posted_requests(c);
 }
 
 #endif
@@ -516,17 +1301,49 @@ static ngx_int_t
 ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
 {
     ngx_int_t                    rc;
+    ngx_uint_t                   hit;
     ngx_http_file_cache_node_t  *fcn;
 
     ngx_shmtx_lock(&cache->shpool->mutex);
 
-    fcn = ngx_http_file_cache_lookup(cache, c->key);
+    hit = 0;
+    fcn = c->node;
+
+    if (fcn == NULL) {
+        fcn = ngx_http_file_cache_lookup(cache, c->key);
+
+        if (cache->policy == NGX_HTTP_CACHE_POLICY_TINYLFU
+            && cache->sh->sketch)
+        {
+            ngx_http_file_cache_sketch_add(cache, c->key);
+        }
+    }
 
     if (fcn) {
         ngx_queue_remove(&fcn->queue);
 
-        fcn->uses++;
-        fcn->count++;
+        if (c->node == NULL) {
+            fcn->uses++;
+            fcn->count++;
+
+            if (fcn->exists) {
+                cache->sh->hits++;
+                hit = 1;
+
+                if (fcn->tier && !fcn->promote && fcn->uses >= cache->promote
+                    && cache->sh->npromote < NGX_HTTP_CACHE_PROMOTE)
+                {
+                    /* the cache manager moves the file to the first tier */
+
+                    ngx_memcpy(cache->sh->promote[cache->sh->npromote++],
+                               c->key, NGX_HTTP_CACHE_KEY_LEN);
+                    fcn->promote = 1;
+                }
+
+            } else {
+                cache->sh->misses++;
+            }
+        }
 
         if (fcn->error) {
 
@@ -541,6 +1358,11 @@ ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
 
         if (fcn->exists || fcn->uses >= c->min_uses) {
 
+            if (!fcn->exists && !ngx_http_file_cache_admit(cache, c->key)) {
+                rc = NGX_AGAIN;
+                goto done;
+            }
+
             c->exists = fcn->exists;
             if (fcn->body_start) {
                 c->body_start = fcn->body_start;
@@ -556,6 +1378,8 @@ ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
         goto done;
     }
 
+    cache->sh->misses++;
+
     fcn = ngx_slab_alloc_locked(cache->shpool,
                                 sizeof(ngx_http_file_cache_node_t));
     if (fcn == NULL) {
@@ -584,10 +1408,20 @@ ngx_http_file_cache_exists(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
     fcn->count = 1;
     fcn->updating = 0;
     fcn->deleting = 0;
+    fcn->hot = 0;
+    fcn->tier = 0;
+    fcn->promote = 0;
+    fcn->moving = 0;
+    fcn->vary = 0;
 
 renew:
 
-    rc = NGX_DECLINED;
+    rc = ngx_http_file_cache_admit(cache, c->key) ? NGX_DECLINED : NGX_AGAIN;
+
+    if (fcn->hot) {
+        cache->sh->protected_size -= fcn->fs_size;
+        fcn->hot = 0;
+    }
 
     fcn->valid_msec = 0;
     fcn->error = 0;
@@ -601,10 +1435,11 @@ done:
 
     fcn->expire = ngx_time() + cache->inactive;
 
-    ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
+    ngx_http_file_cache_access(cache, fcn, hit);
 
     c->uniq = fcn->uniq;
     c->error = fcn->error;
+    c->tier = fcn->tier;
     c->node = fcn;
 
 failed:
@@ -734,700 +1569,2944 @@ ngx_http_file_cache_rbtree_insert_value(ngx_rbtree_node_t *temp,
 }
 
 
-void
-ngx_http_file_cache_set_header(ngx_http_request_t *r, u_char *buf)
+static ngx_int_t
+ngx_http_file_cache_sketch_init(ngx_http_file_cache_t *cache,
+    ngx_shm_zone_t *shm_zone)
 {
-    ngx_http_file_cache_header_t  *h = (ngx_http_file_cache_header_t *) buf;
+    size_t      size;
+    ngx_uint_t  n, width;
 
-    u_char            *p;
-    ngx_str_t         *key;
-    ngx_uint_t         i;
-    ngx_http_cache_t  *c;
+    /* a counter per node that fits in the zone, rounded down to 2^n */
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http file cache set header");
+    n = shm_zone->shm.size / sizeof(ngx_http_file_cache_node_t);
 
-    c = r->cache;
+    for (width = 64; width * 2 <= n; width *= 2) { /* void */ }
 
-    h->valid_sec = c->valid_sec;
-    h->last_modified = c->last_modified;
-    h->date = c->date;
-    h->crc32 = c->crc32;
-    h->valid_msec = (u_short) c->valid_msec;
-    h->header_start = (u_short) c->header_start;
-    h->body_start = (u_short) c->body_start;
+    size = NGX_HTTP_FILE_CACHE_SKETCH_DEPTH * width;
 
-    p = buf + sizeof(ngx_http_file_cache_header_t);
+    ngx_shmtx_lock(&cache->shpool->mutex);
 
-    p = ngx_cpymem(p, ngx_http_file_cache_key, sizeof(ngx_http_file_cache_key));
+    cache->sh->sketch = ngx_slab_alloc_locked(cache->shpool, size);
 
-    key = c->keys.elts;
-    for (i = 0; i < c->keys.nelts; i++) {
-        p = ngx_copy(p, key[i].data, key[i].len);
+    if (cache->sh->sketch == NULL) {
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+        return NGX_ERROR;
     }
 
-    *p = LF;
+    ngx_memzero(cache->sh->sketch, size);
+
+    cache->sh->sketch_mask = width - 1;
+    cache->sh->sketch_samples = 0;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    return NGX_OK;
 }
 
 
-void
-ngx_http_file_cache_update(ngx_http_request_t *r, ngx_temp_file_t *tf)
+static void
+ngx_http_file_cache_sketch_add(ngx_http_file_cache_t *cache, u_char *key)
 {
-    off_t                   fs_size;
-    ngx_int_t               rc;
-    ngx_file_uniq_t         uniq;
-    ngx_file_info_t         fi;
-    ngx_http_cache_t        *c;
-    ngx_ext_rename_file_t   ext;
-    ngx_http_file_cache_t  *cache;
+    u_char      *p;
+    uint32_t     hash;
+    ngx_uint_t   i, width;
 
-    c = r->cache;
+    /*
+     * a count-min sketch of access frequencies, each row is indexed
+     * by its own 32 bits of the md5 key; the counters are halved
+     * once there were 10 times more samples than counters in a row,
+     * so that the frequencies of the past accesses are aged out
+     */
 
-    if (c->updated) {
-        return;
-    }
+    width = cache->sh->sketch_mask + 1;
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http file cache update");
+    for (i = 0; i < NGX_HTTP_FILE_CACHE_SKETCH_DEPTH; i++) {
+        ngx_memcpy(&hash, &key[i * sizeof(uint32_t)], sizeof(uint32_t));
 
-    c->updated = 1;
-    c->updating = 0;
+        p = &cache->sh->sketch[i * width + (hash & cache->sh->sketch_mask)];
 
-    cache = c->file_cache;
+        if (*p < NGX_HTTP_FILE_CACHE_SKETCH_MAX) {
+            (*p)++;
+        }
+    }
 
-    uniq = 0;
-    fs_size = 0;
+    if (++cache->sh->sketch_samples < 10 * width) {
+        return;
+    }
 
-    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http file cache rename: \"%s\" to \"%s\"",
-                   tf->file.name.data, c->file.name.data);
+    p = cache->sh->sketch;
 
-    ext.access = NGX_FILE_OWNER_ACCESS;
-    ext.path_access = NGX_FILE_OWNER_ACCESS;
-    ext.time = -1;
-    ext.create_path = 1;
-    ext.delete_file = 1;
-    ext.log = r->connection->log;
+    for (i = 0; i < NGX_HTTP_FILE_CACHE_SKETCH_DEPTH * width; i++) {
+        p[i] >>= 1;
+    }
 
-    rc = ngx_ext_rename_file(&tf->file.name, &c->file.name, &ext);
+    cache->sh->sketch_samples /= 2;
+}
 
-    if (rc == NGX_OK) {
 
-        if (ngx_fd_info(tf->file.fd, &fi) == NGX_FILE_ERROR) {
-            ngx_log_error(NGX_LOG_CRIT, r->connection->log, ngx_errno,
-                          ngx_fd_info_n " \"%s\" failed", tf->file.name.data);
+static ngx_uint_t
+ngx_http_file_cache_sketch_estimate(ngx_http_file_cache_t *cache, u_char *key)
+{
+    u_char      *p;
+    uint32_t     hash;
+    ngx_uint_t   i, width, min;
 
-            rc = NGX_ERROR;
+    width = cache->sh->sketch_mask + 1;
+    min = NGX_HTTP_FILE_CACHE_SKETCH_MAX;
 
-        } else {
-            uniq = ngx_file_uniq(&fi);
-            fs_size = (ngx_file_fs_size(&fi) + cache->bsize - 1) / cache->bsize;
+    for (i = 0; i < NGX_HTTP_FILE_CACHE_SKETCH_DEPTH; i++) {
+        ngx_memcpy(&hash, &key[i * sizeof(uint32_t)], sizeof(uint32_t));
+
+        p = &cache->sh->sketch[i * width + (hash & cache->sh->sketch_mask)];
+
+        if (*p < min) {
+            min = *p;
         }
     }
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    return min;
+}
 
-    c->node->count--;
-    c->node->uniq = uniq;
-    c->node->body_start = c->body_start;
 
-    cache->sh->size += fs_size - c->node->fs_size;
-    c->node->fs_size = fs_size;
+static ngx_uint_t
+ngx_http_file_cache_admit(ngx_http_file_cache_t *cache, u_char *key)
+{
+    u_char                       victim[NGX_HTTP_CACHE_KEY_LEN];
+    ngx_queue_t                 *q;
+    ngx_http_file_cache_node_t  *fcn;
 
-    if (rc == NGX_OK) {
-        c->node->exists = 1;
-    }
+    /*
+     * TinyLFU admission: when the cache is close to its max_size,
+     * a new response is stored only if it was requested more often
+     * than the entry which is going to be evicted for it
+     */
 
-    c->node->updating = 0;
+    if (cache->policy != NGX_HTTP_CACHE_POLICY_TINYLFU
+        || cache->sh->sketch == NULL
+        || cache->sh->cold
+        || cache->sh->size < cache->max_size - cache->max_size / 16)
+    {
+        cache->sh->admitted++;
+        return 1;
+    }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
-}
+    if (!ngx_queue_empty(&cache->sh->queue)) {
+        q = ngx_queue_last(&cache->sh->queue);
 
+    } else if (!ngx_queue_empty(&cache->sh->protected)) {
+        q = ngx_queue_last(&cache->sh->protected);
 
-ngx_int_t
-ngx_http_cache_send(ngx_http_request_t *r)
-{
-    ngx_int_t          rc;
-    ngx_buf_t         *b;
-    ngx_chain_t        out;
-    ngx_http_cache_t  *c;
+    } else {
+        cache->sh->admitted++;
+        return 1;
+    }
 
-    c = r->cache;
+    fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
 
-    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
-                   "http file cache send: %s", c->file.name.data);
+    ngx_memcpy(victim, &fcn->node.key, sizeof(ngx_rbtree_key_t));
+    ngx_memcpy(&victim[sizeof(ngx_rbtree_key_t)], fcn->key,
+               NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
 
-    if (r != r->main && c->length - c->body_start == 0) {
-        return ngx_http_send_header(r);
+    if (ngx_http_file_cache_sketch_estimate(cache, key)
+        > ngx_http_file_cache_sketch_estimate(cache, victim))
+    {
+        cache->sh->admitted++;
+        return 1;
     }
 
-    /* we need to allocate all before the header would be sent */
+    cache->sh->rejected++;
+    return 0;
+}
 
-    b = ngx_pcalloc(r->pool, sizeof(ngx_buf_t));
-    if (b == NULL) {
-        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+
+static void
+ngx_http_file_cache_access(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, ngx_uint_t hit)
+{
+    off_t                        limit;
+    ngx_queue_t                 *q;
+    ngx_http_file_cache_node_t  *last;
+
+    /*
+     * segmented LRU: entries hit while in the probationary queue
+     * are promoted to the protected one, which is limited to 80%
+     * of max_size, its least recently used entries are moved back
+     */
+
+    if (hit && !fcn->hot && cache->policy == NGX_HTTP_CACHE_POLICY_TINYLFU) {
+        fcn->hot = 1;
+        cache->sh->protected_size += fcn->fs_size;
     }
 
-    b->file = ngx_pcalloc(r->pool, sizeof(ngx_file_t));
-    if (b->file == NULL) {
-        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+    if (!fcn->hot) {
+        ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
+        return;
     }
 
-    rc = ngx_http_send_header(r);
+    ngx_queue_insert_head(&cache->sh->protected, &fcn->queue);
 
-    if (rc == NGX_ERROR || rc > NGX_OK || r->header_only) {
-        return rc;
-    }
+    limit = cache->max_size / 5 * 4;
 
-    b->file_pos = c->body_start;
-    b->file_last = c->length;
+    while (cache->sh->protected_size > limit
+           && !ngx_queue_empty(&cache->sh->protected))
+    {
 
-    b->in_file = (c->length - c->body_start) ? 1: 0;
-    b->last_buf = (r == r->main) ? 1: 0;
-    b->last_in_chain = 1;
+        q = ngx_queue_last(&cache->sh->protected);
+        last = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
 
-    b->file->fd = c->file.fd;
-    b->file->name = c->file.name;
-    b->file->log = r->connection->log;
+        ngx_queue_remove(q);
 
-    out.buf = b;
-    out.next = NULL;
+        if (last->hot) {
+            cache->sh->protected_size -= last->fs_size;
+            last->hot = 0;
+        }
 
-    return ngx_http_output_filter(r, &out);
+        ngx_queue_insert_head(&cache->sh->queue, q);
+    }
 }
 
 
-void
-ngx_http_file_cache_free(ngx_http_cache_t *c, ngx_temp_file_t *tf)
+static ngx_int_t
+ngx_http_file_cache_memory_open(ngx_http_request_t *r, ngx_http_cache_t *c)
 {
-    ngx_http_file_cache_t       *cache;
-    ngx_http_file_cache_node_t  *fcn;
-
-    if (c->updated || c->node == NULL) {
-        return;
-    }
+    ngx_http_file_cache_t           *cache;
+    ngx_http_file_cache_mem_node_t  *mn;
 
     cache = c->file_cache;
 
-    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
-                   "http file cache free, fd: %d", c->file.fd);
-
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    ngx_shmtx_lock(&cache->mpool->mutex);
 
-    fcn = c->node;
-    fcn->count--;
+    mn = ngx_http_file_cache_memory_lookup(cache, c->key);
 
-    if (c->updating) {
-        fcn->updating = 0;
+    if (mn == NULL) {
+        ngx_shmtx_unlock(&cache->mpool->mutex);
+        return NGX_DECLINED;
     }
 
-    if (c->error) {
-        fcn->error = c->error;
+    if (mn->uniq != c->uniq) {
 
-        if (c->valid_sec) {
-            fcn->valid_sec = c->valid_sec;
-            fcn->valid_msec = c->valid_msec;
-        }
+        /* the cache file has been replaced */
 
-    } else if (!fcn->exists && fcn->count == 0 && c->min_uses == 1) {
-        ngx_queue_remove(&fcn->queue);
-        ngx_rbtree_delete(&cache->sh->rbtree, &fcn->node);
-        ngx_slab_free_locked(cache->shpool, fcn);
-        c->node = NULL;
+        ngx_http_file_cache_memory_free(cache, mn);
+        ngx_shmtx_unlock(&cache->mpool->mutex);
+        return NGX_DECLINED;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    c->buf = ngx_create_temp_buf(r->pool, mn->len);
+    if (c->buf == NULL) {
+        ngx_shmtx_unlock(&cache->mpool->mutex);
+        return NGX_ERROR;
+    }
 
-    c->updated = 1;
-    c->updating = 0;
+    ngx_memcpy(c->buf->pos, mn->data, mn->len);
 
-    if (c->temp_file) {
-        if (tf && tf->file.fd != NGX_INVALID_FILE) {
-            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
-                           "http file cache incomplete: \"%s\"",
-                           tf->file.name.data);
+    ngx_queue_remove(&mn->queue);
+    ngx_queue_insert_head(&cache->mem->queue, &mn->queue);
 
-            if (ngx_delete_file(tf->file.name.data) == NGX_FILE_ERROR) {
-                ngx_log_error(NGX_LOG_CRIT, c->file.log, ngx_errno,
-                              ngx_delete_file_n " \"%s\" failed",
-                              tf->file.name.data);
-            }
-        }
-    }
+    ngx_shmtx_unlock(&cache->mpool->mutex);
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache memory: %uz", mn->len);
+
+    c->length = c->buf->end - c->buf->pos;
+    c->memory = 1;
+
+    return NGX_OK;
 }
 
 
 static void
-ngx_http_file_cache_cleanup(void *data)
+ngx_http_file_cache_memory_store(ngx_http_file_cache_t *cache,
+    ngx_http_cache_t *c)
 {
-    ngx_http_cache_t  *c = data;
+    size_t                           len;
+    ngx_uint_t                       current;
+    ngx_queue_t                     *q;
+    ngx_http_file_cache_mem_node_t  *mn;
 
-    if (c->updated) {
-        return;
-    }
+    ngx_shmtx_lock(&cache->shpool->mutex);
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
-                   "http file cache cleanup");
+    /* entries added by the cache loader have no uniq yet */
 
-    if (c->updating) {
-        ngx_log_error(NGX_LOG_ALERT, c->file.log, 0,
-                      "stalled cache updating, error:%ui", c->error);
+    if (c->node->exists && c->node->uniq == 0) {
+        c->node->uniq = c->uniq;
     }
 
-    ngx_http_file_cache_free(c, NULL);
-}
-
+    current = (c->node->uniq == c->uniq);
 
-static time_t
-ngx_http_file_cache_forced_expire(ngx_http_file_cache_t *cache)
-{
-    u_char                      *name;
-    size_t                       len;
-    time_t                       wait;
-    ngx_uint_t                   tries;
-    ngx_path_t                  *path;
-    ngx_queue_t                 *q;
-    ngx_http_file_cache_node_t  *fcn;
+    ngx_shmtx_unlock(&cache->shpool->mutex);
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                   "http file cache forced expire");
+    if (!current) {
+        return;
+    }
 
-    path = cache->path;
-    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+    len = offsetof(ngx_http_file_cache_mem_node_t, data)
+          + (c->buf->last - c->buf->pos);
 
-    name = ngx_alloc(len + 1, ngx_cycle->log);
-    if (name == NULL) {
-        return 10;
+    if (len > (size_t) (cache->mpool->end - cache->mpool->start) / 2) {
+        return;
     }
 
-    ngx_memcpy(name, path->name.data, path->name.len);
+    ngx_shmtx_lock(&cache->mpool->mutex);
 
-    wait = 10;
-    tries = 20;
+    mn = ngx_http_file_cache_memory_lookup(cache, c->key);
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+    if (mn) {
+        if (mn->uniq == c->uniq) {
+            ngx_shmtx_unlock(&cache->mpool->mutex);
+            return;
+        }
 
-    for (q = ngx_queue_last(&cache->sh->queue);
-         q != ngx_queue_sentinel(&cache->sh->queue);
-         q = ngx_queue_prev(q))
-    {
-        fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+        ngx_http_file_cache_memory_free(cache, mn);
+    }
 
-        ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                  "http file cache forced expire: #%d %d %02xd%02xd%02xd%02xd",
-                  fcn->count, fcn->exists,
-                  fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+    /* least recently used entries are evicted until the new one fits */
 
-        if (fcn->count == 0) {
-            ngx_http_file_cache_delete(cache, q, name);
-            wait = 0;
+    for ( ;; ) {
+        mn = ngx_slab_alloc_locked(cache->mpool, len);
 
-        } else {
-            if (--tries) {
-                continue;
-            }
+        if (mn) {
+            break;
+        }
 
-            wait = 1;
+        if (ngx_queue_empty(&cache->mem->queue)) {
+            ngx_shmtx_unlock(&cache->mpool->mutex);
+            return;
         }
 
-        break;
+        q = ngx_queue_last(&cache->mem->queue);
+
+        ngx_http_file_cache_memory_free(cache,
+                     ngx_queue_data(q, ngx_http_file_cache_mem_node_t, queue));
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    ngx_memcpy((u_char *) &mn->node.key, c->key, sizeof(ngx_rbtree_key_t));
 
-    ngx_free(name);
+    ngx_memcpy(mn->key, &c->key[sizeof(ngx_rbtree_key_t)],
+               NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
 
-    return wait;
+    mn->uniq = c->uniq;
+    mn->len = c->buf->last - c->buf->pos;
+
+    ngx_memcpy(mn->data, c->buf->pos, mn->len);
+
+    ngx_rbtree_insert(&cache->mem->rbtree, &mn->node);
+    ngx_queue_insert_head(&cache->mem->queue, &mn->queue);
+
+    ngx_shmtx_unlock(&cache->mpool->mutex);
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
+                   "http file cache memory store: %uz", mn->len);
 }
 
 
-static time_t
-ngx_http_file_cache_expire(ngx_http_file_cache_t *cache)
+static void
+ngx_http_file_cache_memory_update(ngx_http_file_cache_t *cache,
+    ngx_http_cache_t *c, ngx_http_file_cache_header_t *h)
 {
-    u_char                      *name, *p;
-    size_t                       len;
-    time_t                       now, wait;
-    ngx_path_t                  *path;
-    ngx_queue_t                 *q;
-    ngx_http_file_cache_node_t  *fcn;
-    u_char                       key[2 * NGX_HTTP_CACHE_KEY_LEN];
+    ngx_http_file_cache_mem_node_t  *mn;
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                   "http file cache expire");
+    ngx_shmtx_lock(&cache->mpool->mutex);
 
-    path = cache->path;
-    len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+    mn = ngx_http_file_cache_memory_lookup(cache, c->key);
 
-    name = ngx_alloc(len + 1, ngx_cycle->log);
-    if (name == NULL) {
-        return 10;
+    if (mn) {
+        if (mn->uniq == c->uniq
+            && mn->len >= sizeof(ngx_http_file_cache_header_t))
+        {
+            ngx_memcpy(mn->data, h, sizeof(ngx_http_file_cache_header_t));
+
+        } else {
+            ngx_http_file_cache_memory_free(cache, mn);
+        }
     }
 
-    ngx_memcpy(name, path->name.data, path->name.len);
+    ngx_shmtx_unlock(&cache->mpool->mutex);
+}
 
-    now = ngx_time();
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+static void
+ngx_http_file_cache_memory_delete(ngx_http_file_cache_t *cache, u_char *key)
+{
+    ngx_http_file_cache_mem_node_t  *mn;
 
-    for ( ;; ) {
+    ngx_shmtx_lock(&cache->mpool->mutex);
 
-        if (ngx_queue_empty(&cache->sh->queue)) {
-            wait = 10;
-            break;
-        }
+    mn = ngx_http_file_cache_memory_lookup(cache, key);
 
-        q = ngx_queue_last(&cache->sh->queue);
+    if (mn) {
+        ngx_http_file_cache_memory_free(cache, mn);
+    }
 
-        fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+    ngx_shmtx_unlock(&cache->mpool->mutex);
+}
 
-        wait = fcn->expire - now;
 
-        if (wait > 0) {
-            wait = wait > 10 ? 10 : wait;
-            break;
-        }
+static ngx_http_file_cache_mem_node_t *
+ngx_http_file_cache_memory_lookup(ngx_http_file_cache_t *cache, u_char *key)
+{
+    ngx_int_t                        rc;
+    ngx_rbtree_key_t                 node_key;
+    ngx_rbtree_node_t               *node, *sentinel;
+    ngx_http_file_cache_mem_node_t  *mn;
 
-        ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                       "http file cache expire: #%d %d %02xd%02xd%02xd%02xd",
-                       fcn->count, fcn->exists,
-                       fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+    ngx_memcpy((u_char *) &node_key, key, sizeof(ngx_rbtree_key_t));
 
-        if (fcn->count == 0) {
-            ngx_http_file_cache_delete(cache, q, name);
+    node = cache->mem->rbtree.root;
+    sentinel = cache->mem->rbtree.sentinel;
+
+    while (node != sentinel) {
+
+        if (node_key < node->key) {
+            node = node->left;
             continue;
         }
 
-        if (fcn->deleting) {
-            wait = 1;
-            break;
+        if (node_key > node->key) {
+            node = node->right;
+            continue;
         }
 
-        p = ngx_hex_dump(key, (u_char *) &fcn->node.key,
-                         sizeof(ngx_rbtree_key_t));
-        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
-        (void) ngx_hex_dump(p, fcn->key, len);
+        /* node_key == node->key */
 
-        /*
-         * abnormally exited workers may leave locked cache entries,
-         * and although it may be safe to remove them completely,
-         * we prefer to just move them to the top of the inactive queue
-         */
+        mn = (ngx_http_file_cache_mem_node_t *) node;
 
-        ngx_queue_remove(q);
-        fcn->expire = ngx_time() + cache->inactive;
-        ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
+        rc = ngx_memcmp(&key[sizeof(ngx_rbtree_key_t)], mn->key,
+                        NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
 
-        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, 0,
-                      "ignore long locked inactive cache entry %*s, count:%d",
-                      2 * NGX_HTTP_CACHE_KEY_LEN, key, fcn->count);
+        if (rc == 0) {
+            return mn;
+        }
+
+        node = (rc < 0) ? node->left : node->right;
     }
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+    /* not found */
 
-    ngx_free(name);
+    return NULL;
+}
+
+
+static void
+ngx_http_file_cache_memory_free(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_mem_node_t *mn)
+{
+    ngx_queue_remove(&mn->queue);
+    ngx_rbtree_delete(&cache->mem->rbtree, &mn->node);
+    ngx_slab_free_locked(cache->mpool, mn);
+}
+
+
+static void
+ngx_http_file_cache_memory_insert_value(ngx_rbtree_node_t *temp,
+    ngx_rbtree_node_t *node, ngx_rbtree_node_t *sentinel)
+{
+    ngx_rbtree_node_t               **p;
+    ngx_http_file_cache_mem_node_t   *mn, *mnt;
+
+    for ( ;; ) {
+
+        if (node->key < temp->key) {
+
+            p = &temp->left;
+
+        } else if (node->key > temp->key) {
+
+            p = &temp->right;
+
+        } else { /* node->key == temp->key */
+
+            mn = (ngx_http_file_cache_mem_node_t *) node;
+            mnt = (ngx_http_file_cache_mem_node_t *) temp;
+
+            p = (ngx_memcmp(mn->key, mnt->key,
+                            NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t))
+                 < 0)
+                    ? &temp->left : &temp->right;
+        }
+
+        if (*p == sentinel) {
+            break;
+        }
+
+        temp = *p;
+    }
+
+    *p = node;
+    node->parent = temp;
+    node->left = sentinel;
+    node->right = sentinel;
+    ngx_rbt_red(node);
+}
+
+
+ngx_int_t
+ngx_http_file_cache_purge(ngx_http_request_t *r)
+{
+    u_char                      *p, *last, *name;
+    size_t                       len;
+    ngx_int_t                    rc;
+    ngx_str_t                   *key, text;
+    ngx_uint_t                   i, cold, vary;
+    ngx_list_part_t             *part;
+    ngx_table_elt_t             *header;
+    ngx_http_cache_t            *c;
+    ngx_http_file_cache_t       *cache;
+    ngx_http_file_cache_node_t  *fcn;
+
+    c = r->cache;
+    cache = c->file_cache;
+
+    /* the "Cache-Tag" request header purges the entries by tags */
+
+    part = &r->headers_in.headers.part;
+    header = part->elts;
+
+    for (i = 0; /* void */ ; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            header = part->elts;
+            i = 0;
+        }
+
+        if (header[i].key.len != sizeof(ngx_http_file_cache_tag) - 2
+            || ngx_strncasecmp(header[i].key.data, ngx_http_file_cache_tag,
+                               sizeof(ngx_http_file_cache_tag) - 2)
+               != 0)
+        {
+            continue;
+        }
+
+        p = header[i].value.data;
+        last = p + header[i].value.len;
+
+        while (p < last) {
+
+            if (*p == ' ' || *p == ',' || *p == '\t') {
+                p++;
+                continue;
+            }
+
+            for (len = 0; p + len < last; len++) {
+                if (p[len] == ' ' || p[len] == ',' || p[len] == '\t') {
+                    break;
+                }
+            }
+
+            ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "http file cache purge tag: \"%*s\"", len, p);
+
+            rc = ngx_http_file_cache_ban(cache, NGX_HTTP_FILE_CACHE_BAN_TAG,
+                                         p, len);
+
+            if (rc != NGX_OK) {
+                return rc;
+            }
+
+            p += len;
+        }
+
+        return NGX_OK;
+    }
+
+    len = 0;
+    key = c->keys.elts;
+
+    for (i = 0; i < c->keys.nelts; i++) {
+        len += key[i].len;
+    }
+
+    text.len = len;
+    text.data = ngx_pnalloc(r->pool, len);
+    if (text.data == NULL) {
+        return NGX_ERROR;
+    }
+
+    p = text.data;
+
+    for (i = 0; i < c->keys.nelts; i++) {
+        p = ngx_cpymem(p, key[i].data, key[i].len);
+    }
+
+    /* the key ending with "*" purges the entries by prefix */
+
+    if (len && text.data[len - 1] == '*') {
+
+        ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                       "http file cache purge prefix: \"%*s\"",
+                       len - 1, text.data);
+
+        return ngx_http_file_cache_ban(cache, NGX_HTTP_FILE_CACHE_BAN_PREFIX,
+                                       text.data, len - 1);
+    }
+
+    name = ngx_pnalloc(r->pool, cache->name_len + 1 + cache->path->len
+                                + 2 * NGX_HTTP_CACHE_KEY_LEN + 1);
+    if (name == NULL) {
+        return NGX_ERROR;
+    }
+
+    rc = NGX_DECLINED;
+    vary = 0;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    fcn = ngx_http_file_cache_lookup(cache, c->key);
+
+    if (fcn && (fcn->exists || fcn->error) && !fcn->deleting) {
+        vary = fcn->vary;
+
+        ngx_http_file_cache_purge_node(cache, fcn, name);
+        cache->sh->purged++;
+        rc = NGX_OK;
+    }
+
+    cold = cache->sh->cold;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    if (vary) {
+
+        /* the variants are stored under the keys not known here */
+
+        if (ngx_http_file_cache_ban(cache, NGX_HTTP_FILE_CACHE_BAN_KEY,
+                                    text.data, text.len)
+            == NGX_ERROR)
+        {
+            return NGX_ERROR;
+        }
+    }
+
+    if (rc == NGX_OK || !cold) {
+        return rc;
+    }
+
+    /* the loader may have not seen the file yet */
+
+    for (i = 0; i < cache->ntiers; i++) {
+
+        if (ngx_http_file_cache_name(r, cache->tiers[i].path) != NGX_OK) {
+            return NGX_ERROR;
+        }
+
+        if (ngx_delete_file(c->file.name.data) != NGX_FILE_ERROR) {
+            rc = NGX_OK;
+        }
+    }
+
+    return rc;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_ban(ngx_http_file_cache_t *cache, ngx_uint_t type,
+    u_char *data, size_t len)
+{
+    ngx_queue_t                *q;
+    ngx_http_file_cache_ban_t  *ban;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    for (q = ngx_queue_head(&cache->sh->bans);
+         q != ngx_queue_sentinel(&cache->sh->bans);
+         q = ngx_queue_next(q))
+    {
+        ban = ngx_queue_data(q, ngx_http_file_cache_ban_t, queue);
+
+        if (ban->type == type && ban->len == len
+            && ngx_strncmp(ban->data, data, len) == 0)
+        {
+            ban->time = ngx_time();
+            ngx_shmtx_unlock(&cache->shpool->mutex);
+            return NGX_OK;
+        }
+    }
+
+    if (cache->sh->nbans >= NGX_HTTP_CACHE_BANS) {
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+        ngx_log_error(NGX_LOG_WARN, ngx_cycle->log, 0,
+                      "too many pending purges in cache \"%V\"",
+                      &cache->shm_zone->shm.name);
+
+        return NGX_BUSY;
+    }
+
+    ban = ngx_slab_alloc_locked(cache->shpool,
+                                offsetof(ngx_http_file_cache_ban_t, data)
+                                + len);
+    if (ban == NULL) {
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+        return NGX_ERROR;
+    }
+
+    ban->time = ngx_time();
+    ban->type = type;
+    ban->len = len;
+    ngx_memcpy(ban->data, data, len);
+
+    ngx_queue_insert_tail(&cache->sh->bans, &ban->queue);
+    cache->sh->nbans++;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    return NGX_OK;
+}
+
+
+static ngx_uint_t
+ngx_http_file_cache_banned(ngx_http_file_cache_t *cache, u_char *start,
+    size_t size)
+{
+    u_char                        *p, *last, *end;
+    ngx_str_t                      key, tags;
+    ngx_queue_t                   *q;
+    ngx_http_file_cache_ban_t     *ban;
+    ngx_http_file_cache_header_t  *h;
+
+    h = (ngx_http_file_cache_header_t *) start;
+    last = start + size;
+
+    key.data = start + sizeof(ngx_http_file_cache_header_t)
+               + sizeof(ngx_http_file_cache_key);
+
+    if (key.data >= last) {
+        return 0;
+    }
+
+    p = ngx_strlchr(key.data, last, LF);
+    if (p == NULL) {
+        return 0;
+    }
+
+    key.len = p - key.data;
+
+    tags.len = 0;
+    tags.data = NULL;
+
+    for (q = ngx_queue_head(&cache->sh->bans);
+         q != ngx_queue_sentinel(&cache->sh->bans);
+         q = ngx_queue_next(q))
+    {
+        ban = ngx_queue_data(q, ngx_http_file_cache_ban_t, queue);
+
+        /* the seconds are compared, so a same second entry is purged too */
+
+        if (ban->time < h->date) {
+            continue;
+        }
+
+        if (ban->type == NGX_HTTP_FILE_CACHE_BAN_PREFIX) {
+            if (key.len >= ban->len
+                && ngx_memcmp(key.data, ban->data, ban->len) == 0)
+            {
+                return 1;
+            }
+
+            continue;
+        }
+
+        if (ban->type == NGX_HTTP_FILE_CACHE_BAN_KEY) {
+            if (key.len == ban->len
+                && ngx_memcmp(key.data, ban->data, ban->len) == 0)
+            {
+                return 1;
+            }
+
+            continue;
+        }
+
+        if (tags.data == NULL) {
+
+            /* the "Cache-Tag" header of the cached response */
+
+            tags.data = last;
+
+            p = start + h->header_start;
+            end = start + ngx_min(h->body_start, size);
+
+            while (p < end) {
+
+                if ((size_t) (end - p) > sizeof(ngx_http_file_cache_tag) - 1
+                    && ngx_strncasecmp(p, ngx_http_file_cache_tag,
+                                       sizeof(ngx_http_file_cache_tag) - 1)
+                       == 0)
+                {
+                    tags.data = p + sizeof(ngx_http_file_cache_tag) - 1;
+
+                    p = ngx_strlchr(tags.data, end, LF);
+                    if (p == NULL) {
+                        p = end;
+                    }
+
+                    tags.len = p - tags.data;
+                    break;
+                }
+
+                p = ngx_strlchr(p, end, LF);
+                if (p == NULL) {
+                    break;
+                }
+
+                p++;
+            }
+        }
+
+        if (ngx_http_file_cache_tagged(&tags, ban->data, ban->len)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static ngx_uint_t
+ngx_http_file_cache_tagged(ngx_str_t *tags, u_char *tag, size_t len)
+{
+    u_char  *p, *last, *start;
+
+    p = tags->data;
+    last = p + tags->len;
+
+    while (p < last) {
+
+        if (*p == ' ' || *p == ',' || *p == '\t' || *p == CR) {
+            p++;
+            continue;
+        }
+
+        start = p;
+
+        while (p < last && *p != ' ' && *p != ',' && *p != '\t' && *p != CR) {
+            p++;
+        }
+
+        if ((size_t) (p - start) == len && ngx_memcmp(start, tag, len) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+static void
+ngx_http_file_cache_purge_node(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, u_char *name)
+{
+    ngx_err_t  err;
+    u_char     key[NGX_HTTP_CACHE_KEY_LEN];
+
+    if (fcn->count == 0) {
+        ngx_http_file_cache_delete(cache, &fcn->queue, name);
+        return;
+    }
+
+    /*
+     * the entry is in use, so it is only reset to be fetched again
+     * by the next request, while the current ones keep the file open
+     */
+
+    fcn->error = 0;
+    fcn->valid_sec = 0;
+
+    if (!fcn->exists) {
+        return;
+    }
+
+    cache->sh->size -= fcn->fs_size;
+    cache->sh->tier_size[fcn->tier] -= fcn->fs_size;
+
+    if (fcn->hot) {
+        cache->sh->protected_size -= fcn->fs_size;
+        fcn->hot = 0;
+    }
+
+    ngx_http_file_cache_node_name(cache, fcn, fcn->tier, name);
+
+    if (cache->mem) {
+        ngx_memcpy(key, &fcn->node.key, sizeof(ngx_rbtree_key_t));
+        ngx_memcpy(&key[sizeof(ngx_rbtree_key_t)], fcn->key,
+                   NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+        ngx_http_file_cache_memory_delete(cache, key);
+    }
+
+    fcn->exists = 0;
+    fcn->uniq = 0;
+    fcn->fs_size = 0;
+    fcn->body_start = 0;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache purge: \"%s\"", name);
+
+    if (ngx_delete_file(name) == NGX_FILE_ERROR) {
+        err = ngx_errno;
+
+        if (err != NGX_ENOENT) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                          ngx_delete_file_n " \"%s\" failed", name);
+        }
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+}
+
+
+ngx_int_t
+ngx_http_file_cache_set_header(ngx_http_request_t *r, u_char *buf)
+{
+    ngx_http_file_cache_header_t  *h = (ngx_http_file_cache_header_t *) buf;
+
+    u_char            *p;
+    ngx_str_t         *key;
+    ngx_uint_t         i;
+    ngx_http_cache_t  *c;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache set header");
+
+    c = r->cache;
+
+    h->version = NGX_HTTP_CACHE_VERSION;
+    h->valid_sec = c->valid_sec;
+    h->last_modified = c->last_modified;
+    h->date = c->date;
+    h->crc32 = c->crc32;
+    h->valid_msec = (u_short) c->valid_msec;
+    h->header_start = (u_short) c->header_start;
+    h->body_start = (u_short) c->body_start;
+
+    if (c->etag.len <= NGX_HTTP_CACHE_ETAG_LEN) {
+        h->etag_len = (u_char) c->etag.len;
+        ngx_memcpy(h->etag, c->etag.data, c->etag.len);
+
+    } else {
+        h->etag_len = 0;
+    }
+
+    if (c->vary.len && c->vary.len <= NGX_HTTP_CACHE_VARY_LEN) {
+        h->vary_len = (u_char) c->vary.len;
+        ngx_memcpy(h->vary, c->vary.data, c->vary.len);
+
+        ngx_http_file_cache_vary(r, c->vary.data, c->vary.len, c->variant);
+        ngx_memcpy(h->variant, c->variant, NGX_HTTP_CACHE_KEY_LEN);
+
+    } else {
+        h->vary_len = 0;
+    }
+
+    if (ngx_http_file_cache_update_variant(r, c) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    p = buf + sizeof(ngx_http_file_cache_header_t);
+
+    p = ngx_cpymem(p, ngx_http_file_cache_key, sizeof(ngx_http_file_cache_key));
+
+    key = c->keys.elts;
+    for (i = 0; i < c->keys.nelts; i++) {
+        p = ngx_copy(p, key[i].data, key[i].len);
+    }
+
+    *p = LF;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_update_variant(ngx_http_request_t *r, ngx_http_cache_t *c)
+{
+    ngx_http_file_cache_t  *cache;
+
+    if (!c->secondary) {
+        return NGX_OK;
+    }
+
+    if (c->vary.len
+        && ngx_memcmp(c->variant, c->key, NGX_HTTP_CACHE_KEY_LEN) == 0)
+    {
+        return NGX_OK;
+    }
+
+    /*
+     * the response does not vary the same way as the one stored
+     * under the main key anymore, so it replaces the latter
+     */
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache main key");
+
+    cache = c->file_cache;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    c->node->count--;
+    c->node->updating = 0;
+    c->node = NULL;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    c->secondary = 0;
+
+    ngx_memcpy(c->key, c->main, NGX_HTTP_CACHE_KEY_LEN);
+
+    if (ngx_http_file_cache_exists(cache, c) == NGX_ERROR) {
+        return NGX_ERROR;
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    c->node->updating = 1;
+    c->node->lock_time = ngx_current_msec + c->lock_timeout;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    c->updating = 1;
+
+    return ngx_http_file_cache_name(r, cache->tiers[c->tier].path);
+}
+
+
+void
+ngx_http_file_cache_update(ngx_http_request_t *r, ngx_temp_file_t *tf)
+{
+    off_t                   fs_size;
+    ngx_int_t               rc;
+    ngx_file_uniq_t         uniq;
+    ngx_file_info_t         fi;
+    ngx_http_cache_t        *c;
+    ngx_ext_rename_file_t   ext;
+    ngx_http_file_cache_t  *cache;
+
+    c = r->cache;
+
+    if (c->updated) {
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache update");
+
+    c->updated = 1;
+    c->updating = 0;
+
+    cache = c->file_cache;
+
+    uniq = 0;
+    fs_size = 0;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache rename: \"%s\" to \"%s\"",
+                   tf->file.name.data, c->file.name.data);
+
+    ext.access = NGX_FILE_OWNER_ACCESS;
+    ext.path_access = NGX_FILE_OWNER_ACCESS;
+    ext.time = -1;
+    ext.create_path = 1;
+    ext.delete_file = 1;
+    ext.log = r->connection->log;
+
+    rc = ngx_ext_rename_file(&tf->file.name, &c->file.name, &ext);
+
+    if (rc == NGX_OK) {
+
+        if (ngx_fd_info(tf->file.fd, &fi) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_CRIT, r->connection->log, ngx_errno,
+                          ngx_fd_info_n " \"%s\" failed", tf->file.name.data);
+
+            rc = NGX_ERROR;
+
+        } else {
+            uniq = ngx_file_uniq(&fi);
+            fs_size = (ngx_file_fs_size(&fi) + cache->bsize - 1) / cache->bsize;
+        }
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    c->node->count--;
+    c->node->uniq = uniq;
+    c->node->body_start = c->body_start;
+
+    cache->sh->size += fs_size - c->node->fs_size;
+    cache->sh->tier_size[c->node->tier] += fs_size - c->node->fs_size;
+
+    if (c->node->hot) {
+        cache->sh->protected_size += fs_size - c->node->fs_size;
+    }
+
+    c->node->fs_size = fs_size;
+
+    if (rc == NGX_OK) {
+        c->node->exists = 1;
+
+        if (c->vary.len) {
+            c->node->vary = 1;
+        }
+    }
+
+    c->node->updating = 0;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    if (cache->mem) {
+        ngx_http_file_cache_memory_delete(cache, c->key);
+    }
+}
+
+
+void
+ngx_http_file_cache_update_header(ngx_http_request_t *r)
+{
+    ssize_t                        n;
+    ngx_err_t                      err;
+    ngx_file_t                     file;
+    ngx_file_uniq_t                uniq;
+    ngx_file_info_t                fi;
+    ngx_http_cache_t              *c;
+    ngx_http_file_cache_t         *cache;
+    ngx_http_file_cache_header_t   h;
+
+    c = r->cache;
+
+    if (c->updated) {
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache update header");
+
+    c->updated = 1;
+    c->updating = 0;
+
+    cache = c->file_cache;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    c->node->count--;
+    c->node->updating = 0;
+    uniq = c->node->uniq;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_memzero(&file, sizeof(ngx_file_t));
+
+    file.name = c->file.name;
+    file.log = r->connection->log;
+
+    file.fd = ngx_open_file(file.name.data, NGX_FILE_RDWR, NGX_FILE_OPEN, 0);
+
+    if (file.fd == NGX_INVALID_FILE) {
+        err = ngx_errno;
+
+        /* the cache file may have been deleted meanwhile */
+
+        if (err == NGX_ENOENT) {
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                           "http file cache \"%s\" not found",
+                           file.name.data);
+            return;
+        }
+
+        ngx_log_error(NGX_LOG_CRIT, r->connection->log, err,
+                      ngx_open_file_n " \"%s\" failed", file.name.data);
+        return;
+    }
+
+    /* the file is left intact if it was replaced by another response */
+
+    if (ngx_fd_info(file.fd, &fi) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, r->connection->log, ngx_errno,
+                      ngx_fd_info_n " \"%s\" failed", file.name.data);
+        goto done;
+    }
+
+    if (uniq != ngx_file_uniq(&fi) || uniq != c->uniq) {
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                       "http file cache \"%s\" changed", file.name.data);
+        goto done;
+    }
+
+    n = ngx_read_file(&file, (u_char *) &h,
+                      sizeof(ngx_http_file_cache_header_t), 0);
+
+    if (n == NGX_ERROR) {
+        goto done;
+    }
+
+    if ((size_t) n != sizeof(ngx_http_file_cache_header_t)) {
+        ngx_log_error(NGX_LOG_CRIT, r->connection->log, 0,
+                      ngx_read_file_n " read only %z of %uz from \"%s\"",
+                      n, sizeof(ngx_http_file_cache_header_t), file.name.data);
+        goto done;
+    }
+
+    if (h.version != NGX_HTTP_CACHE_VERSION
+        || h.last_modified != c->last_modified
+        || h.crc32 != c->crc32
+        || h.header_start != c->header_start
+        || h.body_start != c->body_start)
+    {
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                       "http file cache \"%s\" content changed",
+                       file.name.data);
+        goto done;
+    }
+
+    h.valid_sec = c->valid_sec;
+    h.date = c->date;
+
+    n = ngx_write_file(&file, (u_char *) &h,
+                       sizeof(ngx_http_file_cache_header_t), 0);
+
+    if (cache->mem && n == sizeof(ngx_http_file_cache_header_t)) {
+        ngx_http_file_cache_memory_update(cache, c, &h);
+    }
+
+done:
+
+    if (ngx_close_file(file.fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, r->connection->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", file.name.data);
+    }
+}
+
+
+ngx_int_t
+ngx_http_cache_send(ngx_http_request_t *r)
+{
+    ngx_int_t          rc;
+    ngx_uint_t         memory;
+    ngx_buf_t         *b;
+    ngx_chain_t        out;
+    ngx_http_cache_t  *c;
+
+    c = r->cache;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http file cache send: %s", c->file.name.data);
+
+    if (r != r->main && c->length - c->body_start == 0) {
+        return ngx_http_send_header(r);
+    }
+
+    /* the whole entry is in the buffer if it came from the memory zone */
+
+    memory = c->memory || (off_t) (c->buf->last - c->buf->pos) == c->length;
+
+    /* we need to allocate all before the header would be sent */
+
+    b = ngx_pcalloc(r->pool, sizeof(ngx_buf_t));
+    if (b == NULL) {
+        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    if (!memory) {
+        b->file = ngx_pcalloc(r->pool, sizeof(ngx_file_t));
+        if (b->file == NULL) {
+            return NGX_HTTP_INTERNAL_SERVER_ERROR;
+        }
+    }
+
+    rc = ngx_http_send_header(r);
+
+    if (rc == NGX_ERROR || rc > NGX_OK || r->header_only) {
+        return rc;
+    }
+
+    b->last_buf = (r == r->main) ? 1: 0;
+    b->last_in_chain = 1;
+
+    if (memory) {
+        b->pos = c->buf->pos + c->body_start;
+        b->last = c->buf->pos + c->length;
+
+        b->memory = (c->length - c->body_start) ? 1: 0;
+
+    } else {
+        b->file_pos = c->body_start;
+        b->file_last = c->length;
+
+        b->in_file = (c->length - c->body_start) ? 1: 0;
+
+        b->file->fd = c->file.fd;
+        b->file->name = c->file.name;
+        b->file->log = r->connection->log;
+    }
+
+    out.buf = b;
+    out.next = NULL;
+
+    return ngx_http_output_filter(r, &out);
+}
+
+
+void
+ngx_http_file_cache_free(ngx_http_cache_t *c, ngx_temp_file_t *tf)
+{
+    ngx_http_file_cache_t       *cache;
+    ngx_http_file_cache_node_t  *fcn;
+
+    if (c->updated || c->node == NULL) {
+        return;
+    }
+
+    cache = c->file_cache;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
+                   "http file cache free, fd: %d", c->file.fd);
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    fcn = c->node;
+    fcn->count--;
+
+    if (c->updating) {
+        fcn->updating = 0;
+    }
+
+    if (c->error) {
+        fcn->error = c->error;
+
+        if (c->valid_sec) {
+            fcn->valid_sec = c->valid_sec;
+            fcn->valid_msec = c->valid_msec;
+        }
+
+    } else if (!fcn->exists && fcn->count == 0 && c->min_uses == 1) {
+        ngx_queue_remove(&fcn->queue);
+        ngx_rbtree_delete(&cache->sh->rbtree, &fcn->node);
+        ngx_slab_free_locked(cache->shpool, fcn);
+        c->node = NULL;
+    }
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    c->updated = 1;
+    c->updating = 0;
+
+    if (c->temp_file) {
+        if (tf && tf->file.fd != NGX_INVALID_FILE) {
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
+                           "http file cache incomplete: \"%s\"",
+                           tf->file.name.data);
+
+            if (ngx_delete_file(tf->file.name.data) == NGX_FILE_ERROR) {
+                ngx_log_error(NGX_LOG_CRIT, c->file.log, ngx_errno,
+                              ngx_delete_file_n " \"%s\" failed",
+                              tf->file.name.data);
+            }
+        }
+    }
+}
+
+
+static void
+ngx_http_file_cache_cleanup(void *data)
+{
+    ngx_http_cache_t  *c = data;
+
+    if (c->updated) {
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->file.log, 0,
+                   "http file cache cleanup");
+
+    if (c->updating && !c->background) {
+        ngx_log_error(NGX_LOG_ALERT, c->file.log, 0,
+                      "stalled cache updating, error:%ui", c->error);
+    }
+
+    ngx_http_file_cache_free(c, NULL);
+}
+
+
+static time_t
+ngx_http_file_cache_forced_expire(ngx_http_file_cache_t *cache)
+{
+    u_char                      *name;
+    size_t                       len;
+    time_t                       wait;
+    ngx_uint_t                   i, tries;
+    ngx_path_t                  *path;
+    ngx_queue_t                 *q, *queue;
+    ngx_http_file_cache_node_t  *fcn;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache forced expire");
+
+    path = cache->path;
+    len = cache->name_len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+
+    name = ngx_alloc(len + 1, ngx_cycle->log);
+    if (name == NULL) {
+        return 10;
+    }
+
+    wait = 10;
+    tries = 20;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    /* the probationary segment is evicted first */
+
+    for (i = 0; i < 2 && wait == 10; i++) {
+
+        queue = (i == 0) ? &cache->sh->queue : &cache->sh->protected;
+
+        for (q = ngx_queue_last(queue);
+             q != ngx_queue_sentinel(queue);
+             q = ngx_queue_prev(q))
+        {
+            fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+            ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                  "http file cache forced expire: #%d %d %02xd%02xd%02xd%02xd",
+                  fcn->count, fcn->exists,
+                  fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+
+            if (fcn->count == 0) {
+                ngx_http_file_cache_delete(cache, q, name);
+                cache->sh->evicted++;
+                wait = 0;
+
+            } else {
+                if (--tries) {
+                    continue;
+                }
+
+                wait = 1;
+            }
+
+            break;
+        }
+    }
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_free(name);
+
+    return wait;
+}
+
+
+static time_t
+ngx_http_file_cache_expire(ngx_http_file_cache_t *cache)
+{
+    u_char      *name;
+    size_t       len;
+    time_t       wait, next;
+    ngx_path_t  *path;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache expire");
+
+    path = cache->path;
+    len = cache->name_len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
+
+    name = ngx_alloc(len + 1, ngx_cycle->log);
+    if (name == NULL) {
+        return 10;
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    next = ngx_http_file_cache_expire_queue(cache, &cache->sh->queue, name);
+
+    wait = ngx_http_file_cache_expire_queue(cache, &cache->sh->protected,
+                                            name);
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_free(name);
+
+    return ngx_min(next, wait);
+}
+
+
+static time_t
+ngx_http_file_cache_expire_queue(ngx_http_file_cache_t *cache,
+    ngx_queue_t *queue, u_char *name)
+{
+    u_char                      *p;
+    size_t                       len;
+    time_t                       now, wait;
+    ngx_queue_t                 *q;
+    ngx_http_file_cache_node_t  *fcn;
+    u_char                       key[2 * NGX_HTTP_CACHE_KEY_LEN];
+
+    now = ngx_time();
+
+    for ( ;; ) {
+
+        if (ngx_queue_empty(queue)) {
+            wait = 10;
+            break;
+        }
+
+        q = ngx_queue_last(queue);
+
+        fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+        wait = fcn->expire - now;
+
+        if (wait > 0) {
+            wait = wait > 10 ? 10 : wait;
+            break;
+        }
+
+        ngx_log_debug6(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                       "http file cache expire: #%d %d %02xd%02xd%02xd%02xd",
+                       fcn->count, fcn->exists,
+                       fcn->key[0], fcn->key[1], fcn->key[2], fcn->key[3]);
+
+        if (fcn->count == 0) {
+            ngx_http_file_cache_delete(cache, q, name);
+            continue;
+        }
+
+        if (fcn->deleting || fcn->moving) {
+            wait = 1;
+            break;
+        }
+
+        p = ngx_hex_dump(key, (u_char *) &fcn->node.key,
+                         sizeof(ngx_rbtree_key_t));
+        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
+        (void) ngx_hex_dump(p, fcn->key, len);
+
+        /*
+         * abnormally exited workers may leave locked cache entries,
+         * and although it may be safe to remove them completely,
+         * we prefer to just move them to the top of the inactive queue
+         */
+
+        ngx_queue_remove(q);
+        fcn->expire = ngx_time() + cache->inactive;
+        ngx_queue_insert_head(queue, &fcn->queue);
+
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, 0,
+                      "ignore long locked inactive cache entry %*s, count:%d",
+                      2 * NGX_HTTP_CACHE_KEY_LEN, key, fcn->count);
+    }
 
     return wait;
 }
 
 
-static void
-ngx_http_file_cache_delete(ngx_http_file_cache_t *cache, ngx_queue_t *q,
-    u_char *name)
+static void
+ngx_http_file_cache_delete(ngx_http_file_cache_t *cache, ngx_queue_t *q,
+    u_char *name)
+{
+    ngx_err_t                    err;
+    ngx_http_file_cache_node_t  *fcn;
+    u_char                       key[NGX_HTTP_CACHE_KEY_LEN];
+
+    fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+    if (fcn->exists) {
+        cache->sh->size -= fcn->fs_size;
+        cache->sh->tier_size[fcn->tier] -= fcn->fs_size;
+
+        if (fcn->hot) {
+            cache->sh->protected_size -= fcn->fs_size;
+            fcn->hot = 0;
+        }
+
+        ngx_http_file_cache_node_name(cache, fcn, fcn->tier, name);
+
+        if (cache->mem) {
+            ngx_memcpy(key, &fcn->node.key, sizeof(ngx_rbtree_key_t));
+            ngx_memcpy(&key[sizeof(ngx_rbtree_key_t)], fcn->key,
+                       NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+            ngx_http_file_cache_memory_delete(cache, key);
+        }
+
+        fcn->count++;
+        fcn->deleting = 1;
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                       "http file cache expire: \"%s\"", name);
+
+        if (ngx_delete_file(name) == NGX_FILE_ERROR) {
+            err = ngx_errno;
+
+            /* the file may have gone since the index was written */
+
+            if (err != NGX_ENOENT) {
+                ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                              ngx_delete_file_n " \"%s\" failed", name);
+            }
+        }
+
+        ngx_shmtx_lock(&cache->shpool->mutex);
+        fcn->count--;
+        fcn->deleting = 0;
+    }
+
+    if (fcn->count == 0) {
+        ngx_queue_remove(q);
+        ngx_rbtree_delete(&cache->sh->rbtree, &fcn->node);
+        ngx_slab_free_locked(cache->shpool, fcn);
+    }
+}
+
+
+static time_t
+ngx_http_file_cache_migrate(ngx_http_file_cache_t *cache)
+{
+    u_char                      *name;
+    size_t                       len;
+    ngx_uint_t                   i, moved;
+    ngx_http_file_cache_node_t  *fcn;
+    u_char                       key[NGX_HTTP_CACHE_KEY_LEN];
+
+    len = cache->name_len + 1 + cache->path->len + 2 * NGX_HTTP_CACHE_KEY_LEN
+          + sizeof(".tmp");
+
+    name = ngx_alloc(3 * len, ngx_cycle->log);
+    if (name == NULL) {
+        return 10;
+    }
+
+    moved = 0;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    /* the entries hit often enough in a slower tier */
+
+    while (cache->sh->npromote && moved < NGX_HTTP_FILE_CACHE_MOVE_BATCH) {
+
+        ngx_memcpy(key, cache->sh->promote[--cache->sh->npromote],
+                   NGX_HTTP_CACHE_KEY_LEN);
+
+        fcn = ngx_http_file_cache_lookup(cache, key);
+
+        if (fcn == NULL) {
+            continue;
+        }
+
+        fcn->promote = 0;
+
+        if (fcn->tier == 0 || !fcn->exists || fcn->count) {
+            continue;
+        }
+
+        if (ngx_http_file_cache_move(cache, fcn, 0, name, len) == NGX_OK) {
+            cache->sh->promoted++;
+        }
+
+        moved++;
+    }
+
+    /* the least recently used entries of the tiers over their share */
+
+    for (i = 0; i < cache->ntiers - 1; i++) {
+
+        while (cache->sh->tier_size[i] > cache->tiers[i].max_size
+               && moved < NGX_HTTP_FILE_CACHE_MOVE_BATCH)
+        {
+            fcn = ngx_http_file_cache_coldest(cache, i);
+
+            if (fcn == NULL) {
+                break;
+            }
+
+            moved++;
+
+            if (ngx_http_file_cache_move(cache, fcn, i + 1, name, len)
+                != NGX_OK)
+            {
+                break;
+            }
+
+            fcn->uses = 1;
+            cache->sh->demoted++;
+        }
+    }
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_free(name);
+
+    if (ngx_quit || ngx_terminate) {
+        return 10;
+    }
+
+    return (moved == NGX_HTTP_FILE_CACHE_MOVE_BATCH) ? 1 : 10;
+}
+
+
+static ngx_http_file_cache_node_t *
+ngx_http_file_cache_coldest(ngx_http_file_cache_t *cache, ngx_uint_t tier)
+{
+    ngx_uint_t                   i, n;
+    ngx_queue_t                 *q, *queue;
+    ngx_http_file_cache_node_t  *fcn;
+
+    n = 0;
+
+    for (i = 0; i < 2; i++) {
+
+        queue = (i == 0) ? &cache->sh->queue : &cache->sh->protected;
+
+        for (q = ngx_queue_last(queue);
+             q != ngx_queue_sentinel(queue)
+             && n++ < NGX_HTTP_FILE_CACHE_MOVE_SCAN;
+             q = ngx_queue_prev(q))
+        {
+            fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+
+            if (fcn->tier == tier && fcn->exists && fcn->count == 0) {
+                return fcn;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_move(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, ngx_uint_t tier, u_char *name,
+    size_t len)
+{
+    u_char           *src, *dst, *temp;
+    off_t             fs_size;
+    ngx_int_t         rc;
+    ngx_err_t         err;
+    ngx_uint_t        from;
+    ngx_file_uniq_t   uniq;
+    ngx_file_info_t   fi;
+    ngx_copy_file_t   cf;
+
+    src = name;
+    dst = name + len;
+    temp = name + 2 * len;
+
+    from = fcn->tier;
+    uniq = fcn->uniq;
+
+    ngx_http_file_cache_node_name(cache, fcn, from, src);
+    ngx_http_file_cache_node_name(cache, fcn, tier, dst);
+    ngx_sprintf(temp, "%s.tmp%Z", dst);
+
+    fcn->count++;
+    fcn->moving = 1;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_log_debug3(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache move: \"%s\" to \"%s\", tier %ui",
+                   src, dst, tier);
+
+    /* the copy is renamed in place to never be seen incomplete */
+
+    rc = NGX_ERROR;
+    fs_size = 0;
+
+    (void) ngx_delete_file(temp);
+    (void) ngx_create_full_path(temp, ngx_dir_access(NGX_FILE_OWNER_ACCESS));
+
+    cf.size = -1;
+    cf.buf_size = 0;
+    cf.access = NGX_FILE_OWNER_ACCESS;
+    cf.time = -1;
+    cf.log = ngx_cycle->log;
+
+    if (ngx_copy_file(src, temp, &cf) == NGX_OK) {
+
+        if (ngx_file_info(temp, &fi) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                          ngx_file_info_n " \"%s\" failed", temp);
+
+        } else if (ngx_rename_file(temp, dst) == NGX_FILE_ERROR) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                          ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                          temp, dst);
+
+        } else {
+            fs_size = (ngx_file_fs_size(&fi) + cache->bsize - 1)
+                      / cache->bsize;
+            rc = NGX_OK;
+        }
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    fcn->count--;
+    fcn->moving = 0;
+
+    if (rc != NGX_OK || fcn->count || !fcn->exists || fcn->uniq != uniq) {
+
+        /* the entry has been used or replaced meanwhile */
+
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+        if (rc == NGX_OK) {
+            (void) ngx_delete_file(dst);
+
+        } else {
+            (void) ngx_delete_file(temp);
+        }
+
+        ngx_shmtx_lock(&cache->shpool->mutex);
+
+        return NGX_DECLINED;
+    }
+
+    cache->sh->size += fs_size - fcn->fs_size;
+    cache->sh->tier_size[from] -= fcn->fs_size;
+    cache->sh->tier_size[tier] += fs_size;
+
+    if (fcn->hot) {
+        cache->sh->protected_size += fs_size - fcn->fs_size;
+    }
+
+    fcn->fs_size = fs_size;
+    fcn->uniq = ngx_file_uniq(&fi);
+    fcn->tier = tier;
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    if (ngx_delete_file(src) == NGX_FILE_ERROR) {
+        err = ngx_errno;
+
+        if (err != NGX_ENOENT) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                          ngx_delete_file_n " \"%s\" failed", src);
+        }
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_file_cache_node_name(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_node_t *fcn, ngx_uint_t tier, u_char *name)
+{
+    u_char      *p;
+    size_t       len;
+    ngx_path_t  *path;
+
+    path = cache->tiers[tier].path;
+
+    ngx_memcpy(name, path->name.data, path->name.len);
+
+    p = name + path->name.len + 1 + path->len;
+    p = ngx_hex_dump(p, (u_char *) &fcn->node.key, sizeof(ngx_rbtree_key_t));
+    len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
+    p = ngx_hex_dump(p, fcn->key, len);
+    *p = '\0';
+
+    ngx_create_hashed_filename(path, name, p - name);
+}
+
+
+static time_t
+ngx_http_file_cache_purge_walk(ngx_http_file_cache_t *cache)
+{
+    u_char                             *names, *buf;
+    size_t                              len, size, want;
+    ssize_t                             n;
+    ngx_err_t                           err;
+    ngx_file_t                          file;
+    ngx_uint_t                          i, nentries, done;
+    ngx_msec_t                          start;
+    ngx_queue_t                        *q;
+    ngx_rbtree_node_t                  *node;
+    ngx_http_file_cache_ban_t          *ban;
+    ngx_http_file_cache_node_t         *fcn;
+    ngx_http_file_cache_header_t       *h;
+    ngx_http_file_cache_purge_entry_t  *entries, *pe;
+
+    len = cache->name_len + 1 + cache->path->len + 2 * NGX_HTTP_CACHE_KEY_LEN
+          + 1;
+
+    entries = ngx_alloc(NGX_HTTP_FILE_CACHE_PURGE_BATCH
+                        * (sizeof(ngx_http_file_cache_purge_entry_t) + len),
+                        ngx_cycle->log);
+    if (entries == NULL) {
+        return 10;
+    }
+
+    names = (u_char *) &entries[NGX_HTTP_FILE_CACHE_PURGE_BATCH];
+
+    ngx_memzero(&file, sizeof(ngx_file_t));
+    file.log = ngx_cycle->log;
+
+    buf = NULL;
+    size = 0;
+    done = 0;
+    start = ngx_current_msec;
+
+    /*
+     * the tree is walked in batches from the last key seen, the files
+     * are read with the mutex released, and the walk is resumed on the
+     * next manager run after NGX_HTTP_FILE_CACHE_PURGE_TIME milliseconds
+     */
+
+    do {
+        nentries = 0;
+
+        ngx_shmtx_lock(&cache->shpool->mutex);
+
+        if (cache->sh->purge_start == 0) {
+            cache->sh->purge_start = ngx_time();
+            cache->sh->purge_first = 1;
+            cache->sh->purge_skipped = 0;
+        }
+
+        node = ngx_http_file_cache_index_next(cache, cache->sh->purge_first
+                                                     ? NULL
+                                                     : cache->sh->purge_key);
+
+        while (node && nentries < NGX_HTTP_FILE_CACHE_PURGE_BATCH) {
+
+            fcn = (ngx_http_file_cache_node_t *) node;
+
+            ngx_memcpy(cache->sh->purge_key, &node->key,
+                       sizeof(ngx_rbtree_key_t));
+            ngx_memcpy(&cache->sh->purge_key[sizeof(ngx_rbtree_key_t)],
+                       fcn->key,
+                       NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+            cache->sh->purge_first = 0;
+
+            if (fcn->exists && !fcn->deleting) {
+                pe = &entries[nentries++];
+
+                ngx_memcpy(pe->key, cache->sh->purge_key,
+                           NGX_HTTP_CACHE_KEY_LEN);
+                pe->uniq = fcn->uniq;
+                pe->body_start = fcn->body_start;
+                pe->name = names + (pe - entries) * len;
+
+                ngx_http_file_cache_node_name(cache, fcn, fcn->tier, pe->name);
+            }
+
+            node = ngx_http_file_cache_index_successor(&cache->sh->rbtree,
+                                                       node);
+        }
+
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+        for (i = 0; i < nentries; i++) {
+            pe = &entries[i];
+
+            file.fd = ngx_open_file(pe->name, NGX_FILE_RDONLY, NGX_FILE_OPEN,
+                                    0);
+
+            if (file.fd == NGX_INVALID_FILE) {
+                err = ngx_errno;
+
+                if (err == NGX_ENOENT) {
+                    ngx_http_file_cache_purge_check(cache, pe, NULL, 0);
+
+                } else {
+                    ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                                  ngx_open_file_n " \"%s\" failed", pe->name);
+                }
+
+                continue;
+            }
+
+            file.name.data = pe->name;
+            file.name.len = ngx_strlen(pe->name);
+
+            /*
+             * the header size is not known for the entries added
+             * by the loader, it is taken from the file then
+             */
+
+            want = pe->body_start ? pe->body_start : (size_t) ngx_pagesize;
+
+            for ( ;; ) {
+
+                if (want > size) {
+                    ngx_free(buf);
+
+                    size = want;
+
+                    buf = ngx_alloc(size, ngx_cycle->log);
+                    if (buf == NULL) {
+                        (void) ngx_close_file(file.fd);
+                        ngx_free(entries);
+                        return 10;
+                    }
+                }
+
+                n = ngx_read_file(&file, buf, want, 0);
+
+                h = (ngx_http_file_cache_header_t *) buf;
+
+                if (n != (ssize_t) want
+                    || h->version != NGX_HTTP_CACHE_VERSION
+                    || h->body_start <= want)
+                {
+                    break;
+                }
+
+                want = h->body_start;
+            }
+
+            if (ngx_close_file(file.fd) == NGX_FILE_ERROR) {
+                ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                              ngx_close_file_n " \"%s\" failed", pe->name);
+            }
+
+            if (n >= (ssize_t) sizeof(ngx_http_file_cache_header_t)) {
+                ngx_http_file_cache_purge_check(cache, pe, buf, n);
+            }
+        }
+
+        if (node == NULL) {
+            done = 1;
+            break;
+        }
+
+        ngx_time_update();
+
+    } while (ngx_current_msec - start < NGX_HTTP_FILE_CACHE_PURGE_TIME
+             && !ngx_quit && !ngx_terminate);
+
+    ngx_free(buf);
+    ngx_free(entries);
+
+    if (!done) {
+        return 1;
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    /*
+     * the purges made before the walk started are done unless
+     * some entries were moved between tiers during the walk
+     */
+
+    if (!cache->sh->purge_skipped) {
+
+        q = ngx_queue_head(&cache->sh->bans);
+
+        while (q != ngx_queue_sentinel(&cache->sh->bans)) {
+
+            ban = ngx_queue_data(q, ngx_http_file_cache_ban_t, queue);
+
+            q = ngx_queue_next(q);
+
+            if (ban->time < cache->sh->purge_start) {
+                ngx_queue_remove(&ban->queue);
+                ngx_slab_free_locked(cache->shpool, ban);
+                cache->sh->nbans--;
+            }
+        }
+    }
+
+    cache->sh->purge_start = 0;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache purge walk done, %ui pending",
+                   cache->sh->nbans);
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    return 1;
+}
+
+
+static void
+ngx_http_file_cache_purge_check(ngx_http_file_cache_t *cache,
+    ngx_http_file_cache_purge_entry_t *pe, u_char *buf, size_t size)
+{
+    ngx_http_file_cache_node_t    *fcn;
+    ngx_http_file_cache_header_t  *h;
+
+    h = (ngx_http_file_cache_header_t *) buf;
+
+    if (h && h->version != NGX_HTTP_CACHE_VERSION) {
+        return;
+    }
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    fcn = ngx_http_file_cache_lookup(cache, pe->key);
+
+    if (fcn == NULL || !fcn->exists || fcn->deleting) {
+        goto done;
+    }
+
+    /* an entry without a file is dropped as well */
+
+    if (h && !ngx_http_file_cache_banned(cache, buf, size)) {
+        goto done;
+    }
+
+    if (fcn->uniq != pe->uniq) {
+
+        /* the entry was replaced or moved to another tier meanwhile */
+
+        cache->sh->purge_skipped = 1;
+        goto done;
+    }
+
+    ngx_http_file_cache_purge_node(cache, fcn, pe->name);
+    cache->sh->purged++;
+
+done:
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+}
+
+
+static time_t
+ngx_http_file_cache_manager(void *data)
+{
+    ngx_http_file_cache_t  *cache = data;
+
+    off_t   size;
+    time_t  next, wait, now;
+
+    next = ngx_http_file_cache_expire(cache);
+
+    if (cache->index.len && !cache->sh->cold) {
+
+        now = ngx_time();
+
+        if (now >= cache->index_next) {
+            ngx_http_file_cache_write_index(cache);
+            cache->index_next = now + cache->index_interval;
+        }
+
+        next = ngx_min(next, cache->index_next - now);
+    }
+
+    if (cache->ntiers > 1 && !cache->sh->cold) {
+        wait = ngx_http_file_cache_migrate(cache);
+        next = ngx_min(next, wait);
+    }
+
+    if (cache->sh->nbans && !cache->sh->cold) {
+        wait = ngx_http_file_cache_purge_walk(cache);
+        next = ngx_min(next, wait);
+    }
+
+    if (ngx_cycle->log->log_level >= NGX_LOG_INFO
+        && ngx_time() >= cache->stats_next)
+    {
+        ngx_http_file_cache_log_stats(cache);
+        cache->stats_next = ngx_time() + 60;
+    }
+
+    cache->last = ngx_current_msec;
+    cache->files = 0;
+
+    for ( ;; ) {
+        ngx_shmtx_lock(&cache->shpool->mutex);
+
+        size = cache->sh->size;
+
+        ngx_shmtx_unlock(&cache->shpool->mutex);
+
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                       "http file cache size: %O", size);
+
+        if (size < cache->max_size) {
+            return next;
+        }
+
+        wait = ngx_http_file_cache_forced_expire(cache);
+
+        if (wait > 0) {
+            return wait;
+        }
+
+        if (ngx_quit || ngx_terminate) {
+            return next;
+        }
+    }
+}
+
+
+static void
+ngx_http_file_cache_loader(void *data)
+{
+    ngx_http_file_cache_t  *cache = data;
+
+    ngx_uint_t      i;
+    ngx_tree_ctx_t  tree;
+
+    if (!cache->sh->cold || cache->sh->loading) {
+        return;
+    }
+
+    if (!ngx_atomic_cmp_set(&cache->sh->loading, 0, ngx_pid)) {
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache loader");
+
+    cache->index_time = 0;
+
+    if (cache->index.len) {
+        if (ngx_http_file_cache_load_index(cache) == NGX_ABORT) {
+            cache->sh->loading = 0;
+            return;
+        }
+    }
+
+    tree.init_handler = NULL;
+    tree.file_handler = ngx_http_file_cache_manage_file;
+    tree.pre_tree_handler = cache->index_time ? ngx_http_file_cache_skip_dir:
+                                                ngx_http_file_cache_noop;
+    tree.post_tree_handler = ngx_http_file_cache_noop;
+    tree.spec_handler = ngx_http_file_cache_delete_file;
+    tree.data = cache;
+    tree.alloc = 0;
+    tree.log = ngx_cycle->log;
+
+    cache->last = ngx_current_msec;
+    cache->files = 0;
+
+    for (i = 0; i < cache->ntiers; i++) {
+        cache->walk_tier = i;
+
+        if (ngx_walk_tree(&tree, &cache->tiers[i].path->name) == NGX_ABORT) {
+            cache->sh->loading = 0;
+            return;
+        }
+    }
+
+    cache->sh->cold = 0;
+    cache->sh->loading = 0;
+
+    ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
+                  "http file cache: %V %.3fM, bsize: %uz",
+                  &cache->path->name,
+                  ((double) cache->sh->size * cache->bsize) / (1024 * 1024),
+                  cache->bsize);
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_loader_sleep(ngx_http_file_cache_t *cache)
+{
+    ngx_msec_t  elapsed;
+
+    if (cache->files++ > 100) {
+
+        ngx_time_update();
+
+        elapsed = ngx_abs((ngx_msec_int_t) (ngx_current_msec - cache->last));
+
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                       "http file cache manager time: %M", elapsed);
+
+        if (elapsed > 200) {
+
+            /*
+             * if processing 100 files takes more than 200ms,
+             * it seems that many operations require disk i/o,
+             * therefore sleep 200ms
+             */
+
+            ngx_msleep(200);
+
+            ngx_time_update();
+        }
+
+        cache->last = ngx_current_msec;
+        cache->files = 0;
+    }
+
+    return (ngx_quit || ngx_terminate) ? NGX_ABORT : NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_noop(ngx_tree_ctx_t *ctx, ngx_str_t *path)
+{
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_manage_file(ngx_tree_ctx_t *ctx, ngx_str_t *path)
+{
+    ngx_http_file_cache_t  *cache;
+
+    cache = ctx->data;
+
+    if (ngx_http_file_cache_add_file(ctx, path) != NGX_OK) {
+        (void) ngx_http_file_cache_delete_file(ctx, path);
+    }
+
+    return ngx_http_file_cache_loader_sleep(cache);
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_add_file(ngx_tree_ctx_t *ctx, ngx_str_t *name)
+{
+    u_char                 *p;
+    ngx_int_t               n;
+    ngx_uint_t              i;
+    ngx_http_cache_t        c;
+    ngx_http_file_cache_t  *cache;
+
+    if (name->len < 2 * NGX_HTTP_CACHE_KEY_LEN) {
+        return NGX_ERROR;
+    }
+
+    if (ctx->size < (off_t) sizeof(ngx_http_file_cache_header_t)) {
+        ngx_log_error(NGX_LOG_CRIT, ctx->log, 0,
+                      "cache file \"%s\" is too small", name->data);
+        return NGX_ERROR;
+    }
+
+    ngx_memzero(&c, sizeof(ngx_http_cache_t));
+    cache = ctx->data;
+
+    c.length = ctx->size;
+    c.fs_size = (ctx->fs_size + cache->bsize - 1) / cache->bsize;
+    c.tier = cache->walk_tier;
+
+    p = &name->data[name->len - 2 * NGX_HTTP_CACHE_KEY_LEN];
+
+    for (i = 0; i < NGX_HTTP_CACHE_KEY_LEN; i++) {
+        n = ngx_hextoi(p, 2);
+
+        if (n == NGX_ERROR) {
+            return NGX_ERROR;
+        }
+
+        p += 2;
+
+        c.key[i] = (u_char) n;
+    }
+
+    return ngx_http_file_cache_add(cache, &c);
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_add(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
 {
-    u_char                      *p;
-    size_t                       len;
-    ngx_path_t                  *path;
+    u_char                      *name;
+    ngx_err_t                    err;
     ngx_http_file_cache_node_t  *fcn;
 
-    fcn = ngx_queue_data(q, ngx_http_file_cache_node_t, queue);
+    name = NULL;
+
+    ngx_shmtx_lock(&cache->shpool->mutex);
+
+    fcn = ngx_http_file_cache_lookup(cache, c->key);
+
+    if (fcn == NULL) {
+
+        fcn = ngx_slab_alloc_locked(cache->shpool,
+                                    sizeof(ngx_http_file_cache_node_t));
+        if (fcn == NULL) {
+            ngx_shmtx_unlock(&cache->shpool->mutex);
+            return NGX_ERROR;
+        }
+
+        ngx_memcpy((u_char *) &fcn->node.key, c->key, sizeof(ngx_rbtree_key_t));
+
+        ngx_memcpy(fcn->key, &c->key[sizeof(ngx_rbtree_key_t)],
+                   NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+        ngx_rbtree_insert(&cache->sh->rbtree, &fcn->node);
+
+        fcn->uses = 1;
+        fcn->count = 0;
+        fcn->valid_msec = 0;
+        fcn->error = 0;
+        fcn->exists = 1;
+        fcn->updating = 0;
+        fcn->deleting = 0;
+        fcn->hot = 0;
+        fcn->tier = c->tier;
+        fcn->promote = 0;
+        fcn->moving = 0;
+        fcn->vary = 0;
+        fcn->uniq = 0;
+        fcn->valid_sec = 0;
+        fcn->body_start = 0;
+        fcn->fs_size = c->fs_size;
+
+        cache->sh->size += c->fs_size;
+        cache->sh->tier_size[c->tier] += c->fs_size;
+
+    } else {
+        ngx_queue_remove(&fcn->queue);
+
+        /* the file may have been replaced since the index was written */
+
+        fcn->uniq = 0;
+        fcn->body_start = 0;
 
-    if (fcn->exists) {
         cache->sh->size -= fcn->fs_size;
+        cache->sh->tier_size[fcn->tier] -= fcn->fs_size;
 
-        path = cache->path;
-        p = name + path->name.len + 1 + path->len;
-        p = ngx_hex_dump(p, (u_char *) &fcn->node.key,
-                         sizeof(ngx_rbtree_key_t));
-        len = NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t);
-        p = ngx_hex_dump(p, fcn->key, len);
-        *p = '\0';
+        if (fcn->tier != c->tier) {
 
-        fcn->count++;
-        fcn->deleting = 1;
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+            /*
+             * the file has been moved to another tier since the index
+             * was written, or the manager was interrupted while moving it:
+             * the copy found last is kept
+             */
+
+            name = ngx_alloc(cache->name_len + 1 + cache->path->len
+                             + 2 * NGX_HTTP_CACHE_KEY_LEN + 1, ngx_cycle->log);
+
+            if (name) {
+                ngx_http_file_cache_node_name(cache, fcn, fcn->tier, name);
+            }
+
+            fcn->tier = c->tier;
+        }
+
+        fcn->fs_size = c->fs_size;
+
+        cache->sh->size += c->fs_size;
+        cache->sh->tier_size[c->tier] += c->fs_size;
+    }
 
-        len = path->name.len + 1 + path->len + 2 * NGX_HTTP_CACHE_KEY_LEN;
-        ngx_create_hashed_filename(path, name, len);
+    fcn->expire = ngx_time() + cache->inactive;
+
+    ngx_http_file_cache_access(cache, fcn, 0);
+
+    ngx_shmtx_unlock(&cache->shpool->mutex);
 
+    if (name) {
         ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                       "http file cache expire: \"%s\"", name);
+                       "http file cache delete: \"%s\"", name);
 
         if (ngx_delete_file(name) == NGX_FILE_ERROR) {
-            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
-                          ngx_delete_file_n " \"%s\" failed", name);
+            err = ngx_errno;
+
+            if (err != NGX_ENOENT) {
+                ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                              ngx_delete_file_n " \"%s\" failed", name);
+            }
         }
 
-        ngx_shmtx_lock(&cache->shpool->mutex);
-        fcn->count--;
-        fcn->deleting = 0;
+        ngx_free(name);
     }
 
-    if (fcn->count == 0) {
-        ngx_queue_remove(q);
-        ngx_rbtree_delete(&cache->sh->rbtree, &fcn->node);
-        ngx_slab_free_locked(cache->shpool, fcn);
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_file_cache_delete_file(ngx_tree_ctx_t *ctx, ngx_str_t *path)
+{
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ctx->log, 0,
+                   "http file cache delete: \"%s\"", path->data);
+
+    if (ngx_delete_file(path->data) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ctx->log, ngx_errno,
+                      ngx_delete_file_n " \"%s\" failed", path->data);
     }
+
+    return NGX_OK;
 }
 
 
-static time_t
-ngx_http_file_cache_manager(void *data)
+static void
+ngx_http_file_cache_log_stats(ngx_http_file_cache_t *cache)
 {
-    ngx_http_file_cache_t  *cache = data;
+    ngx_uint_t  hits, misses, admitted, rejected, evicted, promoted, demoted,
+                purged;
 
-    off_t   size;
-    time_t  next, wait;
+    ngx_shmtx_lock(&cache->shpool->mutex);
 
-    next = ngx_http_file_cache_expire(cache);
+    hits = cache->sh->hits;
+    misses = cache->sh->misses;
+    admitted = cache->sh->admitted;
+    rejected = cache->sh->rejected;
+    evicted = cache->sh->evicted;
+    promoted = cache->sh->promoted;
+    demoted = cache->sh->demoted;
+    purged = cache->sh->purged;
 
-    cache->last = ngx_current_msec;
-    cache->files = 0;
+    ngx_shmtx_unlock(&cache->shpool->mutex);
+
+    ngx_log_error(NGX_LOG_INFO, ngx_cycle->log, 0,
+                  "http file cache \"%V\": hits:%ui misses:%ui ratio:%.3f "
+                  "admitted:%ui rejected:%ui evicted:%ui "
+                  "promoted:%ui demoted:%ui purged:%ui",
+                  &cache->shm_zone->shm.name, hits, misses,
+                  hits + misses ? (double) hits / (hits + misses) : 0.0,
+                  admitted, rejected, evicted, promoted, demoted, purged);
+}
+
+
+static void
+ngx_http_file_cache_write_index(ngx_http_file_cache_t *cache)
+{
+    u_char                               key[NGX_HTTP_CACHE_KEY_LEN];
+    ssize_t                              n;
+    ngx_fd_t                             fd;
+    ngx_uint_t                           i, first;
+    ngx_file_t                           file;
+    ngx_rbtree_node_t                   *node;
+    ngx_http_file_cache_node_t          *fcn;
+    ngx_http_file_cache_index_entry_t   *entries;
+    ngx_http_file_cache_index_header_t   h;
+
+    entries = ngx_alloc(NGX_HTTP_FILE_CACHE_INDEX_BATCH
+                        * sizeof(ngx_http_file_cache_index_entry_t),
+                        ngx_cycle->log);
+    if (entries == NULL) {
+        return;
+    }
+
+    fd = ngx_open_file(cache->index_temp.data, NGX_FILE_WRONLY,
+                       NGX_FILE_TRUNCATE, NGX_FILE_DEFAULT_ACCESS);
+
+    if (fd == NGX_INVALID_FILE) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_open_file_n " \"%s\" failed",
+                      cache->index_temp.data);
+        ngx_free(entries);
+        return;
+    }
+
+    ngx_memzero(&file, sizeof(ngx_file_t));
+
+    file.fd = fd;
+    file.name = cache->index_temp;
+    file.log = ngx_cycle->log;
+
+    ngx_memzero(&h, sizeof(ngx_http_file_cache_index_header_t));
+
+    h.magic = NGX_HTTP_FILE_CACHE_INDEX_MAGIC;
+    h.version = NGX_HTTP_CACHE_VERSION;
+    h.entry_size = sizeof(ngx_http_file_cache_index_entry_t);
+    h.level[0] = cache->path->level[0];
+    h.level[1] = cache->path->level[1];
+    h.level[2] = cache->path->level[2];
+    h.tiers = cache->ntiers;
+    h.bsize = cache->bsize;
+
+    /*
+     * the loader walks only the directories changed after this time,
+     * so it is taken before the tree is traversed
+     */
+
+    h.time = ngx_time();
+
+    file.offset = sizeof(ngx_http_file_cache_index_header_t);
+    first = 1;
+
+    /*
+     * the tree is copied in batches to not block workers for long,
+     * each batch restarts from the last key seen as the node
+     * itself may be freed while the mutex is released
+     */
+
+    do {
+        i = 0;
 
-    for ( ;; ) {
         ngx_shmtx_lock(&cache->shpool->mutex);
 
-        size = cache->sh->size;
+        node = ngx_http_file_cache_index_next(cache, first ? NULL : key);
 
-        ngx_shmtx_unlock(&cache->shpool->mutex);
+        while (node && i < NGX_HTTP_FILE_CACHE_INDEX_BATCH) {
 
-        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                       "http file cache size: %O", size);
+            fcn = (ngx_http_file_cache_node_t *) node;
 
-        if (size < cache->max_size) {
-            return next;
+            ngx_memcpy(key, &node->key, sizeof(ngx_rbtree_key_t));
+            ngx_memcpy(&key[sizeof(ngx_rbtree_key_t)], fcn->key,
+                       NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+            if (fcn->exists && !fcn->deleting) {
+                ngx_memcpy(entries[i].key, key, NGX_HTTP_CACHE_KEY_LEN);
+                entries[i].uniq = fcn->uniq;
+                entries[i].fs_size = fcn->fs_size;
+                entries[i].body_start = fcn->body_start;
+                entries[i].tier = fcn->tier;
+                entries[i].vary = fcn->vary;
+                i++;
+            }
+
+            node = ngx_http_file_cache_index_successor(&cache->sh->rbtree,
+                                                       node);
         }
 
-        wait = ngx_http_file_cache_forced_expire(cache);
+        ngx_shmtx_unlock(&cache->shpool->mutex);
 
-        if (wait > 0) {
-            return wait;
+        first = 0;
+
+        if (i) {
+            n = ngx_write_file(&file, (u_char *) entries,
+                           i * sizeof(ngx_http_file_cache_index_entry_t),
+                           file.offset);
+            if (n == NGX_ERROR) {
+                goto failed;
+            }
+
+            h.entries += i;
         }
 
         if (ngx_quit || ngx_terminate) {
-            return next;
+            goto failed;
         }
-    }
-}
-
 
-static void
-ngx_http_file_cache_loader(void *data)
-{
-    ngx_http_file_cache_t  *cache = data;
+    } while (node);
 
-    ngx_tree_ctx_t  tree;
+    if (ngx_write_file(&file, (u_char *) &h,
+                       sizeof(ngx_http_file_cache_index_header_t), 0)
+        == NGX_ERROR)
+    {
+        goto failed;
+    }
 
-    if (!cache->sh->cold || cache->sh->loading) {
-        return;
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed",
+                      cache->index_temp.data);
     }
 
-    if (!ngx_atomic_cmp_set(&cache->sh->loading, 0, ngx_pid)) {
-        return;
+    ngx_free(entries);
+
+    if (ngx_rename_file(cache->index_temp.data, cache->index.data)
+        == NGX_FILE_ERROR)
+    {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_rename_file_n " \"%s\" to \"%s\" failed",
+                      cache->index_temp.data, cache->index.data);
+        goto delete;
     }
 
-    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                   "http file cache loader");
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
+                   "http file cache index: \"%V\" %ui entries",
+                   &cache->index, h.entries);
 
-    tree.init_handler = NULL;
-    tree.file_handler = ngx_http_file_cache_manage_file;
-    tree.pre_tree_handler = ngx_http_file_cache_noop;
-    tree.post_tree_handler = ngx_http_file_cache_noop;
-    tree.spec_handler = ngx_http_file_cache_delete_file;
-    tree.data = cache;
-    tree.alloc = 0;
-    tree.log = ngx_cycle->log;
+    return;
 
-    cache->last = ngx_current_msec;
-    cache->files = 0;
+failed:
 
-    if (ngx_walk_tree(&tree, &cache->path->name) == NGX_ABORT) {
-        cache->sh->loading = 0;
-        return;
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed",
+                      cache->index_temp.data);
     }
 
-    cache->sh->cold = 0;
-    cache->sh->loading = 0;
+    ngx_free(entries);
 
-    ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
-                  "http file cache: %V %.3fM, bsize: %uz",
-                  &cache->path->name,
-                  ((double) cache->sh->size * cache->bsize) / (1024 * 1024),
-                  cache->bsize);
+delete:
+
+    if (ngx_delete_file(cache->index_temp.data) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_delete_file_n " \"%s\" failed",
+                      cache->index_temp.data);
+    }
 }
 
 
-static ngx_int_t
-ngx_http_file_cache_loader_sleep(ngx_http_file_cache_t *cache)
+static ngx_rbtree_node_t *
+ngx_http_file_cache_index_next(ngx_http_file_cache_t *cache, u_char *key)
 {
-    ngx_msec_t  elapsed;
+    ngx_int_t                    rc;
+    ngx_rbtree_key_t             node_key;
+    ngx_rbtree_node_t           *node, *sentinel, *next;
+    ngx_http_file_cache_node_t  *fcn;
 
-    if (cache->files++ > 100) {
+    /* the first node with a key greater than the given one */
 
-        ngx_time_update();
+    node = cache->sh->rbtree.root;
+    sentinel = cache->sh->rbtree.sentinel;
 
-        elapsed = ngx_abs((ngx_msec_int_t) (ngx_current_msec - cache->last));
+    if (node == sentinel) {
+        return NULL;
+    }
 
-        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ngx_cycle->log, 0,
-                       "http file cache manager time: %M", elapsed);
+    if (key == NULL) {
+        while (node->left != sentinel) {
+            node = node->left;
+        }
 
-        if (elapsed > 200) {
+        return node;
+    }
 
-            /*
-             * if processing 100 files takes more than 200ms,
-             * it seems that many operations require disk i/o,
-             * therefore sleep 200ms
-             */
+    ngx_memcpy((u_char *) &node_key, key, sizeof(ngx_rbtree_key_t));
 
-            ngx_msleep(200);
+    next = NULL;
 
-            ngx_time_update();
+    while (node != sentinel) {
+
+        if (node_key != node->key) {
+            rc = (node_key < node->key) ? -1 : 1;
+
+        } else {
+            fcn = (ngx_http_file_cache_node_t *) node;
+
+            rc = ngx_memcmp(&key[sizeof(ngx_rbtree_key_t)], fcn->key,
+                            NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
         }
 
-        cache->last = ngx_current_msec;
-        cache->files = 0;
+        if (rc < 0) {
+            next = node;
+            node = node->left;
+
+        } else {
+            node = node->right;
+        }
     }
 
-    return (ngx_quit || ngx_terminate) ? NGX_ABORT : NGX_OK;
+    return next;
 }
 
 
-static ngx_int_t
-ngx_http_file_cache_noop(ngx_tree_ctx_t *ctx, ngx_str_t *path)
+static ngx_rbtree_node_t *
+ngx_http_file_cache_index_successor(ngx_rbtree_t *tree,
+    ngx_rbtree_node_t *node)
 {
-    return NGX_OK;
-}
+    ngx_rbtree_node_t  *sentinel, *parent;
 
+    sentinel = tree->sentinel;
 
-static ngx_int_t
-ngx_http_file_cache_manage_file(ngx_tree_ctx_t *ctx, ngx_str_t *path)
-{
-    ngx_http_file_cache_t  *cache;
+    if (node->right != sentinel) {
+        node = node->right;
+
+        while (node->left != sentinel) {
+            node = node->left;
+        }
+
+        return node;
+    }
+
+    for ( ;; ) {
+
+        if (node == tree->root) {
+            return NULL;
+        }
+
+        parent = node->parent;
 
-    cache = ctx->data;
+        if (node == parent->left) {
+            return parent;
+        }
 
-    if (ngx_http_file_cache_add_file(ctx, path) != NGX_OK) {
-        (void) ngx_http_file_cache_delete_file(ctx, path);
+        node = parent;
     }
-
-    return ngx_http_file_cache_loader_sleep(cache);
 }
 
 
 static ngx_int_t
-ngx_http_file_cache_add_file(ngx_tree_ctx_t *ctx, ngx_str_t *name)
+ngx_http_file_cache_load_index(ngx_http_file_cache_t *cache)
 {
-    u_char                 *p;
-    ngx_int_t               n;
-    ngx_uint_t              i;
-    ngx_http_cache_t        c;
-    ngx_http_file_cache_t  *cache;
+    u_char                              *p;
+    size_t                               size;
+    ngx_fd_t                             fd;
+    ngx_int_t                            rc;
+    ngx_err_t                            err;
+    ngx_uint_t                           i, n;
+    ngx_file_info_t                      fi;
+    ngx_http_file_cache_node_t          *fcn;
+    ngx_http_file_cache_index_entry_t   *e;
+    ngx_http_file_cache_index_header_t  *h;
+
+    fd = ngx_open_file(cache->index.data, NGX_FILE_RDONLY, NGX_FILE_OPEN, 0);
+
+    if (fd == NGX_INVALID_FILE) {
+        err = ngx_errno;
+
+        if (err != NGX_ENOENT) {
+            ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, err,
+                          ngx_open_file_n " \"%s\" failed",
+                          cache->index.data);
+        }
 
-    if (name->len < 2 * NGX_HTTP_CACHE_KEY_LEN) {
-        return NGX_ERROR;
+        return NGX_DECLINED;
     }
 
-    if (ctx->size < (off_t) sizeof(ngx_http_file_cache_header_t)) {
-        ngx_log_error(NGX_LOG_CRIT, ctx->log, 0,
-                      "cache file \"%s\" is too small", name->data);
-        return NGX_ERROR;
+    rc = NGX_DECLINED;
+    p = MAP_FAILED;
+    size = 0;
+
+    if (ngx_fd_info(fd, &fi) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      ngx_fd_info_n " \"%s\" failed", cache->index.data);
+        goto done;
     }
 
-    ngx_memzero(&c, sizeof(ngx_http_cache_t));
-    cache = ctx->data;
+    size = (size_t) ngx_file_size(&fi);
 
-    c.length = ctx->size;
-    c.fs_size = (ctx->fs_size + cache->bsize - 1) / cache->bsize;
+    if (size < sizeof(ngx_http_file_cache_index_header_t)) {
+        goto invalid;
+    }
 
-    p = &name->data[name->len - 2 * NGX_HTTP_CACHE_KEY_LEN];
+    p = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
 
-    for (i = 0; i < NGX_HTTP_CACHE_KEY_LEN; i++) {
-        n = ngx_hextoi(p, 2);
+    if (p == MAP_FAILED) {
+        ngx_log_error(NGX_LOG_CRIT, ngx_cycle->log, ngx_errno,
+                      "mmap(\"%s\") failed", cache->index.data);
+        goto done;
+    }
 
-        if (n == NGX_ERROR) {
-            return NGX_ERROR;
-        }
+    h = (ngx_http_file_cache_index_header_t *) p;
+
+    if (h->magic != NGX_HTTP_FILE_CACHE_INDEX_MAGIC
+        || h->version != NGX_HTTP_CACHE_VERSION
+        || h->entry_size != sizeof(ngx_http_file_cache_index_entry_t)
+        || h->level[0] != cache->path->level[0]
+        || h->level[1] != cache->path->level[1]
+        || h->level[2] != cache->path->level[2]
+        || h->tiers != cache->ntiers
+        || h->bsize != cache->bsize
+        || size != sizeof(ngx_http_file_cache_index_header_t)
+                   + h->entries * sizeof(ngx_http_file_cache_index_entry_t))
+    {
+        goto invalid;
+    }
 
-        p += 2;
+    e = (ngx_http_file_cache_index_entry_t *)
+            (p + sizeof(ngx_http_file_cache_index_header_t));
 
-        c.key[i] = (u_char) n;
-    }
+    for (i = 0; i < h->entries; /* void */) {
 
-    return ngx_http_file_cache_add(cache, &c);
-}
+        ngx_shmtx_lock(&cache->shpool->mutex);
 
+        for (n = 0; n < NGX_HTTP_FILE_CACHE_INDEX_BATCH && i < h->entries;
+             n++, i++)
+        {
+            fcn = ngx_http_file_cache_lookup(cache, e[i].key);
 
-static ngx_int_t
-ngx_http_file_cache_add(ngx_http_file_cache_t *cache, ngx_http_cache_t *c)
-{
-    ngx_http_file_cache_node_t  *fcn;
+            if (fcn) {
+                continue;
+            }
 
-    ngx_shmtx_lock(&cache->shpool->mutex);
+            fcn = ngx_slab_alloc_locked(cache->shpool,
+                                        sizeof(ngx_http_file_cache_node_t));
+            if (fcn == NULL) {
+                ngx_shmtx_unlock(&cache->shpool->mutex);
 
-    fcn = ngx_http_file_cache_lookup(cache, c->key);
+                /*
+                 * the index cannot be used partially, as the directories
+                 * it covers are not walked; the walk will add what fits
+                 */
 
-    if (fcn == NULL) {
+                ngx_log_error(NGX_LOG_WARN, ngx_cycle->log, 0,
+                              "http file cache index \"%V\" does not fit "
+                              "in keys zone", &cache->index);
+                goto done;
+            }
 
-        fcn = ngx_slab_alloc_locked(cache->shpool,
-                                    sizeof(ngx_http_file_cache_node_t));
-        if (fcn == NULL) {
-            ngx_shmtx_unlock(&cache->shpool->mutex);
-            return NGX_ERROR;
+            ngx_memcpy((u_char *) &fcn->node.key, e[i].key,
+                       sizeof(ngx_rbtree_key_t));
+
+            ngx_memcpy(fcn->key, &e[i].key[sizeof(ngx_rbtree_key_t)],
+                       NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+
+            ngx_rbtree_insert(&cache->sh->rbtree, &fcn->node);
+
+            fcn->uses = 1;
+            fcn->count = 0;
+            fcn->valid_msec = 0;
+            fcn->error = 0;
+            fcn->exists = 1;
+            fcn->updating = 0;
+            fcn->deleting = 0;
+            fcn->hot = 0;
+            fcn->tier = e[i].tier;
+            fcn->promote = 0;
+            fcn->moving = 0;
+            fcn->vary = e[i].vary;
+            fcn->uniq = e[i].uniq;
+            fcn->valid_sec = 0;
+            fcn->body_start = e[i].body_start;
+            fcn->fs_size = e[i].fs_size;
+            fcn->expire = ngx_time() + cache->inactive;
+
+            cache->sh->size += fcn->fs_size;
+            cache->sh->tier_size[fcn->tier] += fcn->fs_size;
+
+            ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
         }
 
-        ngx_memcpy((u_char *) &fcn->node.key, c->key, sizeof(ngx_rbtree_key_t));
+        ngx_shmtx_unlock(&cache->shpool->mutex);
 
-        ngx_memcpy(fcn->key, &c->key[sizeof(ngx_rbtree_key_t)],
-                   NGX_HTTP_CACHE_KEY_LEN - sizeof(ngx_rbtree_key_t));
+        if (ngx_quit || ngx_terminate) {
+            rc = NGX_ABORT;
+            goto done;
+        }
+    }
 
-        ngx_rbtree_insert(&cache->sh->rbtree, &fcn->node);
+    cache->index_time = h->time;
 
-        fcn->uses = 1;
-        fcn->count = 0;
-        fcn->valid_msec = 0;
-        fcn->error = 0;
-        fcn->exists = 1;
-        fcn->updating = 0;
-        fcn->deleting = 0;
-        fcn->uniq = 0;
-        fcn->valid_sec = 0;
-        fcn->body_start = 0;
-        fcn->fs_size = c->fs_size;
+    ngx_log_error(NGX_LOG_NOTICE, ngx_cycle->log, 0,
+                  "http file cache index: \"%V\" %ui entries",
+                  &cache->index, h->entries);
 
-        cache->sh->size += c->fs_size;
+    rc = NGX_OK;
 
-    } else {
-        ngx_queue_remove(&fcn->queue);
-    }
+    goto done;
 
-    fcn->expire = ngx_time() + cache->inactive;
+invalid:
 
-    ngx_queue_insert_head(&cache->sh->queue, &fcn->queue);
+    ngx_log_error(NGX_LOG_WARN, ngx_cycle->log, 0,
+                  "http file cache index \"%V\" is invalid, ignored",
+                  &cache->index);
 
-    ngx_shmtx_unlock(&cache->shpool->mutex);
+done:
 
-    return NGX_OK;
+    if (p != MAP_FAILED) {
+        if (munmap(p, size) == -1) {
+            ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                          "munmap(\"%s\") failed", cache->index.data);
+        }
+    }
+
+    if (ngx_close_file(fd) == NGX_FILE_ERROR) {
+        ngx_log_error(NGX_LOG_ALERT, ngx_cycle->log, ngx_errno,
+                      ngx_close_file_n " \"%s\" failed", cache->index.data);
+    }
+
+    return rc;
 }
 
 
 static ngx_int_t
-ngx_http_file_cache_delete_file(ngx_tree_ctx_t *ctx, ngx_str_t *path)
+ngx_http_file_cache_skip_dir(ngx_tree_ctx_t *ctx, ngx_str_t *path)
 {
-    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ctx->log, 0,
-                   "http file cache delete: \"%s\"", path->data);
+    ngx_http_file_cache_t  *cache;
 
-    if (ngx_delete_file(path->data) == NGX_FILE_ERROR) {
-        ngx_log_error(NGX_LOG_CRIT, ctx->log, ngx_errno,
-                      ngx_delete_file_n " \"%s\" failed", path->data);
+    cache = ctx->data;
+
+    /*
+     * a leaf directory not modified since the index was written
+     * cannot contain files missing from the index
+     */
+
+    if (path->len == cache->tiers[cache->walk_tier].path->name.len
+                     + cache->path->len
+        && ctx->mtime < cache->index_time)
+    {
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, ctx->log, 0,
+                       "http file cache skip: \"%s\"", path->data);
+
+        return NGX_DECLINED;
     }
 
     return NGX_OK;
@@ -1465,10 +4544,12 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
 {
     off_t                   max_size;
     u_char                 *last, *p;
-    time_t                  inactive;
-    ssize_t                 size;
+    time_t                  inactive, index_interval;
+    ssize_t                 size, mem_size, mem_max;
+    ngx_int_t               weight, promote;
     ngx_str_t               s, name, *value;
-    ngx_uint_t              i, n;
+    ngx_uint_t              i, n, total;
+    ngx_path_t             *path;
     ngx_http_file_cache_t  *cache;
 
     cache = ngx_pcalloc(cf->pool, sizeof(ngx_http_file_cache_t));
@@ -1482,10 +4563,15 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     }
 
     inactive = 600;
+    index_interval = 600;
 
     name.len = 0;
     size = 0;
     max_size = NGX_MAX_OFF_T_VALUE;
+    mem_size = 0;
+    mem_max = 16384;
+    weight = 1;
+    promote = 2;
 
     value = cf->args->elts;
 
@@ -1595,6 +4681,163 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
             continue;
         }
 
+        if (ngx_strncmp(value[i].data, "policy=", 7) == 0) {
+
+            if (ngx_strcmp(&value[i].data[7], "lru") == 0) {
+                cache->policy = NGX_HTTP_CACHE_POLICY_LRU;
+                continue;
+            }
+
+            if (ngx_strcmp(&value[i].data[7], "tinylfu") == 0) {
+                cache->policy = NGX_HTTP_CACHE_POLICY_TINYLFU;
+                continue;
+            }
+
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "invalid policy \"%V\"", &value[i]);
+            return NGX_CONF_ERROR;
+        }
+
+        if (ngx_strncmp(value[i].data, "index=", 6) == 0) {
+
+            cache->index.len = value[i].len - 6;
+            cache->index.data = value[i].data + 6;
+
+            if (ngx_conf_full_name(cf->cycle, &cache->index, 0) != NGX_OK) {
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "index_interval=", 15) == 0) {
+
+            s.len = value[i].len - 15;
+            s.data = value[i].data + 15;
+
+            index_interval = ngx_parse_time(&s, 1);
+            if (index_interval <= 0) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid index_interval value \"%V\"",
+                                   &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "memory=", 7) == 0) {
+
+            s.len = value[i].len - 7;
+            s.data = value[i].data + 7;
+
+            mem_size = ngx_parse_size(&s);
+            if (mem_size > 8191) {
+                continue;
+            }
+
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "invalid memory zone size \"%V\"", &value[i]);
+            return NGX_CONF_ERROR;
+        }
+
+        if (ngx_strncmp(value[i].data, "memory_max=", 11) == 0) {
+
+            s.len = value[i].len - 11;
+            s.data = value[i].data + 11;
+
+            mem_max = ngx_parse_size(&s);
+            if (mem_max <= 0) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid memory_max value \"%V\"",
+                                   &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "tier=", 5) == 0) {
+
+            if (cache->ntiers == NGX_HTTP_CACHE_TIERS - 1) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "too many tiers");
+                return NGX_CONF_ERROR;
+            }
+
+            path = ngx_pcalloc(cf->pool, sizeof(ngx_path_t));
+            if (path == NULL) {
+                return NGX_CONF_ERROR;
+            }
+
+            path->name.data = value[i].data + 5;
+            path->name.len = value[i].len - 5;
+
+            n = 1;
+
+            p = (u_char *) ngx_strchr(path->name.data, ':');
+
+            if (p) {
+                *p++ = '\0';
+
+                n = ngx_atoi(p, value[i].data + value[i].len - p);
+                if (n == (ngx_uint_t) NGX_ERROR || n == 0) {
+                    ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                       "invalid tier weight \"%V\"",
+                                       &value[i]);
+                    return NGX_CONF_ERROR;
+                }
+
+                path->name.len = p - 1 - path->name.data;
+            }
+
+            if (path->name.len && path->name.data[path->name.len - 1] == '/')
+            {
+                path->name.len--;
+            }
+
+            if (path->name.len == 0) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid tier \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            if (ngx_conf_full_name(cf->cycle, &path->name, 0) != NGX_OK) {
+                return NGX_CONF_ERROR;
+            }
+
+            cache->ntiers++;
+            cache->tiers[cache->ntiers].path = path;
+            cache->tiers[cache->ntiers].weight = n;
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "weight=", 7) == 0) {
+
+            weight = ngx_atoi(value[i].data + 7, value[i].len - 7);
+            if (weight == NGX_ERROR || weight == 0) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid weight \"%V\"", &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
+        if (ngx_strncmp(value[i].data, "promote=", 8) == 0) {
+
+            promote = ngx_atoi(value[i].data + 8, value[i].len - 8);
+            if (promote == NGX_ERROR || promote == 0 || promote > 1000) {
+                ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                   "invalid promote value \"%V\"",
+                                   &value[i]);
+                return NGX_CONF_ERROR;
+            }
+
+            continue;
+        }
+
         ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
                            "invalid parameter \"%V\"", &value[i]);
         return NGX_CONF_ERROR;
@@ -1607,6 +4850,103 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
         return NGX_CONF_ERROR;
     }
 
+    if (cache->policy == NGX_HTTP_CACHE_POLICY_TINYLFU
+        && max_size == NGX_MAX_OFF_T_VALUE)
+    {
+        ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                           "\"policy=tinylfu\" requires "
+                           "the \"max_size\" parameter");
+        return NGX_CONF_ERROR;
+    }
+
+    /* the tiers following the cache path are counted from 1 */
+
+    cache->ntiers++;
+    cache->tiers[0].path = cache->path;
+    cache->tiers[0].weight = weight;
+    cache->tiers[0].max_size = max_size;
+
+    cache->name_len = cache->path->name.len;
+    cache->promote = promote;
+
+    if (cache->ntiers > 1) {
+
+        if (max_size == NGX_MAX_OFF_T_VALUE) {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "the \"tier\" parameter requires "
+                               "the \"max_size\" parameter");
+            return NGX_CONF_ERROR;
+        }
+
+        total = 0;
+
+        for (i = 0; i < cache->ntiers; i++) {
+            total += cache->tiers[i].weight;
+        }
+
+        for (i = 0; i < cache->ntiers; i++) {
+            path = cache->tiers[i].path;
+
+            for (n = 0; n < i; n++) {
+                if (ngx_strcmp(path->name.data,
+                               cache->tiers[n].path->name.data)
+                    == 0)
+                {
+                    ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                                       "duplicate tier \"%V\"", &path->name);
+                    return NGX_CONF_ERROR;
+                }
+            }
+
+            cache->tiers[i].max_size = max_size / total
+                                       * cache->tiers[i].weight;
+
+            if (path->name.len > cache->name_len) {
+                cache->name_len = path->name.len;
+            }
+
+            if (i == 0) {
+                continue;
+            }
+
+            path->len = cache->path->len;
+            ngx_memcpy(path->level, cache->path->level, sizeof(path->level));
+
+            path->conf_file = cf->conf_file->file.name.data;
+            path->line = cf->conf_file->line;
+
+            if (ngx_add_path(cf, &cache->tiers[i].path) != NGX_OK) {
+                return NGX_CONF_ERROR;
+            }
+        }
+    }
+
+    if (cache->index.len) {
+
+        /* the loader deletes any foreign file found in the cache */
+
+        if (cache->index.len > cache->path->name.len
+            && cache->index.data[cache->path->name.len] == '/'
+            && ngx_strncmp(cache->index.data, cache->path->name.data,
+                           cache->path->name.len)
+               == 0)
+        {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "cache index \"%V\" must not be inside "
+                               "the cache directory", &cache->index);
+            return NGX_CONF_ERROR;
+        }
+
+        cache->index_temp.len = cache->index.len + sizeof(".tmp") - 1;
+        cache->index_temp.data = ngx_pnalloc(cf->pool,
+                                             cache->index_temp.len + 1);
+        if (cache->index_temp.data == NULL) {
+            return NGX_CONF_ERROR;
+        }
+
+        ngx_sprintf(cache->index_temp.data, "%V.tmp%Z", &cache->index);
+    }
+
     cache->path->manager = ngx_http_file_cache_manager;
     cache->path->loader = ngx_http_file_cache_loader;
     cache->path->data = cache;
@@ -1632,8 +4972,35 @@ ngx_http_file_cache_set_slot(ngx_conf_t *cf, ngx_command_t *cmd, void *conf)
     cache->shm_zone->init = ngx_http_file_cache_init;
     cache->shm_zone->data = cache;
 
+    if (mem_size) {
+        s.len = name.len + sizeof(":memory") - 1;
+        s.data = ngx_pnalloc(cf->pool, s.len);
+        if (s.data == NULL) {
+            return NGX_CONF_ERROR;
+        }
+
+        ngx_sprintf(s.data, "%V:memory", &name);
+
+        cache->mem_zone = ngx_shared_memory_add(cf, &s, mem_size, cmd->post);
+        if (cache->mem_zone == NULL) {
+            return NGX_CONF_ERROR;
+        }
+
+        if (cache->mem_zone->data) {
+            ngx_conf_log_error(NGX_LOG_EMERG, cf, 0,
+                               "duplicate zone \"%V\"", &s);
+            return NGX_CONF_ERROR;
+        }
+
+        cache->mem_zone->init = ngx_http_file_cache_memory_init;
+        cache->mem_zone->data = cache;
+
+        cache->mem_max = mem_max;
+    }
+
     cache->inactive = inactive;
     cache->max_size = max_size;
+    cache->index_interval = index_interval;
 
     return NGX_CONF_OK;
 }
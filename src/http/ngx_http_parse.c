@@ -10,6 +10,31 @@
 #include <ngx_http.h>
 
 
+#if (NGX_HAVE_SSE42)
+
+#include <nmmintrin.h>
+
+
+static u_char *ngx_http_parse_skip(u_char *p, u_char *last, u_char *set,
+    int n) __attribute__ ((target ("sse4.2")));
+
+
+/* the characters that are not "usual" in URI, see below */
+
+#if (NGX_WIN32)
+static u_char  ngx_http_uri_delimiters[16] = "\0\n\r #%+./?\\";
+#define NGX_HTTP_URI_DELIMITERS    11
+#else
+static u_char  ngx_http_uri_delimiters[16] = "\0\n\r #%+./?";
+#define NGX_HTTP_URI_DELIMITERS    10
+#endif
+
+static u_char  ngx_http_value_delimiters[16] = "\0\n\r ";
+#define NGX_HTTP_VALUE_DELIMITERS  4
+
+#endif
+
+
 static uint32_t  usual[] = {
     0xffffdbfe, /* 1111 1111 1111 1111  1101 1011 1111 1110 */
 
@@ -477,6 +502,17 @@ ngx_http_parse_request_line(ngx_http_request_t *r, ngx_buf_t *b)
         /* check "/", "%" and "\" (Win32) in URI */
         case sw_check_uri:
 
+#if (NGX_HAVE_SSE42)
+            if (ngx_cpu_sse42 && b->last - p >= 16) {
+                m = ngx_http_parse_skip(p, b->last, ngx_http_uri_delimiters,
+                                        NGX_HTTP_URI_DELIMITERS);
+                if (m != p) {
+                    p = m - 1;
+                    break;
+                }
+            }
+#endif
+
             if (usual[ch >> 5] & (1 << (ch & 0x1f))) {
                 break;
             }
@@ -555,6 +591,17 @@ ngx_http_parse_request_line(ngx_http_request_t *r, ngx_buf_t *b)
         /* URI */
         case sw_uri:
 
+#if (NGX_HAVE_SSE42)
+            if (ngx_cpu_sse42 && b->last - p >= 16) {
+                m = ngx_http_parse_skip(p, b->last, ngx_http_uri_delimiters,
+                                        NGX_HTTP_URI_DELIMITERS);
+                if (m != p) {
+                    p = m - 1;
+                    break;
+                }
+            }
+#endif
+
             if (usual[ch >> 5] & (1 << (ch & 0x1f))) {
                 break;
             }
@@ -756,6 +803,9 @@ ngx_http_parse_header_line(ngx_http_request_t *r, ngx_buf_t *b,
     ngx_uint_t allow_underscores)
 {
     u_char      c, ch, *p;
+#if (NGX_HAVE_SSE42)
+    u_char     *m;
+#endif
     ngx_uint_t  hash, i;
     enum {
         sw_start = 0,
@@ -913,6 +963,18 @@ ngx_http_parse_header_line(ngx_http_request_t *r, ngx_buf_t *b,
 
         /* header value */
         case sw_value:
+
+#if (NGX_HAVE_SSE42)
+            if (ngx_cpu_sse42 && b->last - p >= 16) {
+                m = ngx_http_parse_skip(p, b->last, ngx_http_value_delimiters,
+                                        NGX_HTTP_VALUE_DELIMITERS);
+                if (m != p) {
+                    p = m - 1;
+                    break;
+                }
+            }
+#endif
+
             switch (ch) {
             case ' ':
                 r->header_end = p;
@@ -1007,6 +1069,42 @@ header_done:
 }
 
 
+#if (NGX_HAVE_SSE42)
+
+/*
+ * skips the characters handled by a state machine as is, 16 bytes at once;
+ * returns the first delimiter found or the tail shorter than 16 bytes
+ * that is left to the state machine
+ */
+
+static u_char *
+ngx_http_parse_skip(u_char *p, u_char *last, u_char *set, int n)
+{
+    int      i;
+    __m128i  delimiters, data;
+
+    delimiters = _mm_loadu_si128((__m128i *) set);
+
+    while (last - p >= 16) {
+        data = _mm_loadu_si128((__m128i *) p);
+
+        i = _mm_cmpestri(delimiters, n, data, 16,
+                         _SIDD_UBYTE_OPS|_SIDD_CMP_EQUAL_ANY
+                         |_SIDD_LEAST_SIGNIFICANT);
+
+        if (i != 16) {
+            return p + i;
+        }
+
+        p += 16;
+    }
+
+    return p;
+}
+
+#endif
+
+
 ngx_int_t
 ngx_http_parse_complex_uri(ngx_http_request_t *r, ngx_uint_t merge_slashes)
 {
@@ -1093,6 +1191,7 @@ ngx_http_parse_complex_uri(ngx_http_request_t *r, ngx_uint_t merge_slashes)
                 break;
             case '+':
                 r->plus_in_uri = 1;
+                /* fall through */
             default:
                 *u++ = ch;
                 break;
@@ -1135,6 +1234,7 @@ ngx_http_parse_complex_uri(ngx_http_request_t *r, ngx_uint_t merge_slashes)
                 goto done;
             case '+':
                 r->plus_in_uri = 1;
+                /* fall through */
             default:
                 state = sw_usual;
                 *u++ = ch;
@@ -1176,6 +1276,7 @@ ngx_http_parse_complex_uri(ngx_http_request_t *r, ngx_uint_t merge_slashes)
                 goto done;
             case '+':
                 r->plus_in_uri = 1;
+                /* fall through */
             default:
                 state = sw_usual;
                 *u++ = ch;
@@ -1223,6 +1324,7 @@ ngx_http_parse_complex_uri(ngx_http_request_t *r, ngx_uint_t merge_slashes)
                 goto done;
             case '+':
                 r->plus_in_uri = 1;
+                /* fall through */
             default:
                 state = sw_usual;
                 *u++ = ch;
@@ -1418,6 +1520,7 @@ ngx_http_parse_status_line(ngx_http_request_t *r, ngx_buf_t *b,
                 return NGX_ERROR;
             }
 
+            status->http_version = (ch - '0') * 1000;
             state = sw_major_digit;
             break;
 
@@ -1432,6 +1535,12 @@ ngx_http_parse_status_line(ngx_http_request_t *r, ngx_buf_t *b,
                 return NGX_ERROR;
             }
 
+            if (status->http_version > 99 * 1000) {
+                return NGX_ERROR;
+            }
+
+            status->http_version = status->http_version * 10
+                                   + (ch - '0') * 1000;
             break;
 
         /* the first digit of minor HTTP version */
@@ -1440,6 +1549,7 @@ ngx_http_parse_status_line(ngx_http_request_t *r, ngx_buf_t *b,
                 return NGX_ERROR;
             }
 
+            status->http_version += ch - '0';
             state = sw_minor_digit;
             break;
 
@@ -1454,6 +1564,12 @@ ngx_http_parse_status_line(ngx_http_request_t *r, ngx_buf_t *b,
                 return NGX_ERROR;
             }
 
+            if (status->http_version % 1000 > 99) {
+                return NGX_ERROR;
+            }
+
+            status->http_version += status->http_version % 1000 * 9
+                                    + ch - '0';
             break;
 
         /* HTTP status code */
@@ -1732,3 +1848,270 @@ ngx_http_split_args(ngx_http_request_t *r, ngx_str_t *uri, ngx_str_t *args)
         args->len = 0;
     }
 }
+
+
+ngx_int_t
+ngx_http_parse_chunked(ngx_http_request_t *r, ngx_buf_t *b,
+    ngx_http_chunked_t *ctx)
+{
+    u_char     *pos, ch, c;
+    ngx_int_t   rc;
+    enum {
+        sw_chunk_start = 0,
+        sw_chunk_size,
+        sw_chunk_extension,
+        sw_chunk_extension_almost_done,
+        sw_chunk_data,
+        sw_after_data,
+        sw_after_data_almost_done,
+        sw_last_chunk_extension,
+        sw_last_chunk_extension_almost_done,
+        sw_trailer,
+        sw_trailer_almost_done,
+        sw_trailer_header,
+        sw_trailer_header_almost_done
+    } state;
+
+    state = ctx->state;
+
+    if (state == sw_chunk_data && ctx->size == 0) {
+        state = sw_after_data;
+    }
+
+    rc = NGX_AGAIN;
+
+    for (pos = b->pos; pos < b->last; pos++) {
+
+        ch = *pos;
+
+        ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                       "http chunked byte: %02Xd s:%d", ch, state);
+
+        switch (state) {
+
+        case sw_chunk_start:
+            if (ch >= '0' && ch <= '9') {
+                state = sw_chunk_size;
+                ctx->size = ch - '0';
+                break;
+            }
+
+            c = (u_char) (ch | 0x20);
+
+            if (c >= 'a' && c <= 'f') {
+                state = sw_chunk_size;
+                ctx->size = c - 'a' + 10;
+                break;
+            }
+
+            goto invalid;
+
+        case sw_chunk_size:
+            if (ctx->size > NGX_MAX_OFF_T_VALUE / 16) {
+                goto invalid;
+            }
+
+            if (ch >= '0' && ch <= '9') {
+                ctx->size = ctx->size * 16 + (ch - '0');
+                break;
+            }
+
+            c = (u_char) (ch | 0x20);
+
+            if (c >= 'a' && c <= 'f') {
+                ctx->size = ctx->size * 16 + (c - 'a' + 10);
+                break;
+            }
+
+            if (ctx->size == 0) {
+
+                switch (ch) {
+                case CR:
+                    state = sw_last_chunk_extension_almost_done;
+                    break;
+                case LF:
+                    state = sw_trailer;
+                    break;
+                case ';':
+                case ' ':
+                case '\t':
+                    state = sw_last_chunk_extension;
+                    break;
+                default:
+                    goto invalid;
+                }
+
+                break;
+            }
+
+            switch (ch) {
+            case CR:
+                state = sw_chunk_extension_almost_done;
+                break;
+            case LF:
+                state = sw_chunk_data;
+                break;
+            case ';':
+            case ' ':
+            case '\t':
+                state = sw_chunk_extension;
+                break;
+            default:
+                goto invalid;
+            }
+
+            break;
+
+        case sw_chunk_extension:
+            switch (ch) {
+            case CR:
+                state = sw_chunk_extension_almost_done;
+                break;
+            case LF:
+                state = sw_chunk_data;
+            }
+            break;
+
+        case sw_chunk_extension_almost_done:
+            if (ch == LF) {
+                state = sw_chunk_data;
+                break;
+            }
+            goto invalid;
+
+        case sw_chunk_data:
+            rc = NGX_OK;
+            goto data;
+
+        case sw_after_data:
+            switch (ch) {
+            case CR:
+                state = sw_after_data_almost_done;
+                break;
+            case LF:
+                state = sw_chunk_start;
+            }
+            break;
+
+        case sw_after_data_almost_done:
+            if (ch == LF) {
+                state = sw_chunk_start;
+                break;
+            }
+            goto invalid;
+
+        case sw_last_chunk_extension:
+            switch (ch) {
+            case CR:
+                state = sw_last_chunk_extension_almost_done;
+                break;
+            case LF:
+                state = sw_trailer;
+            }
+            break;
+
+        case sw_last_chunk_extension_almost_done:
+            if (ch == LF) {
+                state = sw_trailer;
+                break;
+            }
+            goto invalid;
+
+        case sw_trailer:
+            switch (ch) {
+            case CR:
+                state = sw_trailer_almost_done;
+                break;
+            case LF:
+                goto done;
+            default:
+                state = sw_trailer_header;
+            }
+            break;
+
+        case sw_trailer_almost_done:
+            if (ch == LF) {
+                goto done;
+            }
+            goto invalid;
+
+        case sw_trailer_header:
+            switch (ch) {
+            case CR:
+                state = sw_trailer_header_almost_done;
+                break;
+            case LF:
+                state = sw_trailer;
+            }
+            break;
+
+        case sw_trailer_header_almost_done:
+            if (ch == LF) {
+                state = sw_trailer;
+                break;
+            }
+            goto invalid;
+
+        }
+    }
+
+data:
+
+    ctx->state = state;
+    b->pos = pos;
+
+    if (ctx->size > NGX_MAX_OFF_T_VALUE - 5) {
+        goto invalid;
+    }
+
+    /* the minimal number of bytes still expected from an upstream */
+
+    switch (state) {
+
+    case sw_chunk_start:
+        ctx->length = 3 /* "0" LF LF */;
+        break;
+    case sw_chunk_size:
+        ctx->length = 1 /* LF */
+                      + (ctx->size ? ctx->size + 4 /* LF "0" LF LF */
+                                   : 1 /* LF */);
+        break;
+    case sw_chunk_extension:
+    case sw_chunk_extension_almost_done:
+        ctx->length = 1 /* LF */ + ctx->size + 4 /* LF "0" LF LF */;
+        break;
+    case sw_chunk_data:
+        ctx->length = ctx->size + 4 /* LF "0" LF LF */;
+        break;
+    case sw_after_data:
+    case sw_after_data_almost_done:
+        ctx->length = 4 /* LF "0" LF LF */;
+        break;
+    case sw_last_chunk_extension:
+    case sw_last_chunk_extension_almost_done:
+        ctx->length = 2 /* LF LF */;
+        break;
+    case sw_trailer:
+    case sw_trailer_almost_done:
+        ctx->length = 1 /* LF */;
+        break;
+    case sw_trailer_header:
+    case sw_trailer_header_almost_done:
+        ctx->length = 2 /* LF LF */;
+        break;
+
+    }
+
+    return rc;
+
+done:
+
+    ctx->state = 0;
+    b->pos = pos + 1;
+
+    return NGX_DONE;
+
+invalid:
+
+    return NGX_ERROR;
+}
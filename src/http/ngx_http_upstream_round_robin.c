@@ -10,6 +10,20 @@
 #include <ngx_http.h>
 
 
+/*
+ * An array of the per-peer state is used by the workers of one
+ * configuration.  As the workers of the previous configurations can run
+ * for long after a reload, e.g. serving long downloads, their arrays are
+ * not reused: each configuration allocates its own array, and an array
+ * is freed by a later reload once all workers holding it have exited.
+ */
+
+typedef struct {
+    ngx_queue_t                     queue;
+    ngx_uint_t                      refs;
+} ngx_http_upstream_rr_zone_conf_t;
+
+
 static ngx_int_t ngx_http_upstream_cmp_servers(const void *one,
     const void *two);
 static ngx_uint_t
@@ -75,6 +89,10 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
                 peers->peer[n].down = server[i].down;
                 peers->peer[n].weight = server[i].down ? 0 : server[i].weight;
                 peers->peer[n].current_weight = peers->peer[n].weight;
+#if (NGX_HTTP_UPSTREAM_CHECK)
+                peers->peer[n].check_index = ngx_http_upstream_check_add_peer(
+                                                cf, us, &server[i].addrs[j]);
+#endif
                 n++;
             }
         }
@@ -128,6 +146,10 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
                 backup->peer[n].max_fails = server[i].max_fails;
                 backup->peer[n].fail_timeout = server[i].fail_timeout;
                 backup->peer[n].down = server[i].down;
+#if (NGX_HTTP_UPSTREAM_CHECK)
+                backup->peer[n].check_index = ngx_http_upstream_check_add_peer(
+                                                cf, us, &server[i].addrs[j]);
+#endif
                 n++;
             }
         }
@@ -186,6 +208,9 @@ ngx_http_upstream_init_round_robin(ngx_conf_t *cf,
         peers->peer[i].current_weight = 1;
         peers->peer[i].max_fails = 1;
         peers->peer[i].fail_timeout = 10;
+#if (NGX_HTTP_UPSTREAM_CHECK)
+        peers->peer[i].check_index = (ngx_uint_t) NGX_ERROR;
+#endif
     }
 
     us->peer.data = peers;
@@ -302,6 +327,9 @@ ngx_http_upstream_create_round_robin_peer(ngx_http_request_t *r,
         peers->peer[0].current_weight = 1;
         peers->peer[0].max_fails = 1;
         peers->peer[0].fail_timeout = 10;
+#if (NGX_HTTP_UPSTREAM_CHECK)
+        peers->peer[0].check_index = (ngx_uint_t) NGX_ERROR;
+#endif
 
     } else {
 
@@ -334,6 +362,9 @@ ngx_http_upstream_create_round_robin_peer(ngx_http_request_t *r,
             peers->peer[i].current_weight = 1;
             peers->peer[i].max_fails = 1;
             peers->peer[i].fail_timeout = 10;
+#if (NGX_HTTP_UPSTREAM_CHECK)
+            peers->peer[i].check_index = (ngx_uint_t) NGX_ERROR;
+#endif
         }
     }
 
@@ -438,13 +469,16 @@ ngx_http_upstream_get_round_robin_peer(ngx_peer_connection_t *pc, void *data)
 
                     if (!peer->down) {
 
-                        if (peer->max_fails == 0
-                            || peer->fails < peer->max_fails)
+                        if ((peer->max_fails == 0
+                             || peer->fails < peer->max_fails)
+                            && ngx_http_upstream_rr_peer_alive(peer))
                         {
                             break;
                         }
 
-                        if (now - peer->accessed > peer->fail_timeout) {
+                        if (now - peer->accessed > peer->fail_timeout
+                            && ngx_http_upstream_rr_peer_alive(peer))
+                        {
                             peer->fails = 0;
                             break;
                         }
@@ -486,13 +520,16 @@ ngx_http_upstream_get_round_robin_peer(ngx_peer_connection_t *pc, void *data)
 
                     if (!peer->down) {
 
-                        if (peer->max_fails == 0
-                            || peer->fails < peer->max_fails)
+                        if ((peer->max_fails == 0
+                             || peer->fails < peer->max_fails)
+                            && ngx_http_upstream_rr_peer_alive(peer))
                         {
                             break;
                         }
 
-                        if (now - peer->accessed > peer->fail_timeout) {
+                        if (now - peer->accessed > peer->fail_timeout
+                            && ngx_http_upstream_rr_peer_alive(peer))
+                        {
                             peer->fails = 0;
                             break;
                         }
@@ -789,3 +826,111 @@ ngx_http_upstream_empty_save_session(ngx_peer_connection_t *pc, void *data)
 }
 
 #endif
+
+
+void *
+ngx_http_upstream_rr_zone_alloc(ngx_shm_zone_t *shm_zone, void *data,
+    size_t size, void **prev)
+{
+    ngx_uint_t                         n;
+    ngx_queue_t                       *confs, *q, *next;
+    ngx_slab_pool_t                   *shpool;
+    ngx_http_upstream_rr_zone_conf_t  *zc, *last;
+
+    shpool = (ngx_slab_pool_t *) shm_zone->shm.addr;
+
+    ngx_shmtx_lock(&shpool->mutex);
+
+    if (data || shm_zone->shm.exists) {
+        confs = shpool->data;
+
+    } else {
+        confs = ngx_slab_alloc_locked(shpool, sizeof(ngx_queue_t));
+        if (confs == NULL) {
+            ngx_shmtx_unlock(&shpool->mutex);
+            return NULL;
+        }
+
+        ngx_queue_init(confs);
+
+        shpool->data = confs;
+    }
+
+    /* the array of the running configuration is the most recent one */
+
+    if (ngx_queue_empty(confs)) {
+        last = NULL;
+        *prev = NULL;
+
+    } else {
+        last = ngx_queue_data(ngx_queue_head(confs),
+                              ngx_http_upstream_rr_zone_conf_t, queue);
+        *prev = (u_char *) last + sizeof(ngx_http_upstream_rr_zone_conf_t);
+    }
+
+    /*
+     * the worker processes hold their arrays, so the arrays are freed
+     * by the master process only: in the single process mode the arrays
+     * of the previous configurations may still be in use and are kept
+     */
+
+    n = 0;
+
+    for (q = ngx_queue_head(confs);
+         q != ngx_queue_sentinel(confs);
+         q = next)
+    {
+        next = ngx_queue_next(q);
+
+        zc = ngx_queue_data(q, ngx_http_upstream_rr_zone_conf_t, queue);
+
+        if (zc != last && zc->refs == 0
+            && ngx_process == NGX_PROCESS_MASTER)
+        {
+            ngx_queue_remove(q);
+            ngx_slab_free_locked(shpool, zc);
+            continue;
+        }
+
+        n++;
+    }
+
+    zc = ngx_slab_alloc_locked(shpool,
+                               sizeof(ngx_http_upstream_rr_zone_conf_t) + size);
+
+    if (zc == NULL) {
+        ngx_shmtx_unlock(&shpool->mutex);
+
+        ngx_log_error(NGX_LOG_EMERG, shm_zone->shm.log, 0,
+                      "could not allocate peers in \"%V\" zone, "
+                      "the workers of %ui configurations are still running",
+                      &shm_zone->shm.name, n);
+        return NULL;
+    }
+
+    zc->refs = 0;
+    ngx_queue_insert_head(confs, &zc->queue);
+
+    ngx_shmtx_unlock(&shpool->mutex);
+
+    zc++;
+
+    ngx_memzero(zc, size);
+
+    return zc;
+}
+
+
+void
+ngx_http_upstream_rr_zone_hold(ngx_slab_pool_t *shpool, void *p, ngx_int_t n)
+{
+    ngx_http_upstream_rr_zone_conf_t  *zc;
+
+    zc = (ngx_http_upstream_rr_zone_conf_t *) p - 1;
+
+    ngx_shmtx_lock(&shpool->mutex);
+
+    zc->refs += n;
+
+    ngx_shmtx_unlock(&shpool->mutex);
+}
@@ -30,12 +30,24 @@ typedef struct {
 
     ngx_uint_t                      down;          /* unsigned  down:1; */
 
+#if (NGX_HTTP_UPSTREAM_CHECK)
+    ngx_uint_t                      check_index;
+#endif
+
 #if (NGX_HTTP_SSL)
     ngx_ssl_session_t              *ssl_session;   /* local to a process */
 #endif
 } ngx_http_upstream_rr_peer_t;
 
 
+#if (NGX_HTTP_UPSTREAM_CHECK)
+#define ngx_http_upstream_rr_peer_alive(peer)                                 \
+    (!ngx_http_upstream_check_peer_down((peer)->check_index))
+#else
+#define ngx_http_upstream_rr_peer_alive(peer)  1
+#endif
+
+
 typedef struct ngx_http_upstream_rr_peers_s  ngx_http_upstream_rr_peers_t;
 
 struct ngx_http_upstream_rr_peers_s {
@@ -73,6 +85,17 @@ ngx_int_t ngx_http_upstream_get_round_robin_peer(ngx_peer_connection_t *pc,
 void ngx_http_upstream_free_round_robin_peer(ngx_peer_connection_t *pc,
     void *data, ngx_uint_t state);
 
+/*
+ * the per-peer state kept in a shared zone is allocated anew for each
+ * configuration, the zones are sized for this number of configurations
+ */
+#define NGX_HTTP_UPSTREAM_RR_ZONE_CONFS  4
+
+void *ngx_http_upstream_rr_zone_alloc(ngx_shm_zone_t *shm_zone, void *data,
+    size_t size, void **prev);
+void ngx_http_upstream_rr_zone_hold(ngx_slab_pool_t *shpool, void *p,
+    ngx_int_t n);
+
 #if (NGX_HTTP_SSL)
 ngx_int_t
     ngx_http_upstream_set_round_robin_peer_session(ngx_peer_connection_t *pc,
@@ -0,0 +1,3735 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+#include <ngx_http_v2_module.h>
+
+
+/* settings fields */
+#define NGX_HTTP_V2_HEADER_TABLE_SIZE_SETTING    0x1
+#define NGX_HTTP_V2_ENABLE_PUSH_SETTING          0x2
+#define NGX_HTTP_V2_MAX_STREAMS_SETTING          0x3
+#define NGX_HTTP_V2_INIT_WINDOW_SIZE_SETTING     0x4
+#define NGX_HTTP_V2_MAX_FRAME_SIZE_SETTING       0x5
+
+#define NGX_HTTP_V2_SETTINGS_PARAM_SIZE          6
+
+#define NGX_HTTP_V2_FRAME_BUFFER_SIZE            24
+
+#define NGX_HTTP_V2_PREFACE_START                "PRI * HTTP/2.0\r\n"
+#define NGX_HTTP_V2_PREFACE_END                  "\r\nSM\r\n\r\n"
+
+#define NGX_HTTP_V2_PRIORITY_SIZE                5
+#define NGX_HTTP_V2_RST_STREAM_SIZE              4
+#define NGX_HTTP_V2_PING_SIZE                    8
+#define NGX_HTTP_V2_GOAWAY_SIZE                  8
+#define NGX_HTTP_V2_WINDOW_UPDATE_SIZE           4
+
+/* the maximum number of octets in the continuation of an integer */
+#define NGX_HTTP_V2_INT_OCTETS                   4
+
+/* the maximum number of control frames not yet sent to a client */
+#define NGX_HTTP_V2_MAX_FRAMES                   10000
+
+#define ngx_http_v2_index(h2scf, sid)  ((sid >> 1) & h2scf->streams_index_mask)
+#define ngx_http_v2_index_size(h2scf)  (h2scf->streams_index_mask + 1)
+
+
+static void ngx_http_v2_read_handler(ngx_event_t *rev);
+static void ngx_http_v2_write_handler(ngx_event_t *wev);
+static void ngx_http_v2_idle_handler(ngx_event_t *rev);
+static void ngx_http_v2_handle_connection_handler(ngx_event_t *rev);
+static void ngx_http_v2_handle_connection(ngx_http_v2_connection_t *h2c);
+static void ngx_http_v2_finalize_connection(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t status);
+
+static u_char *ngx_http_v2_state_preface(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_preface_end(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_head(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_data(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_read_data(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_headers(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_header_block(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_continuation(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_priority(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_rst_stream(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_settings(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_settings_params(
+    ngx_http_v2_connection_t *h2c, u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_push_promise(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_ping(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_goaway(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_window_update(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_skip_padded(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_skip(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_state_save(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end, ngx_http_v2_handler_pt handler);
+static u_char *ngx_http_v2_state_complete(ngx_http_v2_connection_t *h2c,
+    u_char *pos, u_char *end);
+static u_char *ngx_http_v2_connection_error(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t err);
+
+static ngx_int_t ngx_http_v2_process_header_block(
+    ngx_http_v2_connection_t *h2c);
+static ngx_int_t ngx_http_v2_parse_int(u_char **pos, u_char *end,
+    ngx_uint_t prefix, ngx_uint_t *value);
+static ngx_int_t ngx_http_v2_parse_string(ngx_http_v2_connection_t *h2c,
+    u_char **pos, u_char *end, ngx_str_t *str, u_char **last);
+static ngx_int_t ngx_http_v2_process_header(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_header_t *header);
+static ngx_int_t ngx_http_v2_validate_header(ngx_http_request_t *r,
+    ngx_http_v2_header_t *header);
+static ngx_int_t ngx_http_v2_pseudo_header(ngx_http_request_t *r,
+    ngx_http_v2_header_t *header);
+static ngx_int_t ngx_http_v2_add_request_header(ngx_http_request_t *r,
+    ngx_str_t *name, ngx_str_t *value);
+static ngx_int_t ngx_http_v2_construct_request_line(ngx_http_request_t *r);
+static ngx_int_t ngx_http_v2_construct_cookie_header(ngx_http_request_t *r);
+static void ngx_http_v2_run_request(ngx_http_request_t *r);
+
+static ngx_int_t ngx_http_v2_init_request_body(ngx_http_request_t *r);
+static void ngx_http_v2_request_body_data(ngx_http_v2_stream_t *stream,
+    u_char *pos, size_t size, ngx_uint_t last);
+static ngx_int_t ngx_http_v2_process_request_body(ngx_http_request_t *r,
+    u_char *pos, size_t size, ngx_uint_t last);
+static ngx_int_t ngx_http_v2_finish_request_body(ngx_http_request_t *r);
+static void ngx_http_v2_read_client_request_body_handler(
+    ngx_http_request_t *r);
+
+static ngx_http_v2_stream_t *ngx_http_v2_create_stream(
+    ngx_http_v2_connection_t *h2c);
+static ngx_http_v2_stream_t *ngx_http_v2_get_stream_by_id(
+    ngx_http_v2_connection_t *h2c, ngx_uint_t sid);
+static ngx_int_t ngx_http_v2_terminate_stream(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_stream_t *stream, ngx_uint_t status);
+static void ngx_http_v2_abort_stream(ngx_http_v2_stream_t *stream);
+static void ngx_http_v2_close_stream_handler(ngx_event_t *ev);
+
+static void ngx_http_v2_set_dependency(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_stream_t *stream, ngx_uint_t depend, ngx_uint_t exclusive,
+    ngx_uint_t weight);
+static void ngx_http_v2_node_remove(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_stream_t *stream);
+static void ngx_http_v2_node_update(ngx_http_v2_stream_t *stream);
+static ngx_int_t ngx_http_v2_adjust_windows(ngx_http_v2_connection_t *h2c,
+    ssize_t delta);
+
+static ngx_http_v2_out_frame_t *ngx_http_v2_get_frame(
+    ngx_http_v2_connection_t *h2c, size_t length, ngx_uint_t type,
+    u_char flags, ngx_uint_t sid);
+static ngx_int_t ngx_http_v2_frame_handler(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_out_frame_t *frame);
+static ngx_int_t ngx_http_v2_send_settings(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t ack);
+static ngx_int_t ngx_http_v2_send_window_update(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t sid, size_t window);
+static ngx_int_t ngx_http_v2_send_rst_stream(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t sid, ngx_uint_t status);
+static ngx_int_t ngx_http_v2_send_goaway(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t status);
+
+
+static ngx_http_v2_handler_pt  ngx_http_v2_frame_states[] = {
+    ngx_http_v2_state_data,
+    ngx_http_v2_state_headers,
+    ngx_http_v2_state_priority,
+    ngx_http_v2_state_rst_stream,
+    ngx_http_v2_state_settings,
+    ngx_http_v2_state_push_promise,
+    ngx_http_v2_state_ping,
+    ngx_http_v2_state_goaway,
+    ngx_http_v2_state_window_update,
+    ngx_http_v2_state_continuation
+};
+
+#define NGX_HTTP_V2_FRAME_STATES                                              \
+    (sizeof(ngx_http_v2_frame_states) / sizeof(ngx_http_v2_handler_pt))
+
+
+void
+ngx_http_v2_init(ngx_event_t *rev)
+{
+    int                        tcp_nodelay;
+    ngx_connection_t          *c;
+    ngx_http_connection_t     *hc;
+    ngx_http_v2_srv_conf_t    *h2scf;
+    ngx_http_v2_main_conf_t   *h2mcf;
+    ngx_http_core_loc_conf_t  *clcf;
+    ngx_http_v2_connection_t  *h2c;
+
+#if (NGX_STAT_STUB)
+    (void) ngx_atomic_fetch_add(ngx_stat_reading, -1);
+#endif
+
+    c = rev->data;
+    hc = c->data;
+
+    if (rev->timedout) {
+        ngx_log_error(NGX_LOG_INFO, c->log, NGX_ETIMEDOUT, "client timed out");
+
+        ngx_http_close_connection(c);
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0, "init http2 connection");
+
+    c->log->action = "processing HTTP/2 connection";
+
+    h2c = ngx_pcalloc(c->pool, sizeof(ngx_http_v2_connection_t));
+    if (h2c == NULL) {
+        ngx_http_close_connection(c);
+        return;
+    }
+
+    h2c->connection = c;
+    h2c->http_connection = hc;
+    h2c->conf_ctx = hc->addr_conf->default_server->ctx;
+
+    h2c->send_window = NGX_HTTP_V2_DEFAULT_WINDOW;
+    h2c->recv_window = NGX_HTTP_V2_MAX_WINDOW;
+
+    h2c->init_window = NGX_HTTP_V2_DEFAULT_WINDOW;
+
+    h2c->frame_size = NGX_HTTP_V2_DEFAULT_FRAME_SIZE;
+
+    ngx_queue_init(&h2c->waiting);
+    ngx_queue_init(&h2c->dependencies);
+
+    h2c->state.handler = ngx_http_v2_state_preface;
+
+    h2mcf = ngx_http_v2_get_module_main_conf(h2c, ngx_http_v2_module);
+
+    if (h2mcf->recv_buffer == NULL) {
+        h2mcf->recv_buffer = ngx_palloc(ngx_cycle->pool,
+                                        h2mcf->recv_buffer_size);
+        if (h2mcf->recv_buffer == NULL) {
+            ngx_http_close_connection(c);
+            return;
+        }
+    }
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    h2c->streams_index = ngx_pcalloc(c->pool, ngx_http_v2_index_size(h2scf)
+                                           * sizeof(ngx_http_v2_stream_t *));
+    if (h2c->streams_index == NULL) {
+        ngx_http_close_connection(c);
+        return;
+    }
+
+    if (ngx_http_v2_send_settings(h2c, 0) == NGX_ERROR) {
+        ngx_http_close_connection(c);
+        return;
+    }
+
+    if (ngx_http_v2_send_window_update(h2c, 0, NGX_HTTP_V2_MAX_WINDOW
+                                               - NGX_HTTP_V2_DEFAULT_WINDOW)
+        == NGX_ERROR)
+    {
+        ngx_http_close_connection(c);
+        return;
+    }
+
+    /* the frames of several streams are interleaved, so Nagle is harmful */
+
+    clcf = ngx_http_v2_get_module_loc_conf(h2c, ngx_http_core_module);
+
+    if (clcf->tcp_nodelay && c->tcp_nodelay == NGX_TCP_NODELAY_UNSET) {
+        ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0, "tcp_nodelay");
+
+        tcp_nodelay = 1;
+
+        if (setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY,
+                       (const void *) &tcp_nodelay, sizeof(int))
+            == -1)
+        {
+            ngx_connection_error(c, ngx_socket_errno,
+                                 "setsockopt(TCP_NODELAY) failed");
+            ngx_http_close_connection(c);
+            return;
+        }
+
+        c->tcp_nodelay = NGX_TCP_NODELAY_SET;
+    }
+
+    c->data = h2c;
+
+    rev->handler = ngx_http_v2_read_handler;
+    c->write->handler = ngx_http_v2_write_handler;
+
+    ngx_http_v2_read_handler(rev);
+}
+
+
+static void
+ngx_http_v2_read_handler(ngx_event_t *rev)
+{
+    u_char                    *p, *end;
+    size_t                     available;
+    ssize_t                    n;
+    ngx_connection_t          *c;
+    ngx_http_v2_srv_conf_t    *h2scf;
+    ngx_http_v2_main_conf_t   *h2mcf;
+    ngx_http_v2_connection_t  *h2c;
+
+    c = rev->data;
+    h2c = c->data;
+
+    if (rev->timedout) {
+        ngx_log_error(NGX_LOG_INFO, c->log, NGX_ETIMEDOUT, "client timed out");
+        ngx_http_v2_finalize_connection(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0, "http2 read handler");
+
+    h2c->blocked = 1;
+
+    h2mcf = ngx_http_v2_get_module_main_conf(h2c, ngx_http_v2_module);
+
+    /* the room for the saved state is reserved at the buffer start */
+
+    available = h2mcf->recv_buffer_size - 2 * NGX_HTTP_V2_STATE_BUFFER_SIZE;
+
+    h2c->new_streams = 0;
+
+    do {
+        p = h2mcf->recv_buffer;
+
+        ngx_memcpy(p, h2c->state.buffer, NGX_HTTP_V2_STATE_BUFFER_SIZE);
+        end = p + h2c->state.buffer_used;
+
+        n = c->recv(c, end, available);
+
+        if (n == NGX_AGAIN) {
+            break;
+        }
+
+        if (n == 0 && (h2c->state.incomplete || h2c->processing)) {
+            ngx_log_error(NGX_LOG_INFO, c->log, 0,
+                          "client prematurely closed connection");
+        }
+
+        if (n == 0 || n == NGX_ERROR) {
+            c->error = 1;
+            ngx_http_v2_finalize_connection(h2c, 0);
+            return;
+        }
+
+        end += n;
+
+        h2c->state.buffer_used = 0;
+        h2c->state.incomplete = 0;
+
+        do {
+            p = h2c->state.handler(h2c, p, end);
+
+            if (p == NULL) {
+                return;
+            }
+
+        } while (p != end);
+
+    } while (rev->ready);
+
+    if (ngx_handle_read_event(rev, 0) != NGX_OK) {
+        ngx_http_v2_finalize_connection(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+        return;
+    }
+
+    if (h2c->last_out && ngx_http_v2_send_output_queue(h2c) == NGX_ERROR) {
+        ngx_http_v2_finalize_connection(h2c, 0);
+        return;
+    }
+
+    h2c->blocked = 0;
+
+    if (h2c->processing) {
+        if (h2c->state.incomplete) {
+            h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+            ngx_add_timer(rev, h2scf->recv_timeout);
+
+        } else if (rev->timer_set) {
+            ngx_del_timer(rev);
+        }
+
+        return;
+    }
+
+    ngx_http_v2_handle_connection(h2c);
+}
+
+
+static void
+ngx_http_v2_write_handler(ngx_event_t *wev)
+{
+    ngx_connection_t          *c;
+    ngx_http_v2_connection_t  *h2c;
+
+    c = wev->data;
+    h2c = c->data;
+
+    if (wev->timedout) {
+        ngx_log_error(NGX_LOG_INFO, c->log, NGX_ETIMEDOUT, "client timed out");
+
+        c->timedout = 1;
+        c->error = 1;
+
+        ngx_http_v2_finalize_connection(h2c, 0);
+        return;
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0, "http2 write handler");
+
+    if (ngx_http_v2_send_output_queue(h2c) == NGX_ERROR) {
+        ngx_http_v2_finalize_connection(h2c, 0);
+        return;
+    }
+
+    ngx_http_v2_handle_connection(h2c);
+}
+
+
+ngx_int_t
+ngx_http_v2_send_output_queue(ngx_http_v2_connection_t *h2c)
+{
+    ngx_chain_t               *cl;
+    ngx_event_t               *wev;
+    ngx_connection_t          *c;
+    ngx_http_core_loc_conf_t  *clcf;
+    ngx_http_v2_out_frame_t   *out, *frame, *fn;
+
+    c = h2c->connection;
+
+    if (c->error) {
+        return NGX_ERROR;
+    }
+
+    wev = c->write;
+
+    if (!wev->ready) {
+        return NGX_OK;
+    }
+
+    cl = NULL;
+    out = NULL;
+
+    /* h2c->last_out is in the reverse order */
+
+    for (frame = h2c->last_out; frame; frame = fn) {
+        frame->last->next = cl;
+        cl = frame->first;
+
+        fn = frame->next;
+        frame->next = out;
+        out = frame;
+
+        ngx_log_debug4(NGX_LOG_DEBUG_HTTP, c->log, 0,
+                       "http2 frame out: %p sid:%ui bl:%d len:%uz",
+                       out, out->stream ? out->stream->id : 0, out->blocked,
+                       out->length);
+    }
+
+    cl = c->send_chain(c, cl, 0);
+
+    if (cl == NGX_CHAIN_ERROR) {
+        goto error;
+    }
+
+    clcf = ngx_http_v2_get_module_loc_conf(h2c, ngx_http_core_module);
+
+    if (ngx_handle_write_event(wev, clcf->send_lowat) != NGX_OK) {
+        goto error;
+    }
+
+    if (cl) {
+        ngx_add_timer(wev, clcf->send_timeout);
+
+    } else if (wev->timer_set) {
+        ngx_del_timer(wev);
+    }
+
+    for ( /* void */ ; out; out = fn) {
+        fn = out->next;
+
+        if (out->handler(h2c, out) != NGX_OK) {
+            out->blocked = 1;
+            break;
+        }
+
+        ngx_log_debug4(NGX_LOG_DEBUG_HTTP, c->log, 0,
+                       "http2 frame sent: %p sid:%ui bl:%d len:%uz",
+                       out, out->stream ? out->stream->id : 0, out->blocked,
+                       out->length);
+    }
+
+    frame = NULL;
+
+    for ( /* void */ ; out; out = fn) {
+        fn = out->next;
+        out->next = frame;
+        frame = out;
+    }
+
+    h2c->last_out = frame;
+
+    return NGX_OK;
+
+error:
+
+    c->error = 1;
+
+    if (!h2c->blocked) {
+        ngx_post_event(wev, &ngx_posted_events);
+    }
+
+    return NGX_ERROR;
+}
+
+
+static void
+ngx_http_v2_idle_handler(ngx_event_t *rev)
+{
+    ngx_connection_t          *c;
+    ngx_http_v2_connection_t  *h2c;
+
+    c = rev->data;
+    h2c = c->data;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0, "http2 idle handler");
+
+    if (rev->timedout || c->close) {
+        ngx_http_v2_finalize_connection(h2c, NGX_HTTP_V2_NO_ERROR);
+        return;
+    }
+
+    c->destroyed = 0;
+    c->idle = 0;
+    ngx_reusable_connection(c, 0);
+
+    c->write->handler = ngx_http_v2_write_handler;
+
+    rev->handler = ngx_http_v2_read_handler;
+    ngx_http_v2_read_handler(rev);
+}
+
+
+static void
+ngx_http_v2_handle_connection_handler(ngx_event_t *rev)
+{
+    ngx_connection_t          *c;
+    ngx_http_v2_connection_t  *h2c;
+
+    c = rev->data;
+    h2c = c->data;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, c->log, 0,
+                   "http2 handle connection handler");
+
+    if (c->error) {
+        ngx_http_v2_finalize_connection(h2c, 0);
+        return;
+    }
+
+    rev->handler = ngx_http_v2_read_handler;
+
+    if (rev->ready) {
+        ngx_http_v2_read_handler(rev);
+        return;
+    }
+
+    ngx_http_v2_handle_connection(h2c);
+}
+
+
+static void
+ngx_http_v2_handle_connection(ngx_http_v2_connection_t *h2c)
+{
+    ngx_connection_t        *c;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    if (h2c->last_out || h2c->processing) {
+        return;
+    }
+
+    c = h2c->connection;
+
+    if (c->error) {
+        ngx_http_v2_finalize_connection(h2c, 0);
+        return;
+    }
+
+    if (c->buffered) {
+        return;
+    }
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    if (h2c->state.incomplete) {
+        ngx_add_timer(c->read, h2scf->recv_timeout);
+        return;
+    }
+
+    if (ngx_terminate || ngx_exiting) {
+        ngx_http_v2_finalize_connection(h2c, NGX_HTTP_V2_NO_ERROR);
+        return;
+    }
+
+    /* no streams: the memory of the past ones is released */
+
+    if (h2c->pool) {
+        ngx_destroy_pool(h2c->pool);
+        h2c->pool = NULL;
+        h2c->free_fake_connections = NULL;
+    }
+
+    if (h2c->state.header_block) {
+        ngx_free(h2c->state.header_block);
+        h2c->state.header_block = NULL;
+        h2c->state.header_size = 0;
+    }
+
+    c->destroyed = 1;
+    c->idle = 1;
+    ngx_reusable_connection(c, 1);
+
+    c->write->handler = ngx_http_empty_handler;
+    c->read->handler = ngx_http_v2_idle_handler;
+
+    ngx_add_timer(c->read, h2scf->idle_timeout);
+}
+
+
+static void
+ngx_http_v2_finalize_connection(ngx_http_v2_connection_t *h2c,
+    ngx_uint_t status)
+{
+    ngx_uint_t               i, size;
+    ngx_connection_t        *c;
+    ngx_http_v2_stream_t    *stream, *next;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    c = h2c->connection;
+
+    h2c->blocked = 1;
+
+    if (!c->error && !h2c->goaway) {
+        if (ngx_http_v2_send_goaway(h2c, status) != NGX_ERROR) {
+            (void) ngx_http_v2_send_output_queue(h2c);
+        }
+    }
+
+    c->error = 1;
+
+    /* the frames left are never sent */
+
+    h2c->last_out = NULL;
+
+    c->read->handler = ngx_http_empty_handler;
+    c->write->handler = ngx_http_empty_handler;
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    size = ngx_http_v2_index_size(h2scf);
+
+    for (i = 0; i < size; i++) {
+
+        for (stream = h2c->streams_index[i]; stream; stream = next) {
+            next = stream->index;
+
+            stream->queued = 0;
+            stream->in_closed = 1;
+            stream->out_closed = 1;
+
+            if (stream->closing) {
+                ngx_http_v2_close_stream(stream, 0);
+                continue;
+            }
+
+            ngx_http_v2_abort_stream(stream);
+        }
+    }
+
+    if (h2c->processing) {
+
+        /* a stream waits for an operation to complete, e.g. file AIO */
+
+        h2c->blocked = 0;
+        return;
+    }
+
+    if (h2c->state.header_block) {
+        ngx_free(h2c->state.header_block);
+        h2c->state.header_block = NULL;
+    }
+
+    if (h2c->pool) {
+        ngx_destroy_pool(h2c->pool);
+        h2c->pool = NULL;
+    }
+
+    ngx_http_close_connection(c);
+}
+
+
+static u_char *
+ngx_http_v2_state_preface(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    static const u_char preface[] = NGX_HTTP_V2_PREFACE_START;
+
+    if ((size_t) (end - pos) < sizeof(preface) - 1) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_preface);
+    }
+
+    if (ngx_memcmp(pos, preface, sizeof(preface) - 1) != 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "invalid http2 connection preface \"%*s\"",
+                      sizeof(preface) - 1, pos);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    return ngx_http_v2_state_preface_end(h2c, pos + sizeof(preface) - 1, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_preface_end(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    static const u_char preface[] = NGX_HTTP_V2_PREFACE_END;
+
+    if ((size_t) (end - pos) < sizeof(preface) - 1) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_preface_end);
+    }
+
+    if (ngx_memcmp(pos, preface, sizeof(preface) - 1) != 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "invalid http2 connection preface \"%*s\"",
+                      sizeof(preface) - 1, pos);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 preface verified");
+
+    return ngx_http_v2_state_head(h2c, pos + sizeof(preface) - 1, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_head(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    uint32_t    head;
+    ngx_uint_t  type;
+
+    if (end - pos < NGX_HTTP_V2_FRAME_HEADER_SIZE) {
+        return ngx_http_v2_state_save(h2c, pos, end, ngx_http_v2_state_head);
+    }
+
+    head = ngx_http_v2_parse_uint32(pos);
+
+    h2c->state.length = ngx_http_v2_parse_length(head);
+    h2c->state.flags = pos[4];
+
+    h2c->state.sid = ngx_http_v2_parse_sid(&pos[5]);
+
+    h2c->state.padding = 0;
+
+    pos += NGX_HTTP_V2_FRAME_HEADER_SIZE;
+
+    type = ngx_http_v2_parse_type(head);
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 frame type:%ui f:%Xd l:%uz sid:%ui",
+                   type, h2c->state.flags, h2c->state.length, h2c->state.sid);
+
+    if (h2c->state.length > NGX_HTTP_V2_DEFAULT_FRAME_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent frame with length %uz exceeding "
+                      "the advertised maximum", h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if (h2c->state.continuation) {
+
+        if (type != NGX_HTTP_V2_CONTINUATION_FRAME
+            || h2c->state.sid != h2c->state.header_sid)
+        {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent inappropriate frame while "
+                          "CONTINUATION was expected");
+
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_PROTOCOL_ERROR);
+        }
+
+    } else if (type == NGX_HTTP_V2_CONTINUATION_FRAME) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent unexpected CONTINUATION frame");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    /*
+     * PING, SETTINGS, and HEADERS frames for refused streams are
+     * answered with control frames; a client which keeps sending
+     * them without reading the answers is disconnected
+     */
+
+    if (h2c->frames >= NGX_HTTP_V2_MAX_FRAMES) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "http2 flood detected");
+
+        return ngx_http_v2_connection_error(h2c,
+                                            NGX_HTTP_V2_ENHANCE_YOUR_CALM);
+    }
+
+    if (type >= NGX_HTTP_V2_FRAME_STATES) {
+        ngx_log_debug1(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                       "http2 frame with unknown type %ui", type);
+
+        return ngx_http_v2_state_skip(h2c, pos, end);
+    }
+
+    return ngx_http_v2_frame_states[type](h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_data(ngx_http_v2_connection_t *h2c, u_char *pos, u_char *end)
+{
+    size_t                 size;
+    ngx_http_v2_stream_t  *stream;
+
+    size = h2c->state.length;
+
+    if (h2c->state.flags & NGX_HTTP_V2_PADDED_FLAG) {
+
+        if (h2c->state.length == 0) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent padded DATA frame "
+                          "with incorrect length: 0");
+
+            return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+        }
+
+        if (end - pos == 0) {
+            return ngx_http_v2_state_save(h2c, pos, end,
+                                          ngx_http_v2_state_data);
+        }
+
+        h2c->state.padding = *pos++;
+
+        if (h2c->state.padding >= size) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent padded DATA frame "
+                          "with incorrect length: %uz, padding: %uz",
+                          size, h2c->state.padding);
+
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_PROTOCOL_ERROR);
+        }
+
+        h2c->state.length -= 1 + h2c->state.padding;
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 DATA frame sid:%ui length:%uz",
+                   h2c->state.sid, h2c->state.length);
+
+    if (h2c->state.sid == 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent DATA frame with incorrect identifier");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    /* the flow control counts the whole payload including the padding */
+
+    if (size > h2c->recv_window) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client violated connection flow control: "
+                      "received DATA frame length %uz, available window %uz",
+                      size, h2c->recv_window);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_FLOW_CTRL_ERROR);
+    }
+
+    h2c->recv_window -= size;
+
+    if (h2c->recv_window < NGX_HTTP_V2_MAX_WINDOW / 4) {
+
+        if (ngx_http_v2_send_window_update(h2c, 0, NGX_HTTP_V2_MAX_WINDOW
+                                                   - h2c->recv_window)
+            == NGX_ERROR)
+        {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        h2c->recv_window = NGX_HTTP_V2_MAX_WINDOW;
+    }
+
+    stream = ngx_http_v2_get_stream_by_id(h2c, h2c->state.sid);
+
+    if (stream == NULL) {
+
+        if (h2c->state.sid > h2c->last_sid) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent DATA frame for idle stream %ui",
+                          h2c->state.sid);
+
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_PROTOCOL_ERROR);
+        }
+
+        /* the stream is already closed */
+
+        return ngx_http_v2_state_skip_padded(h2c, pos, end);
+    }
+
+    if (stream->in_closed) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent DATA frame for half-closed stream %ui",
+                      stream->id);
+
+        if (ngx_http_v2_terminate_stream(h2c, stream,
+                                         NGX_HTTP_V2_STREAM_CLOSED)
+            == NGX_ERROR)
+        {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        return ngx_http_v2_state_skip_padded(h2c, pos, end);
+    }
+
+    if (size > stream->recv_window) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client violated flow control for stream %ui: "
+                      "received DATA frame length %uz, available window %uz",
+                      stream->id, size, stream->recv_window);
+
+        if (ngx_http_v2_terminate_stream(h2c, stream,
+                                         NGX_HTTP_V2_FLOW_CTRL_ERROR)
+            == NGX_ERROR)
+        {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        return ngx_http_v2_state_skip_padded(h2c, pos, end);
+    }
+
+    stream->recv_window -= size;
+
+    if (h2c->state.flags & NGX_HTTP_V2_END_STREAM_FLAG) {
+        stream->in_closed = 1;
+
+    } else if (stream->recv_window < NGX_HTTP_V2_MAX_WINDOW / 4) {
+
+        if (ngx_http_v2_send_window_update(h2c, stream->id,
+                                           NGX_HTTP_V2_MAX_WINDOW
+                                           - stream->recv_window)
+            == NGX_ERROR)
+        {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        stream->recv_window = NGX_HTTP_V2_MAX_WINDOW;
+    }
+
+    h2c->state.stream = stream;
+
+    return ngx_http_v2_state_read_data(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_read_data(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    size_t      size;
+    ngx_uint_t  last;
+
+    if (h2c->state.stream == NULL) {
+        return ngx_http_v2_state_skip_padded(h2c, pos, end);
+    }
+
+    size = end - pos;
+    last = 0;
+
+    if (size >= h2c->state.length) {
+        size = h2c->state.length;
+        last = h2c->state.flags & NGX_HTTP_V2_END_STREAM_FLAG;
+    }
+
+    h2c->state.length -= size;
+
+    /* the stream may be closed while the data are processed */
+
+    ngx_http_v2_request_body_data(h2c->state.stream, pos, size, last);
+
+    pos += size;
+
+    if (h2c->state.length) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_read_data);
+    }
+
+    if (h2c->state.padding) {
+        return ngx_http_v2_state_skip_padded(h2c, pos, end);
+    }
+
+    return ngx_http_v2_state_complete(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_headers(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    size_t                   size;
+    uint32_t                 dependency;
+    ngx_uint_t               padded, priority, depend, exclusive, weight;
+    ngx_http_v2_stream_t    *stream, **index;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    padded = h2c->state.flags & NGX_HTTP_V2_PADDED_FLAG;
+    priority = h2c->state.flags & NGX_HTTP_V2_PRIORITY_FLAG;
+
+    size = 0;
+
+    if (padded) {
+        size++;
+    }
+
+    if (priority) {
+        size += NGX_HTTP_V2_PRIORITY_SIZE;
+    }
+
+    if (h2c->state.length < size) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent HEADERS frame with incorrect length %uz",
+                      h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if ((size_t) (end - pos) < size) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_headers);
+    }
+
+    h2c->state.length -= size;
+
+    if (padded) {
+        h2c->state.padding = *pos++;
+
+        if (h2c->state.padding > h2c->state.length) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent padded HEADERS frame "
+                          "with incorrect length: %uz, padding: %uz",
+                          h2c->state.length, h2c->state.padding);
+
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_PROTOCOL_ERROR);
+        }
+
+        h2c->state.length -= h2c->state.padding;
+    }
+
+    depend = 0;
+    exclusive = 0;
+    weight = NGX_HTTP_V2_DEFAULT_WEIGHT;
+
+    if (priority) {
+        dependency = ngx_http_v2_parse_uint32(pos);
+
+        depend = dependency & 0x7fffffff;
+        exclusive = dependency >> 31;
+        weight = pos[4] + 1;
+
+        pos += NGX_HTTP_V2_PRIORITY_SIZE;
+    }
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 HEADERS frame sid:%ui on %ui excl:%ui weight:%ui",
+                   h2c->state.sid, depend, exclusive, weight);
+
+    if (h2c->state.sid % 2 == 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent HEADERS frame with incorrect identifier "
+                      "%ui", h2c->state.sid);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    h2c->state.header_sid = h2c->state.sid;
+    h2c->state.header_len = 0;
+    h2c->state.header_error = 0;
+    h2c->state.header_trailers = 0;
+    h2c->state.header_end_stream = (h2c->state.flags
+                                    & NGX_HTTP_V2_END_STREAM_FLAG) ? 1 : 0;
+
+    h2c->state.stream = NULL;
+
+    if (h2c->state.sid <= h2c->last_sid) {
+
+        /* the trailer section: the fields are decoded and ignored */
+
+        stream = ngx_http_v2_get_stream_by_id(h2c, h2c->state.sid);
+
+        if (stream == NULL || stream->in_closed) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent HEADERS frame for closed stream %ui",
+                          h2c->state.sid);
+
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_STREAM_CLOSED);
+        }
+
+        if (!h2c->state.header_end_stream) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent trailers without END_STREAM flag "
+                          "for stream %ui", h2c->state.sid);
+
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_PROTOCOL_ERROR);
+        }
+
+        h2c->state.header_trailers = 1;
+        h2c->state.stream = stream;
+
+        return ngx_http_v2_state_header_block(h2c, pos, end);
+    }
+
+    h2c->last_sid = h2c->state.sid;
+
+    if (depend == h2c->state.sid) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent HEADERS frame for stream %ui "
+                      "with incorrect dependency", h2c->state.sid);
+
+        h2c->state.header_error = NGX_HTTP_V2_PROTOCOL_ERROR;
+
+        return ngx_http_v2_state_header_block(h2c, pos, end);
+    }
+
+    if (h2c->goaway) {
+
+        /* the stream is ignored, the header block still updates the table */
+
+        return ngx_http_v2_state_header_block(h2c, pos, end);
+    }
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    /*
+     * the streams reset by the client right after HEADERS do not count
+     * as concurrent, so the number of streams created per read is limited
+     */
+
+    if (h2c->new_streams++ >= 2 * h2scf->concurrent_streams) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent too many streams at once");
+
+        h2c->state.header_error = NGX_HTTP_V2_REFUSED_STREAM;
+
+        return ngx_http_v2_state_header_block(h2c, pos, end);
+    }
+
+    if (h2c->processing >= h2scf->concurrent_streams) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "concurrent streams exceeded %ui", h2c->processing);
+
+        h2c->state.header_error = NGX_HTTP_V2_REFUSED_STREAM;
+
+        return ngx_http_v2_state_header_block(h2c, pos, end);
+    }
+
+    stream = ngx_http_v2_create_stream(h2c);
+    if (stream == NULL) {
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+    }
+
+    stream->id = h2c->state.sid;
+
+    index = h2c->streams_index + ngx_http_v2_index(h2scf, stream->id);
+
+    stream->index = *index;
+    *index = stream;
+
+    ngx_http_v2_set_dependency(h2c, stream, depend, exclusive, weight);
+
+    h2c->state.stream = stream;
+
+    return ngx_http_v2_state_header_block(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_header_block(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    u_char                  *p;
+    size_t                   size, len;
+    ngx_int_t                rc;
+    ngx_http_v2_stream_t    *stream;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    size = end - pos;
+
+    if (size > h2c->state.length) {
+        size = h2c->state.length;
+    }
+
+    len = h2c->state.header_len + size;
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    if (len > h2scf->max_header_size) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client exceeded http2_max_header_size limit");
+
+        return ngx_http_v2_connection_error(h2c,
+                                            NGX_HTTP_V2_ENHANCE_YOUR_CALM);
+    }
+
+    if (len > h2c->state.header_size) {
+
+        /* the block is accumulated since it may span several frames */
+
+        p = ngx_alloc(h2scf->max_header_size, h2c->connection->log);
+        if (p == NULL) {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        if (h2c->state.header_block) {
+            ngx_memcpy(p, h2c->state.header_block, h2c->state.header_len);
+            ngx_free(h2c->state.header_block);
+        }
+
+        h2c->state.header_block = p;
+        h2c->state.header_size = h2scf->max_header_size;
+    }
+
+    ngx_memcpy(h2c->state.header_block + h2c->state.header_len, pos, size);
+
+    h2c->state.header_len = len;
+    h2c->state.length -= size;
+
+    pos += size;
+
+    if (h2c->state.length) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_header_block);
+    }
+
+    if (!(h2c->state.flags & NGX_HTTP_V2_END_HEADERS_FLAG)) {
+        h2c->state.continuation = 1;
+        goto done;
+    }
+
+    h2c->state.continuation = 0;
+
+    rc = ngx_http_v2_process_header_block(h2c);
+
+    if (rc == NGX_DECLINED) {
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_COMP_ERROR);
+    }
+
+    if (rc == NGX_ERROR) {
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+    }
+
+    if (h2c->state.header_error) {
+        if (ngx_http_v2_send_rst_stream(h2c, h2c->state.header_sid,
+                                        h2c->state.header_error)
+            != NGX_OK)
+        {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        goto done;
+    }
+
+    /* a header handler may have already finalized the request */
+
+    stream = h2c->state.stream;
+
+    if (stream == NULL) {
+        goto done;
+    }
+
+    h2c->state.stream = NULL;
+
+    if (h2c->state.header_trailers) {
+        stream->in_closed = 1;
+        ngx_http_v2_request_body_data(stream, NULL, 0, 1);
+        goto done;
+    }
+
+    if (h2c->state.header_end_stream) {
+        stream->in_closed = 1;
+    }
+
+    ngx_http_v2_run_request(stream->request);
+
+done:
+
+    if (h2c->state.padding) {
+        return ngx_http_v2_state_skip_padded(h2c, pos, end);
+    }
+
+    return ngx_http_v2_state_complete(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_continuation(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 CONTINUATION frame sid:%ui length:%uz",
+                   h2c->state.sid, h2c->state.length);
+
+    return ngx_http_v2_state_header_block(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_priority(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    uint32_t               dependency;
+    ngx_uint_t             depend, exclusive, weight;
+    ngx_http_v2_stream_t  *stream;
+
+    if (h2c->state.length != NGX_HTTP_V2_PRIORITY_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent PRIORITY frame with incorrect length %uz",
+                      h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if (end - pos < NGX_HTTP_V2_PRIORITY_SIZE) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_priority);
+    }
+
+    dependency = ngx_http_v2_parse_uint32(pos);
+
+    depend = dependency & 0x7fffffff;
+    exclusive = dependency >> 31;
+    weight = pos[4] + 1;
+
+    pos += NGX_HTTP_V2_PRIORITY_SIZE;
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 PRIORITY frame sid:%ui on %ui excl:%ui weight:%ui",
+                   h2c->state.sid, depend, exclusive, weight);
+
+    if (h2c->state.sid == 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent PRIORITY frame with incorrect identifier");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    if (depend == h2c->state.sid) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent PRIORITY frame for stream %ui "
+                      "with incorrect dependency", h2c->state.sid);
+
+        stream = ngx_http_v2_get_stream_by_id(h2c, h2c->state.sid);
+
+        if (stream) {
+            if (ngx_http_v2_terminate_stream(h2c, stream,
+                                             NGX_HTTP_V2_PROTOCOL_ERROR)
+                == NGX_ERROR)
+            {
+                return ngx_http_v2_connection_error(h2c,
+                                                  NGX_HTTP_V2_INTERNAL_ERROR);
+            }
+
+        } else if (ngx_http_v2_send_rst_stream(h2c, h2c->state.sid,
+                                               NGX_HTTP_V2_PROTOCOL_ERROR)
+                   != NGX_OK)
+        {
+            return ngx_http_v2_connection_error(h2c,
+                                                NGX_HTTP_V2_INTERNAL_ERROR);
+        }
+
+        return ngx_http_v2_state_complete(h2c, pos, end);
+    }
+
+    /* the priority of idle and closed streams is not tracked */
+
+    stream = ngx_http_v2_get_stream_by_id(h2c, h2c->state.sid);
+
+    if (stream) {
+        ngx_http_v2_set_dependency(h2c, stream, depend, exclusive, weight);
+    }
+
+    return ngx_http_v2_state_complete(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_rst_stream(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    ngx_uint_t             status;
+    ngx_http_v2_stream_t  *stream;
+
+    if (h2c->state.length != NGX_HTTP_V2_RST_STREAM_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent RST_STREAM frame with incorrect length %uz",
+                      h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if (end - pos < NGX_HTTP_V2_RST_STREAM_SIZE) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_rst_stream);
+    }
+
+    status = ngx_http_v2_parse_uint32(pos);
+
+    pos += NGX_HTTP_V2_RST_STREAM_SIZE;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 RST_STREAM frame sid:%ui status:%ui",
+                   h2c->state.sid, status);
+
+    if (h2c->state.sid == 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent RST_STREAM frame "
+                      "with incorrect identifier");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    stream = ngx_http_v2_get_stream_by_id(h2c, h2c->state.sid);
+
+    if (stream == NULL) {
+        return ngx_http_v2_state_complete(h2c, pos, end);
+    }
+
+    stream->in_closed = 1;
+    stream->out_closed = 1;
+
+    switch (status) {
+
+    case NGX_HTTP_V2_CANCEL:
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client canceled stream %ui", h2c->state.sid);
+        break;
+
+    case NGX_HTTP_V2_INTERNAL_ERROR:
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client terminated stream %ui due to internal error",
+                      h2c->state.sid);
+        break;
+
+    default:
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client terminated stream %ui with status %ui",
+                      h2c->state.sid, status);
+        break;
+    }
+
+    if (!stream->closing) {
+        ngx_http_v2_abort_stream(stream);
+    }
+
+    return ngx_http_v2_state_complete(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_settings(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    if (h2c->state.sid) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent SETTINGS frame with incorrect identifier");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    if (h2c->state.flags == NGX_HTTP_V2_ACK_FLAG) {
+
+        if (h2c->state.length != 0) {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent SETTINGS frame with the ACK flag "
+                          "and nonzero length");
+
+            return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+        }
+
+        ngx_log_debug0(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                       "http2 SETTINGS frame ack");
+
+        return ngx_http_v2_state_complete(h2c, pos, end);
+    }
+
+    if (h2c->state.length % NGX_HTTP_V2_SETTINGS_PARAM_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent SETTINGS frame with incorrect length %uz",
+                      h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 SETTINGS frame");
+
+    if (ngx_http_v2_send_settings(h2c, 1) == NGX_ERROR) {
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+    }
+
+    return ngx_http_v2_state_settings_params(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_settings_params(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    ngx_uint_t  id, value;
+
+    while (h2c->state.length) {
+
+        if (end - pos < NGX_HTTP_V2_SETTINGS_PARAM_SIZE) {
+            return ngx_http_v2_state_save(h2c, pos, end,
+                                          ngx_http_v2_state_settings_params);
+        }
+
+        h2c->state.length -= NGX_HTTP_V2_SETTINGS_PARAM_SIZE;
+
+        id = ngx_http_v2_parse_uint16(pos);
+        value = ngx_http_v2_parse_uint32(&pos[2]);
+
+        pos += NGX_HTTP_V2_SETTINGS_PARAM_SIZE;
+
+        ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                       "http2 setting %ui:%ui", id, value);
+
+        switch (id) {
+
+        case NGX_HTTP_V2_INIT_WINDOW_SIZE_SETTING:
+
+            if (value > NGX_HTTP_V2_MAX_WINDOW) {
+                ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                              "client sent SETTINGS frame with incorrect "
+                              "INITIAL_WINDOW_SIZE value %ui", value);
+
+                return ngx_http_v2_connection_error(h2c,
+                                                  NGX_HTTP_V2_FLOW_CTRL_ERROR);
+            }
+
+            if (ngx_http_v2_adjust_windows(h2c, value - h2c->init_window)
+                != NGX_OK)
+            {
+                return ngx_http_v2_connection_error(h2c,
+                                                  NGX_HTTP_V2_FLOW_CTRL_ERROR);
+            }
+
+            h2c->init_window = value;
+            break;
+
+        case NGX_HTTP_V2_MAX_FRAME_SIZE_SETTING:
+
+            if (value > NGX_HTTP_V2_MAX_FRAME_SIZE
+                || value < NGX_HTTP_V2_DEFAULT_FRAME_SIZE)
+            {
+                ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                              "client sent SETTINGS frame with incorrect "
+                              "MAX_FRAME_SIZE value %ui", value);
+
+                return ngx_http_v2_connection_error(h2c,
+                                                   NGX_HTTP_V2_PROTOCOL_ERROR);
+            }
+
+            h2c->frame_size = value;
+            break;
+
+        case NGX_HTTP_V2_ENABLE_PUSH_SETTING:
+
+            if (value > 1) {
+                ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                              "client sent SETTINGS frame with incorrect "
+                              "ENABLE_PUSH value %ui", value);
+
+                return ngx_http_v2_connection_error(h2c,
+                                                   NGX_HTTP_V2_PROTOCOL_ERROR);
+            }
+
+            break;
+
+        default:
+
+            /* the response header blocks do not use the dynamic table */
+
+            break;
+        }
+    }
+
+    return ngx_http_v2_state_complete(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_push_promise(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                  "client sent PUSH_PROMISE frame");
+
+    return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+}
+
+
+static u_char *
+ngx_http_v2_state_ping(ngx_http_v2_connection_t *h2c, u_char *pos, u_char *end)
+{
+    ngx_buf_t                *buf;
+    ngx_http_v2_out_frame_t  *frame;
+
+    if (h2c->state.length != NGX_HTTP_V2_PING_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent PING frame with incorrect length %uz",
+                      h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if (end - pos < NGX_HTTP_V2_PING_SIZE) {
+        return ngx_http_v2_state_save(h2c, pos, end, ngx_http_v2_state_ping);
+    }
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 PING frame");
+
+    if (h2c->state.sid) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent PING frame with incorrect identifier");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    if (h2c->state.flags & NGX_HTTP_V2_ACK_FLAG) {
+        return ngx_http_v2_state_skip(h2c, pos, end);
+    }
+
+    frame = ngx_http_v2_get_frame(h2c, NGX_HTTP_V2_PING_SIZE,
+                                  NGX_HTTP_V2_PING_FRAME,
+                                  NGX_HTTP_V2_ACK_FLAG, 0);
+    if (frame == NULL) {
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+    }
+
+    buf = frame->first->buf;
+
+    buf->last = ngx_cpymem(buf->last, pos, NGX_HTTP_V2_PING_SIZE);
+
+    ngx_http_v2_queue_blocked_frame(h2c, frame);
+
+    return ngx_http_v2_state_complete(h2c, pos + NGX_HTTP_V2_PING_SIZE, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_goaway(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+#if (NGX_DEBUG)
+    ngx_uint_t  last_sid, error;
+#endif
+
+    if (h2c->state.length < NGX_HTTP_V2_GOAWAY_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent GOAWAY frame "
+                      "with incorrect length %uz", h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if (end - pos < NGX_HTTP_V2_GOAWAY_SIZE) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_goaway);
+    }
+
+    if (h2c->state.sid) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent GOAWAY frame with incorrect identifier");
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+#if (NGX_DEBUG)
+    h2c->state.length -= NGX_HTTP_V2_GOAWAY_SIZE;
+
+    last_sid = ngx_http_v2_parse_sid(pos);
+    error = ngx_http_v2_parse_uint32(&pos[4]);
+
+    pos += NGX_HTTP_V2_GOAWAY_SIZE;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 GOAWAY frame: last sid %ui, error %ui",
+                   last_sid, error);
+#endif
+
+    /* the streams already opened are served to completion */
+
+    return ngx_http_v2_state_skip(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_window_update(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    size_t                 window;
+    ngx_http_v2_stream_t  *stream;
+
+    if (h2c->state.length != NGX_HTTP_V2_WINDOW_UPDATE_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent WINDOW_UPDATE frame "
+                      "with incorrect length %uz", h2c->state.length);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_SIZE_ERROR);
+    }
+
+    if (end - pos < NGX_HTTP_V2_WINDOW_UPDATE_SIZE) {
+        return ngx_http_v2_state_save(h2c, pos, end,
+                                      ngx_http_v2_state_window_update);
+    }
+
+    window = ngx_http_v2_parse_window(pos);
+
+    pos += NGX_HTTP_V2_WINDOW_UPDATE_SIZE;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 WINDOW_UPDATE frame sid:%ui window:%uz",
+                   h2c->state.sid, window);
+
+    if (h2c->state.sid) {
+
+        stream = ngx_http_v2_get_stream_by_id(h2c, h2c->state.sid);
+
+        if (stream == NULL) {
+            return ngx_http_v2_state_complete(h2c, pos, end);
+        }
+
+        if (window == 0
+            || window > (size_t) (NGX_HTTP_V2_MAX_WINDOW
+                                  - stream->send_window))
+        {
+            ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                          "client sent WINDOW_UPDATE frame with "
+                          "incorrect increment %uz for stream %ui",
+                          window, stream->id);
+
+            if (ngx_http_v2_terminate_stream(h2c, stream,
+                                             window
+                                             ? NGX_HTTP_V2_FLOW_CTRL_ERROR
+                                             : NGX_HTTP_V2_PROTOCOL_ERROR)
+                == NGX_ERROR)
+            {
+                return ngx_http_v2_connection_error(h2c,
+                                                  NGX_HTTP_V2_INTERNAL_ERROR);
+            }
+
+            return ngx_http_v2_state_complete(h2c, pos, end);
+        }
+
+        stream->send_window += window;
+
+        if (stream->exhausted && stream->send_window > 0) {
+            stream->exhausted = 0;
+
+            if (!stream->queued) {
+                ngx_http_v2_handle_stream(h2c, stream);
+            }
+        }
+
+        return ngx_http_v2_state_complete(h2c, pos, end);
+    }
+
+    if (window == 0 || window > NGX_HTTP_V2_MAX_WINDOW - h2c->send_window) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent WINDOW_UPDATE frame with "
+                      "incorrect increment %uz for the connection", window);
+
+        return ngx_http_v2_connection_error(h2c,
+                                            window
+                                            ? NGX_HTTP_V2_FLOW_CTRL_ERROR
+                                            : NGX_HTTP_V2_PROTOCOL_ERROR);
+    }
+
+    h2c->send_window += window;
+
+    ngx_http_v2_handle_waiting(h2c);
+
+    return ngx_http_v2_state_complete(h2c, pos, end);
+}
+
+
+void
+ngx_http_v2_handle_waiting(ngx_http_v2_connection_t *h2c)
+{
+    ngx_queue_t           *q;
+    ngx_http_v2_stream_t  *stream;
+
+    if (h2c->send_window == 0) {
+        return;
+    }
+
+    /*
+     * the streams stay in the queue until they get a share of the window,
+     * the posted events are run in the reverse order, so the queue is
+     * walked from the tail to let the longest waiting stream go first
+     */
+
+    for (q = ngx_queue_last(&h2c->waiting);
+         q != ngx_queue_sentinel(&h2c->waiting);
+         q = ngx_queue_prev(q))
+    {
+        stream = ngx_queue_data(q, ngx_http_v2_stream_t, queue);
+
+        if (!stream->queued) {
+            ngx_http_v2_handle_stream(h2c, stream);
+        }
+    }
+}
+
+
+static u_char *
+ngx_http_v2_state_skip_padded(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    h2c->state.length += h2c->state.padding;
+    h2c->state.padding = 0;
+
+    return ngx_http_v2_state_skip(h2c, pos, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_skip(ngx_http_v2_connection_t *h2c, u_char *pos, u_char *end)
+{
+    size_t  size;
+
+    size = end - pos;
+
+    if (size < h2c->state.length) {
+        h2c->state.length -= size;
+        return ngx_http_v2_state_save(h2c, end, end, ngx_http_v2_state_skip);
+    }
+
+    return ngx_http_v2_state_complete(h2c, pos + h2c->state.length, end);
+}
+
+
+static u_char *
+ngx_http_v2_state_save(ngx_http_v2_connection_t *h2c, u_char *pos, u_char *end,
+    ngx_http_v2_handler_pt handler)
+{
+    size_t  size;
+
+    ngx_log_debug3(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 frame state save pos:%p end:%p handler:%p",
+                   pos, end, handler);
+
+    size = end - pos;
+
+    if (size > NGX_HTTP_V2_STATE_BUFFER_SIZE) {
+        ngx_log_error(NGX_LOG_ALERT, h2c->connection->log, 0,
+                      "state buffer overflow: %uz bytes required", size);
+
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+    }
+
+    ngx_memcpy(h2c->state.buffer, pos, size);
+
+    h2c->state.buffer_used = size;
+    h2c->state.handler = handler;
+    h2c->state.incomplete = 1;
+
+    return end;
+}
+
+
+static u_char *
+ngx_http_v2_state_complete(ngx_http_v2_connection_t *h2c, u_char *pos,
+    u_char *end)
+{
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 frame complete");
+
+    if (pos > end) {
+        ngx_log_error(NGX_LOG_ALERT, h2c->connection->log, 0,
+                      "receive buffer overrun");
+
+        ngx_debug_point();
+        return ngx_http_v2_connection_error(h2c, NGX_HTTP_V2_INTERNAL_ERROR);
+    }
+
+    if (!h2c->state.continuation) {
+        h2c->state.stream = NULL;
+    }
+
+    h2c->state.handler = ngx_http_v2_state_head;
+
+    return pos;
+}
+
+
+static u_char *
+ngx_http_v2_connection_error(ngx_http_v2_connection_t *h2c, ngx_uint_t err)
+{
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 state connection error: %ui", err);
+
+    if (err == NGX_HTTP_V2_INTERNAL_ERROR) {
+        ngx_debug_point();
+    }
+
+    ngx_http_v2_finalize_connection(h2c, err);
+
+    return NULL;
+}
+
+
+static ngx_int_t
+ngx_http_v2_process_header_block(ngx_http_v2_connection_t *h2c)
+{
+    u_char                *p, *end, *last, *buf;
+    ngx_int_t              rc;
+    ngx_uint_t             ch, index, value, indexing, size_update;
+    ngx_http_v2_header_t   header;
+
+    p = h2c->state.header_block;
+    end = p + h2c->state.header_len;
+
+    /* the Huffman code is at least 5 bits long per octet */
+
+    buf = ngx_alloc(h2c->state.header_len * 2 + 1, h2c->connection->log);
+    if (buf == NULL) {
+        return NGX_ERROR;
+    }
+
+    last = buf;
+    rc = NGX_OK;
+
+    size_update = 1;
+
+    while (p < end) {
+        ch = *p;
+
+        if (ch & 0x80) {
+
+            /* indexed header field */
+
+            if (ngx_http_v2_parse_int(&p, end, 7, &index) != NGX_OK
+                || ngx_http_v2_get_indexed_header(h2c, index, 0, &header)
+                   != NGX_OK)
+            {
+                goto failed;
+            }
+
+        } else if ((ch & 0xe0) == 0x20) {
+
+            /* dynamic table size update, only at the block start */
+
+            if (!size_update
+                || ngx_http_v2_parse_int(&p, end, 5, &value) != NGX_OK
+                || ngx_http_v2_table_size(h2c, value) != NGX_OK)
+            {
+                goto failed;
+            }
+
+            continue;
+
+        } else {
+
+            /* literal header field */
+
+            indexing = ch & 0x40;
+
+            if (ngx_http_v2_parse_int(&p, end, indexing ? 6 : 4, &index)
+                != NGX_OK)
+            {
+                goto failed;
+            }
+
+            if (index) {
+                if (ngx_http_v2_get_indexed_header(h2c, index, 1, &header)
+                    != NGX_OK)
+                {
+                    goto failed;
+                }
+
+            } else if (ngx_http_v2_parse_string(h2c, &p, end, &header.name,
+                                                &last)
+                       != NGX_OK)
+            {
+                goto failed;
+            }
+
+            if (ngx_http_v2_parse_string(h2c, &p, end, &header.value, &last)
+                != NGX_OK)
+            {
+                goto failed;
+            }
+
+            if (indexing && ngx_http_v2_add_header(h2c, &header) != NGX_OK) {
+                rc = NGX_ERROR;
+                goto done;
+            }
+        }
+
+        size_update = 0;
+
+        if (ngx_http_v2_process_header(h2c, &header) != NGX_OK) {
+            rc = NGX_ERROR;
+            goto done;
+        }
+    }
+
+    goto done;
+
+failed:
+
+    ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                  "client sent invalid header block");
+
+    rc = NGX_DECLINED;
+
+done:
+
+    ngx_free(buf);
+
+    return rc;
+}
+
+
+static ngx_int_t
+ngx_http_v2_parse_int(u_char **pos, u_char *end, ngx_uint_t prefix,
+    ngx_uint_t *value)
+{
+    u_char      *p;
+    ngx_uint_t   octet, shift, v;
+
+    p = *pos;
+
+    if (p == end) {
+        return NGX_ERROR;
+    }
+
+    prefix = ngx_http_v2_prefix(prefix);
+
+    v = *p++ & prefix;
+
+    if (v == prefix) {
+
+        for (shift = 0; /* void */; shift += 7) {
+
+            if (p == end || shift == 7 * NGX_HTTP_V2_INT_OCTETS) {
+                return NGX_ERROR;
+            }
+
+            octet = *p++;
+
+            v += (octet & 0x7f) << shift;
+
+            if (octet < 128) {
+                break;
+            }
+        }
+    }
+
+    *pos = p;
+    *value = v;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_parse_string(ngx_http_v2_connection_t *h2c, u_char **pos,
+    u_char *end, ngx_str_t *str, u_char **last)
+{
+    u_char      *p, state;
+    ngx_uint_t   huff, len;
+
+    p = *pos;
+
+    if (p == end) {
+        return NGX_ERROR;
+    }
+
+    huff = *p & 0x80;
+
+    if (ngx_http_v2_parse_int(&p, end, 7, &len) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    if ((size_t) (end - p) < len) {
+        return NGX_ERROR;
+    }
+
+    if (huff) {
+        state = 0;
+        str->data = *last;
+
+        if (ngx_http_v2_huff_decode(&state, p, len, last, 1,
+                                    h2c->connection->log)
+            != NGX_OK)
+        {
+            return NGX_ERROR;
+        }
+
+        str->len = *last - str->data;
+
+    } else {
+        str->data = p;
+        str->len = len;
+    }
+
+    *pos = p + len;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_process_header(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_header_t *header)
+{
+    ngx_int_t                rc;
+    ngx_str_t               *cookie;
+    ngx_http_request_t      *r;
+    ngx_http_v2_stream_t    *stream;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 header: \"%*s: %*s\"",
+                   header->name.len, header->name.data,
+                   header->value.len, header->value.data);
+
+    stream = h2c->state.stream;
+
+    if (stream == NULL || h2c->state.header_trailers) {
+        return NGX_OK;
+    }
+
+    r = stream->request;
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    if (header->name.len + header->value.len > h2scf->max_field_size) {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "client exceeded http2_max_field_size limit");
+
+        ngx_http_finalize_request(r, NGX_HTTP_REQUEST_HEADER_TOO_LARGE);
+        return NGX_OK;
+    }
+
+    r->request_length += header->name.len + header->value.len + 4;
+
+    if (r->request_length > (off_t) h2scf->max_header_size) {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "client exceeded http2_max_header_size limit");
+
+        ngx_http_finalize_request(r, NGX_HTTP_REQUEST_HEADER_TOO_LARGE);
+        return NGX_OK;
+    }
+
+    if (header->name.len && header->name.data[0] == ':') {
+
+        if (stream->pseudo_done) {
+            ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                          "client sent pseudo-header \"%V\" "
+                          "after regular header", &header->name);
+
+            ngx_http_finalize_request(r, NGX_HTTP_BAD_REQUEST);
+            return NGX_OK;
+        }
+
+        rc = ngx_http_v2_pseudo_header(r, header);
+
+        if (rc != NGX_OK) {
+            ngx_http_finalize_request(r, rc);
+        }
+
+        return NGX_OK;
+    }
+
+    stream->pseudo_done = 1;
+
+    rc = ngx_http_v2_validate_header(r, header);
+
+    if (rc != NGX_OK) {
+        ngx_http_finalize_request(r, rc);
+        return NGX_OK;
+    }
+
+    if (header->name.len == sizeof("cookie") - 1
+        && ngx_strncmp(header->name.data, "cookie", sizeof("cookie") - 1) == 0)
+    {
+        if (stream->cookies == NULL) {
+            stream->cookies = ngx_array_create(r->pool, 2, sizeof(ngx_str_t));
+            if (stream->cookies == NULL) {
+                return NGX_ERROR;
+            }
+        }
+
+        cookie = ngx_array_push(stream->cookies);
+        if (cookie == NULL) {
+            return NGX_ERROR;
+        }
+
+        cookie->len = header->value.len;
+        cookie->data = ngx_pstrdup(r->pool, &header->value);
+        if (cookie->data == NULL) {
+            return NGX_ERROR;
+        }
+
+        return NGX_OK;
+    }
+
+    rc = ngx_http_v2_add_request_header(r, &header->name, &header->value);
+
+    if (rc == NGX_ERROR) {
+        return NGX_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_validate_header(ngx_http_request_t *r,
+    ngx_http_v2_header_t *header)
+{
+    u_char  ch;
+    size_t  i;
+
+    if (header->name.len == 0) {
+        goto invalid;
+    }
+
+    for (i = 0; i < header->name.len; i++) {
+        ch = header->name.data[i];
+
+        if (ch <= 0x20 || ch == 0x7f || ch == ':'
+            || (ch >= 'A' && ch <= 'Z'))
+        {
+            goto invalid;
+        }
+    }
+
+    for (i = 0; i < header->value.len; i++) {
+        ch = header->value.data[i];
+
+        if (ch == '\0' || ch == LF || ch == CR) {
+            goto invalid;
+        }
+    }
+
+    /* the connection-specific fields are not allowed (RFC 7540, 8.1.2.2) */
+
+    switch (header->name.len) {
+
+    case 2:
+        if (ngx_strncmp(header->name.data, "te", 2) == 0
+            && (header->value.len != sizeof("trailers") - 1
+                || ngx_strncmp(header->value.data, "trailers",
+                               sizeof("trailers") - 1) != 0))
+        {
+            goto invalid;
+        }
+
+        break;
+
+    case 7:
+        if (ngx_strncmp(header->name.data, "upgrade", 7) == 0) {
+            goto invalid;
+        }
+
+        break;
+
+    case 10:
+        if (ngx_strncmp(header->name.data, "connection", 10) == 0
+            || ngx_strncmp(header->name.data, "keep-alive", 10) == 0)
+        {
+            goto invalid;
+        }
+
+        break;
+
+    case 16:
+        if (ngx_strncmp(header->name.data, "proxy-connection", 16) == 0) {
+            goto invalid;
+        }
+
+        break;
+
+    case 17:
+        if (ngx_strncmp(header->name.data, "transfer-encoding", 17) == 0) {
+            goto invalid;
+        }
+
+        break;
+    }
+
+    return NGX_OK;
+
+invalid:
+
+    ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                  "client sent invalid header: \"%V: %V\"",
+                  &header->name, &header->value);
+
+    return NGX_HTTP_BAD_REQUEST;
+}
+
+
+static ngx_int_t
+ngx_http_v2_pseudo_header(ngx_http_request_t *r, ngx_http_v2_header_t *header)
+{
+    u_char     *p;
+    ngx_str_t   name;
+
+    name.len = header->name.len - 1;
+    name.data = header->name.data + 1;
+
+    switch (name.len) {
+
+    case 4:
+        if (ngx_strncmp(name.data, "path", 4) != 0) {
+            break;
+        }
+
+        if (r->unparsed_uri.len) {
+            goto duplicate;
+        }
+
+        if (header->value.len == 0) {
+            goto invalid;
+        }
+
+        r->unparsed_uri.len = header->value.len;
+        r->unparsed_uri.data = ngx_pstrdup(r->pool, &header->value);
+        if (r->unparsed_uri.data == NULL) {
+            return NGX_HTTP_INTERNAL_SERVER_ERROR;
+        }
+
+        return NGX_OK;
+
+    case 6:
+        if (ngx_strncmp(name.data, "method", 6) == 0) {
+
+            if (r->method_name.len) {
+                goto duplicate;
+            }
+
+            if (header->value.len == 0) {
+                goto invalid;
+            }
+
+            r->method_name.len = header->value.len;
+            r->method_name.data = ngx_pstrdup(r->pool, &header->value);
+            if (r->method_name.data == NULL) {
+                return NGX_HTTP_INTERNAL_SERVER_ERROR;
+            }
+
+            return NGX_OK;
+        }
+
+        if (ngx_strncmp(name.data, "scheme", 6) == 0) {
+
+            if (r->schema_start) {
+                goto duplicate;
+            }
+
+            if (header->value.len == 0) {
+                goto invalid;
+            }
+
+            p = ngx_pstrdup(r->pool, &header->value);
+            if (p == NULL) {
+                return NGX_HTTP_INTERNAL_SERVER_ERROR;
+            }
+
+            r->schema_start = p;
+            r->schema_end = p + header->value.len;
+
+            return NGX_OK;
+        }
+
+        break;
+
+    case 9:
+        if (ngx_strncmp(name.data, "authority", 9) != 0) {
+            break;
+        }
+
+        ngx_str_set(&name, "host");
+
+        if (ngx_http_v2_add_request_header(r, &name, &header->value)
+            == NGX_ERROR)
+        {
+            return NGX_HTTP_INTERNAL_SERVER_ERROR;
+        }
+
+        return NGX_OK;
+    }
+
+    ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                  "client sent unknown pseudo-header \"%V\"", &header->name);
+
+    return NGX_HTTP_BAD_REQUEST;
+
+duplicate:
+
+    ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                  "client sent duplicate pseudo-header \"%V\"",
+                  &header->name);
+
+    return NGX_HTTP_BAD_REQUEST;
+
+invalid:
+
+    ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                  "client sent empty pseudo-header \"%V\"", &header->name);
+
+    return NGX_HTTP_BAD_REQUEST;
+}
+
+
+static ngx_int_t
+ngx_http_v2_add_request_header(ngx_http_request_t *r, ngx_str_t *name,
+    ngx_str_t *value)
+{
+    ngx_table_elt_t            *h;
+    ngx_http_header_t          *hh;
+    ngx_http_core_main_conf_t  *cmcf;
+
+    h = ngx_list_push(&r->headers_in.headers);
+    if (h == NULL) {
+        return NGX_ERROR;
+    }
+
+    h->key.len = name->len;
+    h->key.data = ngx_pnalloc(r->pool, name->len + 1 + value->len + 1);
+    if (h->key.data == NULL) {
+        return NGX_ERROR;
+    }
+
+    ngx_memcpy(h->key.data, name->data, name->len);
+    h->key.data[name->len] = '\0';
+
+    h->value.len = value->len;
+    h->value.data = h->key.data + name->len + 1;
+
+    ngx_memcpy(h->value.data, value->data, value->len);
+    h->value.data[value->len] = '\0';
+
+    /* the field names are in lowercase already */
+
+    h->lowcase_key = h->key.data;
+    h->hash = ngx_hash_key(h->key.data, h->key.len);
+
+    cmcf = ngx_http_get_module_main_conf(r, ngx_http_core_module);
+
+    hh = ngx_hash_perfect_find(&cmcf->headers_in_hash, h->hash,
+                               h->lowcase_key, h->key.len);
+
+    if (hh && hh->handler(r, h, hh->offset) != NGX_OK) {
+
+        /* the request is finalized by the handler */
+
+        return NGX_ABORT;
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http2 http header: \"%V: %V\"", &h->key, &h->value);
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_v2_run_request(ngx_http_request_t *r)
+{
+    ngx_http_v2_stream_t  *stream;
+
+    stream = r->stream;
+
+    if (ngx_http_v2_construct_request_line(r) != NGX_OK) {
+        return;
+    }
+
+    if (ngx_http_v2_construct_cookie_header(r) != NGX_OK) {
+        return;
+    }
+
+    r->http_state = NGX_HTTP_PROCESS_REQUEST_STATE;
+
+    if (ngx_http_process_request_header(r) != NGX_OK) {
+        return;
+    }
+
+    if (stream->in_closed) {
+
+        if (r->headers_in.content_length_n > 0) {
+            ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                          "client prematurely closed stream");
+
+            ngx_http_finalize_request(r, NGX_HTTP_BAD_REQUEST);
+            return;
+        }
+
+    } else if (ngx_http_v2_init_request_body(r) != NGX_OK) {
+        ngx_http_finalize_request(r, NGX_HTTP_INTERNAL_SERVER_ERROR);
+        return;
+    }
+
+    ngx_http_process_request(r);
+}
+
+
+static ngx_int_t
+ngx_http_v2_construct_request_line(ngx_http_request_t *r)
+{
+    u_char     *p;
+    size_t      len;
+    ngx_int_t   rc;
+    ngx_buf_t   b;
+
+    if (r->method_name.len == 0
+        || r->schema_start == NULL
+        || r->unparsed_uri.len == 0)
+    {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "client sent no :method, :scheme, or :path "
+                      "pseudo-header");
+
+        ngx_http_finalize_request(r, NGX_HTTP_BAD_REQUEST);
+        return NGX_ERROR;
+    }
+
+    if (r->unparsed_uri.data[0] != '/') {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "client sent invalid :path \"%V\"", &r->unparsed_uri);
+
+        ngx_http_finalize_request(r, NGX_HTTP_BAD_REQUEST);
+        return NGX_ERROR;
+    }
+
+    /* the request line is parsed as in HTTP/1.x */
+
+    len = r->method_name.len + 1 + r->unparsed_uri.len + 1
+          + sizeof("HTTP/2.0" CRLF) - 1;
+
+    p = ngx_pnalloc(r->pool, len);
+    if (p == NULL) {
+        ngx_http_finalize_request(r, NGX_HTTP_INTERNAL_SERVER_ERROR);
+        return NGX_ERROR;
+    }
+
+    ngx_memzero(&b, sizeof(ngx_buf_t));
+
+    b.start = p;
+    b.pos = p;
+
+    p = ngx_cpymem(p, r->method_name.data, r->method_name.len);
+    *p++ = ' ';
+    p = ngx_cpymem(p, r->unparsed_uri.data, r->unparsed_uri.len);
+    *p++ = ' ';
+    p = ngx_cpymem(p, "HTTP/2.0" CRLF, sizeof("HTTP/2.0" CRLF) - 1);
+
+    b.last = p;
+    b.end = p;
+
+    r->unparsed_uri.len = 0;
+
+    rc = ngx_http_parse_request_line(r, &b);
+
+    if (rc != NGX_OK) {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "client sent invalid :method or :path");
+
+        ngx_http_finalize_request(r, NGX_HTTP_BAD_REQUEST);
+        return NGX_ERROR;
+    }
+
+    r->request_line.len = r->request_end - r->request_start;
+    r->request_line.data = r->request_start;
+
+    r->method_name.len = r->method_end - r->request_start + 1;
+    r->method_name.data = r->request_line.data;
+
+    r->http_protocol.len = r->request_end - r->http_protocol.data;
+
+    r->http_version = NGX_HTTP_VERSION_20;
+
+    if (ngx_http_process_request_uri(r) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http2 request line: \"%V\"", &r->request_line);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_construct_cookie_header(ngx_http_request_t *r)
+{
+    u_char     *p;
+    size_t      len;
+    ngx_str_t  *cookies, name, value;
+    ngx_uint_t  i;
+    ngx_array_t *array;
+
+    array = r->stream->cookies;
+
+    if (array == NULL) {
+        return NGX_OK;
+    }
+
+    /* the crumbs of the cookie field are joined (RFC 7540, 8.1.2.5) */
+
+    cookies = array->elts;
+
+    len = 0;
+
+    for (i = 0; i < array->nelts; i++) {
+        len += cookies[i].len + 2;
+    }
+
+    len -= 2;
+
+    p = ngx_pnalloc(r->pool, len);
+    if (p == NULL) {
+        ngx_http_finalize_request(r, NGX_HTTP_INTERNAL_SERVER_ERROR);
+        return NGX_ERROR;
+    }
+
+    value.len = len;
+    value.data = p;
+
+    for (i = 0; /* void */; i++) {
+        p = ngx_cpymem(p, cookies[i].data, cookies[i].len);
+
+        if (i == array->nelts - 1) {
+            break;
+        }
+
+        *p++ = ';'; *p++ = ' ';
+    }
+
+    ngx_str_set(&name, "cookie");
+
+    switch (ngx_http_v2_add_request_header(r, &name, &value)) {
+
+    case NGX_OK:
+        return NGX_OK;
+
+    case NGX_ERROR:
+        ngx_http_finalize_request(r, NGX_HTTP_INTERNAL_SERVER_ERROR);
+        return NGX_ERROR;
+
+    default:
+        return NGX_ERROR;
+    }
+}
+
+
+static ngx_int_t
+ngx_http_v2_init_request_body(ngx_http_request_t *r)
+{
+    off_t                      len;
+    ngx_http_request_body_t   *rb;
+    ngx_http_core_loc_conf_t  *clcf;
+
+    rb = ngx_pcalloc(r->pool, sizeof(ngx_http_request_body_t));
+    if (rb == NULL) {
+        return NGX_ERROR;
+    }
+
+    /*
+     * the body is stored as DATA frames arrive and is handed over
+     * once the client half-closes the stream, rb->rest is only
+     * a mark that the reading is not finished for the save filter
+     */
+
+    rb->rest = 1;
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    len = r->headers_in.content_length_n;
+
+    if (len < 0 || len > (off_t) clcf->client_body_buffer_size) {
+        len = clcf->client_body_buffer_size;
+    }
+
+    if (len) {
+        rb->buf = ngx_create_temp_buf(r->pool, (size_t) len);
+        if (rb->buf == NULL) {
+            return NGX_ERROR;
+        }
+    }
+
+    r->request_body = rb;
+
+    return NGX_OK;
+}
+
+
+ngx_int_t
+ngx_http_v2_read_request_body(ngx_http_request_t *r,
+    ngx_http_client_body_handler_pt post_handler)
+{
+    ngx_int_t                  rc;
+    ngx_http_v2_stream_t      *stream;
+    ngx_http_request_body_t   *rb;
+    ngx_http_core_loc_conf_t  *clcf;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, r->connection->log, 0,
+                   "http2 read request body");
+
+    stream = r->stream;
+    rb = r->request_body;
+
+    if (r != r->main || stream->skip_data == NGX_HTTP_V2_DATA_DISCARD) {
+        post_handler(r);
+        return NGX_OK;
+    }
+
+    if (rb == NULL) {
+
+        /* the stream was half-closed with the header block */
+
+        rb = ngx_pcalloc(r->pool, sizeof(ngx_http_request_body_t));
+        if (rb == NULL) {
+            return NGX_HTTP_INTERNAL_SERVER_ERROR;
+        }
+
+        r->request_body = rb;
+
+        post_handler(r);
+        return NGX_OK;
+    }
+
+    if (rb->post_handler) {
+        post_handler(r);
+        return NGX_OK;
+    }
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    if (stream->skip_data == NGX_HTTP_V2_DATA_ERROR) {
+
+        if (clcf->client_max_body_size
+            && stream->recv_length > clcf->client_max_body_size)
+        {
+            return NGX_HTTP_REQUEST_ENTITY_TOO_LARGE;
+        }
+
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    rb->post_handler = post_handler;
+
+    if (stream->in_closed) {
+        rc = ngx_http_v2_finish_request_body(r);
+
+        if (rc != NGX_OK) {
+            return rc;
+        }
+
+        post_handler(r);
+        return NGX_OK;
+    }
+
+    ngx_add_timer(r->connection->read, clcf->client_body_timeout);
+
+    r->read_event_handler = ngx_http_v2_read_client_request_body_handler;
+    r->write_event_handler = ngx_http_request_empty_handler;
+
+    return NGX_AGAIN;
+}
+
+
+static void
+ngx_http_v2_request_body_data(ngx_http_v2_stream_t *stream, u_char *pos,
+    size_t size, ngx_uint_t last)
+{
+    ngx_int_t            rc;
+    ngx_connection_t    *fc;
+    ngx_http_request_t  *r;
+
+    r = stream->request;
+
+    r->request_length += size;
+
+    if (stream->skip_data || stream->closing || r->request_body == NULL) {
+        return;
+    }
+
+    fc = r->connection;
+
+    rc = ngx_http_v2_process_request_body(r, pos, size, last);
+
+    if (rc != NGX_OK) {
+        stream->skip_data = NGX_HTTP_V2_DATA_ERROR;
+
+        if (r->request_body->post_handler) {
+            ngx_http_finalize_request(r, rc);
+        }
+    }
+
+    ngx_http_run_posted_requests(fc);
+}
+
+
+static ngx_int_t
+ngx_http_v2_process_request_body(ngx_http_request_t *r, u_char *pos,
+    size_t size, ngx_uint_t last)
+{
+    size_t                     n;
+    ngx_int_t                  rc;
+    ngx_buf_t                 *buf;
+    ngx_chain_t                cl;
+    ngx_http_v2_stream_t      *stream;
+    ngx_http_request_body_t   *rb;
+    ngx_http_core_loc_conf_t  *clcf;
+
+    stream = r->stream;
+    rb = r->request_body;
+    buf = rb->buf;
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    if (size) {
+        stream->recv_length += size;
+
+        if (r->headers_in.content_length_n >= 0
+            && stream->recv_length > r->headers_in.content_length_n)
+        {
+            ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                          "client intended to send body data "
+                          "larger than declared");
+
+            return NGX_HTTP_BAD_REQUEST;
+        }
+
+        if (clcf->client_max_body_size
+            && stream->recv_length > clcf->client_max_body_size)
+        {
+            ngx_log_error(NGX_LOG_ERR, r->connection->log, 0,
+                          "client intended to send too large body: "
+                          "%O bytes", stream->recv_length);
+
+            return NGX_HTTP_REQUEST_ENTITY_TOO_LARGE;
+        }
+
+        while (size) {
+            n = buf->end - buf->last;
+
+            if (n > size) {
+                n = size;
+            }
+
+            buf->last = ngx_cpymem(buf->last, pos, n);
+
+            pos += n;
+            size -= n;
+
+            if (buf->last == buf->end && (size || !last)) {
+
+                /* the full buffer goes to a temporary file */
+
+                cl.buf = buf;
+                cl.next = NULL;
+
+                if (ngx_http_request_body_save_filter(r, &cl) != NGX_OK) {
+                    return NGX_HTTP_INTERNAL_SERVER_ERROR;
+                }
+
+                buf->pos = buf->start;
+                buf->last = buf->start;
+            }
+        }
+    }
+
+    if (!last) {
+        if (rb->post_handler) {
+            ngx_add_timer(r->connection->read, clcf->client_body_timeout);
+        }
+
+        return NGX_OK;
+    }
+
+    if (r->headers_in.content_length_n < 0) {
+        r->headers_in.content_length_n = stream->recv_length;
+
+    } else if (stream->recv_length != r->headers_in.content_length_n) {
+        ngx_log_error(NGX_LOG_INFO, r->connection->log, 0,
+                      "client prematurely closed stream: "
+                      "only %O out of %O bytes of request body received",
+                      stream->recv_length, r->headers_in.content_length_n);
+
+        return NGX_HTTP_BAD_REQUEST;
+    }
+
+    if (rb->post_handler == NULL) {
+
+        /* the handler gets the body once it asks for it */
+
+        return NGX_OK;
+    }
+
+    rc = ngx_http_v2_finish_request_body(r);
+
+    if (rc != NGX_OK) {
+        return rc;
+    }
+
+    r->read_event_handler = ngx_http_block_reading;
+
+    rb->post_handler(r);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_finish_request_body(ngx_http_request_t *r)
+{
+    ngx_chain_t               cl, *in;
+    ngx_http_request_body_t  *rb;
+
+    rb = r->request_body;
+
+    if (r->connection->read->timer_set) {
+        ngx_del_timer(r->connection->read);
+    }
+
+    in = NULL;
+
+    if (rb->buf && rb->buf->last != rb->buf->pos) {
+        cl.buf = rb->buf;
+        cl.next = NULL;
+        in = &cl;
+    }
+
+    rb->rest = 0;
+
+    if (ngx_http_request_body_save_filter(r, in) != NGX_OK) {
+        return NGX_HTTP_INTERNAL_SERVER_ERROR;
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_v2_read_client_request_body_handler(ngx_http_request_t *r)
+{
+    ngx_connection_t  *fc;
+
+    fc = r->connection;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, fc->log, 0,
+                   "http2 read client request body handler");
+
+    if (fc->read->timedout) {
+        ngx_log_error(NGX_LOG_INFO, fc->log, NGX_ETIMEDOUT,
+                      "client timed out");
+
+        fc->timedout = 1;
+        r->stream->skip_data = NGX_HTTP_V2_DATA_DISCARD;
+
+        ngx_http_finalize_request(r, NGX_HTTP_REQUEST_TIME_OUT);
+        return;
+    }
+
+    if (fc->error) {
+        ngx_log_error(NGX_LOG_INFO, fc->log, 0,
+                      "client prematurely closed stream");
+
+        r->stream->skip_data = NGX_HTTP_V2_DATA_DISCARD;
+
+        ngx_http_finalize_request(r, NGX_HTTP_CLIENT_CLOSED_REQUEST);
+        return;
+    }
+}
+
+
+static ngx_http_v2_stream_t *
+ngx_http_v2_create_stream(ngx_http_v2_connection_t *h2c)
+{
+    ngx_log_t               *log;
+    ngx_event_t             *rev, *wev;
+    ngx_connection_t        *fc;
+    ngx_http_log_ctx_t      *ctx;
+    ngx_http_request_t      *r;
+    ngx_http_v2_stream_t    *stream;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    fc = h2c->free_fake_connections;
+
+    if (fc) {
+        h2c->free_fake_connections = fc->data;
+
+        rev = fc->read;
+        wev = fc->write;
+        log = fc->log;
+        ctx = log->data;
+
+    } else {
+
+        if (h2c->pool == NULL) {
+            h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+            h2c->pool = ngx_create_pool(h2scf->pool_size,
+                                        h2c->connection->log);
+            if (h2c->pool == NULL) {
+                return NULL;
+            }
+        }
+
+        fc = ngx_palloc(h2c->pool, sizeof(ngx_connection_t));
+        if (fc == NULL) {
+            return NULL;
+        }
+
+        rev = ngx_palloc(h2c->pool, sizeof(ngx_event_t));
+        if (rev == NULL) {
+            return NULL;
+        }
+
+        wev = ngx_palloc(h2c->pool, sizeof(ngx_event_t));
+        if (wev == NULL) {
+            return NULL;
+        }
+
+        log = ngx_palloc(h2c->pool, sizeof(ngx_log_t));
+        if (log == NULL) {
+            return NULL;
+        }
+
+        ctx = ngx_palloc(h2c->pool, sizeof(ngx_http_log_ctx_t));
+        if (ctx == NULL) {
+            return NULL;
+        }
+    }
+
+    ctx->connection = fc;
+    ctx->request = NULL;
+    ctx->current_request = NULL;
+
+    ngx_memcpy(log, h2c->connection->log, sizeof(ngx_log_t));
+
+    log->data = ctx;
+
+    ngx_memzero(rev, sizeof(ngx_event_t));
+
+    rev->data = fc;
+    rev->ready = 1;
+    rev->handler = ngx_http_empty_handler;
+    rev->log = log;
+
+    ngx_memcpy(wev, rev, sizeof(ngx_event_t));
+
+    wev->write = 1;
+
+    /*
+     * the stream is served by a fake connection that shares the socket,
+     * its events are never added to the event module: they are always
+     * ready and are posted when the stream may proceed
+     */
+
+    ngx_memcpy(fc, h2c->connection, sizeof(ngx_connection_t));
+
+    fc->data = h2c->http_connection;
+    fc->read = rev;
+    fc->write = wev;
+    fc->sent = 0;
+    fc->log = log;
+    fc->buffered = 0;
+    fc->sndlowat = 1;
+    fc->tcp_nodelay = NGX_TCP_NODELAY_DISABLED;
+
+    r = ngx_http_alloc_request(fc);
+    if (r == NULL) {
+        fc->data = h2c->free_fake_connections;
+        h2c->free_fake_connections = fc;
+        return NULL;
+    }
+
+    if (ngx_list_init(&r->headers_in.headers, r->pool, 20,
+                      sizeof(ngx_table_elt_t))
+        != NGX_OK
+        || ngx_array_init(&r->headers_in.cookies, r->pool, 2,
+                          sizeof(ngx_table_elt_t *))
+           != NGX_OK)
+    {
+        goto failed;
+    }
+
+    stream = ngx_pcalloc(r->pool, sizeof(ngx_http_v2_stream_t));
+    if (stream == NULL) {
+        goto failed;
+    }
+
+    r->stream = stream;
+
+    stream->request = r;
+    stream->connection = h2c;
+
+    stream->send_window = h2c->init_window;
+    stream->recv_window = NGX_HTTP_V2_MAX_WINDOW;
+
+    ngx_queue_init(&stream->children);
+    ngx_queue_init(&stream->sibling);
+
+    fc->data = r;
+
+    h2c->processing++;
+
+    return stream;
+
+failed:
+
+    ngx_http_free_request(r, NGX_HTTP_INTERNAL_SERVER_ERROR);
+
+    fc->data = h2c->free_fake_connections;
+    h2c->free_fake_connections = fc;
+
+    return NULL;
+}
+
+
+static ngx_http_v2_stream_t *
+ngx_http_v2_get_stream_by_id(ngx_http_v2_connection_t *h2c, ngx_uint_t sid)
+{
+    ngx_http_v2_stream_t    *stream;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    stream = h2c->streams_index[ngx_http_v2_index(h2scf, sid)];
+
+    while (stream) {
+        if (stream->id == sid) {
+            return stream;
+        }
+
+        stream = stream->index;
+    }
+
+    return NULL;
+}
+
+
+static ngx_int_t
+ngx_http_v2_terminate_stream(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_stream_t *stream, ngx_uint_t status)
+{
+    if (ngx_http_v2_send_rst_stream(h2c, stream->id, status) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    stream->in_closed = 1;
+    stream->out_closed = 1;
+
+    if (!stream->closing) {
+        ngx_http_v2_abort_stream(stream);
+    }
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_v2_abort_stream(ngx_http_v2_stream_t *stream)
+{
+    ngx_connection_t    *fc;
+    ngx_http_request_t  *r;
+
+    r = stream->request;
+    fc = r->connection;
+
+    fc->error = 1;
+
+    stream->skip_data = NGX_HTTP_V2_DATA_DISCARD;
+
+    ngx_http_finalize_request(r, NGX_HTTP_CLIENT_CLOSED_REQUEST);
+    ngx_http_run_posted_requests(fc);
+}
+
+
+void
+ngx_http_v2_close_stream(ngx_http_v2_stream_t *stream, ngx_int_t rc)
+{
+    ngx_uint_t                 timedout, status;
+    ngx_event_t               *ev;
+    ngx_connection_t          *fc;
+    ngx_http_v2_stream_t     **index;
+    ngx_http_v2_srv_conf_t    *h2scf;
+    ngx_http_v2_connection_t  *h2c;
+
+    h2c = stream->connection;
+    fc = stream->request->connection;
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 close stream %ui, queued %ui, processing %ui, "
+                   "rc %i", stream->id, stream->queued, h2c->processing, rc);
+
+    if (h2c->state.stream == stream) {
+        h2c->state.stream = NULL;
+    }
+
+    if (stream->queued) {
+
+        /* the stream is closed once its frames are sent */
+
+        stream->closing = 1;
+
+        fc->write->handler = ngx_http_v2_close_stream_handler;
+        fc->read->handler = ngx_http_empty_handler;
+
+        fc->write->delayed = 0;
+
+        if (fc->write->timer_set) {
+            ngx_del_timer(fc->write);
+        }
+
+        if (fc->read->timer_set) {
+            ngx_del_timer(fc->read);
+        }
+
+        return;
+    }
+
+    timedout = fc->timedout;
+
+    /* the socket is shared, so it is never reset on a stream timeout */
+
+    fc->timedout = 0;
+
+    if (!h2c->connection->error && (!stream->out_closed || !stream->in_closed))
+    {
+        if (!stream->out_closed) {
+            status = timedout ? NGX_HTTP_V2_PROTOCOL_ERROR
+                              : NGX_HTTP_V2_INTERNAL_ERROR;
+
+        } else {
+
+            /* the response is complete, the rest of the body is not needed */
+
+            status = NGX_HTTP_V2_NO_ERROR;
+        }
+
+        if (ngx_http_v2_send_rst_stream(h2c, stream->id, status) != NGX_OK) {
+            h2c->connection->error = 1;
+        }
+    }
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    for (index = h2c->streams_index + ngx_http_v2_index(h2scf, stream->id);
+         *index;
+         index = &(*index)->index)
+    {
+        if (*index == stream) {
+            *index = stream->index;
+            break;
+        }
+    }
+
+    ngx_http_v2_node_remove(h2c, stream);
+
+    if (stream->waiting) {
+        ngx_queue_remove(&stream->queue);
+        stream->waiting = 0;
+
+        ngx_http_v2_handle_waiting(h2c);
+    }
+
+    /* the stream is allocated from the request pool */
+
+    ngx_http_free_request(stream->request, rc);
+
+    ev = fc->read;
+
+    if (ev->timer_set) {
+        ngx_del_timer(ev);
+    }
+
+    if (ev->prev) {
+        ngx_delete_posted_event(ev);
+    }
+
+    ev = fc->write;
+
+    if (ev->timer_set) {
+        ngx_del_timer(ev);
+    }
+
+    if (ev->prev) {
+        ngx_delete_posted_event(ev);
+    }
+
+    fc->data = h2c->free_fake_connections;
+    h2c->free_fake_connections = fc;
+
+    h2c->processing--;
+
+    if (h2c->processing || h2c->blocked) {
+        return;
+    }
+
+    ev = h2c->connection->read;
+
+    ev->handler = ngx_http_v2_handle_connection_handler;
+    ngx_post_event(ev, &ngx_posted_events);
+}
+
+
+static void
+ngx_http_v2_close_stream_handler(ngx_event_t *ev)
+{
+    ngx_connection_t    *fc;
+    ngx_http_request_t  *r;
+
+    fc = ev->data;
+    r = fc->data;
+
+    ngx_log_debug0(NGX_LOG_DEBUG_HTTP, fc->log, 0,
+                   "http2 close stream handler");
+
+    ngx_http_v2_close_stream(r->stream, 0);
+}
+
+
+static void
+ngx_http_v2_set_dependency(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_stream_t *stream, ngx_uint_t depend, ngx_uint_t exclusive,
+    ngx_uint_t weight)
+{
+    ngx_queue_t           *q, *children;
+    ngx_http_v2_stream_t  *parent, *p, *child;
+
+    parent = depend ? ngx_http_v2_get_stream_by_id(h2c, depend) : NULL;
+
+    if (depend && parent == NULL) {
+
+        /* a closed or idle stream: the default priority (RFC 7540, 5.3.1) */
+
+        exclusive = 0;
+        weight = NGX_HTTP_V2_DEFAULT_WEIGHT;
+    }
+
+    if (parent) {
+
+        /* a dependent stream is moved up first (RFC 7540, 5.3.3) */
+
+        for (p = parent->parent; p; p = p->parent) {
+
+            if (p != stream) {
+                continue;
+            }
+
+            ngx_queue_remove(&parent->sibling);
+
+            parent->parent = stream->parent;
+
+            children = stream->parent ? &stream->parent->children
+                                      : &h2c->dependencies;
+
+            ngx_queue_insert_tail(children, &parent->sibling);
+
+            break;
+        }
+    }
+
+    ngx_queue_remove(&stream->sibling);
+
+    children = parent ? &parent->children : &h2c->dependencies;
+
+    if (exclusive) {
+        while (!ngx_queue_empty(children)) {
+            q = ngx_queue_head(children);
+
+            ngx_queue_remove(q);
+
+            child = ngx_queue_data(q, ngx_http_v2_stream_t, sibling);
+            child->parent = stream;
+
+            ngx_queue_insert_tail(&stream->children, q);
+        }
+    }
+
+    stream->parent = parent;
+    stream->weight = weight;
+
+    ngx_queue_insert_tail(children, &stream->sibling);
+
+    ngx_http_v2_node_update(parent ? parent : stream);
+}
+
+
+static void
+ngx_http_v2_node_remove(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_stream_t *stream)
+{
+    ngx_queue_t           *q, *children;
+    ngx_http_v2_stream_t  *child;
+
+    ngx_queue_remove(&stream->sibling);
+
+    /* the children are inherited by the parent (RFC 7540, 5.3.4) */
+
+    children = stream->parent ? &stream->parent->children
+                              : &h2c->dependencies;
+
+    while (!ngx_queue_empty(&stream->children)) {
+        q = ngx_queue_head(&stream->children);
+
+        ngx_queue_remove(q);
+
+        child = ngx_queue_data(q, ngx_http_v2_stream_t, sibling);
+        child->parent = stream->parent;
+
+        ngx_queue_insert_tail(children, q);
+
+        ngx_http_v2_node_update(child);
+    }
+}
+
+
+static void
+ngx_http_v2_node_update(ngx_http_v2_stream_t *stream)
+{
+    ngx_queue_t           *q;
+    ngx_http_v2_stream_t  *child;
+
+    if (stream->parent) {
+        stream->rank = stream->parent->rank + 1;
+        stream->rel_weight = (stream->parent->rel_weight / 256)
+                             * stream->weight;
+
+    } else {
+        stream->rank = 1;
+        stream->rel_weight = (1.0 / 256) * stream->weight;
+    }
+
+    for (q = ngx_queue_head(&stream->children);
+         q != ngx_queue_sentinel(&stream->children);
+         q = ngx_queue_next(q))
+    {
+        child = ngx_queue_data(q, ngx_http_v2_stream_t, sibling);
+        ngx_http_v2_node_update(child);
+    }
+}
+
+
+static ngx_int_t
+ngx_http_v2_adjust_windows(ngx_http_v2_connection_t *h2c, ssize_t delta)
+{
+    ngx_uint_t               i, size;
+    ngx_http_v2_stream_t    *stream;
+    ngx_http_v2_srv_conf_t  *h2scf;
+
+    h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+    size = ngx_http_v2_index_size(h2scf);
+
+    for (i = 0; i < size; i++) {
+
+        for (stream = h2c->streams_index[i]; stream; stream = stream->index) {
+
+            if (delta > 0
+                && stream->send_window
+                   > (ssize_t) (NGX_HTTP_V2_MAX_WINDOW - delta))
+            {
+                return NGX_ERROR;
+            }
+
+            stream->send_window += delta;
+
+            ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                           "http2 adjusted window: %z of stream %ui",
+                           stream->send_window, stream->id);
+
+            if (stream->exhausted && stream->send_window > 0) {
+                stream->exhausted = 0;
+
+                if (!stream->queued) {
+                    ngx_http_v2_handle_stream(h2c, stream);
+                }
+            }
+        }
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_http_v2_out_frame_t *
+ngx_http_v2_get_frame(ngx_http_v2_connection_t *h2c, size_t length,
+    ngx_uint_t type, u_char flags, ngx_uint_t sid)
+{
+    ngx_buf_t                *buf;
+    ngx_pool_t               *pool;
+    ngx_http_v2_out_frame_t  *frame;
+
+    frame = h2c->free_frames;
+
+    if (frame) {
+        h2c->free_frames = frame->next;
+
+        buf = frame->first->buf;
+        buf->pos = buf->start;
+
+    } else {
+        pool = h2c->connection->pool;
+
+        frame = ngx_pcalloc(pool, sizeof(ngx_http_v2_out_frame_t));
+        if (frame == NULL) {
+            return NULL;
+        }
+
+        frame->first = ngx_alloc_chain_link(pool);
+        if (frame->first == NULL) {
+            return NULL;
+        }
+
+        buf = ngx_create_temp_buf(pool, NGX_HTTP_V2_FRAME_BUFFER_SIZE);
+        if (buf == NULL) {
+            return NULL;
+        }
+
+        frame->first->buf = buf;
+        frame->last = frame->first;
+
+        frame->handler = ngx_http_v2_frame_handler;
+    }
+
+    h2c->frames++;
+
+#if (NGX_DEBUG)
+    if (length > NGX_HTTP_V2_FRAME_BUFFER_SIZE - NGX_HTTP_V2_FRAME_HEADER_SIZE)
+    {
+        ngx_log_error(NGX_LOG_ALERT, h2c->connection->log, 0,
+                      "requested control frame is too large: %uz", length);
+        return NULL;
+    }
+#endif
+
+    frame->length = length;
+    frame->blocked = 0;
+
+    buf->last = ngx_http_v2_write_len_and_type(buf->pos, length, type);
+
+    *buf->last++ = flags;
+
+    buf->last = ngx_http_v2_write_sid(buf->last, sid);
+
+    return frame;
+}
+
+
+static ngx_int_t
+ngx_http_v2_frame_handler(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_out_frame_t *frame)
+{
+    ngx_buf_t  *buf;
+
+    buf = frame->first->buf;
+
+    if (buf->pos != buf->last) {
+        return NGX_AGAIN;
+    }
+
+    h2c->frames--;
+
+    frame->next = h2c->free_frames;
+    h2c->free_frames = frame;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_send_settings(ngx_http_v2_connection_t *h2c, ngx_uint_t ack)
+{
+    size_t                    len;
+    ngx_buf_t                *buf;
+    ngx_http_v2_srv_conf_t   *h2scf;
+    ngx_http_v2_out_frame_t  *frame;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 send SETTINGS frame ack:%ui", ack);
+
+    len = ack ? 0 : 2 * NGX_HTTP_V2_SETTINGS_PARAM_SIZE;
+
+    frame = ngx_http_v2_get_frame(h2c, len, NGX_HTTP_V2_SETTINGS_FRAME,
+                                  ack ? NGX_HTTP_V2_ACK_FLAG
+                                      : NGX_HTTP_V2_NO_FLAG,
+                                  0);
+    if (frame == NULL) {
+        return NGX_ERROR;
+    }
+
+    if (!ack) {
+        buf = frame->first->buf;
+
+        h2scf = ngx_http_v2_get_module_srv_conf(h2c, ngx_http_v2_module);
+
+        buf->last = ngx_http_v2_write_uint16(buf->last,
+                                           NGX_HTTP_V2_MAX_STREAMS_SETTING);
+        buf->last = ngx_http_v2_write_uint32(buf->last,
+                                             h2scf->concurrent_streams);
+
+        buf->last = ngx_http_v2_write_uint16(buf->last,
+                                         NGX_HTTP_V2_INIT_WINDOW_SIZE_SETTING);
+        buf->last = ngx_http_v2_write_uint32(buf->last,
+                                             NGX_HTTP_V2_MAX_WINDOW);
+    }
+
+    ngx_http_v2_queue_blocked_frame(h2c, frame);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_send_window_update(ngx_http_v2_connection_t *h2c, ngx_uint_t sid,
+    size_t window)
+{
+    ngx_buf_t                *buf;
+    ngx_http_v2_out_frame_t  *frame;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 send WINDOW_UPDATE frame sid:%ui, window:%uz",
+                   sid, window);
+
+    frame = ngx_http_v2_get_frame(h2c, NGX_HTTP_V2_WINDOW_UPDATE_SIZE,
+                                  NGX_HTTP_V2_WINDOW_UPDATE_FRAME,
+                                  NGX_HTTP_V2_NO_FLAG, sid);
+    if (frame == NULL) {
+        return NGX_ERROR;
+    }
+
+    buf = frame->first->buf;
+
+    buf->last = ngx_http_v2_write_uint32(buf->last, window);
+
+    ngx_http_v2_queue_blocked_frame(h2c, frame);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_send_rst_stream(ngx_http_v2_connection_t *h2c, ngx_uint_t sid,
+    ngx_uint_t status)
+{
+    ngx_buf_t                *buf;
+    ngx_http_v2_out_frame_t  *frame;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 send RST_STREAM frame sid:%ui, status:%ui",
+                   sid, status);
+
+    frame = ngx_http_v2_get_frame(h2c, NGX_HTTP_V2_RST_STREAM_SIZE,
+                                  NGX_HTTP_V2_RST_STREAM_FRAME,
+                                  NGX_HTTP_V2_NO_FLAG, sid);
+    if (frame == NULL) {
+        return NGX_ERROR;
+    }
+
+    buf = frame->first->buf;
+
+    buf->last = ngx_http_v2_write_uint32(buf->last, status);
+
+    ngx_http_v2_queue_blocked_frame(h2c, frame);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_send_goaway(ngx_http_v2_connection_t *h2c, ngx_uint_t status)
+{
+    ngx_buf_t                *buf;
+    ngx_http_v2_out_frame_t  *frame;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 send GOAWAY frame: last sid %ui, error %ui",
+                   h2c->last_sid, status);
+
+    frame = ngx_http_v2_get_frame(h2c, NGX_HTTP_V2_GOAWAY_SIZE,
+                                  NGX_HTTP_V2_GOAWAY_FRAME,
+                                  NGX_HTTP_V2_NO_FLAG, 0);
+    if (frame == NULL) {
+        return NGX_ERROR;
+    }
+
+    buf = frame->first->buf;
+
+    buf->last = ngx_http_v2_write_sid(buf->last, h2c->last_sid);
+    buf->last = ngx_http_v2_write_uint32(buf->last, status);
+
+    ngx_http_v2_queue_blocked_frame(h2c, frame);
+
+    h2c->goaway = 1;
+
+    return NGX_OK;
+}
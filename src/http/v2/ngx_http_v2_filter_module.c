@@ -0,0 +1,1201 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+#include <nginx.h>
+#include <ngx_http_v2_module.h>
+
+
+/* the indices of the static table (RFC 7541, Appendix A) */
+#define NGX_HTTP_V2_STATUS_INDEX          8
+#define NGX_HTTP_V2_STATUS_200_INDEX      8
+#define NGX_HTTP_V2_STATUS_204_INDEX      9
+#define NGX_HTTP_V2_STATUS_206_INDEX      10
+#define NGX_HTTP_V2_STATUS_304_INDEX      11
+#define NGX_HTTP_V2_STATUS_400_INDEX      12
+#define NGX_HTTP_V2_STATUS_404_INDEX      13
+#define NGX_HTTP_V2_STATUS_500_INDEX      14
+
+#define NGX_HTTP_V2_CONTENT_LENGTH_INDEX  28
+#define NGX_HTTP_V2_CONTENT_TYPE_INDEX    31
+#define NGX_HTTP_V2_DATE_INDEX            33
+#define NGX_HTTP_V2_LAST_MODIFIED_INDEX   44
+#define NGX_HTTP_V2_LOCATION_INDEX        46
+#define NGX_HTTP_V2_SERVER_INDEX          54
+#define NGX_HTTP_V2_VARY_INDEX            59
+
+/* an integer with the 7-bit prefix in at most 4 octets */
+#define NGX_HTTP_V2_INT_OCTETS            4
+#define NGX_HTTP_V2_MAX_FIELD                                                 \
+    (127 + (1 << (NGX_HTTP_V2_INT_OCTETS - 1) * 7) - 1)
+
+#define ngx_http_v2_indexed(i)      (128 + (i))
+#define ngx_http_v2_inc_indexed(i)  (64 + (i))
+
+#define NGX_HTTP_V2_ENCODE_RAW            0
+
+
+static u_char *ngx_http_v2_write_int(u_char *pos, ngx_uint_t prefix,
+    ngx_uint_t value);
+static u_char *ngx_http_v2_write_field(u_char *pos, ngx_uint_t index,
+    ngx_str_t *name, u_char *value, size_t len);
+static ngx_int_t ngx_http_v2_create_headers_frame(ngx_http_request_t *r,
+    u_char *pos, u_char *end);
+static ngx_chain_t *ngx_http_v2_filter_get_shadow(
+    ngx_http_v2_stream_t *stream, ngx_buf_t *buf, off_t offset, off_t size);
+static ngx_http_v2_out_frame_t *ngx_http_v2_filter_get_data_frame(
+    ngx_http_v2_stream_t *stream, size_t len, ngx_chain_t *first,
+    ngx_uint_t fin);
+static ngx_int_t ngx_http_v2_filter_send(ngx_connection_t *fc,
+    ngx_http_v2_stream_t *stream);
+
+static ngx_int_t ngx_http_v2_headers_frame_handler(
+    ngx_http_v2_connection_t *h2c, ngx_http_v2_out_frame_t *frame);
+static ngx_int_t ngx_http_v2_data_frame_handler(
+    ngx_http_v2_connection_t *h2c, ngx_http_v2_out_frame_t *frame);
+static void ngx_http_v2_handle_frame(ngx_http_v2_stream_t *stream,
+    ngx_http_v2_out_frame_t *frame);
+
+static ngx_int_t ngx_http_v2_filter_init(ngx_conf_t *cf);
+
+
+static ngx_http_module_t  ngx_http_v2_filter_module_ctx = {
+    NULL,                                  /* preconfiguration */
+    ngx_http_v2_filter_init,               /* postconfiguration */
+
+    NULL,                                  /* create main configuration */
+    NULL,                                  /* init main configuration */
+
+    NULL,                                  /* create server configuration */
+    NULL,                                  /* merge server configuration */
+
+    NULL,                                  /* create location configuration */
+    NULL                                   /* merge location configuration */
+};
+
+
+ngx_module_t  ngx_http_v2_filter_module = {
+    NGX_MODULE_V1,
+    &ngx_http_v2_filter_module_ctx,        /* module context */
+    NULL,                                  /* module directives */
+    NGX_HTTP_MODULE,                       /* module type */
+    NULL,                                  /* init master */
+    NULL,                                  /* init module */
+    NULL,                                  /* init process */
+    NULL,                                  /* init thread */
+    NULL,                                  /* exit thread */
+    NULL,                                  /* exit process */
+    NULL,                                  /* exit master */
+    NGX_MODULE_V1_PADDING
+};
+
+
+static ngx_http_output_header_filter_pt  ngx_http_next_header_filter;
+
+
+static ngx_int_t
+ngx_http_v2_header_filter(ngx_http_request_t *r)
+{
+    u_char                    *pos, *start, *p, tmp[NGX_OFF_T_LEN];
+    u_char                     date[sizeof("Mon, 28 Sep 1970 06:00:00 GMT")];
+    size_t                     len;
+    ngx_str_t                  host, name;
+    ngx_uint_t                 status, index, port, i;
+    ngx_list_part_t           *part;
+    ngx_table_elt_t           *header;
+    ngx_connection_t          *fc;
+    ngx_http_core_loc_conf_t  *clcf;
+    ngx_http_core_srv_conf_t  *cscf;
+    struct sockaddr_in        *sin;
+#if (NGX_HAVE_INET6)
+    struct sockaddr_in6       *sin6;
+#endif
+    u_char                     addr[NGX_SOCKADDR_STRLEN];
+
+    if (r->stream == NULL) {
+        return ngx_http_next_header_filter(r);
+    }
+
+    if (r->header_sent) {
+        return NGX_OK;
+    }
+
+    r->header_sent = 1;
+
+    if (r != r->main) {
+        return NGX_OK;
+    }
+
+    fc = r->connection;
+
+    if (fc->error) {
+        return NGX_ERROR;
+    }
+
+    if (r->method == NGX_HTTP_HEAD) {
+        r->header_only = 1;
+    }
+
+    switch (r->headers_out.status) {
+
+    case NGX_HTTP_OK:
+        index = NGX_HTTP_V2_STATUS_200_INDEX;
+        break;
+
+    case NGX_HTTP_NO_CONTENT:
+        r->header_only = 1;
+
+        ngx_str_null(&r->headers_out.content_type);
+
+        r->headers_out.content_length = NULL;
+        r->headers_out.content_length_n = -1;
+
+        r->headers_out.last_modified_time = -1;
+        r->headers_out.last_modified = NULL;
+
+        index = NGX_HTTP_V2_STATUS_204_INDEX;
+        break;
+
+    case NGX_HTTP_PARTIAL_CONTENT:
+        index = NGX_HTTP_V2_STATUS_206_INDEX;
+        break;
+
+    case NGX_HTTP_NOT_MODIFIED:
+        r->header_only = 1;
+        index = NGX_HTTP_V2_STATUS_304_INDEX;
+        break;
+
+    default:
+        r->headers_out.last_modified_time = -1;
+        r->headers_out.last_modified = NULL;
+
+        switch (r->headers_out.status) {
+
+        case NGX_HTTP_BAD_REQUEST:
+            index = NGX_HTTP_V2_STATUS_400_INDEX;
+            break;
+
+        case NGX_HTTP_NOT_FOUND:
+            index = NGX_HTTP_V2_STATUS_404_INDEX;
+            break;
+
+        case NGX_HTTP_INTERNAL_SERVER_ERROR:
+            index = NGX_HTTP_V2_STATUS_500_INDEX;
+            break;
+
+        default:
+            index = 0;
+        }
+    }
+
+    status = r->headers_out.status;
+
+    /* the status is a literal field with the ":status" name if not indexed */
+
+    len = 1 + (index ? 0 : 1 + sizeof("000") - 1);
+
+    clcf = ngx_http_get_module_loc_conf(r, ngx_http_core_module);
+
+    if (r->headers_out.server == NULL) {
+        len += 2 + NGX_HTTP_V2_INT_OCTETS
+               + (clcf->server_tokens ? sizeof(NGINX_VER) - 1
+                                      : sizeof("nginx") - 1);
+    }
+
+    if (r->headers_out.date == NULL) {
+        len += 2 + NGX_HTTP_V2_INT_OCTETS + ngx_cached_http_time.len;
+    }
+
+    if (r->headers_out.content_type.len) {
+        len += 2 + NGX_HTTP_V2_INT_OCTETS + r->headers_out.content_type.len;
+
+        if (r->headers_out.content_type_len == r->headers_out.content_type.len
+            && r->headers_out.charset.len)
+        {
+            len += sizeof("; charset=") - 1 + r->headers_out.charset.len;
+        }
+    }
+
+    if (r->headers_out.content_length == NULL
+        && r->headers_out.content_length_n >= 0)
+    {
+        len += 2 + NGX_HTTP_V2_INT_OCTETS + NGX_OFF_T_LEN;
+    }
+
+    if (r->headers_out.last_modified == NULL
+        && r->headers_out.last_modified_time != -1)
+    {
+        len += 2 + NGX_HTTP_V2_INT_OCTETS
+               + sizeof("Mon, 28 Sep 1970 06:00:00 GMT") - 1;
+    }
+
+    if (r->headers_out.location
+        && r->headers_out.location->value.len
+        && r->headers_out.location->value.data[0] == '/')
+    {
+        r->headers_out.location->hash = 0;
+
+        if (clcf->server_name_in_redirect) {
+            cscf = ngx_http_get_module_srv_conf(r, ngx_http_core_module);
+            host = cscf->server_name;
+
+        } else if (r->headers_in.server.len) {
+            host = r->headers_in.server;
+
+        } else {
+            host.len = NGX_SOCKADDR_STRLEN;
+            host.data = addr;
+
+            if (ngx_connection_local_sockaddr(fc, &host, 0) != NGX_OK) {
+                return NGX_ERROR;
+            }
+        }
+
+        switch (fc->local_sockaddr->sa_family) {
+
+#if (NGX_HAVE_INET6)
+        case AF_INET6:
+            sin6 = (struct sockaddr_in6 *) fc->local_sockaddr;
+            port = ntohs(sin6->sin6_port);
+            break;
+#endif
+#if (NGX_HAVE_UNIX_DOMAIN)
+        case AF_UNIX:
+            port = 0;
+            break;
+#endif
+        default: /* AF_INET */
+            sin = (struct sockaddr_in *) fc->local_sockaddr;
+            port = ntohs(sin->sin_port);
+            break;
+        }
+
+        if (clcf->port_in_redirect) {
+
+#if (NGX_HTTP_SSL)
+            if (fc->ssl)
+                port = (port == 443) ? 0 : port;
+            else
+#endif
+                port = (port == 80) ? 0 : port;
+
+        } else {
+            port = 0;
+        }
+
+        len += 2 + NGX_HTTP_V2_INT_OCTETS + sizeof("https://") - 1 + host.len
+               + sizeof(":65535") - 1 + r->headers_out.location->value.len;
+
+    } else {
+        ngx_str_null(&host);
+        port = 0;
+    }
+
+#if (NGX_HTTP_GZIP)
+    if (r->gzip_vary) {
+        if (clcf->gzip_vary) {
+            len += 2 + NGX_HTTP_V2_INT_OCTETS + sizeof("Accept-Encoding") - 1;
+
+        } else {
+            r->gzip_vary = 0;
+        }
+    }
+#endif
+
+    part = &r->headers_out.headers.part;
+    header = part->elts;
+
+    for (i = 0; /* void */; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            header = part->elts;
+            i = 0;
+        }
+
+        if (header[i].hash == 0) {
+            continue;
+        }
+
+        if (header[i].key.len > NGX_HTTP_V2_MAX_FIELD
+            || header[i].value.len > NGX_HTTP_V2_MAX_FIELD)
+        {
+            ngx_log_error(NGX_LOG_CRIT, fc->log, 0,
+                          "too long response header \"%V\" in http2 stream",
+                          &header[i].key);
+            return NGX_ERROR;
+        }
+
+        len += 1 + NGX_HTTP_V2_INT_OCTETS + header[i].key.len
+               + NGX_HTTP_V2_INT_OCTETS + header[i].value.len;
+    }
+
+    start = ngx_pnalloc(r->pool, len);
+    if (start == NULL) {
+        return NGX_ERROR;
+    }
+
+    pos = start;
+
+    if (index) {
+        *pos++ = ngx_http_v2_indexed(index);
+
+    } else {
+        *pos++ = NGX_HTTP_V2_STATUS_INDEX;
+        *pos++ = NGX_HTTP_V2_ENCODE_RAW | 3;
+        pos = ngx_sprintf(pos, "%03ui", status);
+    }
+
+    if (r->headers_out.server == NULL) {
+        if (clcf->server_tokens) {
+            pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_SERVER_INDEX, NULL,
+                                          (u_char *) NGINX_VER,
+                                          sizeof(NGINX_VER) - 1);
+
+        } else {
+            pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_SERVER_INDEX, NULL,
+                                          (u_char *) "nginx",
+                                          sizeof("nginx") - 1);
+        }
+    }
+
+    if (r->headers_out.date == NULL) {
+        pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_DATE_INDEX, NULL,
+                                      ngx_cached_http_time.data,
+                                      ngx_cached_http_time.len);
+    }
+
+    if (r->headers_out.content_type.len) {
+
+        if (r->headers_out.content_type_len == r->headers_out.content_type.len
+            && r->headers_out.charset.len)
+        {
+            len = r->headers_out.content_type.len + sizeof("; charset=") - 1
+                  + r->headers_out.charset.len;
+
+            p = ngx_pnalloc(r->pool, len);
+            if (p == NULL) {
+                return NGX_ERROR;
+            }
+
+            /* update r->headers_out.content_type for possible logging */
+
+            r->headers_out.content_type.data = p;
+
+            p = ngx_cpymem(p, r->headers_out.content_type.data,
+                           r->headers_out.content_type.len);
+            p = ngx_cpymem(p, "; charset=", sizeof("; charset=") - 1);
+            ngx_memcpy(p, r->headers_out.charset.data,
+                       r->headers_out.charset.len);
+
+            r->headers_out.content_type.len = len;
+        }
+
+        pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_CONTENT_TYPE_INDEX,
+                                      NULL, r->headers_out.content_type.data,
+                                      r->headers_out.content_type.len);
+    }
+
+    if (r->headers_out.content_length == NULL
+        && r->headers_out.content_length_n >= 0)
+    {
+        p = ngx_sprintf(tmp, "%O", r->headers_out.content_length_n);
+
+        pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_CONTENT_LENGTH_INDEX,
+                                      NULL, tmp, p - tmp);
+    }
+
+    if (r->headers_out.last_modified == NULL
+        && r->headers_out.last_modified_time != -1)
+    {
+        p = ngx_http_time(date, r->headers_out.last_modified_time);
+
+        pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_LAST_MODIFIED_INDEX,
+                                      NULL, date, p - date);
+    }
+
+    if (host.data) {
+
+        /* the location is made absolute as in HTTP/1.x */
+
+        len = sizeof("https://") - 1 + host.len + sizeof(":65535") - 1
+              + r->headers_out.location->value.len;
+
+        p = ngx_pnalloc(r->pool, len);
+        if (p == NULL) {
+            return NGX_ERROR;
+        }
+
+        name.data = p;
+
+        p = ngx_cpymem(p, "http", sizeof("http") - 1);
+
+#if (NGX_HTTP_SSL)
+        if (fc->ssl) {
+            *p++ = 's';
+        }
+#endif
+
+        *p++ = ':'; *p++ = '/'; *p++ = '/';
+        p = ngx_copy(p, host.data, host.len);
+
+        if (port) {
+            p = ngx_sprintf(p, ":%ui", port);
+        }
+
+        p = ngx_copy(p, r->headers_out.location->value.data,
+                     r->headers_out.location->value.len);
+
+        /* update r->headers_out.location->value for possible logging */
+
+        r->headers_out.location->value.len = p - name.data;
+        r->headers_out.location->value.data = name.data;
+        ngx_str_set(&r->headers_out.location->key, "Location");
+
+        pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_LOCATION_INDEX, NULL,
+                                      r->headers_out.location->value.data,
+                                      r->headers_out.location->value.len);
+    }
+
+#if (NGX_HTTP_GZIP)
+    if (r->gzip_vary) {
+        pos = ngx_http_v2_write_field(pos, NGX_HTTP_V2_VARY_INDEX, NULL,
+                                      (u_char *) "Accept-Encoding",
+                                      sizeof("Accept-Encoding") - 1);
+    }
+#endif
+
+    part = &r->headers_out.headers.part;
+    header = part->elts;
+
+    for (i = 0; /* void */; i++) {
+
+        if (i >= part->nelts) {
+            if (part->next == NULL) {
+                break;
+            }
+
+            part = part->next;
+            header = part->elts;
+            i = 0;
+        }
+
+        if (header[i].hash == 0) {
+            continue;
+        }
+
+        /* the connection-specific fields are not allowed in HTTP/2 */
+
+        switch (header[i].key.len) {
+
+        case 7:
+            if (ngx_strncasecmp(header[i].key.data, (u_char *) "upgrade", 7)
+                == 0)
+            {
+                continue;
+            }
+
+            break;
+
+        case 10:
+            if (ngx_strncasecmp(header[i].key.data, (u_char *) "connection",
+                                10) == 0
+                || ngx_strncasecmp(header[i].key.data, (u_char *) "keep-alive",
+                                   10) == 0)
+            {
+                continue;
+            }
+
+            break;
+
+        case 16:
+            if (ngx_strncasecmp(header[i].key.data,
+                                (u_char *) "proxy-connection", 16) == 0)
+            {
+                continue;
+            }
+
+            break;
+
+        case 17:
+            if (ngx_strncasecmp(header[i].key.data,
+                                (u_char *) "transfer-encoding", 17) == 0)
+            {
+                continue;
+            }
+
+            break;
+        }
+
+        pos = ngx_http_v2_write_field(pos, 0, &header[i].key,
+                                      header[i].value.data,
+                                      header[i].value.len);
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, fc->log, 0,
+                   "http2 header block: %uz bytes, stream %ui",
+                   (size_t) (pos - start), r->stream->id);
+
+    if (ngx_http_v2_create_headers_frame(r, start, pos) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    /* the body is sent as DATA frames by ngx_http_v2_send_chain() */
+
+    fc->send_chain = ngx_http_v2_send_chain;
+    fc->need_last_buf = 1;
+
+    return ngx_http_v2_filter_send(fc, r->stream);
+}
+
+
+static u_char *
+ngx_http_v2_write_int(u_char *pos, ngx_uint_t prefix, ngx_uint_t value)
+{
+    /* the first octet with the prefix is written by the caller */
+
+    prefix = ngx_http_v2_prefix(prefix);
+
+    if (value < prefix) {
+        return pos;
+    }
+
+    value -= prefix;
+
+    while (value >= 128) {
+        *pos++ = value % 128 + 128;
+        value /= 128;
+    }
+
+    *pos++ = (u_char) value;
+
+    return pos;
+}
+
+
+static u_char *
+ngx_http_v2_write_field(u_char *pos, ngx_uint_t index, ngx_str_t *name,
+    u_char *value, size_t len)
+{
+    u_char  *p;
+
+    /* a literal field without indexing */
+
+    if (index) {
+        *pos++ = (u_char) ngx_min(index, ngx_http_v2_prefix(4));
+        pos = ngx_http_v2_write_int(pos, 4, index);
+
+    } else {
+        *pos++ = 0;
+
+        *pos++ = NGX_HTTP_V2_ENCODE_RAW
+                 | (u_char) ngx_min(name->len, ngx_http_v2_prefix(7));
+        pos = ngx_http_v2_write_int(pos, 7, name->len);
+
+        /* the field names must be in lowercase */
+
+        p = pos;
+        pos = ngx_cpymem(pos, name->data, name->len);
+        ngx_strlow(p, p, name->len);
+    }
+
+    *pos++ = NGX_HTTP_V2_ENCODE_RAW
+             | (u_char) ngx_min(len, ngx_http_v2_prefix(7));
+    pos = ngx_http_v2_write_int(pos, 7, len);
+
+    return ngx_cpymem(pos, value, len);
+}
+
+
+static ngx_int_t
+ngx_http_v2_create_headers_frame(ngx_http_request_t *r, u_char *pos,
+    u_char *end)
+{
+    u_char                    *p;
+    size_t                     rest, size, frame_size;
+    ngx_uint_t                 type, flags;
+    ngx_buf_t                 *b;
+    ngx_chain_t               *cl;
+    ngx_http_v2_stream_t      *stream;
+    ngx_http_v2_out_frame_t   *frame;
+    ngx_http_v2_connection_t  *h2c;
+
+    stream = r->stream;
+    h2c = stream->connection;
+
+    frame_size = h2c->frame_size;
+    rest = end - pos;
+
+    /*
+     * the block is split into HEADERS and CONTINUATION frames that
+     * are kept in one buffer, so no frame may get in between them
+     */
+
+    size = rest + (rest / frame_size + 1) * NGX_HTTP_V2_FRAME_HEADER_SIZE;
+
+    b = ngx_create_temp_buf(r->pool, size);
+    if (b == NULL) {
+        return NGX_ERROR;
+    }
+
+    type = NGX_HTTP_V2_HEADERS_FRAME;
+    flags = r->header_only ? NGX_HTTP_V2_END_STREAM_FLAG : NGX_HTTP_V2_NO_FLAG;
+
+    p = b->last;
+
+    for ( ;; ) {
+        size = ngx_min(rest, frame_size);
+
+        rest -= size;
+
+        if (rest == 0) {
+            flags |= NGX_HTTP_V2_END_HEADERS_FLAG;
+        }
+
+        p = ngx_http_v2_write_len_and_type(p, size, type);
+        *p++ = (u_char) flags;
+        p = ngx_http_v2_write_sid(p, stream->id);
+
+        p = ngx_cpymem(p, pos, size);
+        pos += size;
+
+        if (rest == 0) {
+            break;
+        }
+
+        type = NGX_HTTP_V2_CONTINUATION_FRAME;
+        flags = NGX_HTTP_V2_NO_FLAG;
+    }
+
+    b->last = p;
+
+    cl = ngx_alloc_chain_link(r->pool);
+    if (cl == NULL) {
+        return NGX_ERROR;
+    }
+
+    cl->buf = b;
+    cl->next = NULL;
+
+    frame = ngx_palloc(r->pool, sizeof(ngx_http_v2_out_frame_t));
+    if (frame == NULL) {
+        return NGX_ERROR;
+    }
+
+    frame->first = cl;
+    frame->last = cl;
+    frame->handler = ngx_http_v2_headers_frame_handler;
+    frame->stream = stream;
+    frame->length = b->last - b->pos - NGX_HTTP_V2_FRAME_HEADER_SIZE;
+    frame->blocked = 1;
+    frame->fin = r->header_only;
+
+    r->header_size = b->last - b->pos;
+
+    if (r->header_only) {
+        stream->out_closed = 1;
+    }
+
+    ngx_http_v2_queue_blocked_frame(h2c, frame);
+
+    stream->queued++;
+
+    return NGX_OK;
+}
+
+
+ngx_chain_t *
+ngx_http_v2_send_chain(ngx_connection_t *fc, ngx_chain_t *in, off_t limit)
+{
+    off_t                      size, offset, rest, frame_size;
+    size_t                     window, length;
+    ngx_uint_t                 fin;
+    ngx_chain_t               *cl, *out, **ln;
+    ngx_http_request_t        *r;
+    ngx_http_v2_stream_t      *stream;
+    ngx_http_v2_loc_conf_t    *h2lcf;
+    ngx_http_v2_out_frame_t   *frame;
+    ngx_http_v2_connection_t  *h2c;
+
+    r = fc->data;
+    stream = r->stream;
+
+    while (in && ngx_buf_size(in->buf) == 0 && !in->buf->last_buf) {
+        in = in->next;
+    }
+
+    if (in == NULL) {
+        return NULL;
+    }
+
+    if (stream->out_closed) {
+
+        /* e.g. a body of the response to a HEAD request */
+
+        for (cl = in; cl; cl = cl->next) {
+            if (ngx_buf_in_memory(cl->buf)) {
+                cl->buf->pos = cl->buf->last;
+            }
+
+            if (cl->buf->in_file) {
+                cl->buf->file_pos = cl->buf->file_last;
+            }
+        }
+
+        return NULL;
+    }
+
+    if (stream->queued) {
+
+        /*
+         * the progress of the frames already queued is passed to the
+         * original buffers only after they are sent, so the rest of the
+         * chain waits for them
+         */
+
+        fc->write->active = 1;
+        fc->write->ready = 0;
+
+        return in;
+    }
+
+    h2c = stream->connection;
+
+    h2lcf = ngx_http_get_module_loc_conf(r, ngx_http_v2_module);
+
+    frame_size = ngx_min((off_t) h2lcf->chunk_size, (off_t) h2c->frame_size);
+
+    if (limit == 0 || limit > NGX_MAX_OFF_T_VALUE / 2) {
+        limit = NGX_MAX_OFF_T_VALUE / 2;
+    }
+
+    /*
+     * a buffer partially framed stays in the chain: the progress
+     * is passed to its position by the frame handlers once sent
+     */
+
+    offset = 0;
+
+    while (in && limit > 0) {
+
+        if (ngx_buf_size(in->buf) - offset > 0) {
+
+            if (stream->send_window <= 0) {
+                stream->exhausted = 1;
+
+                if (stream->waiting) {
+                    ngx_queue_remove(&stream->queue);
+                    stream->waiting = 0;
+                }
+
+                break;
+            }
+
+            /*
+             * a stream does not take the connection window
+             * ahead of the streams already waiting for it
+             */
+
+            if (h2c->send_window == 0
+                || (!stream->waiting && !ngx_queue_empty(&h2c->waiting)))
+            {
+                if (!stream->waiting) {
+                    ngx_queue_insert_tail(&h2c->waiting, &stream->queue);
+                    stream->waiting = 1;
+                }
+
+                break;
+            }
+
+            if (stream->waiting) {
+                ngx_queue_remove(&stream->queue);
+                stream->waiting = 0;
+            }
+        }
+
+        window = ngx_min((size_t) stream->send_window, h2c->send_window);
+
+        rest = ngx_min(frame_size, (off_t) window);
+        rest = ngx_min(rest, limit);
+
+        out = NULL;
+        ln = &out;
+        length = 0;
+        fin = 0;
+
+        while (in && rest) {
+            size = ngx_buf_size(in->buf) - offset;
+
+            if (size > rest) {
+                size = rest;
+            }
+
+            if (size) {
+                cl = ngx_http_v2_filter_get_shadow(stream, in->buf, offset,
+                                                   size);
+                if (cl == NULL) {
+                    return NGX_CHAIN_ERROR;
+                }
+
+                *ln = cl;
+                ln = &cl->next;
+
+                length += (size_t) size;
+                rest -= size;
+                offset += size;
+            }
+
+            if (offset < ngx_buf_size(in->buf)) {
+                break;
+            }
+
+            fin = in->buf->last_buf;
+
+            in = in->next;
+            offset = 0;
+
+            if (fin) {
+                break;
+            }
+        }
+
+        if (length == 0 && !fin) {
+            break;
+        }
+
+        frame = ngx_http_v2_filter_get_data_frame(stream, length, out, fin);
+        if (frame == NULL) {
+            return NGX_CHAIN_ERROR;
+        }
+
+        if (fin) {
+            stream->out_closed = 1;
+        }
+
+        stream->send_window -= length;
+        h2c->send_window -= length;
+
+        limit -= length;
+
+        ngx_http_v2_queue_frame(h2c, frame);
+
+        stream->queued++;
+
+        if (fin) {
+            break;
+        }
+    }
+
+    if (!ngx_queue_empty(&h2c->waiting)) {
+        ngx_http_v2_handle_waiting(h2c);
+    }
+
+    if (ngx_http_v2_filter_send(fc, stream) == NGX_ERROR) {
+        return NGX_CHAIN_ERROR;
+    }
+
+    if (in && !stream->queued) {
+
+        /* the flow control windows are exhausted */
+
+        fc->write->active = 1;
+        fc->write->ready = 0;
+    }
+
+    return in;
+}
+
+
+static ngx_chain_t *
+ngx_http_v2_filter_get_shadow(ngx_http_v2_stream_t *stream, ngx_buf_t *buf,
+    off_t offset, off_t size)
+{
+    ngx_buf_t    *b;
+    ngx_chain_t  *cl;
+
+    cl = ngx_chain_get_free_buf(stream->request->pool, &stream->free_bufs);
+    if (cl == NULL) {
+        return NULL;
+    }
+
+    b = cl->buf;
+
+    ngx_memcpy(b, buf, sizeof(ngx_buf_t));
+
+    b->tag = (ngx_buf_tag_t) &ngx_http_v2_filter_module;
+    b->shadow = buf;
+    b->last_buf = 0;
+    b->last_in_chain = 0;
+    b->flush = 0;
+    b->recycled = 0;
+
+    if (ngx_buf_in_memory(buf)) {
+        b->pos = buf->pos + (size_t) offset;
+        b->last = b->pos + (size_t) size;
+
+        if (buf->in_file) {
+            b->file_pos = buf->file_pos + offset;
+            b->file_last = b->file_pos + size;
+        }
+
+    } else {
+        b->file_pos = buf->file_pos + offset;
+        b->file_last = b->file_pos + size;
+    }
+
+    return cl;
+}
+
+
+static ngx_http_v2_out_frame_t *
+ngx_http_v2_filter_get_data_frame(ngx_http_v2_stream_t *stream, size_t len,
+    ngx_chain_t *first, ngx_uint_t fin)
+{
+    u_char                   *p;
+    ngx_buf_t                *b;
+    ngx_chain_t              *cl, *ln;
+    ngx_http_v2_out_frame_t  *frame;
+
+    frame = stream->free_frames;
+
+    if (frame) {
+        stream->free_frames = frame->next;
+
+    } else {
+        frame = ngx_palloc(stream->request->pool,
+                           sizeof(ngx_http_v2_out_frame_t));
+        if (frame == NULL) {
+            return NULL;
+        }
+    }
+
+    cl = stream->free_frame_headers;
+
+    if (cl) {
+        stream->free_frame_headers = cl->next;
+
+        b = cl->buf;
+        b->pos = b->start;
+
+    } else {
+        cl = ngx_alloc_chain_link(stream->request->pool);
+        if (cl == NULL) {
+            return NULL;
+        }
+
+        b = ngx_create_temp_buf(stream->request->pool,
+                                NGX_HTTP_V2_FRAME_HEADER_SIZE);
+        if (b == NULL) {
+            return NULL;
+        }
+
+        b->tag = (ngx_buf_tag_t) &ngx_http_v2_module;
+
+        cl->buf = b;
+    }
+
+    ngx_log_debug3(NGX_LOG_DEBUG_HTTP, stream->request->connection->log, 0,
+                   "http2 create DATA frame: len:%uz fin:%ui sid:%ui",
+                   len, fin, stream->id);
+
+    p = b->pos;
+
+    p = ngx_http_v2_write_len_and_type(p, len, NGX_HTTP_V2_DATA_FRAME);
+    *p++ = fin ? NGX_HTTP_V2_END_STREAM_FLAG : NGX_HTTP_V2_NO_FLAG;
+    p = ngx_http_v2_write_sid(p, stream->id);
+
+    b->last = p;
+
+    cl->next = first;
+
+    /* find the last link of the payload */
+
+    ln = cl;
+
+    for ( /* void */ ; first; first = first->next) {
+        ln = first;
+    }
+
+    ln->next = NULL;
+
+    frame->first = cl;
+    frame->last = ln;
+    frame->handler = ngx_http_v2_data_frame_handler;
+    frame->stream = stream;
+    frame->length = len;
+    frame->blocked = 0;
+    frame->fin = fin;
+
+    return frame;
+}
+
+
+static ngx_int_t
+ngx_http_v2_filter_send(ngx_connection_t *fc, ngx_http_v2_stream_t *stream)
+{
+    if (ngx_http_v2_send_output_queue(stream->connection) == NGX_ERROR) {
+        fc->error = 1;
+        return NGX_ERROR;
+    }
+
+    if (stream->queued) {
+        fc->buffered |= NGX_HTTP_V2_BUFFERED;
+        fc->write->active = 1;
+        fc->write->ready = 0;
+        return NGX_AGAIN;
+    }
+
+    fc->buffered &= ~NGX_HTTP_V2_BUFFERED;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_headers_frame_handler(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_out_frame_t *frame)
+{
+    ngx_buf_t             *b;
+    ngx_http_v2_stream_t  *stream;
+
+    b = frame->first->buf;
+
+    if (b->pos != b->last) {
+        return NGX_AGAIN;
+    }
+
+    stream = frame->stream;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2:%ui HEADERS frame %p was sent", stream->id, frame);
+
+    stream->request->connection->sent += b->last - b->start;
+
+    /* the buffer is not reused, the frame is freed with the request pool */
+
+    ngx_http_v2_handle_frame(stream, NULL);
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_data_frame_handler(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_out_frame_t *frame)
+{
+    ngx_buf_t             *buf;
+    ngx_chain_t           *cl, *ln;
+    ngx_http_v2_stream_t  *stream;
+
+    stream = frame->stream;
+
+    cl = frame->first;
+
+    /* the frame header */
+
+    if (cl->buf->pos != cl->buf->last) {
+        return NGX_AGAIN;
+    }
+
+    for (ln = cl; ln != frame->last; /* void */) {
+        ln = ln->next;
+
+        if (ngx_buf_size(ln->buf)) {
+
+            /* the progress is passed to the original buffer */
+
+            buf = ln->buf->shadow;
+
+            if (ngx_buf_in_memory(buf)) {
+                buf->pos = ln->buf->pos;
+            }
+
+            if (buf->in_file) {
+                buf->file_pos = ln->buf->file_pos;
+            }
+
+            return NGX_AGAIN;
+        }
+    }
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2:%ui DATA frame %p was sent", stream->id, frame);
+
+    /* all the payload is sent: the buffers are returned to the stream */
+
+    for (ln = cl->next; ln; /* void */) {
+        cl->next = ln->next;
+
+        buf = ln->buf->shadow;
+
+        if (ngx_buf_in_memory(buf)) {
+            buf->pos = ln->buf->pos;
+        }
+
+        if (buf->in_file) {
+            buf->file_pos = ln->buf->file_pos;
+        }
+
+        if (ln == frame->last) {
+            ln->next = stream->free_bufs;
+            stream->free_bufs = ln;
+            break;
+        }
+
+        ln->next = stream->free_bufs;
+        stream->free_bufs = ln;
+
+        ln = cl->next;
+    }
+
+    cl->next = stream->free_frame_headers;
+    stream->free_frame_headers = cl;
+
+    ngx_http_v2_handle_frame(stream, frame);
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_v2_handle_frame(ngx_http_v2_stream_t *stream,
+    ngx_http_v2_out_frame_t *frame)
+{
+    ngx_connection_t  *fc;
+
+    fc = stream->request->connection;
+
+    if (frame) {
+        fc->sent += NGX_HTTP_V2_FRAME_HEADER_SIZE + frame->length;
+
+        frame->next = stream->free_frames;
+        stream->free_frames = frame;
+    }
+
+    stream->queued--;
+
+    if (stream->queued == 0) {
+        fc->buffered &= ~NGX_HTTP_V2_BUFFERED;
+
+        ngx_http_v2_handle_stream(stream->connection, stream);
+    }
+}
+
+
+static ngx_int_t
+ngx_http_v2_filter_init(ngx_conf_t *cf)
+{
+    ngx_http_next_header_filter = ngx_http_top_header_filter;
+    ngx_http_top_header_filter = ngx_http_v2_header_filter;
+
+    return NGX_OK;
+}
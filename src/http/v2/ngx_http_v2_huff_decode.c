@@ -0,0 +1,1903 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+/*
+ * the decoder walks the Huffman tree of RFC 7541 Appendix B four bits
+ * at a time: each of the 256 states is an internal node of the tree,
+ * and a transition may emit at most one symbol since the shortest code
+ * is five bits long
+ */
+
+#define NGX_HTTP_V2_HUFF_EMIT    0x01
+#define NGX_HTTP_V2_HUFF_ACCEPT  0x02  /* padding of up to 7 one-bits */
+#define NGX_HTTP_V2_HUFF_FAIL    0x04  /* EOS symbol in the input */
+
+
+typedef struct {
+    u_char  next;
+    u_char  flags;
+    u_char  sym;
+} ngx_http_v2_huff_decode_code_t;
+
+
+static ngx_int_t ngx_http_v2_huff_decode_bits(u_char *state, u_char *ending,
+    ngx_uint_t bits, u_char **dst);
+
+
+static ngx_http_v2_huff_decode_code_t  ngx_http_v2_huff_decode_codes[256][16] =
+{
+    /* 0 */
+    {
+        {0x0f, 0, 0x00}, {0x10, 0, 0x00}, {0x11, 0, 0x00}, {0x12, 0, 0x00},
+        {0x13, 0, 0x00}, {0x14, 0, 0x00}, {0x15, 0, 0x00}, {0x16, 0, 0x00},
+        {0x17, 0, 0x00}, {0x18, 0, 0x00}, {0x19, 0, 0x00}, {0x1a, 0, 0x00},
+        {0x1b, 0, 0x00}, {0x1c, 0, 0x00}, {0x1d, 0, 0x00}, {0x1e, 2, 0x00}
+    },
+    /* 1 */
+    {
+        {0x00, 3, 0x30}, {0x00, 3, 0x31}, {0x00, 3, 0x32}, {0x00, 3, 0x61},
+        {0x00, 3, 0x63}, {0x00, 3, 0x65}, {0x00, 3, 0x69}, {0x00, 3, 0x6f},
+        {0x00, 3, 0x73}, {0x00, 3, 0x74}, {0x1f, 0, 0x00}, {0x20, 0, 0x00},
+        {0x21, 0, 0x00}, {0x22, 0, 0x00}, {0x23, 0, 0x00}, {0x24, 0, 0x00}
+    },
+    /* 2 */
+    {
+        {0x25, 0, 0x00}, {0x26, 0, 0x00}, {0x27, 0, 0x00}, {0x28, 0, 0x00},
+        {0x29, 0, 0x00}, {0x2a, 0, 0x00}, {0x2b, 0, 0x00}, {0x2c, 0, 0x00},
+        {0x2d, 0, 0x00}, {0x2e, 0, 0x00}, {0x2f, 0, 0x00}, {0x30, 0, 0x00},
+        {0x31, 0, 0x00}, {0x32, 0, 0x00}, {0x33, 0, 0x00}, {0x34, 2, 0x00}
+    },
+    /* 3 */
+    {
+        {0x01, 1, 0x30}, {0x02, 3, 0x30}, {0x01, 1, 0x31}, {0x02, 3, 0x31},
+        {0x01, 1, 0x32}, {0x02, 3, 0x32}, {0x01, 1, 0x61}, {0x02, 3, 0x61},
+        {0x01, 1, 0x63}, {0x02, 3, 0x63}, {0x01, 1, 0x65}, {0x02, 3, 0x65},
+        {0x01, 1, 0x69}, {0x02, 3, 0x69}, {0x01, 1, 0x6f}, {0x02, 3, 0x6f}
+    },
+    /* 4 */
+    {
+        {0x01, 1, 0x73}, {0x02, 3, 0x73}, {0x01, 1, 0x74}, {0x02, 3, 0x74},
+        {0x00, 3, 0x20}, {0x00, 3, 0x25}, {0x00, 3, 0x2d}, {0x00, 3, 0x2e},
+        {0x00, 3, 0x2f}, {0x00, 3, 0x33}, {0x00, 3, 0x34}, {0x00, 3, 0x35},
+        {0x00, 3, 0x36}, {0x00, 3, 0x37}, {0x00, 3, 0x38}, {0x00, 3, 0x39}
+    },
+    /* 5 */
+    {
+        {0x00, 3, 0x3d}, {0x00, 3, 0x41}, {0x00, 3, 0x5f}, {0x00, 3, 0x62},
+        {0x00, 3, 0x64}, {0x00, 3, 0x66}, {0x00, 3, 0x67}, {0x00, 3, 0x68},
+        {0x00, 3, 0x6c}, {0x00, 3, 0x6d}, {0x00, 3, 0x6e}, {0x00, 3, 0x70},
+        {0x00, 3, 0x72}, {0x00, 3, 0x75}, {0x35, 0, 0x00}, {0x36, 0, 0x00}
+    },
+    /* 6 */
+    {
+        {0x37, 0, 0x00}, {0x38, 0, 0x00}, {0x39, 0, 0x00}, {0x3a, 0, 0x00},
+        {0x3b, 0, 0x00}, {0x3c, 0, 0x00}, {0x3d, 0, 0x00}, {0x3e, 0, 0x00},
+        {0x3f, 0, 0x00}, {0x40, 0, 0x00}, {0x41, 0, 0x00}, {0x42, 0, 0x00},
+        {0x43, 0, 0x00}, {0x44, 0, 0x00}, {0x45, 0, 0x00}, {0x46, 2, 0x00}
+    },
+    /* 7 */
+    {
+        {0x03, 1, 0x30}, {0x04, 1, 0x30}, {0x05, 1, 0x30}, {0x06, 3, 0x30},
+        {0x03, 1, 0x31}, {0x04, 1, 0x31}, {0x05, 1, 0x31}, {0x06, 3, 0x31},
+        {0x03, 1, 0x32}, {0x04, 1, 0x32}, {0x05, 1, 0x32}, {0x06, 3, 0x32},
+        {0x03, 1, 0x61}, {0x04, 1, 0x61}, {0x05, 1, 0x61}, {0x06, 3, 0x61}
+    },
+    /* 8 */
+    {
+        {0x03, 1, 0x63}, {0x04, 1, 0x63}, {0x05, 1, 0x63}, {0x06, 3, 0x63},
+        {0x03, 1, 0x65}, {0x04, 1, 0x65}, {0x05, 1, 0x65}, {0x06, 3, 0x65},
+        {0x03, 1, 0x69}, {0x04, 1, 0x69}, {0x05, 1, 0x69}, {0x06, 3, 0x69},
+        {0x03, 1, 0x6f}, {0x04, 1, 0x6f}, {0x05, 1, 0x6f}, {0x06, 3, 0x6f}
+    },
+    /* 9 */
+    {
+        {0x03, 1, 0x73}, {0x04, 1, 0x73}, {0x05, 1, 0x73}, {0x06, 3, 0x73},
+        {0x03, 1, 0x74}, {0x04, 1, 0x74}, {0x05, 1, 0x74}, {0x06, 3, 0x74},
+        {0x01, 1, 0x20}, {0x02, 3, 0x20}, {0x01, 1, 0x25}, {0x02, 3, 0x25},
+        {0x01, 1, 0x2d}, {0x02, 3, 0x2d}, {0x01, 1, 0x2e}, {0x02, 3, 0x2e}
+    },
+    /* 10 */
+    {
+        {0x01, 1, 0x2f}, {0x02, 3, 0x2f}, {0x01, 1, 0x33}, {0x02, 3, 0x33},
+        {0x01, 1, 0x34}, {0x02, 3, 0x34}, {0x01, 1, 0x35}, {0x02, 3, 0x35},
+        {0x01, 1, 0x36}, {0x02, 3, 0x36}, {0x01, 1, 0x37}, {0x02, 3, 0x37},
+        {0x01, 1, 0x38}, {0x02, 3, 0x38}, {0x01, 1, 0x39}, {0x02, 3, 0x39}
+    },
+    /* 11 */
+    {
+        {0x01, 1, 0x3d}, {0x02, 3, 0x3d}, {0x01, 1, 0x41}, {0x02, 3, 0x41},
+        {0x01, 1, 0x5f}, {0x02, 3, 0x5f}, {0x01, 1, 0x62}, {0x02, 3, 0x62},
+        {0x01, 1, 0x64}, {0x02, 3, 0x64}, {0x01, 1, 0x66}, {0x02, 3, 0x66},
+        {0x01, 1, 0x67}, {0x02, 3, 0x67}, {0x01, 1, 0x68}, {0x02, 3, 0x68}
+    },
+    /* 12 */
+    {
+        {0x01, 1, 0x6c}, {0x02, 3, 0x6c}, {0x01, 1, 0x6d}, {0x02, 3, 0x6d},
+        {0x01, 1, 0x6e}, {0x02, 3, 0x6e}, {0x01, 1, 0x70}, {0x02, 3, 0x70},
+        {0x01, 1, 0x72}, {0x02, 3, 0x72}, {0x01, 1, 0x75}, {0x02, 3, 0x75},
+        {0x00, 3, 0x3a}, {0x00, 3, 0x42}, {0x00, 3, 0x43}, {0x00, 3, 0x44}
+    },
+    /* 13 */
+    {
+        {0x00, 3, 0x45}, {0x00, 3, 0x46}, {0x00, 3, 0x47}, {0x00, 3, 0x48},
+        {0x00, 3, 0x49}, {0x00, 3, 0x4a}, {0x00, 3, 0x4b}, {0x00, 3, 0x4c},
+        {0x00, 3, 0x4d}, {0x00, 3, 0x4e}, {0x00, 3, 0x4f}, {0x00, 3, 0x50},
+        {0x00, 3, 0x51}, {0x00, 3, 0x52}, {0x00, 3, 0x53}, {0x00, 3, 0x54}
+    },
+    /* 14 */
+    {
+        {0x00, 3, 0x55}, {0x00, 3, 0x56}, {0x00, 3, 0x57}, {0x00, 3, 0x59},
+        {0x00, 3, 0x6a}, {0x00, 3, 0x6b}, {0x00, 3, 0x71}, {0x00, 3, 0x76},
+        {0x00, 3, 0x77}, {0x00, 3, 0x78}, {0x00, 3, 0x79}, {0x00, 3, 0x7a},
+        {0x47, 0, 0x00}, {0x48, 0, 0x00}, {0x49, 0, 0x00}, {0x4a, 2, 0x00}
+    },
+    /* 15 */
+    {
+        {0x07, 1, 0x30}, {0x08, 1, 0x30}, {0x09, 1, 0x30}, {0x0a, 1, 0x30},
+        {0x0b, 1, 0x30}, {0x0c, 1, 0x30}, {0x0d, 1, 0x30}, {0x0e, 3, 0x30},
+        {0x07, 1, 0x31}, {0x08, 1, 0x31}, {0x09, 1, 0x31}, {0x0a, 1, 0x31},
+        {0x0b, 1, 0x31}, {0x0c, 1, 0x31}, {0x0d, 1, 0x31}, {0x0e, 3, 0x31}
+    },
+    /* 16 */
+    {
+        {0x07, 1, 0x32}, {0x08, 1, 0x32}, {0x09, 1, 0x32}, {0x0a, 1, 0x32},
+        {0x0b, 1, 0x32}, {0x0c, 1, 0x32}, {0x0d, 1, 0x32}, {0x0e, 3, 0x32},
+        {0x07, 1, 0x61}, {0x08, 1, 0x61}, {0x09, 1, 0x61}, {0x0a, 1, 0x61},
+        {0x0b, 1, 0x61}, {0x0c, 1, 0x61}, {0x0d, 1, 0x61}, {0x0e, 3, 0x61}
+    },
+    /* 17 */
+    {
+        {0x07, 1, 0x63}, {0x08, 1, 0x63}, {0x09, 1, 0x63}, {0x0a, 1, 0x63},
+        {0x0b, 1, 0x63}, {0x0c, 1, 0x63}, {0x0d, 1, 0x63}, {0x0e, 3, 0x63},
+        {0x07, 1, 0x65}, {0x08, 1, 0x65}, {0x09, 1, 0x65}, {0x0a, 1, 0x65},
+        {0x0b, 1, 0x65}, {0x0c, 1, 0x65}, {0x0d, 1, 0x65}, {0x0e, 3, 0x65}
+    },
+    /* 18 */
+    {
+        {0x07, 1, 0x69}, {0x08, 1, 0x69}, {0x09, 1, 0x69}, {0x0a, 1, 0x69},
+        {0x0b, 1, 0x69}, {0x0c, 1, 0x69}, {0x0d, 1, 0x69}, {0x0e, 3, 0x69},
+        {0x07, 1, 0x6f}, {0x08, 1, 0x6f}, {0x09, 1, 0x6f}, {0x0a, 1, 0x6f},
+        {0x0b, 1, 0x6f}, {0x0c, 1, 0x6f}, {0x0d, 1, 0x6f}, {0x0e, 3, 0x6f}
+    },
+    /* 19 */
+    {
+        {0x07, 1, 0x73}, {0x08, 1, 0x73}, {0x09, 1, 0x73}, {0x0a, 1, 0x73},
+        {0x0b, 1, 0x73}, {0x0c, 1, 0x73}, {0x0d, 1, 0x73}, {0x0e, 3, 0x73},
+        {0x07, 1, 0x74}, {0x08, 1, 0x74}, {0x09, 1, 0x74}, {0x0a, 1, 0x74},
+        {0x0b, 1, 0x74}, {0x0c, 1, 0x74}, {0x0d, 1, 0x74}, {0x0e, 3, 0x74}
+    },
+    /* 20 */
+    {
+        {0x03, 1, 0x20}, {0x04, 1, 0x20}, {0x05, 1, 0x20}, {0x06, 3, 0x20},
+        {0x03, 1, 0x25}, {0x04, 1, 0x25}, {0x05, 1, 0x25}, {0x06, 3, 0x25},
+        {0x03, 1, 0x2d}, {0x04, 1, 0x2d}, {0x05, 1, 0x2d}, {0x06, 3, 0x2d},
+        {0x03, 1, 0x2e}, {0x04, 1, 0x2e}, {0x05, 1, 0x2e}, {0x06, 3, 0x2e}
+    },
+    /* 21 */
+    {
+        {0x03, 1, 0x2f}, {0x04, 1, 0x2f}, {0x05, 1, 0x2f}, {0x06, 3, 0x2f},
+        {0x03, 1, 0x33}, {0x04, 1, 0x33}, {0x05, 1, 0x33}, {0x06, 3, 0x33},
+        {0x03, 1, 0x34}, {0x04, 1, 0x34}, {0x05, 1, 0x34}, {0x06, 3, 0x34},
+        {0x03, 1, 0x35}, {0x04, 1, 0x35}, {0x05, 1, 0x35}, {0x06, 3, 0x35}
+    },
+    /* 22 */
+    {
+        {0x03, 1, 0x36}, {0x04, 1, 0x36}, {0x05, 1, 0x36}, {0x06, 3, 0x36},
+        {0x03, 1, 0x37}, {0x04, 1, 0x37}, {0x05, 1, 0x37}, {0x06, 3, 0x37},
+        {0x03, 1, 0x38}, {0x04, 1, 0x38}, {0x05, 1, 0x38}, {0x06, 3, 0x38},
+        {0x03, 1, 0x39}, {0x04, 1, 0x39}, {0x05, 1, 0x39}, {0x06, 3, 0x39}
+    },
+    /* 23 */
+    {
+        {0x03, 1, 0x3d}, {0x04, 1, 0x3d}, {0x05, 1, 0x3d}, {0x06, 3, 0x3d},
+        {0x03, 1, 0x41}, {0x04, 1, 0x41}, {0x05, 1, 0x41}, {0x06, 3, 0x41},
+        {0x03, 1, 0x5f}, {0x04, 1, 0x5f}, {0x05, 1, 0x5f}, {0x06, 3, 0x5f},
+        {0x03, 1, 0x62}, {0x04, 1, 0x62}, {0x05, 1, 0x62}, {0x06, 3, 0x62}
+    },
+    /* 24 */
+    {
+        {0x03, 1, 0x64}, {0x04, 1, 0x64}, {0x05, 1, 0x64}, {0x06, 3, 0x64},
+        {0x03, 1, 0x66}, {0x04, 1, 0x66}, {0x05, 1, 0x66}, {0x06, 3, 0x66},
+        {0x03, 1, 0x67}, {0x04, 1, 0x67}, {0x05, 1, 0x67}, {0x06, 3, 0x67},
+        {0x03, 1, 0x68}, {0x04, 1, 0x68}, {0x05, 1, 0x68}, {0x06, 3, 0x68}
+    },
+    /* 25 */
+    {
+        {0x03, 1, 0x6c}, {0x04, 1, 0x6c}, {0x05, 1, 0x6c}, {0x06, 3, 0x6c},
+        {0x03, 1, 0x6d}, {0x04, 1, 0x6d}, {0x05, 1, 0x6d}, {0x06, 3, 0x6d},
+        {0x03, 1, 0x6e}, {0x04, 1, 0x6e}, {0x05, 1, 0x6e}, {0x06, 3, 0x6e},
+        {0x03, 1, 0x70}, {0x04, 1, 0x70}, {0x05, 1, 0x70}, {0x06, 3, 0x70}
+    },
+    /* 26 */
+    {
+        {0x03, 1, 0x72}, {0x04, 1, 0x72}, {0x05, 1, 0x72}, {0x06, 3, 0x72},
+        {0x03, 1, 0x75}, {0x04, 1, 0x75}, {0x05, 1, 0x75}, {0x06, 3, 0x75},
+        {0x01, 1, 0x3a}, {0x02, 3, 0x3a}, {0x01, 1, 0x42}, {0x02, 3, 0x42},
+        {0x01, 1, 0x43}, {0x02, 3, 0x43}, {0x01, 1, 0x44}, {0x02, 3, 0x44}
+    },
+    /* 27 */
+    {
+        {0x01, 1, 0x45}, {0x02, 3, 0x45}, {0x01, 1, 0x46}, {0x02, 3, 0x46},
+        {0x01, 1, 0x47}, {0x02, 3, 0x47}, {0x01, 1, 0x48}, {0x02, 3, 0x48},
+        {0x01, 1, 0x49}, {0x02, 3, 0x49}, {0x01, 1, 0x4a}, {0x02, 3, 0x4a},
+        {0x01, 1, 0x4b}, {0x02, 3, 0x4b}, {0x01, 1, 0x4c}, {0x02, 3, 0x4c}
+    },
+    /* 28 */
+    {
+        {0x01, 1, 0x4d}, {0x02, 3, 0x4d}, {0x01, 1, 0x4e}, {0x02, 3, 0x4e},
+        {0x01, 1, 0x4f}, {0x02, 3, 0x4f}, {0x01, 1, 0x50}, {0x02, 3, 0x50},
+        {0x01, 1, 0x51}, {0x02, 3, 0x51}, {0x01, 1, 0x52}, {0x02, 3, 0x52},
+        {0x01, 1, 0x53}, {0x02, 3, 0x53}, {0x01, 1, 0x54}, {0x02, 3, 0x54}
+    },
+    /* 29 */
+    {
+        {0x01, 1, 0x55}, {0x02, 3, 0x55}, {0x01, 1, 0x56}, {0x02, 3, 0x56},
+        {0x01, 1, 0x57}, {0x02, 3, 0x57}, {0x01, 1, 0x59}, {0x02, 3, 0x59},
+        {0x01, 1, 0x6a}, {0x02, 3, 0x6a}, {0x01, 1, 0x6b}, {0x02, 3, 0x6b},
+        {0x01, 1, 0x71}, {0x02, 3, 0x71}, {0x01, 1, 0x76}, {0x02, 3, 0x76}
+    },
+    /* 30 */
+    {
+        {0x01, 1, 0x77}, {0x02, 3, 0x77}, {0x01, 1, 0x78}, {0x02, 3, 0x78},
+        {0x01, 1, 0x79}, {0x02, 3, 0x79}, {0x01, 1, 0x7a}, {0x02, 3, 0x7a},
+        {0x00, 3, 0x26}, {0x00, 3, 0x2a}, {0x00, 3, 0x2c}, {0x00, 3, 0x3b},
+        {0x00, 3, 0x58}, {0x00, 3, 0x5a}, {0x4b, 0, 0x00}, {0x4c, 0, 0x00}
+    },
+    /* 31 */
+    {
+        {0x07, 1, 0x20}, {0x08, 1, 0x20}, {0x09, 1, 0x20}, {0x0a, 1, 0x20},
+        {0x0b, 1, 0x20}, {0x0c, 1, 0x20}, {0x0d, 1, 0x20}, {0x0e, 3, 0x20},
+        {0x07, 1, 0x25}, {0x08, 1, 0x25}, {0x09, 1, 0x25}, {0x0a, 1, 0x25},
+        {0x0b, 1, 0x25}, {0x0c, 1, 0x25}, {0x0d, 1, 0x25}, {0x0e, 3, 0x25}
+    },
+    /* 32 */
+    {
+        {0x07, 1, 0x2d}, {0x08, 1, 0x2d}, {0x09, 1, 0x2d}, {0x0a, 1, 0x2d},
+        {0x0b, 1, 0x2d}, {0x0c, 1, 0x2d}, {0x0d, 1, 0x2d}, {0x0e, 3, 0x2d},
+        {0x07, 1, 0x2e}, {0x08, 1, 0x2e}, {0x09, 1, 0x2e}, {0x0a, 1, 0x2e},
+        {0x0b, 1, 0x2e}, {0x0c, 1, 0x2e}, {0x0d, 1, 0x2e}, {0x0e, 3, 0x2e}
+    },
+    /* 33 */
+    {
+        {0x07, 1, 0x2f}, {0x08, 1, 0x2f}, {0x09, 1, 0x2f}, {0x0a, 1, 0x2f},
+        {0x0b, 1, 0x2f}, {0x0c, 1, 0x2f}, {0x0d, 1, 0x2f}, {0x0e, 3, 0x2f},
+        {0x07, 1, 0x33}, {0x08, 1, 0x33}, {0x09, 1, 0x33}, {0x0a, 1, 0x33},
+        {0x0b, 1, 0x33}, {0x0c, 1, 0x33}, {0x0d, 1, 0x33}, {0x0e, 3, 0x33}
+    },
+    /* 34 */
+    {
+        {0x07, 1, 0x34}, {0x08, 1, 0x34}, {0x09, 1, 0x34}, {0x0a, 1, 0x34},
+        {0x0b, 1, 0x34}, {0x0c, 1, 0x34}, {0x0d, 1, 0x34}, {0x0e, 3, 0x34},
+        {0x07, 1, 0x35}, {0x08, 1, 0x35}, {0x09, 1, 0x35}, {0x0a, 1, 0x35},
+        {0x0b, 1, 0x35}, {0x0c, 1, 0x35}, {0x0d, 1, 0x35}, {0x0e, 3, 0x35}
+    },
+    /* 35 */
+    {
+        {0x07, 1, 0x36}, {0x08, 1, 0x36}, {0x09, 1, 0x36}, {0x0a, 1, 0x36},
+        {0x0b, 1, 0x36}, {0x0c, 1, 0x36}, {0x0d, 1, 0x36}, {0x0e, 3, 0x36},
+        {0x07, 1, 0x37}, {0x08, 1, 0x37}, {0x09, 1, 0x37}, {0x0a, 1, 0x37},
+        {0x0b, 1, 0x37}, {0x0c, 1, 0x37}, {0x0d, 1, 0x37}, {0x0e, 3, 0x37}
+    },
+    /* 36 */
+    {
+        {0x07, 1, 0x38}, {0x08, 1, 0x38}, {0x09, 1, 0x38}, {0x0a, 1, 0x38},
+        {0x0b, 1, 0x38}, {0x0c, 1, 0x38}, {0x0d, 1, 0x38}, {0x0e, 3, 0x38},
+        {0x07, 1, 0x39}, {0x08, 1, 0x39}, {0x09, 1, 0x39}, {0x0a, 1, 0x39},
+        {0x0b, 1, 0x39}, {0x0c, 1, 0x39}, {0x0d, 1, 0x39}, {0x0e, 3, 0x39}
+    },
+    /* 37 */
+    {
+        {0x07, 1, 0x3d}, {0x08, 1, 0x3d}, {0x09, 1, 0x3d}, {0x0a, 1, 0x3d},
+        {0x0b, 1, 0x3d}, {0x0c, 1, 0x3d}, {0x0d, 1, 0x3d}, {0x0e, 3, 0x3d},
+        {0x07, 1, 0x41}, {0x08, 1, 0x41}, {0x09, 1, 0x41}, {0x0a, 1, 0x41},
+        {0x0b, 1, 0x41}, {0x0c, 1, 0x41}, {0x0d, 1, 0x41}, {0x0e, 3, 0x41}
+    },
+    /* 38 */
+    {
+        {0x07, 1, 0x5f}, {0x08, 1, 0x5f}, {0x09, 1, 0x5f}, {0x0a, 1, 0x5f},
+        {0x0b, 1, 0x5f}, {0x0c, 1, 0x5f}, {0x0d, 1, 0x5f}, {0x0e, 3, 0x5f},
+        {0x07, 1, 0x62}, {0x08, 1, 0x62}, {0x09, 1, 0x62}, {0x0a, 1, 0x62},
+        {0x0b, 1, 0x62}, {0x0c, 1, 0x62}, {0x0d, 1, 0x62}, {0x0e, 3, 0x62}
+    },
+    /* 39 */
+    {
+        {0x07, 1, 0x64}, {0x08, 1, 0x64}, {0x09, 1, 0x64}, {0x0a, 1, 0x64},
+        {0x0b, 1, 0x64}, {0x0c, 1, 0x64}, {0x0d, 1, 0x64}, {0x0e, 3, 0x64},
+        {0x07, 1, 0x66}, {0x08, 1, 0x66}, {0x09, 1, 0x66}, {0x0a, 1, 0x66},
+        {0x0b, 1, 0x66}, {0x0c, 1, 0x66}, {0x0d, 1, 0x66}, {0x0e, 3, 0x66}
+    },
+    /* 40 */
+    {
+        {0x07, 1, 0x67}, {0x08, 1, 0x67}, {0x09, 1, 0x67}, {0x0a, 1, 0x67},
+        {0x0b, 1, 0x67}, {0x0c, 1, 0x67}, {0x0d, 1, 0x67}, {0x0e, 3, 0x67},
+        {0x07, 1, 0x68}, {0x08, 1, 0x68}, {0x09, 1, 0x68}, {0x0a, 1, 0x68},
+        {0x0b, 1, 0x68}, {0x0c, 1, 0x68}, {0x0d, 1, 0x68}, {0x0e, 3, 0x68}
+    },
+    /* 41 */
+    {
+        {0x07, 1, 0x6c}, {0x08, 1, 0x6c}, {0x09, 1, 0x6c}, {0x0a, 1, 0x6c},
+        {0x0b, 1, 0x6c}, {0x0c, 1, 0x6c}, {0x0d, 1, 0x6c}, {0x0e, 3, 0x6c},
+        {0x07, 1, 0x6d}, {0x08, 1, 0x6d}, {0x09, 1, 0x6d}, {0x0a, 1, 0x6d},
+        {0x0b, 1, 0x6d}, {0x0c, 1, 0x6d}, {0x0d, 1, 0x6d}, {0x0e, 3, 0x6d}
+    },
+    /* 42 */
+    {
+        {0x07, 1, 0x6e}, {0x08, 1, 0x6e}, {0x09, 1, 0x6e}, {0x0a, 1, 0x6e},
+        {0x0b, 1, 0x6e}, {0x0c, 1, 0x6e}, {0x0d, 1, 0x6e}, {0x0e, 3, 0x6e},
+        {0x07, 1, 0x70}, {0x08, 1, 0x70}, {0x09, 1, 0x70}, {0x0a, 1, 0x70},
+        {0x0b, 1, 0x70}, {0x0c, 1, 0x70}, {0x0d, 1, 0x70}, {0x0e, 3, 0x70}
+    },
+    /* 43 */
+    {
+        {0x07, 1, 0x72}, {0x08, 1, 0x72}, {0x09, 1, 0x72}, {0x0a, 1, 0x72},
+        {0x0b, 1, 0x72}, {0x0c, 1, 0x72}, {0x0d, 1, 0x72}, {0x0e, 3, 0x72},
+        {0x07, 1, 0x75}, {0x08, 1, 0x75}, {0x09, 1, 0x75}, {0x0a, 1, 0x75},
+        {0x0b, 1, 0x75}, {0x0c, 1, 0x75}, {0x0d, 1, 0x75}, {0x0e, 3, 0x75}
+    },
+    /* 44 */
+    {
+        {0x03, 1, 0x3a}, {0x04, 1, 0x3a}, {0x05, 1, 0x3a}, {0x06, 3, 0x3a},
+        {0x03, 1, 0x42}, {0x04, 1, 0x42}, {0x05, 1, 0x42}, {0x06, 3, 0x42},
+        {0x03, 1, 0x43}, {0x04, 1, 0x43}, {0x05, 1, 0x43}, {0x06, 3, 0x43},
+        {0x03, 1, 0x44}, {0x04, 1, 0x44}, {0x05, 1, 0x44}, {0x06, 3, 0x44}
+    },
+    /* 45 */
+    {
+        {0x03, 1, 0x45}, {0x04, 1, 0x45}, {0x05, 1, 0x45}, {0x06, 3, 0x45},
+        {0x03, 1, 0x46}, {0x04, 1, 0x46}, {0x05, 1, 0x46}, {0x06, 3, 0x46},
+        {0x03, 1, 0x47}, {0x04, 1, 0x47}, {0x05, 1, 0x47}, {0x06, 3, 0x47},
+        {0x03, 1, 0x48}, {0x04, 1, 0x48}, {0x05, 1, 0x48}, {0x06, 3, 0x48}
+    },
+    /* 46 */
+    {
+        {0x03, 1, 0x49}, {0x04, 1, 0x49}, {0x05, 1, 0x49}, {0x06, 3, 0x49},
+        {0x03, 1, 0x4a}, {0x04, 1, 0x4a}, {0x05, 1, 0x4a}, {0x06, 3, 0x4a},
+        {0x03, 1, 0x4b}, {0x04, 1, 0x4b}, {0x05, 1, 0x4b}, {0x06, 3, 0x4b},
+        {0x03, 1, 0x4c}, {0x04, 1, 0x4c}, {0x05, 1, 0x4c}, {0x06, 3, 0x4c}
+    },
+    /* 47 */
+    {
+        {0x03, 1, 0x4d}, {0x04, 1, 0x4d}, {0x05, 1, 0x4d}, {0x06, 3, 0x4d},
+        {0x03, 1, 0x4e}, {0x04, 1, 0x4e}, {0x05, 1, 0x4e}, {0x06, 3, 0x4e},
+        {0x03, 1, 0x4f}, {0x04, 1, 0x4f}, {0x05, 1, 0x4f}, {0x06, 3, 0x4f},
+        {0x03, 1, 0x50}, {0x04, 1, 0x50}, {0x05, 1, 0x50}, {0x06, 3, 0x50}
+    },
+    /* 48 */
+    {
+        {0x03, 1, 0x51}, {0x04, 1, 0x51}, {0x05, 1, 0x51}, {0x06, 3, 0x51},
+        {0x03, 1, 0x52}, {0x04, 1, 0x52}, {0x05, 1, 0x52}, {0x06, 3, 0x52},
+        {0x03, 1, 0x53}, {0x04, 1, 0x53}, {0x05, 1, 0x53}, {0x06, 3, 0x53},
+        {0x03, 1, 0x54}, {0x04, 1, 0x54}, {0x05, 1, 0x54}, {0x06, 3, 0x54}
+    },
+    /* 49 */
+    {
+        {0x03, 1, 0x55}, {0x04, 1, 0x55}, {0x05, 1, 0x55}, {0x06, 3, 0x55},
+        {0x03, 1, 0x56}, {0x04, 1, 0x56}, {0x05, 1, 0x56}, {0x06, 3, 0x56},
+        {0x03, 1, 0x57}, {0x04, 1, 0x57}, {0x05, 1, 0x57}, {0x06, 3, 0x57},
+        {0x03, 1, 0x59}, {0x04, 1, 0x59}, {0x05, 1, 0x59}, {0x06, 3, 0x59}
+    },
+    /* 50 */
+    {
+        {0x03, 1, 0x6a}, {0x04, 1, 0x6a}, {0x05, 1, 0x6a}, {0x06, 3, 0x6a},
+        {0x03, 1, 0x6b}, {0x04, 1, 0x6b}, {0x05, 1, 0x6b}, {0x06, 3, 0x6b},
+        {0x03, 1, 0x71}, {0x04, 1, 0x71}, {0x05, 1, 0x71}, {0x06, 3, 0x71},
+        {0x03, 1, 0x76}, {0x04, 1, 0x76}, {0x05, 1, 0x76}, {0x06, 3, 0x76}
+    },
+    /* 51 */
+    {
+        {0x03, 1, 0x77}, {0x04, 1, 0x77}, {0x05, 1, 0x77}, {0x06, 3, 0x77},
+        {0x03, 1, 0x78}, {0x04, 1, 0x78}, {0x05, 1, 0x78}, {0x06, 3, 0x78},
+        {0x03, 1, 0x79}, {0x04, 1, 0x79}, {0x05, 1, 0x79}, {0x06, 3, 0x79},
+        {0x03, 1, 0x7a}, {0x04, 1, 0x7a}, {0x05, 1, 0x7a}, {0x06, 3, 0x7a}
+    },
+    /* 52 */
+    {
+        {0x01, 1, 0x26}, {0x02, 3, 0x26}, {0x01, 1, 0x2a}, {0x02, 3, 0x2a},
+        {0x01, 1, 0x2c}, {0x02, 3, 0x2c}, {0x01, 1, 0x3b}, {0x02, 3, 0x3b},
+        {0x01, 1, 0x58}, {0x02, 3, 0x58}, {0x01, 1, 0x5a}, {0x02, 3, 0x5a},
+        {0x4d, 0, 0x00}, {0x4e, 0, 0x00}, {0x4f, 0, 0x00}, {0x50, 0, 0x00}
+    },
+    /* 53 */
+    {
+        {0x07, 1, 0x3a}, {0x08, 1, 0x3a}, {0x09, 1, 0x3a}, {0x0a, 1, 0x3a},
+        {0x0b, 1, 0x3a}, {0x0c, 1, 0x3a}, {0x0d, 1, 0x3a}, {0x0e, 3, 0x3a},
+        {0x07, 1, 0x42}, {0x08, 1, 0x42}, {0x09, 1, 0x42}, {0x0a, 1, 0x42},
+        {0x0b, 1, 0x42}, {0x0c, 1, 0x42}, {0x0d, 1, 0x42}, {0x0e, 3, 0x42}
+    },
+    /* 54 */
+    {
+        {0x07, 1, 0x43}, {0x08, 1, 0x43}, {0x09, 1, 0x43}, {0x0a, 1, 0x43},
+        {0x0b, 1, 0x43}, {0x0c, 1, 0x43}, {0x0d, 1, 0x43}, {0x0e, 3, 0x43},
+        {0x07, 1, 0x44}, {0x08, 1, 0x44}, {0x09, 1, 0x44}, {0x0a, 1, 0x44},
+        {0x0b, 1, 0x44}, {0x0c, 1, 0x44}, {0x0d, 1, 0x44}, {0x0e, 3, 0x44}
+    },
+    /* 55 */
+    {
+        {0x07, 1, 0x45}, {0x08, 1, 0x45}, {0x09, 1, 0x45}, {0x0a, 1, 0x45},
+        {0x0b, 1, 0x45}, {0x0c, 1, 0x45}, {0x0d, 1, 0x45}, {0x0e, 3, 0x45},
+        {0x07, 1, 0x46}, {0x08, 1, 0x46}, {0x09, 1, 0x46}, {0x0a, 1, 0x46},
+        {0x0b, 1, 0x46}, {0x0c, 1, 0x46}, {0x0d, 1, 0x46}, {0x0e, 3, 0x46}
+    },
+    /* 56 */
+    {
+        {0x07, 1, 0x47}, {0x08, 1, 0x47}, {0x09, 1, 0x47}, {0x0a, 1, 0x47},
+        {0x0b, 1, 0x47}, {0x0c, 1, 0x47}, {0x0d, 1, 0x47}, {0x0e, 3, 0x47},
+        {0x07, 1, 0x48}, {0x08, 1, 0x48}, {0x09, 1, 0x48}, {0x0a, 1, 0x48},
+        {0x0b, 1, 0x48}, {0x0c, 1, 0x48}, {0x0d, 1, 0x48}, {0x0e, 3, 0x48}
+    },
+    /* 57 */
+    {
+        {0x07, 1, 0x49}, {0x08, 1, 0x49}, {0x09, 1, 0x49}, {0x0a, 1, 0x49},
+        {0x0b, 1, 0x49}, {0x0c, 1, 0x49}, {0x0d, 1, 0x49}, {0x0e, 3, 0x49},
+        {0x07, 1, 0x4a}, {0x08, 1, 0x4a}, {0x09, 1, 0x4a}, {0x0a, 1, 0x4a},
+        {0x0b, 1, 0x4a}, {0x0c, 1, 0x4a}, {0x0d, 1, 0x4a}, {0x0e, 3, 0x4a}
+    },
+    /* 58 */
+    {
+        {0x07, 1, 0x4b}, {0x08, 1, 0x4b}, {0x09, 1, 0x4b}, {0x0a, 1, 0x4b},
+        {0x0b, 1, 0x4b}, {0x0c, 1, 0x4b}, {0x0d, 1, 0x4b}, {0x0e, 3, 0x4b},
+        {0x07, 1, 0x4c}, {0x08, 1, 0x4c}, {0x09, 1, 0x4c}, {0x0a, 1, 0x4c},
+        {0x0b, 1, 0x4c}, {0x0c, 1, 0x4c}, {0x0d, 1, 0x4c}, {0x0e, 3, 0x4c}
+    },
+    /* 59 */
+    {
+        {0x07, 1, 0x4d}, {0x08, 1, 0x4d}, {0x09, 1, 0x4d}, {0x0a, 1, 0x4d},
+        {0x0b, 1, 0x4d}, {0x0c, 1, 0x4d}, {0x0d, 1, 0x4d}, {0x0e, 3, 0x4d},
+        {0x07, 1, 0x4e}, {0x08, 1, 0x4e}, {0x09, 1, 0x4e}, {0x0a, 1, 0x4e},
+        {0x0b, 1, 0x4e}, {0x0c, 1, 0x4e}, {0x0d, 1, 0x4e}, {0x0e, 3, 0x4e}
+    },
+    /* 60 */
+    {
+        {0x07, 1, 0x4f}, {0x08, 1, 0x4f}, {0x09, 1, 0x4f}, {0x0a, 1, 0x4f},
+        {0x0b, 1, 0x4f}, {0x0c, 1, 0x4f}, {0x0d, 1, 0x4f}, {0x0e, 3, 0x4f},
+        {0x07, 1, 0x50}, {0x08, 1, 0x50}, {0x09, 1, 0x50}, {0x0a, 1, 0x50},
+        {0x0b, 1, 0x50}, {0x0c, 1, 0x50}, {0x0d, 1, 0x50}, {0x0e, 3, 0x50}
+    },
+    /* 61 */
+    {
+        {0x07, 1, 0x51}, {0x08, 1, 0x51}, {0x09, 1, 0x51}, {0x0a, 1, 0x51},
+        {0x0b, 1, 0x51}, {0x0c, 1, 0x51}, {0x0d, 1, 0x51}, {0x0e, 3, 0x51},
+        {0x07, 1, 0x52}, {0x08, 1, 0x52}, {0x09, 1, 0x52}, {0x0a, 1, 0x52},
+        {0x0b, 1, 0x52}, {0x0c, 1, 0x52}, {0x0d, 1, 0x52}, {0x0e, 3, 0x52}
+    },
+    /* 62 */
+    {
+        {0x07, 1, 0x53}, {0x08, 1, 0x53}, {0x09, 1, 0x53}, {0x0a, 1, 0x53},
+        {0x0b, 1, 0x53}, {0x0c, 1, 0x53}, {0x0d, 1, 0x53}, {0x0e, 3, 0x53},
+        {0x07, 1, 0x54}, {0x08, 1, 0x54}, {0x09, 1, 0x54}, {0x0a, 1, 0x54},
+        {0x0b, 1, 0x54}, {0x0c, 1, 0x54}, {0x0d, 1, 0x54}, {0x0e, 3, 0x54}
+    },
+    /* 63 */
+    {
+        {0x07, 1, 0x55}, {0x08, 1, 0x55}, {0x09, 1, 0x55}, {0x0a, 1, 0x55},
+        {0x0b, 1, 0x55}, {0x0c, 1, 0x55}, {0x0d, 1, 0x55}, {0x0e, 3, 0x55},
+        {0x07, 1, 0x56}, {0x08, 1, 0x56}, {0x09, 1, 0x56}, {0x0a, 1, 0x56},
+        {0x0b, 1, 0x56}, {0x0c, 1, 0x56}, {0x0d, 1, 0x56}, {0x0e, 3, 0x56}
+    },
+    /* 64 */
+    {
+        {0x07, 1, 0x57}, {0x08, 1, 0x57}, {0x09, 1, 0x57}, {0x0a, 1, 0x57},
+        {0x0b, 1, 0x57}, {0x0c, 1, 0x57}, {0x0d, 1, 0x57}, {0x0e, 3, 0x57},
+        {0x07, 1, 0x59}, {0x08, 1, 0x59}, {0x09, 1, 0x59}, {0x0a, 1, 0x59},
+        {0x0b, 1, 0x59}, {0x0c, 1, 0x59}, {0x0d, 1, 0x59}, {0x0e, 3, 0x59}
+    },
+    /* 65 */
+    {
+        {0x07, 1, 0x6a}, {0x08, 1, 0x6a}, {0x09, 1, 0x6a}, {0x0a, 1, 0x6a},
+        {0x0b, 1, 0x6a}, {0x0c, 1, 0x6a}, {0x0d, 1, 0x6a}, {0x0e, 3, 0x6a},
+        {0x07, 1, 0x6b}, {0x08, 1, 0x6b}, {0x09, 1, 0x6b}, {0x0a, 1, 0x6b},
+        {0x0b, 1, 0x6b}, {0x0c, 1, 0x6b}, {0x0d, 1, 0x6b}, {0x0e, 3, 0x6b}
+    },
+    /* 66 */
+    {
+        {0x07, 1, 0x71}, {0x08, 1, 0x71}, {0x09, 1, 0x71}, {0x0a, 1, 0x71},
+        {0x0b, 1, 0x71}, {0x0c, 1, 0x71}, {0x0d, 1, 0x71}, {0x0e, 3, 0x71},
+        {0x07, 1, 0x76}, {0x08, 1, 0x76}, {0x09, 1, 0x76}, {0x0a, 1, 0x76},
+        {0x0b, 1, 0x76}, {0x0c, 1, 0x76}, {0x0d, 1, 0x76}, {0x0e, 3, 0x76}
+    },
+    /* 67 */
+    {
+        {0x07, 1, 0x77}, {0x08, 1, 0x77}, {0x09, 1, 0x77}, {0x0a, 1, 0x77},
+        {0x0b, 1, 0x77}, {0x0c, 1, 0x77}, {0x0d, 1, 0x77}, {0x0e, 3, 0x77},
+        {0x07, 1, 0x78}, {0x08, 1, 0x78}, {0x09, 1, 0x78}, {0x0a, 1, 0x78},
+        {0x0b, 1, 0x78}, {0x0c, 1, 0x78}, {0x0d, 1, 0x78}, {0x0e, 3, 0x78}
+    },
+    /* 68 */
+    {
+        {0x07, 1, 0x79}, {0x08, 1, 0x79}, {0x09, 1, 0x79}, {0x0a, 1, 0x79},
+        {0x0b, 1, 0x79}, {0x0c, 1, 0x79}, {0x0d, 1, 0x79}, {0x0e, 3, 0x79},
+        {0x07, 1, 0x7a}, {0x08, 1, 0x7a}, {0x09, 1, 0x7a}, {0x0a, 1, 0x7a},
+        {0x0b, 1, 0x7a}, {0x0c, 1, 0x7a}, {0x0d, 1, 0x7a}, {0x0e, 3, 0x7a}
+    },
+    /* 69 */
+    {
+        {0x03, 1, 0x26}, {0x04, 1, 0x26}, {0x05, 1, 0x26}, {0x06, 3, 0x26},
+        {0x03, 1, 0x2a}, {0x04, 1, 0x2a}, {0x05, 1, 0x2a}, {0x06, 3, 0x2a},
+        {0x03, 1, 0x2c}, {0x04, 1, 0x2c}, {0x05, 1, 0x2c}, {0x06, 3, 0x2c},
+        {0x03, 1, 0x3b}, {0x04, 1, 0x3b}, {0x05, 1, 0x3b}, {0x06, 3, 0x3b}
+    },
+    /* 70 */
+    {
+        {0x03, 1, 0x58}, {0x04, 1, 0x58}, {0x05, 1, 0x58}, {0x06, 3, 0x58},
+        {0x03, 1, 0x5a}, {0x04, 1, 0x5a}, {0x05, 1, 0x5a}, {0x06, 3, 0x5a},
+        {0x00, 3, 0x21}, {0x00, 3, 0x22}, {0x00, 3, 0x28}, {0x00, 3, 0x29},
+        {0x00, 3, 0x3f}, {0x51, 0, 0x00}, {0x52, 0, 0x00}, {0x53, 0, 0x00}
+    },
+    /* 71 */
+    {
+        {0x07, 1, 0x26}, {0x08, 1, 0x26}, {0x09, 1, 0x26}, {0x0a, 1, 0x26},
+        {0x0b, 1, 0x26}, {0x0c, 1, 0x26}, {0x0d, 1, 0x26}, {0x0e, 3, 0x26},
+        {0x07, 1, 0x2a}, {0x08, 1, 0x2a}, {0x09, 1, 0x2a}, {0x0a, 1, 0x2a},
+        {0x0b, 1, 0x2a}, {0x0c, 1, 0x2a}, {0x0d, 1, 0x2a}, {0x0e, 3, 0x2a}
+    },
+    /* 72 */
+    {
+        {0x07, 1, 0x2c}, {0x08, 1, 0x2c}, {0x09, 1, 0x2c}, {0x0a, 1, 0x2c},
+        {0x0b, 1, 0x2c}, {0x0c, 1, 0x2c}, {0x0d, 1, 0x2c}, {0x0e, 3, 0x2c},
+        {0x07, 1, 0x3b}, {0x08, 1, 0x3b}, {0x09, 1, 0x3b}, {0x0a, 1, 0x3b},
+        {0x0b, 1, 0x3b}, {0x0c, 1, 0x3b}, {0x0d, 1, 0x3b}, {0x0e, 3, 0x3b}
+    },
+    /* 73 */
+    {
+        {0x07, 1, 0x58}, {0x08, 1, 0x58}, {0x09, 1, 0x58}, {0x0a, 1, 0x58},
+        {0x0b, 1, 0x58}, {0x0c, 1, 0x58}, {0x0d, 1, 0x58}, {0x0e, 3, 0x58},
+        {0x07, 1, 0x5a}, {0x08, 1, 0x5a}, {0x09, 1, 0x5a}, {0x0a, 1, 0x5a},
+        {0x0b, 1, 0x5a}, {0x0c, 1, 0x5a}, {0x0d, 1, 0x5a}, {0x0e, 3, 0x5a}
+    },
+    /* 74 */
+    {
+        {0x01, 1, 0x21}, {0x02, 3, 0x21}, {0x01, 1, 0x22}, {0x02, 3, 0x22},
+        {0x01, 1, 0x28}, {0x02, 3, 0x28}, {0x01, 1, 0x29}, {0x02, 3, 0x29},
+        {0x01, 1, 0x3f}, {0x02, 3, 0x3f}, {0x00, 3, 0x27}, {0x00, 3, 0x2b},
+        {0x00, 3, 0x7c}, {0x54, 0, 0x00}, {0x55, 0, 0x00}, {0x56, 0, 0x00}
+    },
+    /* 75 */
+    {
+        {0x03, 1, 0x21}, {0x04, 1, 0x21}, {0x05, 1, 0x21}, {0x06, 3, 0x21},
+        {0x03, 1, 0x22}, {0x04, 1, 0x22}, {0x05, 1, 0x22}, {0x06, 3, 0x22},
+        {0x03, 1, 0x28}, {0x04, 1, 0x28}, {0x05, 1, 0x28}, {0x06, 3, 0x28},
+        {0x03, 1, 0x29}, {0x04, 1, 0x29}, {0x05, 1, 0x29}, {0x06, 3, 0x29}
+    },
+    /* 76 */
+    {
+        {0x03, 1, 0x3f}, {0x04, 1, 0x3f}, {0x05, 1, 0x3f}, {0x06, 3, 0x3f},
+        {0x01, 1, 0x27}, {0x02, 3, 0x27}, {0x01, 1, 0x2b}, {0x02, 3, 0x2b},
+        {0x01, 1, 0x7c}, {0x02, 3, 0x7c}, {0x00, 3, 0x23}, {0x00, 3, 0x3e},
+        {0x57, 0, 0x00}, {0x58, 0, 0x00}, {0x59, 0, 0x00}, {0x5a, 0, 0x00}
+    },
+    /* 77 */
+    {
+        {0x07, 1, 0x21}, {0x08, 1, 0x21}, {0x09, 1, 0x21}, {0x0a, 1, 0x21},
+        {0x0b, 1, 0x21}, {0x0c, 1, 0x21}, {0x0d, 1, 0x21}, {0x0e, 3, 0x21},
+        {0x07, 1, 0x22}, {0x08, 1, 0x22}, {0x09, 1, 0x22}, {0x0a, 1, 0x22},
+        {0x0b, 1, 0x22}, {0x0c, 1, 0x22}, {0x0d, 1, 0x22}, {0x0e, 3, 0x22}
+    },
+    /* 78 */
+    {
+        {0x07, 1, 0x28}, {0x08, 1, 0x28}, {0x09, 1, 0x28}, {0x0a, 1, 0x28},
+        {0x0b, 1, 0x28}, {0x0c, 1, 0x28}, {0x0d, 1, 0x28}, {0x0e, 3, 0x28},
+        {0x07, 1, 0x29}, {0x08, 1, 0x29}, {0x09, 1, 0x29}, {0x0a, 1, 0x29},
+        {0x0b, 1, 0x29}, {0x0c, 1, 0x29}, {0x0d, 1, 0x29}, {0x0e, 3, 0x29}
+    },
+    /* 79 */
+    {
+        {0x07, 1, 0x3f}, {0x08, 1, 0x3f}, {0x09, 1, 0x3f}, {0x0a, 1, 0x3f},
+        {0x0b, 1, 0x3f}, {0x0c, 1, 0x3f}, {0x0d, 1, 0x3f}, {0x0e, 3, 0x3f},
+        {0x03, 1, 0x27}, {0x04, 1, 0x27}, {0x05, 1, 0x27}, {0x06, 3, 0x27},
+        {0x03, 1, 0x2b}, {0x04, 1, 0x2b}, {0x05, 1, 0x2b}, {0x06, 3, 0x2b}
+    },
+    /* 80 */
+    {
+        {0x03, 1, 0x7c}, {0x04, 1, 0x7c}, {0x05, 1, 0x7c}, {0x06, 3, 0x7c},
+        {0x01, 1, 0x23}, {0x02, 3, 0x23}, {0x01, 1, 0x3e}, {0x02, 3, 0x3e},
+        {0x00, 3, 0x00}, {0x00, 3, 0x24}, {0x00, 3, 0x40}, {0x00, 3, 0x5b},
+        {0x00, 3, 0x5d}, {0x00, 3, 0x7e}, {0x5b, 0, 0x00}, {0x5c, 0, 0x00}
+    },
+    /* 81 */
+    {
+        {0x07, 1, 0x27}, {0x08, 1, 0x27}, {0x09, 1, 0x27}, {0x0a, 1, 0x27},
+        {0x0b, 1, 0x27}, {0x0c, 1, 0x27}, {0x0d, 1, 0x27}, {0x0e, 3, 0x27},
+        {0x07, 1, 0x2b}, {0x08, 1, 0x2b}, {0x09, 1, 0x2b}, {0x0a, 1, 0x2b},
+        {0x0b, 1, 0x2b}, {0x0c, 1, 0x2b}, {0x0d, 1, 0x2b}, {0x0e, 3, 0x2b}
+    },
+    /* 82 */
+    {
+        {0x07, 1, 0x7c}, {0x08, 1, 0x7c}, {0x09, 1, 0x7c}, {0x0a, 1, 0x7c},
+        {0x0b, 1, 0x7c}, {0x0c, 1, 0x7c}, {0x0d, 1, 0x7c}, {0x0e, 3, 0x7c},
+        {0x03, 1, 0x23}, {0x04, 1, 0x23}, {0x05, 1, 0x23}, {0x06, 3, 0x23},
+        {0x03, 1, 0x3e}, {0x04, 1, 0x3e}, {0x05, 1, 0x3e}, {0x06, 3, 0x3e}
+    },
+    /* 83 */
+    {
+        {0x01, 1, 0x00}, {0x02, 3, 0x00}, {0x01, 1, 0x24}, {0x02, 3, 0x24},
+        {0x01, 1, 0x40}, {0x02, 3, 0x40}, {0x01, 1, 0x5b}, {0x02, 3, 0x5b},
+        {0x01, 1, 0x5d}, {0x02, 3, 0x5d}, {0x01, 1, 0x7e}, {0x02, 3, 0x7e},
+        {0x00, 3, 0x5e}, {0x00, 3, 0x7d}, {0x5d, 0, 0x00}, {0x5e, 0, 0x00}
+    },
+    /* 84 */
+    {
+        {0x07, 1, 0x23}, {0x08, 1, 0x23}, {0x09, 1, 0x23}, {0x0a, 1, 0x23},
+        {0x0b, 1, 0x23}, {0x0c, 1, 0x23}, {0x0d, 1, 0x23}, {0x0e, 3, 0x23},
+        {0x07, 1, 0x3e}, {0x08, 1, 0x3e}, {0x09, 1, 0x3e}, {0x0a, 1, 0x3e},
+        {0x0b, 1, 0x3e}, {0x0c, 1, 0x3e}, {0x0d, 1, 0x3e}, {0x0e, 3, 0x3e}
+    },
+    /* 85 */
+    {
+        {0x03, 1, 0x00}, {0x04, 1, 0x00}, {0x05, 1, 0x00}, {0x06, 3, 0x00},
+        {0x03, 1, 0x24}, {0x04, 1, 0x24}, {0x05, 1, 0x24}, {0x06, 3, 0x24},
+        {0x03, 1, 0x40}, {0x04, 1, 0x40}, {0x05, 1, 0x40}, {0x06, 3, 0x40},
+        {0x03, 1, 0x5b}, {0x04, 1, 0x5b}, {0x05, 1, 0x5b}, {0x06, 3, 0x5b}
+    },
+    /* 86 */
+    {
+        {0x03, 1, 0x5d}, {0x04, 1, 0x5d}, {0x05, 1, 0x5d}, {0x06, 3, 0x5d},
+        {0x03, 1, 0x7e}, {0x04, 1, 0x7e}, {0x05, 1, 0x7e}, {0x06, 3, 0x7e},
+        {0x01, 1, 0x5e}, {0x02, 3, 0x5e}, {0x01, 1, 0x7d}, {0x02, 3, 0x7d},
+        {0x00, 3, 0x3c}, {0x00, 3, 0x60}, {0x00, 3, 0x7b}, {0x5f, 0, 0x00}
+    },
+    /* 87 */
+    {
+        {0x07, 1, 0x00}, {0x08, 1, 0x00}, {0x09, 1, 0x00}, {0x0a, 1, 0x00},
+        {0x0b, 1, 0x00}, {0x0c, 1, 0x00}, {0x0d, 1, 0x00}, {0x0e, 3, 0x00},
+        {0x07, 1, 0x24}, {0x08, 1, 0x24}, {0x09, 1, 0x24}, {0x0a, 1, 0x24},
+        {0x0b, 1, 0x24}, {0x0c, 1, 0x24}, {0x0d, 1, 0x24}, {0x0e, 3, 0x24}
+    },
+    /* 88 */
+    {
+        {0x07, 1, 0x40}, {0x08, 1, 0x40}, {0x09, 1, 0x40}, {0x0a, 1, 0x40},
+        {0x0b, 1, 0x40}, {0x0c, 1, 0x40}, {0x0d, 1, 0x40}, {0x0e, 3, 0x40},
+        {0x07, 1, 0x5b}, {0x08, 1, 0x5b}, {0x09, 1, 0x5b}, {0x0a, 1, 0x5b},
+        {0x0b, 1, 0x5b}, {0x0c, 1, 0x5b}, {0x0d, 1, 0x5b}, {0x0e, 3, 0x5b}
+    },
+    /* 89 */
+    {
+        {0x07, 1, 0x5d}, {0x08, 1, 0x5d}, {0x09, 1, 0x5d}, {0x0a, 1, 0x5d},
+        {0x0b, 1, 0x5d}, {0x0c, 1, 0x5d}, {0x0d, 1, 0x5d}, {0x0e, 3, 0x5d},
+        {0x07, 1, 0x7e}, {0x08, 1, 0x7e}, {0x09, 1, 0x7e}, {0x0a, 1, 0x7e},
+        {0x0b, 1, 0x7e}, {0x0c, 1, 0x7e}, {0x0d, 1, 0x7e}, {0x0e, 3, 0x7e}
+    },
+    /* 90 */
+    {
+        {0x03, 1, 0x5e}, {0x04, 1, 0x5e}, {0x05, 1, 0x5e}, {0x06, 3, 0x5e},
+        {0x03, 1, 0x7d}, {0x04, 1, 0x7d}, {0x05, 1, 0x7d}, {0x06, 3, 0x7d},
+        {0x01, 1, 0x3c}, {0x02, 3, 0x3c}, {0x01, 1, 0x60}, {0x02, 3, 0x60},
+        {0x01, 1, 0x7b}, {0x02, 3, 0x7b}, {0x60, 0, 0x00}, {0x61, 0, 0x00}
+    },
+    /* 91 */
+    {
+        {0x07, 1, 0x5e}, {0x08, 1, 0x5e}, {0x09, 1, 0x5e}, {0x0a, 1, 0x5e},
+        {0x0b, 1, 0x5e}, {0x0c, 1, 0x5e}, {0x0d, 1, 0x5e}, {0x0e, 3, 0x5e},
+        {0x07, 1, 0x7d}, {0x08, 1, 0x7d}, {0x09, 1, 0x7d}, {0x0a, 1, 0x7d},
+        {0x0b, 1, 0x7d}, {0x0c, 1, 0x7d}, {0x0d, 1, 0x7d}, {0x0e, 3, 0x7d}
+    },
+    /* 92 */
+    {
+        {0x03, 1, 0x3c}, {0x04, 1, 0x3c}, {0x05, 1, 0x3c}, {0x06, 3, 0x3c},
+        {0x03, 1, 0x60}, {0x04, 1, 0x60}, {0x05, 1, 0x60}, {0x06, 3, 0x60},
+        {0x03, 1, 0x7b}, {0x04, 1, 0x7b}, {0x05, 1, 0x7b}, {0x06, 3, 0x7b},
+        {0x62, 0, 0x00}, {0x63, 0, 0x00}, {0x64, 0, 0x00}, {0x65, 0, 0x00}
+    },
+    /* 93 */
+    {
+        {0x07, 1, 0x3c}, {0x08, 1, 0x3c}, {0x09, 1, 0x3c}, {0x0a, 1, 0x3c},
+        {0x0b, 1, 0x3c}, {0x0c, 1, 0x3c}, {0x0d, 1, 0x3c}, {0x0e, 3, 0x3c},
+        {0x07, 1, 0x60}, {0x08, 1, 0x60}, {0x09, 1, 0x60}, {0x0a, 1, 0x60},
+        {0x0b, 1, 0x60}, {0x0c, 1, 0x60}, {0x0d, 1, 0x60}, {0x0e, 3, 0x60}
+    },
+    /* 94 */
+    {
+        {0x07, 1, 0x7b}, {0x08, 1, 0x7b}, {0x09, 1, 0x7b}, {0x0a, 1, 0x7b},
+        {0x0b, 1, 0x7b}, {0x0c, 1, 0x7b}, {0x0d, 1, 0x7b}, {0x0e, 3, 0x7b},
+        {0x66, 0, 0x00}, {0x67, 0, 0x00}, {0x68, 0, 0x00}, {0x69, 0, 0x00},
+        {0x6a, 0, 0x00}, {0x6b, 0, 0x00}, {0x6c, 0, 0x00}, {0x6d, 0, 0x00}
+    },
+    /* 95 */
+    {
+        {0x00, 3, 0x5c}, {0x00, 3, 0xc3}, {0x00, 3, 0xd0}, {0x6e, 0, 0x00},
+        {0x6f, 0, 0x00}, {0x70, 0, 0x00}, {0x71, 0, 0x00}, {0x72, 0, 0x00},
+        {0x73, 0, 0x00}, {0x74, 0, 0x00}, {0x75, 0, 0x00}, {0x76, 0, 0x00},
+        {0x77, 0, 0x00}, {0x78, 0, 0x00}, {0x79, 0, 0x00}, {0x7a, 0, 0x00}
+    },
+    /* 96 */
+    {
+        {0x01, 1, 0x5c}, {0x02, 3, 0x5c}, {0x01, 1, 0xc3}, {0x02, 3, 0xc3},
+        {0x01, 1, 0xd0}, {0x02, 3, 0xd0}, {0x00, 3, 0x80}, {0x00, 3, 0x82},
+        {0x00, 3, 0x83}, {0x00, 3, 0xa2}, {0x00, 3, 0xb8}, {0x00, 3, 0xc2},
+        {0x00, 3, 0xe0}, {0x00, 3, 0xe2}, {0x7b, 0, 0x00}, {0x7c, 0, 0x00}
+    },
+    /* 97 */
+    {
+        {0x7d, 0, 0x00}, {0x7e, 0, 0x00}, {0x7f, 0, 0x00}, {0x80, 0, 0x00},
+        {0x81, 0, 0x00}, {0x82, 0, 0x00}, {0x83, 0, 0x00}, {0x84, 0, 0x00},
+        {0x85, 0, 0x00}, {0x86, 0, 0x00}, {0x87, 0, 0x00}, {0x88, 0, 0x00},
+        {0x89, 0, 0x00}, {0x8a, 0, 0x00}, {0x8b, 0, 0x00}, {0x8c, 0, 0x00}
+    },
+    /* 98 */
+    {
+        {0x03, 1, 0x5c}, {0x04, 1, 0x5c}, {0x05, 1, 0x5c}, {0x06, 3, 0x5c},
+        {0x03, 1, 0xc3}, {0x04, 1, 0xc3}, {0x05, 1, 0xc3}, {0x06, 3, 0xc3},
+        {0x03, 1, 0xd0}, {0x04, 1, 0xd0}, {0x05, 1, 0xd0}, {0x06, 3, 0xd0},
+        {0x01, 1, 0x80}, {0x02, 3, 0x80}, {0x01, 1, 0x82}, {0x02, 3, 0x82}
+    },
+    /* 99 */
+    {
+        {0x01, 1, 0x83}, {0x02, 3, 0x83}, {0x01, 1, 0xa2}, {0x02, 3, 0xa2},
+        {0x01, 1, 0xb8}, {0x02, 3, 0xb8}, {0x01, 1, 0xc2}, {0x02, 3, 0xc2},
+        {0x01, 1, 0xe0}, {0x02, 3, 0xe0}, {0x01, 1, 0xe2}, {0x02, 3, 0xe2},
+        {0x00, 3, 0x99}, {0x00, 3, 0xa1}, {0x00, 3, 0xa7}, {0x00, 3, 0xac}
+    },
+    /* 100 */
+    {
+        {0x00, 3, 0xb0}, {0x00, 3, 0xb1}, {0x00, 3, 0xb3}, {0x00, 3, 0xd1},
+        {0x00, 3, 0xd8}, {0x00, 3, 0xd9}, {0x00, 3, 0xe3}, {0x00, 3, 0xe5},
+        {0x00, 3, 0xe6}, {0x8d, 0, 0x00}, {0x8e, 0, 0x00}, {0x8f, 0, 0x00},
+        {0x90, 0, 0x00}, {0x91, 0, 0x00}, {0x92, 0, 0x00}, {0x93, 0, 0x00}
+    },
+    /* 101 */
+    {
+        {0x94, 0, 0x00}, {0x95, 0, 0x00}, {0x96, 0, 0x00}, {0x97, 0, 0x00},
+        {0x98, 0, 0x00}, {0x99, 0, 0x00}, {0x9a, 0, 0x00}, {0x9b, 0, 0x00},
+        {0x9c, 0, 0x00}, {0x9d, 0, 0x00}, {0x9e, 0, 0x00}, {0x9f, 0, 0x00},
+        {0xa0, 0, 0x00}, {0xa1, 0, 0x00}, {0xa2, 0, 0x00}, {0xa3, 0, 0x00}
+    },
+    /* 102 */
+    {
+        {0x07, 1, 0x5c}, {0x08, 1, 0x5c}, {0x09, 1, 0x5c}, {0x0a, 1, 0x5c},
+        {0x0b, 1, 0x5c}, {0x0c, 1, 0x5c}, {0x0d, 1, 0x5c}, {0x0e, 3, 0x5c},
+        {0x07, 1, 0xc3}, {0x08, 1, 0xc3}, {0x09, 1, 0xc3}, {0x0a, 1, 0xc3},
+        {0x0b, 1, 0xc3}, {0x0c, 1, 0xc3}, {0x0d, 1, 0xc3}, {0x0e, 3, 0xc3}
+    },
+    /* 103 */
+    {
+        {0x07, 1, 0xd0}, {0x08, 1, 0xd0}, {0x09, 1, 0xd0}, {0x0a, 1, 0xd0},
+        {0x0b, 1, 0xd0}, {0x0c, 1, 0xd0}, {0x0d, 1, 0xd0}, {0x0e, 3, 0xd0},
+        {0x03, 1, 0x80}, {0x04, 1, 0x80}, {0x05, 1, 0x80}, {0x06, 3, 0x80},
+        {0x03, 1, 0x82}, {0x04, 1, 0x82}, {0x05, 1, 0x82}, {0x06, 3, 0x82}
+    },
+    /* 104 */
+    {
+        {0x03, 1, 0x83}, {0x04, 1, 0x83}, {0x05, 1, 0x83}, {0x06, 3, 0x83},
+        {0x03, 1, 0xa2}, {0x04, 1, 0xa2}, {0x05, 1, 0xa2}, {0x06, 3, 0xa2},
+        {0x03, 1, 0xb8}, {0x04, 1, 0xb8}, {0x05, 1, 0xb8}, {0x06, 3, 0xb8},
+        {0x03, 1, 0xc2}, {0x04, 1, 0xc2}, {0x05, 1, 0xc2}, {0x06, 3, 0xc2}
+    },
+    /* 105 */
+    {
+        {0x03, 1, 0xe0}, {0x04, 1, 0xe0}, {0x05, 1, 0xe0}, {0x06, 3, 0xe0},
+        {0x03, 1, 0xe2}, {0x04, 1, 0xe2}, {0x05, 1, 0xe2}, {0x06, 3, 0xe2},
+        {0x01, 1, 0x99}, {0x02, 3, 0x99}, {0x01, 1, 0xa1}, {0x02, 3, 0xa1},
+        {0x01, 1, 0xa7}, {0x02, 3, 0xa7}, {0x01, 1, 0xac}, {0x02, 3, 0xac}
+    },
+    /* 106 */
+    {
+        {0x01, 1, 0xb0}, {0x02, 3, 0xb0}, {0x01, 1, 0xb1}, {0x02, 3, 0xb1},
+        {0x01, 1, 0xb3}, {0x02, 3, 0xb3}, {0x01, 1, 0xd1}, {0x02, 3, 0xd1},
+        {0x01, 1, 0xd8}, {0x02, 3, 0xd8}, {0x01, 1, 0xd9}, {0x02, 3, 0xd9},
+        {0x01, 1, 0xe3}, {0x02, 3, 0xe3}, {0x01, 1, 0xe5}, {0x02, 3, 0xe5}
+    },
+    /* 107 */
+    {
+        {0x01, 1, 0xe6}, {0x02, 3, 0xe6}, {0x00, 3, 0x81}, {0x00, 3, 0x84},
+        {0x00, 3, 0x85}, {0x00, 3, 0x86}, {0x00, 3, 0x88}, {0x00, 3, 0x92},
+        {0x00, 3, 0x9a}, {0x00, 3, 0x9c}, {0x00, 3, 0xa0}, {0x00, 3, 0xa3},
+        {0x00, 3, 0xa4}, {0x00, 3, 0xa9}, {0x00, 3, 0xaa}, {0x00, 3, 0xad}
+    },
+    /* 108 */
+    {
+        {0x00, 3, 0xb2}, {0x00, 3, 0xb5}, {0x00, 3, 0xb9}, {0x00, 3, 0xba},
+        {0x00, 3, 0xbb}, {0x00, 3, 0xbd}, {0x00, 3, 0xbe}, {0x00, 3, 0xc4},
+        {0x00, 3, 0xc6}, {0x00, 3, 0xe4}, {0x00, 3, 0xe8}, {0x00, 3, 0xe9},
+        {0xa4, 0, 0x00}, {0xa5, 0, 0x00}, {0xa6, 0, 0x00}, {0xa7, 0, 0x00}
+    },
+    /* 109 */
+    {
+        {0xa8, 0, 0x00}, {0xa9, 0, 0x00}, {0xaa, 0, 0x00}, {0xab, 0, 0x00},
+        {0xac, 0, 0x00}, {0xad, 0, 0x00}, {0xae, 0, 0x00}, {0xaf, 0, 0x00},
+        {0xb0, 0, 0x00}, {0xb1, 0, 0x00}, {0xb2, 0, 0x00}, {0xb3, 0, 0x00},
+        {0xb4, 0, 0x00}, {0xb5, 0, 0x00}, {0xb6, 0, 0x00}, {0xb7, 0, 0x00}
+    },
+    /* 110 */
+    {
+        {0x07, 1, 0x80}, {0x08, 1, 0x80}, {0x09, 1, 0x80}, {0x0a, 1, 0x80},
+        {0x0b, 1, 0x80}, {0x0c, 1, 0x80}, {0x0d, 1, 0x80}, {0x0e, 3, 0x80},
+        {0x07, 1, 0x82}, {0x08, 1, 0x82}, {0x09, 1, 0x82}, {0x0a, 1, 0x82},
+        {0x0b, 1, 0x82}, {0x0c, 1, 0x82}, {0x0d, 1, 0x82}, {0x0e, 3, 0x82}
+    },
+    /* 111 */
+    {
+        {0x07, 1, 0x83}, {0x08, 1, 0x83}, {0x09, 1, 0x83}, {0x0a, 1, 0x83},
+        {0x0b, 1, 0x83}, {0x0c, 1, 0x83}, {0x0d, 1, 0x83}, {0x0e, 3, 0x83},
+        {0x07, 1, 0xa2}, {0x08, 1, 0xa2}, {0x09, 1, 0xa2}, {0x0a, 1, 0xa2},
+        {0x0b, 1, 0xa2}, {0x0c, 1, 0xa2}, {0x0d, 1, 0xa2}, {0x0e, 3, 0xa2}
+    },
+    /* 112 */
+    {
+        {0x07, 1, 0xb8}, {0x08, 1, 0xb8}, {0x09, 1, 0xb8}, {0x0a, 1, 0xb8},
+        {0x0b, 1, 0xb8}, {0x0c, 1, 0xb8}, {0x0d, 1, 0xb8}, {0x0e, 3, 0xb8},
+        {0x07, 1, 0xc2}, {0x08, 1, 0xc2}, {0x09, 1, 0xc2}, {0x0a, 1, 0xc2},
+        {0x0b, 1, 0xc2}, {0x0c, 1, 0xc2}, {0x0d, 1, 0xc2}, {0x0e, 3, 0xc2}
+    },
+    /* 113 */
+    {
+        {0x07, 1, 0xe0}, {0x08, 1, 0xe0}, {0x09, 1, 0xe0}, {0x0a, 1, 0xe0},
+        {0x0b, 1, 0xe0}, {0x0c, 1, 0xe0}, {0x0d, 1, 0xe0}, {0x0e, 3, 0xe0},
+        {0x07, 1, 0xe2}, {0x08, 1, 0xe2}, {0x09, 1, 0xe2}, {0x0a, 1, 0xe2},
+        {0x0b, 1, 0xe2}, {0x0c, 1, 0xe2}, {0x0d, 1, 0xe2}, {0x0e, 3, 0xe2}
+    },
+    /* 114 */
+    {
+        {0x03, 1, 0x99}, {0x04, 1, 0x99}, {0x05, 1, 0x99}, {0x06, 3, 0x99},
+        {0x03, 1, 0xa1}, {0x04, 1, 0xa1}, {0x05, 1, 0xa1}, {0x06, 3, 0xa1},
+        {0x03, 1, 0xa7}, {0x04, 1, 0xa7}, {0x05, 1, 0xa7}, {0x06, 3, 0xa7},
+        {0x03, 1, 0xac}, {0x04, 1, 0xac}, {0x05, 1, 0xac}, {0x06, 3, 0xac}
+    },
+    /* 115 */
+    {
+        {0x03, 1, 0xb0}, {0x04, 1, 0xb0}, {0x05, 1, 0xb0}, {0x06, 3, 0xb0},
+        {0x03, 1, 0xb1}, {0x04, 1, 0xb1}, {0x05, 1, 0xb1}, {0x06, 3, 0xb1},
+        {0x03, 1, 0xb3}, {0x04, 1, 0xb3}, {0x05, 1, 0xb3}, {0x06, 3, 0xb3},
+        {0x03, 1, 0xd1}, {0x04, 1, 0xd1}, {0x05, 1, 0xd1}, {0x06, 3, 0xd1}
+    },
+    /* 116 */
+    {
+        {0x03, 1, 0xd8}, {0x04, 1, 0xd8}, {0x05, 1, 0xd8}, {0x06, 3, 0xd8},
+        {0x03, 1, 0xd9}, {0x04, 1, 0xd9}, {0x05, 1, 0xd9}, {0x06, 3, 0xd9},
+        {0x03, 1, 0xe3}, {0x04, 1, 0xe3}, {0x05, 1, 0xe3}, {0x06, 3, 0xe3},
+        {0x03, 1, 0xe5}, {0x04, 1, 0xe5}, {0x05, 1, 0xe5}, {0x06, 3, 0xe5}
+    },
+    /* 117 */
+    {
+        {0x03, 1, 0xe6}, {0x04, 1, 0xe6}, {0x05, 1, 0xe6}, {0x06, 3, 0xe6},
+        {0x01, 1, 0x81}, {0x02, 3, 0x81}, {0x01, 1, 0x84}, {0x02, 3, 0x84},
+        {0x01, 1, 0x85}, {0x02, 3, 0x85}, {0x01, 1, 0x86}, {0x02, 3, 0x86},
+        {0x01, 1, 0x88}, {0x02, 3, 0x88}, {0x01, 1, 0x92}, {0x02, 3, 0x92}
+    },
+    /* 118 */
+    {
+        {0x01, 1, 0x9a}, {0x02, 3, 0x9a}, {0x01, 1, 0x9c}, {0x02, 3, 0x9c},
+        {0x01, 1, 0xa0}, {0x02, 3, 0xa0}, {0x01, 1, 0xa3}, {0x02, 3, 0xa3},
+        {0x01, 1, 0xa4}, {0x02, 3, 0xa4}, {0x01, 1, 0xa9}, {0x02, 3, 0xa9},
+        {0x01, 1, 0xaa}, {0x02, 3, 0xaa}, {0x01, 1, 0xad}, {0x02, 3, 0xad}
+    },
+    /* 119 */
+    {
+        {0x01, 1, 0xb2}, {0x02, 3, 0xb2}, {0x01, 1, 0xb5}, {0x02, 3, 0xb5},
+        {0x01, 1, 0xb9}, {0x02, 3, 0xb9}, {0x01, 1, 0xba}, {0x02, 3, 0xba},
+        {0x01, 1, 0xbb}, {0x02, 3, 0xbb}, {0x01, 1, 0xbd}, {0x02, 3, 0xbd},
+        {0x01, 1, 0xbe}, {0x02, 3, 0xbe}, {0x01, 1, 0xc4}, {0x02, 3, 0xc4}
+    },
+    /* 120 */
+    {
+        {0x01, 1, 0xc6}, {0x02, 3, 0xc6}, {0x01, 1, 0xe4}, {0x02, 3, 0xe4},
+        {0x01, 1, 0xe8}, {0x02, 3, 0xe8}, {0x01, 1, 0xe9}, {0x02, 3, 0xe9},
+        {0x00, 3, 0x01}, {0x00, 3, 0x87}, {0x00, 3, 0x89}, {0x00, 3, 0x8a},
+        {0x00, 3, 0x8b}, {0x00, 3, 0x8c}, {0x00, 3, 0x8d}, {0x00, 3, 0x8f}
+    },
+    /* 121 */
+    {
+        {0x00, 3, 0x93}, {0x00, 3, 0x95}, {0x00, 3, 0x96}, {0x00, 3, 0x97},
+        {0x00, 3, 0x98}, {0x00, 3, 0x9b}, {0x00, 3, 0x9d}, {0x00, 3, 0x9e},
+        {0x00, 3, 0xa5}, {0x00, 3, 0xa6}, {0x00, 3, 0xa8}, {0x00, 3, 0xae},
+        {0x00, 3, 0xaf}, {0x00, 3, 0xb4}, {0x00, 3, 0xb6}, {0x00, 3, 0xb7}
+    },
+    /* 122 */
+    {
+        {0x00, 3, 0xbc}, {0x00, 3, 0xbf}, {0x00, 3, 0xc5}, {0x00, 3, 0xe7},
+        {0x00, 3, 0xef}, {0xb8, 0, 0x00}, {0xb9, 0, 0x00}, {0xba, 0, 0x00},
+        {0xbb, 0, 0x00}, {0xbc, 0, 0x00}, {0xbd, 0, 0x00}, {0xbe, 0, 0x00},
+        {0xbf, 0, 0x00}, {0xc0, 0, 0x00}, {0xc1, 0, 0x00}, {0xc2, 0, 0x00}
+    },
+    /* 123 */
+    {
+        {0x07, 1, 0x99}, {0x08, 1, 0x99}, {0x09, 1, 0x99}, {0x0a, 1, 0x99},
+        {0x0b, 1, 0x99}, {0x0c, 1, 0x99}, {0x0d, 1, 0x99}, {0x0e, 3, 0x99},
+        {0x07, 1, 0xa1}, {0x08, 1, 0xa1}, {0x09, 1, 0xa1}, {0x0a, 1, 0xa1},
+        {0x0b, 1, 0xa1}, {0x0c, 1, 0xa1}, {0x0d, 1, 0xa1}, {0x0e, 3, 0xa1}
+    },
+    /* 124 */
+    {
+        {0x07, 1, 0xa7}, {0x08, 1, 0xa7}, {0x09, 1, 0xa7}, {0x0a, 1, 0xa7},
+        {0x0b, 1, 0xa7}, {0x0c, 1, 0xa7}, {0x0d, 1, 0xa7}, {0x0e, 3, 0xa7},
+        {0x07, 1, 0xac}, {0x08, 1, 0xac}, {0x09, 1, 0xac}, {0x0a, 1, 0xac},
+        {0x0b, 1, 0xac}, {0x0c, 1, 0xac}, {0x0d, 1, 0xac}, {0x0e, 3, 0xac}
+    },
+    /* 125 */
+    {
+        {0x07, 1, 0xb0}, {0x08, 1, 0xb0}, {0x09, 1, 0xb0}, {0x0a, 1, 0xb0},
+        {0x0b, 1, 0xb0}, {0x0c, 1, 0xb0}, {0x0d, 1, 0xb0}, {0x0e, 3, 0xb0},
+        {0x07, 1, 0xb1}, {0x08, 1, 0xb1}, {0x09, 1, 0xb1}, {0x0a, 1, 0xb1},
+        {0x0b, 1, 0xb1}, {0x0c, 1, 0xb1}, {0x0d, 1, 0xb1}, {0x0e, 3, 0xb1}
+    },
+    /* 126 */
+    {
+        {0x07, 1, 0xb3}, {0x08, 1, 0xb3}, {0x09, 1, 0xb3}, {0x0a, 1, 0xb3},
+        {0x0b, 1, 0xb3}, {0x0c, 1, 0xb3}, {0x0d, 1, 0xb3}, {0x0e, 3, 0xb3},
+        {0x07, 1, 0xd1}, {0x08, 1, 0xd1}, {0x09, 1, 0xd1}, {0x0a, 1, 0xd1},
+        {0x0b, 1, 0xd1}, {0x0c, 1, 0xd1}, {0x0d, 1, 0xd1}, {0x0e, 3, 0xd1}
+    },
+    /* 127 */
+    {
+        {0x07, 1, 0xd8}, {0x08, 1, 0xd8}, {0x09, 1, 0xd8}, {0x0a, 1, 0xd8},
+        {0x0b, 1, 0xd8}, {0x0c, 1, 0xd8}, {0x0d, 1, 0xd8}, {0x0e, 3, 0xd8},
+        {0x07, 1, 0xd9}, {0x08, 1, 0xd9}, {0x09, 1, 0xd9}, {0x0a, 1, 0xd9},
+        {0x0b, 1, 0xd9}, {0x0c, 1, 0xd9}, {0x0d, 1, 0xd9}, {0x0e, 3, 0xd9}
+    },
+    /* 128 */
+    {
+        {0x07, 1, 0xe3}, {0x08, 1, 0xe3}, {0x09, 1, 0xe3}, {0x0a, 1, 0xe3},
+        {0x0b, 1, 0xe3}, {0x0c, 1, 0xe3}, {0x0d, 1, 0xe3}, {0x0e, 3, 0xe3},
+        {0x07, 1, 0xe5}, {0x08, 1, 0xe5}, {0x09, 1, 0xe5}, {0x0a, 1, 0xe5},
+        {0x0b, 1, 0xe5}, {0x0c, 1, 0xe5}, {0x0d, 1, 0xe5}, {0x0e, 3, 0xe5}
+    },
+    /* 129 */
+    {
+        {0x07, 1, 0xe6}, {0x08, 1, 0xe6}, {0x09, 1, 0xe6}, {0x0a, 1, 0xe6},
+        {0x0b, 1, 0xe6}, {0x0c, 1, 0xe6}, {0x0d, 1, 0xe6}, {0x0e, 3, 0xe6},
+        {0x03, 1, 0x81}, {0x04, 1, 0x81}, {0x05, 1, 0x81}, {0x06, 3, 0x81},
+        {0x03, 1, 0x84}, {0x04, 1, 0x84}, {0x05, 1, 0x84}, {0x06, 3, 0x84}
+    },
+    /* 130 */
+    {
+        {0x03, 1, 0x85}, {0x04, 1, 0x85}, {0x05, 1, 0x85}, {0x06, 3, 0x85},
+        {0x03, 1, 0x86}, {0x04, 1, 0x86}, {0x05, 1, 0x86}, {0x06, 3, 0x86},
+        {0x03, 1, 0x88}, {0x04, 1, 0x88}, {0x05, 1, 0x88}, {0x06, 3, 0x88},
+        {0x03, 1, 0x92}, {0x04, 1, 0x92}, {0x05, 1, 0x92}, {0x06, 3, 0x92}
+    },
+    /* 131 */
+    {
+        {0x03, 1, 0x9a}, {0x04, 1, 0x9a}, {0x05, 1, 0x9a}, {0x06, 3, 0x9a},
+        {0x03, 1, 0x9c}, {0x04, 1, 0x9c}, {0x05, 1, 0x9c}, {0x06, 3, 0x9c},
+        {0x03, 1, 0xa0}, {0x04, 1, 0xa0}, {0x05, 1, 0xa0}, {0x06, 3, 0xa0},
+        {0x03, 1, 0xa3}, {0x04, 1, 0xa3}, {0x05, 1, 0xa3}, {0x06, 3, 0xa3}
+    },
+    /* 132 */
+    {
+        {0x03, 1, 0xa4}, {0x04, 1, 0xa4}, {0x05, 1, 0xa4}, {0x06, 3, 0xa4},
+        {0x03, 1, 0xa9}, {0x04, 1, 0xa9}, {0x05, 1, 0xa9}, {0x06, 3, 0xa9},
+        {0x03, 1, 0xaa}, {0x04, 1, 0xaa}, {0x05, 1, 0xaa}, {0x06, 3, 0xaa},
+        {0x03, 1, 0xad}, {0x04, 1, 0xad}, {0x05, 1, 0xad}, {0x06, 3, 0xad}
+    },
+    /* 133 */
+    {
+        {0x03, 1, 0xb2}, {0x04, 1, 0xb2}, {0x05, 1, 0xb2}, {0x06, 3, 0xb2},
+        {0x03, 1, 0xb5}, {0x04, 1, 0xb5}, {0x05, 1, 0xb5}, {0x06, 3, 0xb5},
+        {0x03, 1, 0xb9}, {0x04, 1, 0xb9}, {0x05, 1, 0xb9}, {0x06, 3, 0xb9},
+        {0x03, 1, 0xba}, {0x04, 1, 0xba}, {0x05, 1, 0xba}, {0x06, 3, 0xba}
+    },
+    /* 134 */
+    {
+        {0x03, 1, 0xbb}, {0x04, 1, 0xbb}, {0x05, 1, 0xbb}, {0x06, 3, 0xbb},
+        {0x03, 1, 0xbd}, {0x04, 1, 0xbd}, {0x05, 1, 0xbd}, {0x06, 3, 0xbd},
+        {0x03, 1, 0xbe}, {0x04, 1, 0xbe}, {0x05, 1, 0xbe}, {0x06, 3, 0xbe},
+        {0x03, 1, 0xc4}, {0x04, 1, 0xc4}, {0x05, 1, 0xc4}, {0x06, 3, 0xc4}
+    },
+    /* 135 */
+    {
+        {0x03, 1, 0xc6}, {0x04, 1, 0xc6}, {0x05, 1, 0xc6}, {0x06, 3, 0xc6},
+        {0x03, 1, 0xe4}, {0x04, 1, 0xe4}, {0x05, 1, 0xe4}, {0x06, 3, 0xe4},
+        {0x03, 1, 0xe8}, {0x04, 1, 0xe8}, {0x05, 1, 0xe8}, {0x06, 3, 0xe8},
+        {0x03, 1, 0xe9}, {0x04, 1, 0xe9}, {0x05, 1, 0xe9}, {0x06, 3, 0xe9}
+    },
+    /* 136 */
+    {
+        {0x01, 1, 0x01}, {0x02, 3, 0x01}, {0x01, 1, 0x87}, {0x02, 3, 0x87},
+        {0x01, 1, 0x89}, {0x02, 3, 0x89}, {0x01, 1, 0x8a}, {0x02, 3, 0x8a},
+        {0x01, 1, 0x8b}, {0x02, 3, 0x8b}, {0x01, 1, 0x8c}, {0x02, 3, 0x8c},
+        {0x01, 1, 0x8d}, {0x02, 3, 0x8d}, {0x01, 1, 0x8f}, {0x02, 3, 0x8f}
+    },
+    /* 137 */
+    {
+        {0x01, 1, 0x93}, {0x02, 3, 0x93}, {0x01, 1, 0x95}, {0x02, 3, 0x95},
+        {0x01, 1, 0x96}, {0x02, 3, 0x96}, {0x01, 1, 0x97}, {0x02, 3, 0x97},
+        {0x01, 1, 0x98}, {0x02, 3, 0x98}, {0x01, 1, 0x9b}, {0x02, 3, 0x9b},
+        {0x01, 1, 0x9d}, {0x02, 3, 0x9d}, {0x01, 1, 0x9e}, {0x02, 3, 0x9e}
+    },
+    /* 138 */
+    {
+        {0x01, 1, 0xa5}, {0x02, 3, 0xa5}, {0x01, 1, 0xa6}, {0x02, 3, 0xa6},
+        {0x01, 1, 0xa8}, {0x02, 3, 0xa8}, {0x01, 1, 0xae}, {0x02, 3, 0xae},
+        {0x01, 1, 0xaf}, {0x02, 3, 0xaf}, {0x01, 1, 0xb4}, {0x02, 3, 0xb4},
+        {0x01, 1, 0xb6}, {0x02, 3, 0xb6}, {0x01, 1, 0xb7}, {0x02, 3, 0xb7}
+    },
+    /* 139 */
+    {
+        {0x01, 1, 0xbc}, {0x02, 3, 0xbc}, {0x01, 1, 0xbf}, {0x02, 3, 0xbf},
+        {0x01, 1, 0xc5}, {0x02, 3, 0xc5}, {0x01, 1, 0xe7}, {0x02, 3, 0xe7},
+        {0x01, 1, 0xef}, {0x02, 3, 0xef}, {0x00, 3, 0x09}, {0x00, 3, 0x8e},
+        {0x00, 3, 0x90}, {0x00, 3, 0x91}, {0x00, 3, 0x94}, {0x00, 3, 0x9f}
+    },
+    /* 140 */
+    {
+        {0x00, 3, 0xab}, {0x00, 3, 0xce}, {0x00, 3, 0xd7}, {0x00, 3, 0xe1},
+        {0x00, 3, 0xec}, {0x00, 3, 0xed}, {0xc3, 0, 0x00}, {0xc4, 0, 0x00},
+        {0xc5, 0, 0x00}, {0xc6, 0, 0x00}, {0xc7, 0, 0x00}, {0xc8, 0, 0x00},
+        {0xc9, 0, 0x00}, {0xca, 0, 0x00}, {0xcb, 0, 0x00}, {0xcc, 0, 0x00}
+    },
+    /* 141 */
+    {
+        {0x07, 1, 0x81}, {0x08, 1, 0x81}, {0x09, 1, 0x81}, {0x0a, 1, 0x81},
+        {0x0b, 1, 0x81}, {0x0c, 1, 0x81}, {0x0d, 1, 0x81}, {0x0e, 3, 0x81},
+        {0x07, 1, 0x84}, {0x08, 1, 0x84}, {0x09, 1, 0x84}, {0x0a, 1, 0x84},
+        {0x0b, 1, 0x84}, {0x0c, 1, 0x84}, {0x0d, 1, 0x84}, {0x0e, 3, 0x84}
+    },
+    /* 142 */
+    {
+        {0x07, 1, 0x85}, {0x08, 1, 0x85}, {0x09, 1, 0x85}, {0x0a, 1, 0x85},
+        {0x0b, 1, 0x85}, {0x0c, 1, 0x85}, {0x0d, 1, 0x85}, {0x0e, 3, 0x85},
+        {0x07, 1, 0x86}, {0x08, 1, 0x86}, {0x09, 1, 0x86}, {0x0a, 1, 0x86},
+        {0x0b, 1, 0x86}, {0x0c, 1, 0x86}, {0x0d, 1, 0x86}, {0x0e, 3, 0x86}
+    },
+    /* 143 */
+    {
+        {0x07, 1, 0x88}, {0x08, 1, 0x88}, {0x09, 1, 0x88}, {0x0a, 1, 0x88},
+        {0x0b, 1, 0x88}, {0x0c, 1, 0x88}, {0x0d, 1, 0x88}, {0x0e, 3, 0x88},
+        {0x07, 1, 0x92}, {0x08, 1, 0x92}, {0x09, 1, 0x92}, {0x0a, 1, 0x92},
+        {0x0b, 1, 0x92}, {0x0c, 1, 0x92}, {0x0d, 1, 0x92}, {0x0e, 3, 0x92}
+    },
+    /* 144 */
+    {
+        {0x07, 1, 0x9a}, {0x08, 1, 0x9a}, {0x09, 1, 0x9a}, {0x0a, 1, 0x9a},
+        {0x0b, 1, 0x9a}, {0x0c, 1, 0x9a}, {0x0d, 1, 0x9a}, {0x0e, 3, 0x9a},
+        {0x07, 1, 0x9c}, {0x08, 1, 0x9c}, {0x09, 1, 0x9c}, {0x0a, 1, 0x9c},
+        {0x0b, 1, 0x9c}, {0x0c, 1, 0x9c}, {0x0d, 1, 0x9c}, {0x0e, 3, 0x9c}
+    },
+    /* 145 */
+    {
+        {0x07, 1, 0xa0}, {0x08, 1, 0xa0}, {0x09, 1, 0xa0}, {0x0a, 1, 0xa0},
+        {0x0b, 1, 0xa0}, {0x0c, 1, 0xa0}, {0x0d, 1, 0xa0}, {0x0e, 3, 0xa0},
+        {0x07, 1, 0xa3}, {0x08, 1, 0xa3}, {0x09, 1, 0xa3}, {0x0a, 1, 0xa3},
+        {0x0b, 1, 0xa3}, {0x0c, 1, 0xa3}, {0x0d, 1, 0xa3}, {0x0e, 3, 0xa3}
+    },
+    /* 146 */
+    {
+        {0x07, 1, 0xa4}, {0x08, 1, 0xa4}, {0x09, 1, 0xa4}, {0x0a, 1, 0xa4},
+        {0x0b, 1, 0xa4}, {0x0c, 1, 0xa4}, {0x0d, 1, 0xa4}, {0x0e, 3, 0xa4},
+        {0x07, 1, 0xa9}, {0x08, 1, 0xa9}, {0x09, 1, 0xa9}, {0x0a, 1, 0xa9},
+        {0x0b, 1, 0xa9}, {0x0c, 1, 0xa9}, {0x0d, 1, 0xa9}, {0x0e, 3, 0xa9}
+    },
+    /* 147 */
+    {
+        {0x07, 1, 0xaa}, {0x08, 1, 0xaa}, {0x09, 1, 0xaa}, {0x0a, 1, 0xaa},
+        {0x0b, 1, 0xaa}, {0x0c, 1, 0xaa}, {0x0d, 1, 0xaa}, {0x0e, 3, 0xaa},
+        {0x07, 1, 0xad}, {0x08, 1, 0xad}, {0x09, 1, 0xad}, {0x0a, 1, 0xad},
+        {0x0b, 1, 0xad}, {0x0c, 1, 0xad}, {0x0d, 1, 0xad}, {0x0e, 3, 0xad}
+    },
+    /* 148 */
+    {
+        {0x07, 1, 0xb2}, {0x08, 1, 0xb2}, {0x09, 1, 0xb2}, {0x0a, 1, 0xb2},
+        {0x0b, 1, 0xb2}, {0x0c, 1, 0xb2}, {0x0d, 1, 0xb2}, {0x0e, 3, 0xb2},
+        {0x07, 1, 0xb5}, {0x08, 1, 0xb5}, {0x09, 1, 0xb5}, {0x0a, 1, 0xb5},
+        {0x0b, 1, 0xb5}, {0x0c, 1, 0xb5}, {0x0d, 1, 0xb5}, {0x0e, 3, 0xb5}
+    },
+    /* 149 */
+    {
+        {0x07, 1, 0xb9}, {0x08, 1, 0xb9}, {0x09, 1, 0xb9}, {0x0a, 1, 0xb9},
+        {0x0b, 1, 0xb9}, {0x0c, 1, 0xb9}, {0x0d, 1, 0xb9}, {0x0e, 3, 0xb9},
+        {0x07, 1, 0xba}, {0x08, 1, 0xba}, {0x09, 1, 0xba}, {0x0a, 1, 0xba},
+        {0x0b, 1, 0xba}, {0x0c, 1, 0xba}, {0x0d, 1, 0xba}, {0x0e, 3, 0xba}
+    },
+    /* 150 */
+    {
+        {0x07, 1, 0xbb}, {0x08, 1, 0xbb}, {0x09, 1, 0xbb}, {0x0a, 1, 0xbb},
+        {0x0b, 1, 0xbb}, {0x0c, 1, 0xbb}, {0x0d, 1, 0xbb}, {0x0e, 3, 0xbb},
+        {0x07, 1, 0xbd}, {0x08, 1, 0xbd}, {0x09, 1, 0xbd}, {0x0a, 1, 0xbd},
+        {0x0b, 1, 0xbd}, {0x0c, 1, 0xbd}, {0x0d, 1, 0xbd}, {0x0e, 3, 0xbd}
+    },
+    /* 151 */
+    {
+        {0x07, 1, 0xbe}, {0x08, 1, 0xbe}, {0x09, 1, 0xbe}, {0x0a, 1, 0xbe},
+        {0x0b, 1, 0xbe}, {0x0c, 1, 0xbe}, {0x0d, 1, 0xbe}, {0x0e, 3, 0xbe},
+        {0x07, 1, 0xc4}, {0x08, 1, 0xc4}, {0x09, 1, 0xc4}, {0x0a, 1, 0xc4},
+        {0x0b, 1, 0xc4}, {0x0c, 1, 0xc4}, {0x0d, 1, 0xc4}, {0x0e, 3, 0xc4}
+    },
+    /* 152 */
+    {
+        {0x07, 1, 0xc6}, {0x08, 1, 0xc6}, {0x09, 1, 0xc6}, {0x0a, 1, 0xc6},
+        {0x0b, 1, 0xc6}, {0x0c, 1, 0xc6}, {0x0d, 1, 0xc6}, {0x0e, 3, 0xc6},
+        {0x07, 1, 0xe4}, {0x08, 1, 0xe4}, {0x09, 1, 0xe4}, {0x0a, 1, 0xe4},
+        {0x0b, 1, 0xe4}, {0x0c, 1, 0xe4}, {0x0d, 1, 0xe4}, {0x0e, 3, 0xe4}
+    },
+    /* 153 */
+    {
+        {0x07, 1, 0xe8}, {0x08, 1, 0xe8}, {0x09, 1, 0xe8}, {0x0a, 1, 0xe8},
+        {0x0b, 1, 0xe8}, {0x0c, 1, 0xe8}, {0x0d, 1, 0xe8}, {0x0e, 3, 0xe8},
+        {0x07, 1, 0xe9}, {0x08, 1, 0xe9}, {0x09, 1, 0xe9}, {0x0a, 1, 0xe9},
+        {0x0b, 1, 0xe9}, {0x0c, 1, 0xe9}, {0x0d, 1, 0xe9}, {0x0e, 3, 0xe9}
+    },
+    /* 154 */
+    {
+        {0x03, 1, 0x01}, {0x04, 1, 0x01}, {0x05, 1, 0x01}, {0x06, 3, 0x01},
+        {0x03, 1, 0x87}, {0x04, 1, 0x87}, {0x05, 1, 0x87}, {0x06, 3, 0x87},
+        {0x03, 1, 0x89}, {0x04, 1, 0x89}, {0x05, 1, 0x89}, {0x06, 3, 0x89},
+        {0x03, 1, 0x8a}, {0x04, 1, 0x8a}, {0x05, 1, 0x8a}, {0x06, 3, 0x8a}
+    },
+    /* 155 */
+    {
+        {0x03, 1, 0x8b}, {0x04, 1, 0x8b}, {0x05, 1, 0x8b}, {0x06, 3, 0x8b},
+        {0x03, 1, 0x8c}, {0x04, 1, 0x8c}, {0x05, 1, 0x8c}, {0x06, 3, 0x8c},
+        {0x03, 1, 0x8d}, {0x04, 1, 0x8d}, {0x05, 1, 0x8d}, {0x06, 3, 0x8d},
+        {0x03, 1, 0x8f}, {0x04, 1, 0x8f}, {0x05, 1, 0x8f}, {0x06, 3, 0x8f}
+    },
+    /* 156 */
+    {
+        {0x03, 1, 0x93}, {0x04, 1, 0x93}, {0x05, 1, 0x93}, {0x06, 3, 0x93},
+        {0x03, 1, 0x95}, {0x04, 1, 0x95}, {0x05, 1, 0x95}, {0x06, 3, 0x95},
+        {0x03, 1, 0x96}, {0x04, 1, 0x96}, {0x05, 1, 0x96}, {0x06, 3, 0x96},
+        {0x03, 1, 0x97}, {0x04, 1, 0x97}, {0x05, 1, 0x97}, {0x06, 3, 0x97}
+    },
+    /* 157 */
+    {
+        {0x03, 1, 0x98}, {0x04, 1, 0x98}, {0x05, 1, 0x98}, {0x06, 3, 0x98},
+        {0x03, 1, 0x9b}, {0x04, 1, 0x9b}, {0x05, 1, 0x9b}, {0x06, 3, 0x9b},
+        {0x03, 1, 0x9d}, {0x04, 1, 0x9d}, {0x05, 1, 0x9d}, {0x06, 3, 0x9d},
+        {0x03, 1, 0x9e}, {0x04, 1, 0x9e}, {0x05, 1, 0x9e}, {0x06, 3, 0x9e}
+    },
+    /* 158 */
+    {
+        {0x03, 1, 0xa5}, {0x04, 1, 0xa5}, {0x05, 1, 0xa5}, {0x06, 3, 0xa5},
+        {0x03, 1, 0xa6}, {0x04, 1, 0xa6}, {0x05, 1, 0xa6}, {0x06, 3, 0xa6},
+        {0x03, 1, 0xa8}, {0x04, 1, 0xa8}, {0x05, 1, 0xa8}, {0x06, 3, 0xa8},
+        {0x03, 1, 0xae}, {0x04, 1, 0xae}, {0x05, 1, 0xae}, {0x06, 3, 0xae}
+    },
+    /* 159 */
+    {
+        {0x03, 1, 0xaf}, {0x04, 1, 0xaf}, {0x05, 1, 0xaf}, {0x06, 3, 0xaf},
+        {0x03, 1, 0xb4}, {0x04, 1, 0xb4}, {0x05, 1, 0xb4}, {0x06, 3, 0xb4},
+        {0x03, 1, 0xb6}, {0x04, 1, 0xb6}, {0x05, 1, 0xb6}, {0x06, 3, 0xb6},
+        {0x03, 1, 0xb7}, {0x04, 1, 0xb7}, {0x05, 1, 0xb7}, {0x06, 3, 0xb7}
+    },
+    /* 160 */
+    {
+        {0x03, 1, 0xbc}, {0x04, 1, 0xbc}, {0x05, 1, 0xbc}, {0x06, 3, 0xbc},
+        {0x03, 1, 0xbf}, {0x04, 1, 0xbf}, {0x05, 1, 0xbf}, {0x06, 3, 0xbf},
+        {0x03, 1, 0xc5}, {0x04, 1, 0xc5}, {0x05, 1, 0xc5}, {0x06, 3, 0xc5},
+        {0x03, 1, 0xe7}, {0x04, 1, 0xe7}, {0x05, 1, 0xe7}, {0x06, 3, 0xe7}
+    },
+    /* 161 */
+    {
+        {0x03, 1, 0xef}, {0x04, 1, 0xef}, {0x05, 1, 0xef}, {0x06, 3, 0xef},
+        {0x01, 1, 0x09}, {0x02, 3, 0x09}, {0x01, 1, 0x8e}, {0x02, 3, 0x8e},
+        {0x01, 1, 0x90}, {0x02, 3, 0x90}, {0x01, 1, 0x91}, {0x02, 3, 0x91},
+        {0x01, 1, 0x94}, {0x02, 3, 0x94}, {0x01, 1, 0x9f}, {0x02, 3, 0x9f}
+    },
+    /* 162 */
+    {
+        {0x01, 1, 0xab}, {0x02, 3, 0xab}, {0x01, 1, 0xce}, {0x02, 3, 0xce},
+        {0x01, 1, 0xd7}, {0x02, 3, 0xd7}, {0x01, 1, 0xe1}, {0x02, 3, 0xe1},
+        {0x01, 1, 0xec}, {0x02, 3, 0xec}, {0x01, 1, 0xed}, {0x02, 3, 0xed},
+        {0x00, 3, 0xc7}, {0x00, 3, 0xcf}, {0x00, 3, 0xea}, {0x00, 3, 0xeb}
+    },
+    /* 163 */
+    {
+        {0xcd, 0, 0x00}, {0xce, 0, 0x00}, {0xcf, 0, 0x00}, {0xd0, 0, 0x00},
+        {0xd1, 0, 0x00}, {0xd2, 0, 0x00}, {0xd3, 0, 0x00}, {0xd4, 0, 0x00},
+        {0xd5, 0, 0x00}, {0xd6, 0, 0x00}, {0xd7, 0, 0x00}, {0xd8, 0, 0x00},
+        {0xd9, 0, 0x00}, {0xda, 0, 0x00}, {0xdb, 0, 0x00}, {0xdc, 0, 0x00}
+    },
+    /* 164 */
+    {
+        {0x07, 1, 0x01}, {0x08, 1, 0x01}, {0x09, 1, 0x01}, {0x0a, 1, 0x01},
+        {0x0b, 1, 0x01}, {0x0c, 1, 0x01}, {0x0d, 1, 0x01}, {0x0e, 3, 0x01},
+        {0x07, 1, 0x87}, {0x08, 1, 0x87}, {0x09, 1, 0x87}, {0x0a, 1, 0x87},
+        {0x0b, 1, 0x87}, {0x0c, 1, 0x87}, {0x0d, 1, 0x87}, {0x0e, 3, 0x87}
+    },
+    /* 165 */
+    {
+        {0x07, 1, 0x89}, {0x08, 1, 0x89}, {0x09, 1, 0x89}, {0x0a, 1, 0x89},
+        {0x0b, 1, 0x89}, {0x0c, 1, 0x89}, {0x0d, 1, 0x89}, {0x0e, 3, 0x89},
+        {0x07, 1, 0x8a}, {0x08, 1, 0x8a}, {0x09, 1, 0x8a}, {0x0a, 1, 0x8a},
+        {0x0b, 1, 0x8a}, {0x0c, 1, 0x8a}, {0x0d, 1, 0x8a}, {0x0e, 3, 0x8a}
+    },
+    /* 166 */
+    {
+        {0x07, 1, 0x8b}, {0x08, 1, 0x8b}, {0x09, 1, 0x8b}, {0x0a, 1, 0x8b},
+        {0x0b, 1, 0x8b}, {0x0c, 1, 0x8b}, {0x0d, 1, 0x8b}, {0x0e, 3, 0x8b},
+        {0x07, 1, 0x8c}, {0x08, 1, 0x8c}, {0x09, 1, 0x8c}, {0x0a, 1, 0x8c},
+        {0x0b, 1, 0x8c}, {0x0c, 1, 0x8c}, {0x0d, 1, 0x8c}, {0x0e, 3, 0x8c}
+    },
+    /* 167 */
+    {
+        {0x07, 1, 0x8d}, {0x08, 1, 0x8d}, {0x09, 1, 0x8d}, {0x0a, 1, 0x8d},
+        {0x0b, 1, 0x8d}, {0x0c, 1, 0x8d}, {0x0d, 1, 0x8d}, {0x0e, 3, 0x8d},
+        {0x07, 1, 0x8f}, {0x08, 1, 0x8f}, {0x09, 1, 0x8f}, {0x0a, 1, 0x8f},
+        {0x0b, 1, 0x8f}, {0x0c, 1, 0x8f}, {0x0d, 1, 0x8f}, {0x0e, 3, 0x8f}
+    },
+    /* 168 */
+    {
+        {0x07, 1, 0x93}, {0x08, 1, 0x93}, {0x09, 1, 0x93}, {0x0a, 1, 0x93},
+        {0x0b, 1, 0x93}, {0x0c, 1, 0x93}, {0x0d, 1, 0x93}, {0x0e, 3, 0x93},
+        {0x07, 1, 0x95}, {0x08, 1, 0x95}, {0x09, 1, 0x95}, {0x0a, 1, 0x95},
+        {0x0b, 1, 0x95}, {0x0c, 1, 0x95}, {0x0d, 1, 0x95}, {0x0e, 3, 0x95}
+    },
+    /* 169 */
+    {
+        {0x07, 1, 0x96}, {0x08, 1, 0x96}, {0x09, 1, 0x96}, {0x0a, 1, 0x96},
+        {0x0b, 1, 0x96}, {0x0c, 1, 0x96}, {0x0d, 1, 0x96}, {0x0e, 3, 0x96},
+        {0x07, 1, 0x97}, {0x08, 1, 0x97}, {0x09, 1, 0x97}, {0x0a, 1, 0x97},
+        {0x0b, 1, 0x97}, {0x0c, 1, 0x97}, {0x0d, 1, 0x97}, {0x0e, 3, 0x97}
+    },
+    /* 170 */
+    {
+        {0x07, 1, 0x98}, {0x08, 1, 0x98}, {0x09, 1, 0x98}, {0x0a, 1, 0x98},
+        {0x0b, 1, 0x98}, {0x0c, 1, 0x98}, {0x0d, 1, 0x98}, {0x0e, 3, 0x98},
+        {0x07, 1, 0x9b}, {0x08, 1, 0x9b}, {0x09, 1, 0x9b}, {0x0a, 1, 0x9b},
+        {0x0b, 1, 0x9b}, {0x0c, 1, 0x9b}, {0x0d, 1, 0x9b}, {0x0e, 3, 0x9b}
+    },
+    /* 171 */
+    {
+        {0x07, 1, 0x9d}, {0x08, 1, 0x9d}, {0x09, 1, 0x9d}, {0x0a, 1, 0x9d},
+        {0x0b, 1, 0x9d}, {0x0c, 1, 0x9d}, {0x0d, 1, 0x9d}, {0x0e, 3, 0x9d},
+        {0x07, 1, 0x9e}, {0x08, 1, 0x9e}, {0x09, 1, 0x9e}, {0x0a, 1, 0x9e},
+        {0x0b, 1, 0x9e}, {0x0c, 1, 0x9e}, {0x0d, 1, 0x9e}, {0x0e, 3, 0x9e}
+    },
+    /* 172 */
+    {
+        {0x07, 1, 0xa5}, {0x08, 1, 0xa5}, {0x09, 1, 0xa5}, {0x0a, 1, 0xa5},
+        {0x0b, 1, 0xa5}, {0x0c, 1, 0xa5}, {0x0d, 1, 0xa5}, {0x0e, 3, 0xa5},
+        {0x07, 1, 0xa6}, {0x08, 1, 0xa6}, {0x09, 1, 0xa6}, {0x0a, 1, 0xa6},
+        {0x0b, 1, 0xa6}, {0x0c, 1, 0xa6}, {0x0d, 1, 0xa6}, {0x0e, 3, 0xa6}
+    },
+    /* 173 */
+    {
+        {0x07, 1, 0xa8}, {0x08, 1, 0xa8}, {0x09, 1, 0xa8}, {0x0a, 1, 0xa8},
+        {0x0b, 1, 0xa8}, {0x0c, 1, 0xa8}, {0x0d, 1, 0xa8}, {0x0e, 3, 0xa8},
+        {0x07, 1, 0xae}, {0x08, 1, 0xae}, {0x09, 1, 0xae}, {0x0a, 1, 0xae},
+        {0x0b, 1, 0xae}, {0x0c, 1, 0xae}, {0x0d, 1, 0xae}, {0x0e, 3, 0xae}
+    },
+    /* 174 */
+    {
+        {0x07, 1, 0xaf}, {0x08, 1, 0xaf}, {0x09, 1, 0xaf}, {0x0a, 1, 0xaf},
+        {0x0b, 1, 0xaf}, {0x0c, 1, 0xaf}, {0x0d, 1, 0xaf}, {0x0e, 3, 0xaf},
+        {0x07, 1, 0xb4}, {0x08, 1, 0xb4}, {0x09, 1, 0xb4}, {0x0a, 1, 0xb4},
+        {0x0b, 1, 0xb4}, {0x0c, 1, 0xb4}, {0x0d, 1, 0xb4}, {0x0e, 3, 0xb4}
+    },
+    /* 175 */
+    {
+        {0x07, 1, 0xb6}, {0x08, 1, 0xb6}, {0x09, 1, 0xb6}, {0x0a, 1, 0xb6},
+        {0x0b, 1, 0xb6}, {0x0c, 1, 0xb6}, {0x0d, 1, 0xb6}, {0x0e, 3, 0xb6},
+        {0x07, 1, 0xb7}, {0x08, 1, 0xb7}, {0x09, 1, 0xb7}, {0x0a, 1, 0xb7},
+        {0x0b, 1, 0xb7}, {0x0c, 1, 0xb7}, {0x0d, 1, 0xb7}, {0x0e, 3, 0xb7}
+    },
+    /* 176 */
+    {
+        {0x07, 1, 0xbc}, {0x08, 1, 0xbc}, {0x09, 1, 0xbc}, {0x0a, 1, 0xbc},
+        {0x0b, 1, 0xbc}, {0x0c, 1, 0xbc}, {0x0d, 1, 0xbc}, {0x0e, 3, 0xbc},
+        {0x07, 1, 0xbf}, {0x08, 1, 0xbf}, {0x09, 1, 0xbf}, {0x0a, 1, 0xbf},
+        {0x0b, 1, 0xbf}, {0x0c, 1, 0xbf}, {0x0d, 1, 0xbf}, {0x0e, 3, 0xbf}
+    },
+    /* 177 */
+    {
+        {0x07, 1, 0xc5}, {0x08, 1, 0xc5}, {0x09, 1, 0xc5}, {0x0a, 1, 0xc5},
+        {0x0b, 1, 0xc5}, {0x0c, 1, 0xc5}, {0x0d, 1, 0xc5}, {0x0e, 3, 0xc5},
+        {0x07, 1, 0xe7}, {0x08, 1, 0xe7}, {0x09, 1, 0xe7}, {0x0a, 1, 0xe7},
+        {0x0b, 1, 0xe7}, {0x0c, 1, 0xe7}, {0x0d, 1, 0xe7}, {0x0e, 3, 0xe7}
+    },
+    /* 178 */
+    {
+        {0x07, 1, 0xef}, {0x08, 1, 0xef}, {0x09, 1, 0xef}, {0x0a, 1, 0xef},
+        {0x0b, 1, 0xef}, {0x0c, 1, 0xef}, {0x0d, 1, 0xef}, {0x0e, 3, 0xef},
+        {0x03, 1, 0x09}, {0x04, 1, 0x09}, {0x05, 1, 0x09}, {0x06, 3, 0x09},
+        {0x03, 1, 0x8e}, {0x04, 1, 0x8e}, {0x05, 1, 0x8e}, {0x06, 3, 0x8e}
+    },
+    /* 179 */
+    {
+        {0x03, 1, 0x90}, {0x04, 1, 0x90}, {0x05, 1, 0x90}, {0x06, 3, 0x90},
+        {0x03, 1, 0x91}, {0x04, 1, 0x91}, {0x05, 1, 0x91}, {0x06, 3, 0x91},
+        {0x03, 1, 0x94}, {0x04, 1, 0x94}, {0x05, 1, 0x94}, {0x06, 3, 0x94},
+        {0x03, 1, 0x9f}, {0x04, 1, 0x9f}, {0x05, 1, 0x9f}, {0x06, 3, 0x9f}
+    },
+    /* 180 */
+    {
+        {0x03, 1, 0xab}, {0x04, 1, 0xab}, {0x05, 1, 0xab}, {0x06, 3, 0xab},
+        {0x03, 1, 0xce}, {0x04, 1, 0xce}, {0x05, 1, 0xce}, {0x06, 3, 0xce},
+        {0x03, 1, 0xd7}, {0x04, 1, 0xd7}, {0x05, 1, 0xd7}, {0x06, 3, 0xd7},
+        {0x03, 1, 0xe1}, {0x04, 1, 0xe1}, {0x05, 1, 0xe1}, {0x06, 3, 0xe1}
+    },
+    /* 181 */
+    {
+        {0x03, 1, 0xec}, {0x04, 1, 0xec}, {0x05, 1, 0xec}, {0x06, 3, 0xec},
+        {0x03, 1, 0xed}, {0x04, 1, 0xed}, {0x05, 1, 0xed}, {0x06, 3, 0xed},
+        {0x01, 1, 0xc7}, {0x02, 3, 0xc7}, {0x01, 1, 0xcf}, {0x02, 3, 0xcf},
+        {0x01, 1, 0xea}, {0x02, 3, 0xea}, {0x01, 1, 0xeb}, {0x02, 3, 0xeb}
+    },
+    /* 182 */
+    {
+        {0x00, 3, 0xc0}, {0x00, 3, 0xc1}, {0x00, 3, 0xc8}, {0x00, 3, 0xc9},
+        {0x00, 3, 0xca}, {0x00, 3, 0xcd}, {0x00, 3, 0xd2}, {0x00, 3, 0xd5},
+        {0x00, 3, 0xda}, {0x00, 3, 0xdb}, {0x00, 3, 0xee}, {0x00, 3, 0xf0},
+        {0x00, 3, 0xf2}, {0x00, 3, 0xf3}, {0x00, 3, 0xff}, {0xdd, 0, 0x00}
+    },
+    /* 183 */
+    {
+        {0xde, 0, 0x00}, {0xdf, 0, 0x00}, {0xe0, 0, 0x00}, {0xe1, 0, 0x00},
+        {0xe2, 0, 0x00}, {0xe3, 0, 0x00}, {0xe4, 0, 0x00}, {0xe5, 0, 0x00},
+        {0xe6, 0, 0x00}, {0xe7, 0, 0x00}, {0xe8, 0, 0x00}, {0xe9, 0, 0x00},
+        {0xea, 0, 0x00}, {0xeb, 0, 0x00}, {0xec, 0, 0x00}, {0xed, 0, 0x00}
+    },
+    /* 184 */
+    {
+        {0x07, 1, 0x09}, {0x08, 1, 0x09}, {0x09, 1, 0x09}, {0x0a, 1, 0x09},
+        {0x0b, 1, 0x09}, {0x0c, 1, 0x09}, {0x0d, 1, 0x09}, {0x0e, 3, 0x09},
+        {0x07, 1, 0x8e}, {0x08, 1, 0x8e}, {0x09, 1, 0x8e}, {0x0a, 1, 0x8e},
+        {0x0b, 1, 0x8e}, {0x0c, 1, 0x8e}, {0x0d, 1, 0x8e}, {0x0e, 3, 0x8e}
+    },
+    /* 185 */
+    {
+        {0x07, 1, 0x90}, {0x08, 1, 0x90}, {0x09, 1, 0x90}, {0x0a, 1, 0x90},
+        {0x0b, 1, 0x90}, {0x0c, 1, 0x90}, {0x0d, 1, 0x90}, {0x0e, 3, 0x90},
+        {0x07, 1, 0x91}, {0x08, 1, 0x91}, {0x09, 1, 0x91}, {0x0a, 1, 0x91},
+        {0x0b, 1, 0x91}, {0x0c, 1, 0x91}, {0x0d, 1, 0x91}, {0x0e, 3, 0x91}
+    },
+    /* 186 */
+    {
+        {0x07, 1, 0x94}, {0x08, 1, 0x94}, {0x09, 1, 0x94}, {0x0a, 1, 0x94},
+        {0x0b, 1, 0x94}, {0x0c, 1, 0x94}, {0x0d, 1, 0x94}, {0x0e, 3, 0x94},
+        {0x07, 1, 0x9f}, {0x08, 1, 0x9f}, {0x09, 1, 0x9f}, {0x0a, 1, 0x9f},
+        {0x0b, 1, 0x9f}, {0x0c, 1, 0x9f}, {0x0d, 1, 0x9f}, {0x0e, 3, 0x9f}
+    },
+    /* 187 */
+    {
+        {0x07, 1, 0xab}, {0x08, 1, 0xab}, {0x09, 1, 0xab}, {0x0a, 1, 0xab},
+        {0x0b, 1, 0xab}, {0x0c, 1, 0xab}, {0x0d, 1, 0xab}, {0x0e, 3, 0xab},
+        {0x07, 1, 0xce}, {0x08, 1, 0xce}, {0x09, 1, 0xce}, {0x0a, 1, 0xce},
+        {0x0b, 1, 0xce}, {0x0c, 1, 0xce}, {0x0d, 1, 0xce}, {0x0e, 3, 0xce}
+    },
+    /* 188 */
+    {
+        {0x07, 1, 0xd7}, {0x08, 1, 0xd7}, {0x09, 1, 0xd7}, {0x0a, 1, 0xd7},
+        {0x0b, 1, 0xd7}, {0x0c, 1, 0xd7}, {0x0d, 1, 0xd7}, {0x0e, 3, 0xd7},
+        {0x07, 1, 0xe1}, {0x08, 1, 0xe1}, {0x09, 1, 0xe1}, {0x0a, 1, 0xe1},
+        {0x0b, 1, 0xe1}, {0x0c, 1, 0xe1}, {0x0d, 1, 0xe1}, {0x0e, 3, 0xe1}
+    },
+    /* 189 */
+    {
+        {0x07, 1, 0xec}, {0x08, 1, 0xec}, {0x09, 1, 0xec}, {0x0a, 1, 0xec},
+        {0x0b, 1, 0xec}, {0x0c, 1, 0xec}, {0x0d, 1, 0xec}, {0x0e, 3, 0xec},
+        {0x07, 1, 0xed}, {0x08, 1, 0xed}, {0x09, 1, 0xed}, {0x0a, 1, 0xed},
+        {0x0b, 1, 0xed}, {0x0c, 1, 0xed}, {0x0d, 1, 0xed}, {0x0e, 3, 0xed}
+    },
+    /* 190 */
+    {
+        {0x03, 1, 0xc7}, {0x04, 1, 0xc7}, {0x05, 1, 0xc7}, {0x06, 3, 0xc7},
+        {0x03, 1, 0xcf}, {0x04, 1, 0xcf}, {0x05, 1, 0xcf}, {0x06, 3, 0xcf},
+        {0x03, 1, 0xea}, {0x04, 1, 0xea}, {0x05, 1, 0xea}, {0x06, 3, 0xea},
+        {0x03, 1, 0xeb}, {0x04, 1, 0xeb}, {0x05, 1, 0xeb}, {0x06, 3, 0xeb}
+    },
+    /* 191 */
+    {
+        {0x01, 1, 0xc0}, {0x02, 3, 0xc0}, {0x01, 1, 0xc1}, {0x02, 3, 0xc1},
+        {0x01, 1, 0xc8}, {0x02, 3, 0xc8}, {0x01, 1, 0xc9}, {0x02, 3, 0xc9},
+        {0x01, 1, 0xca}, {0x02, 3, 0xca}, {0x01, 1, 0xcd}, {0x02, 3, 0xcd},
+        {0x01, 1, 0xd2}, {0x02, 3, 0xd2}, {0x01, 1, 0xd5}, {0x02, 3, 0xd5}
+    },
+    /* 192 */
+    {
+        {0x01, 1, 0xda}, {0x02, 3, 0xda}, {0x01, 1, 0xdb}, {0x02, 3, 0xdb},
+        {0x01, 1, 0xee}, {0x02, 3, 0xee}, {0x01, 1, 0xf0}, {0x02, 3, 0xf0},
+        {0x01, 1, 0xf2}, {0x02, 3, 0xf2}, {0x01, 1, 0xf3}, {0x02, 3, 0xf3},
+        {0x01, 1, 0xff}, {0x02, 3, 0xff}, {0x00, 3, 0xcb}, {0x00, 3, 0xcc}
+    },
+    /* 193 */
+    {
+        {0x00, 3, 0xd3}, {0x00, 3, 0xd4}, {0x00, 3, 0xd6}, {0x00, 3, 0xdd},
+        {0x00, 3, 0xde}, {0x00, 3, 0xdf}, {0x00, 3, 0xf1}, {0x00, 3, 0xf4},
+        {0x00, 3, 0xf5}, {0x00, 3, 0xf6}, {0x00, 3, 0xf7}, {0x00, 3, 0xf8},
+        {0x00, 3, 0xfa}, {0x00, 3, 0xfb}, {0x00, 3, 0xfc}, {0x00, 3, 0xfd}
+    },
+    /* 194 */
+    {
+        {0x00, 3, 0xfe}, {0xee, 0, 0x00}, {0xef, 0, 0x00}, {0xf0, 0, 0x00},
+        {0xf1, 0, 0x00}, {0xf2, 0, 0x00}, {0xf3, 0, 0x00}, {0xf4, 0, 0x00},
+        {0xf5, 0, 0x00}, {0xf6, 0, 0x00}, {0xf7, 0, 0x00}, {0xf8, 0, 0x00},
+        {0xf9, 0, 0x00}, {0xfa, 0, 0x00}, {0xfb, 0, 0x00}, {0xfc, 0, 0x00}
+    },
+    /* 195 */
+    {
+        {0x07, 1, 0xc7}, {0x08, 1, 0xc7}, {0x09, 1, 0xc7}, {0x0a, 1, 0xc7},
+        {0x0b, 1, 0xc7}, {0x0c, 1, 0xc7}, {0x0d, 1, 0xc7}, {0x0e, 3, 0xc7},
+        {0x07, 1, 0xcf}, {0x08, 1, 0xcf}, {0x09, 1, 0xcf}, {0x0a, 1, 0xcf},
+        {0x0b, 1, 0xcf}, {0x0c, 1, 0xcf}, {0x0d, 1, 0xcf}, {0x0e, 3, 0xcf}
+    },
+    /* 196 */
+    {
+        {0x07, 1, 0xea}, {0x08, 1, 0xea}, {0x09, 1, 0xea}, {0x0a, 1, 0xea},
+        {0x0b, 1, 0xea}, {0x0c, 1, 0xea}, {0x0d, 1, 0xea}, {0x0e, 3, 0xea},
+        {0x07, 1, 0xeb}, {0x08, 1, 0xeb}, {0x09, 1, 0xeb}, {0x0a, 1, 0xeb},
+        {0x0b, 1, 0xeb}, {0x0c, 1, 0xeb}, {0x0d, 1, 0xeb}, {0x0e, 3, 0xeb}
+    },
+    /* 197 */
+    {
+        {0x03, 1, 0xc0}, {0x04, 1, 0xc0}, {0x05, 1, 0xc0}, {0x06, 3, 0xc0},
+        {0x03, 1, 0xc1}, {0x04, 1, 0xc1}, {0x05, 1, 0xc1}, {0x06, 3, 0xc1},
+        {0x03, 1, 0xc8}, {0x04, 1, 0xc8}, {0x05, 1, 0xc8}, {0x06, 3, 0xc8},
+        {0x03, 1, 0xc9}, {0x04, 1, 0xc9}, {0x05, 1, 0xc9}, {0x06, 3, 0xc9}
+    },
+    /* 198 */
+    {
+        {0x03, 1, 0xca}, {0x04, 1, 0xca}, {0x05, 1, 0xca}, {0x06, 3, 0xca},
+        {0x03, 1, 0xcd}, {0x04, 1, 0xcd}, {0x05, 1, 0xcd}, {0x06, 3, 0xcd},
+        {0x03, 1, 0xd2}, {0x04, 1, 0xd2}, {0x05, 1, 0xd2}, {0x06, 3, 0xd2},
+        {0x03, 1, 0xd5}, {0x04, 1, 0xd5}, {0x05, 1, 0xd5}, {0x06, 3, 0xd5}
+    },
+    /* 199 */
+    {
+        {0x03, 1, 0xda}, {0x04, 1, 0xda}, {0x05, 1, 0xda}, {0x06, 3, 0xda},
+        {0x03, 1, 0xdb}, {0x04, 1, 0xdb}, {0x05, 1, 0xdb}, {0x06, 3, 0xdb},
+        {0x03, 1, 0xee}, {0x04, 1, 0xee}, {0x05, 1, 0xee}, {0x06, 3, 0xee},
+        {0x03, 1, 0xf0}, {0x04, 1, 0xf0}, {0x05, 1, 0xf0}, {0x06, 3, 0xf0}
+    },
+    /* 200 */
+    {
+        {0x03, 1, 0xf2}, {0x04, 1, 0xf2}, {0x05, 1, 0xf2}, {0x06, 3, 0xf2},
+        {0x03, 1, 0xf3}, {0x04, 1, 0xf3}, {0x05, 1, 0xf3}, {0x06, 3, 0xf3},
+        {0x03, 1, 0xff}, {0x04, 1, 0xff}, {0x05, 1, 0xff}, {0x06, 3, 0xff},
+        {0x01, 1, 0xcb}, {0x02, 3, 0xcb}, {0x01, 1, 0xcc}, {0x02, 3, 0xcc}
+    },
+    /* 201 */
+    {
+        {0x01, 1, 0xd3}, {0x02, 3, 0xd3}, {0x01, 1, 0xd4}, {0x02, 3, 0xd4},
+        {0x01, 1, 0xd6}, {0x02, 3, 0xd6}, {0x01, 1, 0xdd}, {0x02, 3, 0xdd},
+        {0x01, 1, 0xde}, {0x02, 3, 0xde}, {0x01, 1, 0xdf}, {0x02, 3, 0xdf},
+        {0x01, 1, 0xf1}, {0x02, 3, 0xf1}, {0x01, 1, 0xf4}, {0x02, 3, 0xf4}
+    },
+    /* 202 */
+    {
+        {0x01, 1, 0xf5}, {0x02, 3, 0xf5}, {0x01, 1, 0xf6}, {0x02, 3, 0xf6},
+        {0x01, 1, 0xf7}, {0x02, 3, 0xf7}, {0x01, 1, 0xf8}, {0x02, 3, 0xf8},
+        {0x01, 1, 0xfa}, {0x02, 3, 0xfa}, {0x01, 1, 0xfb}, {0x02, 3, 0xfb},
+        {0x01, 1, 0xfc}, {0x02, 3, 0xfc}, {0x01, 1, 0xfd}, {0x02, 3, 0xfd}
+    },
+    /* 203 */
+    {
+        {0x01, 1, 0xfe}, {0x02, 3, 0xfe}, {0x00, 3, 0x02}, {0x00, 3, 0x03},
+        {0x00, 3, 0x04}, {0x00, 3, 0x05}, {0x00, 3, 0x06}, {0x00, 3, 0x07},
+        {0x00, 3, 0x08}, {0x00, 3, 0x0b}, {0x00, 3, 0x0c}, {0x00, 3, 0x0e},
+        {0x00, 3, 0x0f}, {0x00, 3, 0x10}, {0x00, 3, 0x11}, {0x00, 3, 0x12}
+    },
+    /* 204 */
+    {
+        {0x00, 3, 0x13}, {0x00, 3, 0x14}, {0x00, 3, 0x15}, {0x00, 3, 0x17},
+        {0x00, 3, 0x18}, {0x00, 3, 0x19}, {0x00, 3, 0x1a}, {0x00, 3, 0x1b},
+        {0x00, 3, 0x1c}, {0x00, 3, 0x1d}, {0x00, 3, 0x1e}, {0x00, 3, 0x1f},
+        {0x00, 3, 0x7f}, {0x00, 3, 0xdc}, {0x00, 3, 0xf9}, {0xfd, 0, 0x00}
+    },
+    /* 205 */
+    {
+        {0x07, 1, 0xc0}, {0x08, 1, 0xc0}, {0x09, 1, 0xc0}, {0x0a, 1, 0xc0},
+        {0x0b, 1, 0xc0}, {0x0c, 1, 0xc0}, {0x0d, 1, 0xc0}, {0x0e, 3, 0xc0},
+        {0x07, 1, 0xc1}, {0x08, 1, 0xc1}, {0x09, 1, 0xc1}, {0x0a, 1, 0xc1},
+        {0x0b, 1, 0xc1}, {0x0c, 1, 0xc1}, {0x0d, 1, 0xc1}, {0x0e, 3, 0xc1}
+    },
+    /* 206 */
+    {
+        {0x07, 1, 0xc8}, {0x08, 1, 0xc8}, {0x09, 1, 0xc8}, {0x0a, 1, 0xc8},
+        {0x0b, 1, 0xc8}, {0x0c, 1, 0xc8}, {0x0d, 1, 0xc8}, {0x0e, 3, 0xc8},
+        {0x07, 1, 0xc9}, {0x08, 1, 0xc9}, {0x09, 1, 0xc9}, {0x0a, 1, 0xc9},
+        {0x0b, 1, 0xc9}, {0x0c, 1, 0xc9}, {0x0d, 1, 0xc9}, {0x0e, 3, 0xc9}
+    },
+    /* 207 */
+    {
+        {0x07, 1, 0xca}, {0x08, 1, 0xca}, {0x09, 1, 0xca}, {0x0a, 1, 0xca},
+        {0x0b, 1, 0xca}, {0x0c, 1, 0xca}, {0x0d, 1, 0xca}, {0x0e, 3, 0xca},
+        {0x07, 1, 0xcd}, {0x08, 1, 0xcd}, {0x09, 1, 0xcd}, {0x0a, 1, 0xcd},
+        {0x0b, 1, 0xcd}, {0x0c, 1, 0xcd}, {0x0d, 1, 0xcd}, {0x0e, 3, 0xcd}
+    },
+    /* 208 */
+    {
+        {0x07, 1, 0xd2}, {0x08, 1, 0xd2}, {0x09, 1, 0xd2}, {0x0a, 1, 0xd2},
+        {0x0b, 1, 0xd2}, {0x0c, 1, 0xd2}, {0x0d, 1, 0xd2}, {0x0e, 3, 0xd2},
+        {0x07, 1, 0xd5}, {0x08, 1, 0xd5}, {0x09, 1, 0xd5}, {0x0a, 1, 0xd5},
+        {0x0b, 1, 0xd5}, {0x0c, 1, 0xd5}, {0x0d, 1, 0xd5}, {0x0e, 3, 0xd5}
+    },
+    /* 209 */
+    {
+        {0x07, 1, 0xda}, {0x08, 1, 0xda}, {0x09, 1, 0xda}, {0x0a, 1, 0xda},
+        {0x0b, 1, 0xda}, {0x0c, 1, 0xda}, {0x0d, 1, 0xda}, {0x0e, 3, 0xda},
+        {0x07, 1, 0xdb}, {0x08, 1, 0xdb}, {0x09, 1, 0xdb}, {0x0a, 1, 0xdb},
+        {0x0b, 1, 0xdb}, {0x0c, 1, 0xdb}, {0x0d, 1, 0xdb}, {0x0e, 3, 0xdb}
+    },
+    /* 210 */
+    {
+        {0x07, 1, 0xee}, {0x08, 1, 0xee}, {0x09, 1, 0xee}, {0x0a, 1, 0xee},
+        {0x0b, 1, 0xee}, {0x0c, 1, 0xee}, {0x0d, 1, 0xee}, {0x0e, 3, 0xee},
+        {0x07, 1, 0xf0}, {0x08, 1, 0xf0}, {0x09, 1, 0xf0}, {0x0a, 1, 0xf0},
+        {0x0b, 1, 0xf0}, {0x0c, 1, 0xf0}, {0x0d, 1, 0xf0}, {0x0e, 3, 0xf0}
+    },
+    /* 211 */
+    {
+        {0x07, 1, 0xf2}, {0x08, 1, 0xf2}, {0x09, 1, 0xf2}, {0x0a, 1, 0xf2},
+        {0x0b, 1, 0xf2}, {0x0c, 1, 0xf2}, {0x0d, 1, 0xf2}, {0x0e, 3, 0xf2},
+        {0x07, 1, 0xf3}, {0x08, 1, 0xf3}, {0x09, 1, 0xf3}, {0x0a, 1, 0xf3},
+        {0x0b, 1, 0xf3}, {0x0c, 1, 0xf3}, {0x0d, 1, 0xf3}, {0x0e, 3, 0xf3}
+    },
+    /* 212 */
+    {
+        {0x07, 1, 0xff}, {0x08, 1, 0xff}, {0x09, 1, 0xff}, {0x0a, 1, 0xff},
+        {0x0b, 1, 0xff}, {0x0c, 1, 0xff}, {0x0d, 1, 0xff}, {0x0e, 3, 0xff},
+        {0x03, 1, 0xcb}, {0x04, 1, 0xcb}, {0x05, 1, 0xcb}, {0x06, 3, 0xcb},
+        {0x03, 1, 0xcc}, {0x04, 1, 0xcc}, {0x05, 1, 0xcc}, {0x06, 3, 0xcc}
+    },
+    /* 213 */
+    {
+        {0x03, 1, 0xd3}, {0x04, 1, 0xd3}, {0x05, 1, 0xd3}, {0x06, 3, 0xd3},
+        {0x03, 1, 0xd4}, {0x04, 1, 0xd4}, {0x05, 1, 0xd4}, {0x06, 3, 0xd4},
+        {0x03, 1, 0xd6}, {0x04, 1, 0xd6}, {0x05, 1, 0xd6}, {0x06, 3, 0xd6},
+        {0x03, 1, 0xdd}, {0x04, 1, 0xdd}, {0x05, 1, 0xdd}, {0x06, 3, 0xdd}
+    },
+    /* 214 */
+    {
+        {0x03, 1, 0xde}, {0x04, 1, 0xde}, {0x05, 1, 0xde}, {0x06, 3, 0xde},
+        {0x03, 1, 0xdf}, {0x04, 1, 0xdf}, {0x05, 1, 0xdf}, {0x06, 3, 0xdf},
+        {0x03, 1, 0xf1}, {0x04, 1, 0xf1}, {0x05, 1, 0xf1}, {0x06, 3, 0xf1},
+        {0x03, 1, 0xf4}, {0x04, 1, 0xf4}, {0x05, 1, 0xf4}, {0x06, 3, 0xf4}
+    },
+    /* 215 */
+    {
+        {0x03, 1, 0xf5}, {0x04, 1, 0xf5}, {0x05, 1, 0xf5}, {0x06, 3, 0xf5},
+        {0x03, 1, 0xf6}, {0x04, 1, 0xf6}, {0x05, 1, 0xf6}, {0x06, 3, 0xf6},
+        {0x03, 1, 0xf7}, {0x04, 1, 0xf7}, {0x05, 1, 0xf7}, {0x06, 3, 0xf7},
+        {0x03, 1, 0xf8}, {0x04, 1, 0xf8}, {0x05, 1, 0xf8}, {0x06, 3, 0xf8}
+    },
+    /* 216 */
+    {
+        {0x03, 1, 0xfa}, {0x04, 1, 0xfa}, {0x05, 1, 0xfa}, {0x06, 3, 0xfa},
+        {0x03, 1, 0xfb}, {0x04, 1, 0xfb}, {0x05, 1, 0xfb}, {0x06, 3, 0xfb},
+        {0x03, 1, 0xfc}, {0x04, 1, 0xfc}, {0x05, 1, 0xfc}, {0x06, 3, 0xfc},
+        {0x03, 1, 0xfd}, {0x04, 1, 0xfd}, {0x05, 1, 0xfd}, {0x06, 3, 0xfd}
+    },
+    /* 217 */
+    {
+        {0x03, 1, 0xfe}, {0x04, 1, 0xfe}, {0x05, 1, 0xfe}, {0x06, 3, 0xfe},
+        {0x01, 1, 0x02}, {0x02, 3, 0x02}, {0x01, 1, 0x03}, {0x02, 3, 0x03},
+        {0x01, 1, 0x04}, {0x02, 3, 0x04}, {0x01, 1, 0x05}, {0x02, 3, 0x05},
+        {0x01, 1, 0x06}, {0x02, 3, 0x06}, {0x01, 1, 0x07}, {0x02, 3, 0x07}
+    },
+    /* 218 */
+    {
+        {0x01, 1, 0x08}, {0x02, 3, 0x08}, {0x01, 1, 0x0b}, {0x02, 3, 0x0b},
+        {0x01, 1, 0x0c}, {0x02, 3, 0x0c}, {0x01, 1, 0x0e}, {0x02, 3, 0x0e},
+        {0x01, 1, 0x0f}, {0x02, 3, 0x0f}, {0x01, 1, 0x10}, {0x02, 3, 0x10},
+        {0x01, 1, 0x11}, {0x02, 3, 0x11}, {0x01, 1, 0x12}, {0x02, 3, 0x12}
+    },
+    /* 219 */
+    {
+        {0x01, 1, 0x13}, {0x02, 3, 0x13}, {0x01, 1, 0x14}, {0x02, 3, 0x14},
+        {0x01, 1, 0x15}, {0x02, 3, 0x15}, {0x01, 1, 0x17}, {0x02, 3, 0x17},
+        {0x01, 1, 0x18}, {0x02, 3, 0x18}, {0x01, 1, 0x19}, {0x02, 3, 0x19},
+        {0x01, 1, 0x1a}, {0x02, 3, 0x1a}, {0x01, 1, 0x1b}, {0x02, 3, 0x1b}
+    },
+    /* 220 */
+    {
+        {0x01, 1, 0x1c}, {0x02, 3, 0x1c}, {0x01, 1, 0x1d}, {0x02, 3, 0x1d},
+        {0x01, 1, 0x1e}, {0x02, 3, 0x1e}, {0x01, 1, 0x1f}, {0x02, 3, 0x1f},
+        {0x01, 1, 0x7f}, {0x02, 3, 0x7f}, {0x01, 1, 0xdc}, {0x02, 3, 0xdc},
+        {0x01, 1, 0xf9}, {0x02, 3, 0xf9}, {0xfe, 0, 0x00}, {0xff, 0, 0x00}
+    },
+    /* 221 */
+    {
+        {0x07, 1, 0xcb}, {0x08, 1, 0xcb}, {0x09, 1, 0xcb}, {0x0a, 1, 0xcb},
+        {0x0b, 1, 0xcb}, {0x0c, 1, 0xcb}, {0x0d, 1, 0xcb}, {0x0e, 3, 0xcb},
+        {0x07, 1, 0xcc}, {0x08, 1, 0xcc}, {0x09, 1, 0xcc}, {0x0a, 1, 0xcc},
+        {0x0b, 1, 0xcc}, {0x0c, 1, 0xcc}, {0x0d, 1, 0xcc}, {0x0e, 3, 0xcc}
+    },
+    /* 222 */
+    {
+        {0x07, 1, 0xd3}, {0x08, 1, 0xd3}, {0x09, 1, 0xd3}, {0x0a, 1, 0xd3},
+        {0x0b, 1, 0xd3}, {0x0c, 1, 0xd3}, {0x0d, 1, 0xd3}, {0x0e, 3, 0xd3},
+        {0x07, 1, 0xd4}, {0x08, 1, 0xd4}, {0x09, 1, 0xd4}, {0x0a, 1, 0xd4},
+        {0x0b, 1, 0xd4}, {0x0c, 1, 0xd4}, {0x0d, 1, 0xd4}, {0x0e, 3, 0xd4}
+    },
+    /* 223 */
+    {
+        {0x07, 1, 0xd6}, {0x08, 1, 0xd6}, {0x09, 1, 0xd6}, {0x0a, 1, 0xd6},
+        {0x0b, 1, 0xd6}, {0x0c, 1, 0xd6}, {0x0d, 1, 0xd6}, {0x0e, 3, 0xd6},
+        {0x07, 1, 0xdd}, {0x08, 1, 0xdd}, {0x09, 1, 0xdd}, {0x0a, 1, 0xdd},
+        {0x0b, 1, 0xdd}, {0x0c, 1, 0xdd}, {0x0d, 1, 0xdd}, {0x0e, 3, 0xdd}
+    },
+    /* 224 */
+    {
+        {0x07, 1, 0xde}, {0x08, 1, 0xde}, {0x09, 1, 0xde}, {0x0a, 1, 0xde},
+        {0x0b, 1, 0xde}, {0x0c, 1, 0xde}, {0x0d, 1, 0xde}, {0x0e, 3, 0xde},
+        {0x07, 1, 0xdf}, {0x08, 1, 0xdf}, {0x09, 1, 0xdf}, {0x0a, 1, 0xdf},
+        {0x0b, 1, 0xdf}, {0x0c, 1, 0xdf}, {0x0d, 1, 0xdf}, {0x0e, 3, 0xdf}
+    },
+    /* 225 */
+    {
+        {0x07, 1, 0xf1}, {0x08, 1, 0xf1}, {0x09, 1, 0xf1}, {0x0a, 1, 0xf1},
+        {0x0b, 1, 0xf1}, {0x0c, 1, 0xf1}, {0x0d, 1, 0xf1}, {0x0e, 3, 0xf1},
+        {0x07, 1, 0xf4}, {0x08, 1, 0xf4}, {0x09, 1, 0xf4}, {0x0a, 1, 0xf4},
+        {0x0b, 1, 0xf4}, {0x0c, 1, 0xf4}, {0x0d, 1, 0xf4}, {0x0e, 3, 0xf4}
+    },
+    /* 226 */
+    {
+        {0x07, 1, 0xf5}, {0x08, 1, 0xf5}, {0x09, 1, 0xf5}, {0x0a, 1, 0xf5},
+        {0x0b, 1, 0xf5}, {0x0c, 1, 0xf5}, {0x0d, 1, 0xf5}, {0x0e, 3, 0xf5},
+        {0x07, 1, 0xf6}, {0x08, 1, 0xf6}, {0x09, 1, 0xf6}, {0x0a, 1, 0xf6},
+        {0x0b, 1, 0xf6}, {0x0c, 1, 0xf6}, {0x0d, 1, 0xf6}, {0x0e, 3, 0xf6}
+    },
+    /* 227 */
+    {
+        {0x07, 1, 0xf7}, {0x08, 1, 0xf7}, {0x09, 1, 0xf7}, {0x0a, 1, 0xf7},
+        {0x0b, 1, 0xf7}, {0x0c, 1, 0xf7}, {0x0d, 1, 0xf7}, {0x0e, 3, 0xf7},
+        {0x07, 1, 0xf8}, {0x08, 1, 0xf8}, {0x09, 1, 0xf8}, {0x0a, 1, 0xf8},
+        {0x0b, 1, 0xf8}, {0x0c, 1, 0xf8}, {0x0d, 1, 0xf8}, {0x0e, 3, 0xf8}
+    },
+    /* 228 */
+    {
+        {0x07, 1, 0xfa}, {0x08, 1, 0xfa}, {0x09, 1, 0xfa}, {0x0a, 1, 0xfa},
+        {0x0b, 1, 0xfa}, {0x0c, 1, 0xfa}, {0x0d, 1, 0xfa}, {0x0e, 3, 0xfa},
+        {0x07, 1, 0xfb}, {0x08, 1, 0xfb}, {0x09, 1, 0xfb}, {0x0a, 1, 0xfb},
+        {0x0b, 1, 0xfb}, {0x0c, 1, 0xfb}, {0x0d, 1, 0xfb}, {0x0e, 3, 0xfb}
+    },
+    /* 229 */
+    {
+        {0x07, 1, 0xfc}, {0x08, 1, 0xfc}, {0x09, 1, 0xfc}, {0x0a, 1, 0xfc},
+        {0x0b, 1, 0xfc}, {0x0c, 1, 0xfc}, {0x0d, 1, 0xfc}, {0x0e, 3, 0xfc},
+        {0x07, 1, 0xfd}, {0x08, 1, 0xfd}, {0x09, 1, 0xfd}, {0x0a, 1, 0xfd},
+        {0x0b, 1, 0xfd}, {0x0c, 1, 0xfd}, {0x0d, 1, 0xfd}, {0x0e, 3, 0xfd}
+    },
+    /* 230 */
+    {
+        {0x07, 1, 0xfe}, {0x08, 1, 0xfe}, {0x09, 1, 0xfe}, {0x0a, 1, 0xfe},
+        {0x0b, 1, 0xfe}, {0x0c, 1, 0xfe}, {0x0d, 1, 0xfe}, {0x0e, 3, 0xfe},
+        {0x03, 1, 0x02}, {0x04, 1, 0x02}, {0x05, 1, 0x02}, {0x06, 3, 0x02},
+        {0x03, 1, 0x03}, {0x04, 1, 0x03}, {0x05, 1, 0x03}, {0x06, 3, 0x03}
+    },
+    /* 231 */
+    {
+        {0x03, 1, 0x04}, {0x04, 1, 0x04}, {0x05, 1, 0x04}, {0x06, 3, 0x04},
+        {0x03, 1, 0x05}, {0x04, 1, 0x05}, {0x05, 1, 0x05}, {0x06, 3, 0x05},
+        {0x03, 1, 0x06}, {0x04, 1, 0x06}, {0x05, 1, 0x06}, {0x06, 3, 0x06},
+        {0x03, 1, 0x07}, {0x04, 1, 0x07}, {0x05, 1, 0x07}, {0x06, 3, 0x07}
+    },
+    /* 232 */
+    {
+        {0x03, 1, 0x08}, {0x04, 1, 0x08}, {0x05, 1, 0x08}, {0x06, 3, 0x08},
+        {0x03, 1, 0x0b}, {0x04, 1, 0x0b}, {0x05, 1, 0x0b}, {0x06, 3, 0x0b},
+        {0x03, 1, 0x0c}, {0x04, 1, 0x0c}, {0x05, 1, 0x0c}, {0x06, 3, 0x0c},
+        {0x03, 1, 0x0e}, {0x04, 1, 0x0e}, {0x05, 1, 0x0e}, {0x06, 3, 0x0e}
+    },
+    /* 233 */
+    {
+        {0x03, 1, 0x0f}, {0x04, 1, 0x0f}, {0x05, 1, 0x0f}, {0x06, 3, 0x0f},
+        {0x03, 1, 0x10}, {0x04, 1, 0x10}, {0x05, 1, 0x10}, {0x06, 3, 0x10},
+        {0x03, 1, 0x11}, {0x04, 1, 0x11}, {0x05, 1, 0x11}, {0x06, 3, 0x11},
+        {0x03, 1, 0x12}, {0x04, 1, 0x12}, {0x05, 1, 0x12}, {0x06, 3, 0x12}
+    },
+    /* 234 */
+    {
+        {0x03, 1, 0x13}, {0x04, 1, 0x13}, {0x05, 1, 0x13}, {0x06, 3, 0x13},
+        {0x03, 1, 0x14}, {0x04, 1, 0x14}, {0x05, 1, 0x14}, {0x06, 3, 0x14},
+        {0x03, 1, 0x15}, {0x04, 1, 0x15}, {0x05, 1, 0x15}, {0x06, 3, 0x15},
+        {0x03, 1, 0x17}, {0x04, 1, 0x17}, {0x05, 1, 0x17}, {0x06, 3, 0x17}
+    },
+    /* 235 */
+    {
+        {0x03, 1, 0x18}, {0x04, 1, 0x18}, {0x05, 1, 0x18}, {0x06, 3, 0x18},
+        {0x03, 1, 0x19}, {0x04, 1, 0x19}, {0x05, 1, 0x19}, {0x06, 3, 0x19},
+        {0x03, 1, 0x1a}, {0x04, 1, 0x1a}, {0x05, 1, 0x1a}, {0x06, 3, 0x1a},
+        {0x03, 1, 0x1b}, {0x04, 1, 0x1b}, {0x05, 1, 0x1b}, {0x06, 3, 0x1b}
+    },
+    /* 236 */
+    {
+        {0x03, 1, 0x1c}, {0x04, 1, 0x1c}, {0x05, 1, 0x1c}, {0x06, 3, 0x1c},
+        {0x03, 1, 0x1d}, {0x04, 1, 0x1d}, {0x05, 1, 0x1d}, {0x06, 3, 0x1d},
+        {0x03, 1, 0x1e}, {0x04, 1, 0x1e}, {0x05, 1, 0x1e}, {0x06, 3, 0x1e},
+        {0x03, 1, 0x1f}, {0x04, 1, 0x1f}, {0x05, 1, 0x1f}, {0x06, 3, 0x1f}
+    },
+    /* 237 */
+    {
+        {0x03, 1, 0x7f}, {0x04, 1, 0x7f}, {0x05, 1, 0x7f}, {0x06, 3, 0x7f},
+        {0x03, 1, 0xdc}, {0x04, 1, 0xdc}, {0x05, 1, 0xdc}, {0x06, 3, 0xdc},
+        {0x03, 1, 0xf9}, {0x04, 1, 0xf9}, {0x05, 1, 0xf9}, {0x06, 3, 0xf9},
+        {0x00, 3, 0x0a}, {0x00, 3, 0x0d}, {0x00, 3, 0x16}, {0x00, 4, 0x00}
+    },
+    /* 238 */
+    {
+        {0x07, 1, 0x02}, {0x08, 1, 0x02}, {0x09, 1, 0x02}, {0x0a, 1, 0x02},
+        {0x0b, 1, 0x02}, {0x0c, 1, 0x02}, {0x0d, 1, 0x02}, {0x0e, 3, 0x02},
+        {0x07, 1, 0x03}, {0x08, 1, 0x03}, {0x09, 1, 0x03}, {0x0a, 1, 0x03},
+        {0x0b, 1, 0x03}, {0x0c, 1, 0x03}, {0x0d, 1, 0x03}, {0x0e, 3, 0x03}
+    },
+    /* 239 */
+    {
+        {0x07, 1, 0x04}, {0x08, 1, 0x04}, {0x09, 1, 0x04}, {0x0a, 1, 0x04},
+        {0x0b, 1, 0x04}, {0x0c, 1, 0x04}, {0x0d, 1, 0x04}, {0x0e, 3, 0x04},
+        {0x07, 1, 0x05}, {0x08, 1, 0x05}, {0x09, 1, 0x05}, {0x0a, 1, 0x05},
+        {0x0b, 1, 0x05}, {0x0c, 1, 0x05}, {0x0d, 1, 0x05}, {0x0e, 3, 0x05}
+    },
+    /* 240 */
+    {
+        {0x07, 1, 0x06}, {0x08, 1, 0x06}, {0x09, 1, 0x06}, {0x0a, 1, 0x06},
+        {0x0b, 1, 0x06}, {0x0c, 1, 0x06}, {0x0d, 1, 0x06}, {0x0e, 3, 0x06},
+        {0x07, 1, 0x07}, {0x08, 1, 0x07}, {0x09, 1, 0x07}, {0x0a, 1, 0x07},
+        {0x0b, 1, 0x07}, {0x0c, 1, 0x07}, {0x0d, 1, 0x07}, {0x0e, 3, 0x07}
+    },
+    /* 241 */
+    {
+        {0x07, 1, 0x08}, {0x08, 1, 0x08}, {0x09, 1, 0x08}, {0x0a, 1, 0x08},
+        {0x0b, 1, 0x08}, {0x0c, 1, 0x08}, {0x0d, 1, 0x08}, {0x0e, 3, 0x08},
+        {0x07, 1, 0x0b}, {0x08, 1, 0x0b}, {0x09, 1, 0x0b}, {0x0a, 1, 0x0b},
+        {0x0b, 1, 0x0b}, {0x0c, 1, 0x0b}, {0x0d, 1, 0x0b}, {0x0e, 3, 0x0b}
+    },
+    /* 242 */
+    {
+        {0x07, 1, 0x0c}, {0x08, 1, 0x0c}, {0x09, 1, 0x0c}, {0x0a, 1, 0x0c},
+        {0x0b, 1, 0x0c}, {0x0c, 1, 0x0c}, {0x0d, 1, 0x0c}, {0x0e, 3, 0x0c},
+        {0x07, 1, 0x0e}, {0x08, 1, 0x0e}, {0x09, 1, 0x0e}, {0x0a, 1, 0x0e},
+        {0x0b, 1, 0x0e}, {0x0c, 1, 0x0e}, {0x0d, 1, 0x0e}, {0x0e, 3, 0x0e}
+    },
+    /* 243 */
+    {
+        {0x07, 1, 0x0f}, {0x08, 1, 0x0f}, {0x09, 1, 0x0f}, {0x0a, 1, 0x0f},
+        {0x0b, 1, 0x0f}, {0x0c, 1, 0x0f}, {0x0d, 1, 0x0f}, {0x0e, 3, 0x0f},
+        {0x07, 1, 0x10}, {0x08, 1, 0x10}, {0x09, 1, 0x10}, {0x0a, 1, 0x10},
+        {0x0b, 1, 0x10}, {0x0c, 1, 0x10}, {0x0d, 1, 0x10}, {0x0e, 3, 0x10}
+    },
+    /* 244 */
+    {
+        {0x07, 1, 0x11}, {0x08, 1, 0x11}, {0x09, 1, 0x11}, {0x0a, 1, 0x11},
+        {0x0b, 1, 0x11}, {0x0c, 1, 0x11}, {0x0d, 1, 0x11}, {0x0e, 3, 0x11},
+        {0x07, 1, 0x12}, {0x08, 1, 0x12}, {0x09, 1, 0x12}, {0x0a, 1, 0x12},
+        {0x0b, 1, 0x12}, {0x0c, 1, 0x12}, {0x0d, 1, 0x12}, {0x0e, 3, 0x12}
+    },
+    /* 245 */
+    {
+        {0x07, 1, 0x13}, {0x08, 1, 0x13}, {0x09, 1, 0x13}, {0x0a, 1, 0x13},
+        {0x0b, 1, 0x13}, {0x0c, 1, 0x13}, {0x0d, 1, 0x13}, {0x0e, 3, 0x13},
+        {0x07, 1, 0x14}, {0x08, 1, 0x14}, {0x09, 1, 0x14}, {0x0a, 1, 0x14},
+        {0x0b, 1, 0x14}, {0x0c, 1, 0x14}, {0x0d, 1, 0x14}, {0x0e, 3, 0x14}
+    },
+    /* 246 */
+    {
+        {0x07, 1, 0x15}, {0x08, 1, 0x15}, {0x09, 1, 0x15}, {0x0a, 1, 0x15},
+        {0x0b, 1, 0x15}, {0x0c, 1, 0x15}, {0x0d, 1, 0x15}, {0x0e, 3, 0x15},
+        {0x07, 1, 0x17}, {0x08, 1, 0x17}, {0x09, 1, 0x17}, {0x0a, 1, 0x17},
+        {0x0b, 1, 0x17}, {0x0c, 1, 0x17}, {0x0d, 1, 0x17}, {0x0e, 3, 0x17}
+    },
+    /* 247 */
+    {
+        {0x07, 1, 0x18}, {0x08, 1, 0x18}, {0x09, 1, 0x18}, {0x0a, 1, 0x18},
+        {0x0b, 1, 0x18}, {0x0c, 1, 0x18}, {0x0d, 1, 0x18}, {0x0e, 3, 0x18},
+        {0x07, 1, 0x19}, {0x08, 1, 0x19}, {0x09, 1, 0x19}, {0x0a, 1, 0x19},
+        {0x0b, 1, 0x19}, {0x0c, 1, 0x19}, {0x0d, 1, 0x19}, {0x0e, 3, 0x19}
+    },
+    /* 248 */
+    {
+        {0x07, 1, 0x1a}, {0x08, 1, 0x1a}, {0x09, 1, 0x1a}, {0x0a, 1, 0x1a},
+        {0x0b, 1, 0x1a}, {0x0c, 1, 0x1a}, {0x0d, 1, 0x1a}, {0x0e, 3, 0x1a},
+        {0x07, 1, 0x1b}, {0x08, 1, 0x1b}, {0x09, 1, 0x1b}, {0x0a, 1, 0x1b},
+        {0x0b, 1, 0x1b}, {0x0c, 1, 0x1b}, {0x0d, 1, 0x1b}, {0x0e, 3, 0x1b}
+    },
+    /* 249 */
+    {
+        {0x07, 1, 0x1c}, {0x08, 1, 0x1c}, {0x09, 1, 0x1c}, {0x0a, 1, 0x1c},
+        {0x0b, 1, 0x1c}, {0x0c, 1, 0x1c}, {0x0d, 1, 0x1c}, {0x0e, 3, 0x1c},
+        {0x07, 1, 0x1d}, {0x08, 1, 0x1d}, {0x09, 1, 0x1d}, {0x0a, 1, 0x1d},
+        {0x0b, 1, 0x1d}, {0x0c, 1, 0x1d}, {0x0d, 1, 0x1d}, {0x0e, 3, 0x1d}
+    },
+    /* 250 */
+    {
+        {0x07, 1, 0x1e}, {0x08, 1, 0x1e}, {0x09, 1, 0x1e}, {0x0a, 1, 0x1e},
+        {0x0b, 1, 0x1e}, {0x0c, 1, 0x1e}, {0x0d, 1, 0x1e}, {0x0e, 3, 0x1e},
+        {0x07, 1, 0x1f}, {0x08, 1, 0x1f}, {0x09, 1, 0x1f}, {0x0a, 1, 0x1f},
+        {0x0b, 1, 0x1f}, {0x0c, 1, 0x1f}, {0x0d, 1, 0x1f}, {0x0e, 3, 0x1f}
+    },
+    /* 251 */
+    {
+        {0x07, 1, 0x7f}, {0x08, 1, 0x7f}, {0x09, 1, 0x7f}, {0x0a, 1, 0x7f},
+        {0x0b, 1, 0x7f}, {0x0c, 1, 0x7f}, {0x0d, 1, 0x7f}, {0x0e, 3, 0x7f},
+        {0x07, 1, 0xdc}, {0x08, 1, 0xdc}, {0x09, 1, 0xdc}, {0x0a, 1, 0xdc},
+        {0x0b, 1, 0xdc}, {0x0c, 1, 0xdc}, {0x0d, 1, 0xdc}, {0x0e, 3, 0xdc}
+    },
+    /* 252 */
+    {
+        {0x07, 1, 0xf9}, {0x08, 1, 0xf9}, {0x09, 1, 0xf9}, {0x0a, 1, 0xf9},
+        {0x0b, 1, 0xf9}, {0x0c, 1, 0xf9}, {0x0d, 1, 0xf9}, {0x0e, 3, 0xf9},
+        {0x01, 1, 0x0a}, {0x02, 3, 0x0a}, {0x01, 1, 0x0d}, {0x02, 3, 0x0d},
+        {0x01, 1, 0x16}, {0x02, 3, 0x16}, {0x00, 4, 0x00}, {0x00, 4, 0x00}
+    },
+    /* 253 */
+    {
+        {0x03, 1, 0x0a}, {0x04, 1, 0x0a}, {0x05, 1, 0x0a}, {0x06, 3, 0x0a},
+        {0x03, 1, 0x0d}, {0x04, 1, 0x0d}, {0x05, 1, 0x0d}, {0x06, 3, 0x0d},
+        {0x03, 1, 0x16}, {0x04, 1, 0x16}, {0x05, 1, 0x16}, {0x06, 3, 0x16},
+        {0x00, 4, 0x00}, {0x00, 4, 0x00}, {0x00, 4, 0x00}, {0x00, 4, 0x00}
+    },
+    /* 254 */
+    {
+        {0x07, 1, 0x0a}, {0x08, 1, 0x0a}, {0x09, 1, 0x0a}, {0x0a, 1, 0x0a},
+        {0x0b, 1, 0x0a}, {0x0c, 1, 0x0a}, {0x0d, 1, 0x0a}, {0x0e, 3, 0x0a},
+        {0x07, 1, 0x0d}, {0x08, 1, 0x0d}, {0x09, 1, 0x0d}, {0x0a, 1, 0x0d},
+        {0x0b, 1, 0x0d}, {0x0c, 1, 0x0d}, {0x0d, 1, 0x0d}, {0x0e, 3, 0x0d}
+    },
+    /* 255 */
+    {
+        {0x07, 1, 0x16}, {0x08, 1, 0x16}, {0x09, 1, 0x16}, {0x0a, 1, 0x16},
+        {0x0b, 1, 0x16}, {0x0c, 1, 0x16}, {0x0d, 1, 0x16}, {0x0e, 3, 0x16},
+        {0x00, 4, 0x00}, {0x00, 4, 0x00}, {0x00, 4, 0x00}, {0x00, 4, 0x00},
+        {0x00, 4, 0x00}, {0x00, 4, 0x00}, {0x00, 4, 0x00}, {0x00, 4, 0x00}
+    }
+};
+
+
+ngx_int_t
+ngx_http_v2_huff_decode(u_char *state, u_char *src, size_t len, u_char **dst,
+    ngx_uint_t last, ngx_log_t *log)
+{
+    u_char  *end, ch, ending;
+
+    ch = 0;
+    ending = 1;
+
+    end = src + len;
+
+    while (src != end) {
+        ch = *src++;
+
+        if (ngx_http_v2_huff_decode_bits(state, &ending, ch >> 4, dst)
+            != NGX_OK)
+        {
+            ngx_log_debug2(NGX_LOG_DEBUG_HTTP, log, 0,
+                           "http2 huffman decoding error at state %d: "
+                           "bad code 0x%Xd", *state, ch >> 4);
+
+            return NGX_ERROR;
+        }
+
+        if (ngx_http_v2_huff_decode_bits(state, &ending, ch & 0xf, dst)
+            != NGX_OK)
+        {
+            ngx_log_debug2(NGX_LOG_DEBUG_HTTP, log, 0,
+                           "http2 huffman decoding error at state %d: "
+                           "bad code 0x%Xd", *state, ch & 0xf);
+
+            return NGX_ERROR;
+        }
+    }
+
+    if (last) {
+        if (!ending) {
+            ngx_log_debug1(NGX_LOG_DEBUG_HTTP, log, 0,
+                           "http2 huffman decoding error: "
+                           "incomplete code 0x%Xd", ch);
+
+            return NGX_ERROR;
+        }
+
+        *state = 0;
+    }
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_huff_decode_bits(u_char *state, u_char *ending, ngx_uint_t bits,
+    u_char **dst)
+{
+    ngx_http_v2_huff_decode_code_t  code;
+
+    code = ngx_http_v2_huff_decode_codes[*state][bits];
+
+    if (code.flags & NGX_HTTP_V2_HUFF_FAIL) {
+        return NGX_ERROR;
+    }
+
+    if (code.flags & NGX_HTTP_V2_HUFF_EMIT) {
+        *(*dst)++ = code.sym;
+    }
+
+    *ending = code.flags & NGX_HTTP_V2_HUFF_ACCEPT;
+    *state = code.next;
+
+    return NGX_OK;
+}
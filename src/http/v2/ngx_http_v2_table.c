@@ -0,0 +1,311 @@
+
+/*
+ * Copyright (C) Nginx, Inc.
+ */
+
+
+#include <ngx_config.h>
+#include <ngx_core.h>
+#include <ngx_http.h>
+
+
+#define NGX_HTTP_V2_TABLE_ENTRY_SIZE  32
+
+#define ngx_http_v2_entry_size(h)                                             \
+    ((h)->name.len + (h)->value.len + NGX_HTTP_V2_TABLE_ENTRY_SIZE)
+
+
+static ngx_int_t ngx_http_v2_table_init(ngx_http_v2_connection_t *h2c);
+static void ngx_http_v2_table_evict(ngx_http_v2_hpack_t *hpack);
+static void ngx_http_v2_table_cleanup(void *data);
+
+
+static ngx_http_v2_header_t  ngx_http_v2_static_table[] = {
+    { ngx_string(":authority"), ngx_string("") },
+    { ngx_string(":method"), ngx_string("GET") },
+    { ngx_string(":method"), ngx_string("POST") },
+    { ngx_string(":path"), ngx_string("/") },
+    { ngx_string(":path"), ngx_string("/index.html") },
+    { ngx_string(":scheme"), ngx_string("http") },
+    { ngx_string(":scheme"), ngx_string("https") },
+    { ngx_string(":status"), ngx_string("200") },
+    { ngx_string(":status"), ngx_string("204") },
+    { ngx_string(":status"), ngx_string("206") },
+    { ngx_string(":status"), ngx_string("304") },
+    { ngx_string(":status"), ngx_string("400") },
+    { ngx_string(":status"), ngx_string("404") },
+    { ngx_string(":status"), ngx_string("500") },
+    { ngx_string("accept-charset"), ngx_string("") },
+    { ngx_string("accept-encoding"), ngx_string("gzip, deflate") },
+    { ngx_string("accept-language"), ngx_string("") },
+    { ngx_string("accept-ranges"), ngx_string("") },
+    { ngx_string("accept"), ngx_string("") },
+    { ngx_string("access-control-allow-origin"), ngx_string("") },
+    { ngx_string("age"), ngx_string("") },
+    { ngx_string("allow"), ngx_string("") },
+    { ngx_string("authorization"), ngx_string("") },
+    { ngx_string("cache-control"), ngx_string("") },
+    { ngx_string("content-disposition"), ngx_string("") },
+    { ngx_string("content-encoding"), ngx_string("") },
+    { ngx_string("content-language"), ngx_string("") },
+    { ngx_string("content-length"), ngx_string("") },
+    { ngx_string("content-location"), ngx_string("") },
+    { ngx_string("content-range"), ngx_string("") },
+    { ngx_string("content-type"), ngx_string("") },
+    { ngx_string("cookie"), ngx_string("") },
+    { ngx_string("date"), ngx_string("") },
+    { ngx_string("etag"), ngx_string("") },
+    { ngx_string("expect"), ngx_string("") },
+    { ngx_string("expires"), ngx_string("") },
+    { ngx_string("from"), ngx_string("") },
+    { ngx_string("host"), ngx_string("") },
+    { ngx_string("if-match"), ngx_string("") },
+    { ngx_string("if-modified-since"), ngx_string("") },
+    { ngx_string("if-none-match"), ngx_string("") },
+    { ngx_string("if-range"), ngx_string("") },
+    { ngx_string("if-unmodified-since"), ngx_string("") },
+    { ngx_string("last-modified"), ngx_string("") },
+    { ngx_string("link"), ngx_string("") },
+    { ngx_string("location"), ngx_string("") },
+    { ngx_string("max-forwards"), ngx_string("") },
+    { ngx_string("proxy-authenticate"), ngx_string("") },
+    { ngx_string("proxy-authorization"), ngx_string("") },
+    { ngx_string("range"), ngx_string("") },
+    { ngx_string("referer"), ngx_string("") },
+    { ngx_string("refresh"), ngx_string("") },
+    { ngx_string("retry-after"), ngx_string("") },
+    { ngx_string("server"), ngx_string("") },
+    { ngx_string("set-cookie"), ngx_string("") },
+    { ngx_string("strict-transport-security"), ngx_string("") },
+    { ngx_string("transfer-encoding"), ngx_string("") },
+    { ngx_string("user-agent"), ngx_string("") },
+    { ngx_string("vary"), ngx_string("") },
+    { ngx_string("via"), ngx_string("") },
+    { ngx_string("www-authenticate"), ngx_string("") },
+};
+
+#define NGX_HTTP_V2_STATIC_TABLE_ENTRIES                                      \
+    (sizeof(ngx_http_v2_static_table)                                         \
+     / sizeof(ngx_http_v2_header_t))
+
+
+ngx_int_t
+ngx_http_v2_get_indexed_header(ngx_http_v2_connection_t *h2c, ngx_uint_t index,
+    ngx_uint_t name_only, ngx_http_v2_header_t *header)
+{
+    ngx_http_v2_hpack_t   *hpack;
+    ngx_http_v2_header_t  *entry;
+
+    ngx_log_debug2(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 get indexed %s: %ui",
+                   name_only ? "name" : "header", index);
+
+    if (index == 0) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent invalid hpack table index 0");
+        return NGX_ERROR;
+    }
+
+    index--;
+
+    if (index < NGX_HTTP_V2_STATIC_TABLE_ENTRIES) {
+        *header = ngx_http_v2_static_table[index];
+
+        if (name_only) {
+            header->value.len = 0;
+        }
+
+        return NGX_OK;
+    }
+
+    index -= NGX_HTTP_V2_STATIC_TABLE_ENTRIES;
+
+    hpack = &h2c->hpack;
+
+    if (index < hpack->added - hpack->deleted) {
+
+        /* the most recently added entry has the lowest index */
+
+        entry = hpack->entries[(hpack->added - index - 1) % hpack->allocated];
+
+        *header = *entry;
+
+        if (name_only) {
+            header->value.len = 0;
+        }
+
+        return NGX_OK;
+    }
+
+    ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                  "client sent out of bound hpack table index: %ui",
+                  index + NGX_HTTP_V2_STATIC_TABLE_ENTRIES + 1);
+
+    return NGX_ERROR;
+}
+
+
+ngx_int_t
+ngx_http_v2_add_header(ngx_http_v2_connection_t *h2c,
+    ngx_http_v2_header_t *header)
+{
+    size_t                 size;
+    ngx_http_v2_hpack_t   *hpack;
+    ngx_http_v2_header_t  *entry;
+
+    ngx_log_debug4(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 add header to hpack table: \"%*s: %*s\"",
+                   header->name.len, header->name.data,
+                   header->value.len, header->value.data);
+
+    hpack = &h2c->hpack;
+
+    if (hpack->entries == NULL) {
+        if (ngx_http_v2_table_init(h2c) != NGX_OK) {
+            return NGX_ERROR;
+        }
+    }
+
+    size = ngx_http_v2_entry_size(header);
+
+    if (size > hpack->size) {
+
+        /* such an entry empties the table and is not added (RFC 7541, 4.4) */
+
+        while (hpack->added != hpack->deleted) {
+            ngx_http_v2_table_evict(hpack);
+        }
+
+        return NGX_OK;
+    }
+
+    /*
+     * the entry is copied before the eviction since
+     * the name may refer to an entry being evicted
+     */
+
+    entry = ngx_alloc(sizeof(ngx_http_v2_header_t)
+                      + header->name.len + header->value.len,
+                      h2c->connection->log);
+    if (entry == NULL) {
+        return NGX_ERROR;
+    }
+
+    entry->name.len = header->name.len;
+    entry->name.data = (u_char *) entry + sizeof(ngx_http_v2_header_t);
+    ngx_memcpy(entry->name.data, header->name.data, header->name.len);
+
+    entry->value.len = header->value.len;
+    entry->value.data = entry->name.data + entry->name.len;
+    ngx_memcpy(entry->value.data, header->value.data, header->value.len);
+
+    while (size > hpack->free) {
+        ngx_http_v2_table_evict(hpack);
+    }
+
+    hpack->entries[hpack->added++ % hpack->allocated] = entry;
+    hpack->free -= size;
+
+    *header = *entry;
+
+    return NGX_OK;
+}
+
+
+ngx_int_t
+ngx_http_v2_table_size(ngx_http_v2_connection_t *h2c, size_t size)
+{
+    size_t                needed;
+    ngx_http_v2_hpack_t  *hpack;
+
+    ngx_log_debug1(NGX_LOG_DEBUG_HTTP, h2c->connection->log, 0,
+                   "http2 new hpack table size: %uz", size);
+
+    if (size > NGX_HTTP_V2_TABLE_SIZE) {
+        ngx_log_error(NGX_LOG_INFO, h2c->connection->log, 0,
+                      "client sent invalid table size update: %uz", size);
+
+        return NGX_ERROR;
+    }
+
+    hpack = &h2c->hpack;
+
+    if (hpack->entries == NULL) {
+        if (ngx_http_v2_table_init(h2c) != NGX_OK) {
+            return NGX_ERROR;
+        }
+    }
+
+    if (size >= hpack->size) {
+        hpack->free += size - hpack->size;
+        hpack->size = size;
+        return NGX_OK;
+    }
+
+    needed = hpack->size - size;
+
+    while (needed > hpack->free) {
+        ngx_http_v2_table_evict(hpack);
+    }
+
+    hpack->size = size;
+    hpack->free -= needed;
+
+    return NGX_OK;
+}
+
+
+static ngx_int_t
+ngx_http_v2_table_init(ngx_http_v2_connection_t *h2c)
+{
+    ngx_pool_cleanup_t   *cln;
+    ngx_http_v2_hpack_t  *hpack;
+
+    hpack = &h2c->hpack;
+
+    hpack->allocated = NGX_HTTP_V2_TABLE_SIZE / NGX_HTTP_V2_TABLE_ENTRY_SIZE;
+
+    hpack->entries = ngx_palloc(h2c->connection->pool,
+                                sizeof(ngx_http_v2_header_t *)
+                                * hpack->allocated);
+    if (hpack->entries == NULL) {
+        return NGX_ERROR;
+    }
+
+    cln = ngx_pool_cleanup_add(h2c->connection->pool, 0);
+    if (cln == NULL) {
+        return NGX_ERROR;
+    }
+
+    cln->handler = ngx_http_v2_table_cleanup;
+    cln->data = hpack;
+
+    hpack->size = NGX_HTTP_V2_TABLE_SIZE;
+    hpack->free = NGX_HTTP_V2_TABLE_SIZE;
+
+    return NGX_OK;
+}
+
+
+static void
+ngx_http_v2_table_evict(ngx_http_v2_hpack_t *hpack)
+{
+    ngx_http_v2_header_t  *entry;
+
+    entry = hpack->entries[hpack->deleted++ % hpack->allocated];
+
+    hpack->free += ngx_http_v2_entry_size(entry);
+
+    ngx_free(entry);
+}
+
+
+static void
+ngx_http_v2_table_cleanup(void *data)
+{
+    ngx_http_v2_hpack_t  *hpack = data;
+
+    while (hpack->added != hpack->deleted) {
+        ngx_http_v2_table_evict(hpack);
+    }
+}
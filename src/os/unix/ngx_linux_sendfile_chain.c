@@ -34,6 +34,27 @@
 #endif
 
 
+#if (NGX_THREAD_POOL)
+
+#include <ngx_thread_pool.h>
+
+typedef struct {
+    ngx_buf_t     *file;
+    ngx_socket_t   socket;
+    size_t         size;
+
+    size_t         sent;
+    ngx_err_t      err;
+} ngx_linux_sendfile_ctx_t;
+
+
+static ngx_int_t ngx_linux_sendfile_thread(ngx_connection_t *c,
+    ngx_buf_t *file, size_t size, off_t *sent);
+static void ngx_linux_sendfile_thread_handler(void *data, ngx_log_t *log);
+
+#endif
+
+
 ngx_chain_t *
 ngx_linux_sendfile_chain(ngx_connection_t *c, ngx_chain_t *in, off_t limit)
 {
@@ -259,6 +280,25 @@ ngx_linux_sendfile_chain(ngx_connection_t *c, ngx_chain_t *in, off_t limit)
             ngx_log_debug2(NGX_LOG_DEBUG_EVENT, c->log, 0,
                            "sendfile: @%O %uz", file->file_pos, file_size);
 
+#if (NGX_THREAD_POOL)
+
+            if (file->file->thread_handler) {
+                rc = ngx_linux_sendfile_thread(c, file, file_size, &sent);
+
+                if (rc == NGX_ERROR) {
+                    return NGX_CHAIN_ERROR;
+                }
+
+                if (rc == NGX_DONE) {
+                    /* the sendfile() task is posted or still running */
+                    return in;
+                }
+
+                goto done;
+            }
+
+#endif
+
             rc = sendfile(c->fd, file->file->fd, &offset, file_size);
 
             if (rc == -1) {
@@ -317,6 +357,10 @@ ngx_linux_sendfile_chain(ngx_connection_t *c, ngx_chain_t *in, off_t limit)
             ngx_log_debug1(NGX_LOG_DEBUG_EVENT, c->log, 0, "writev: %O", sent);
         }
 
+#if (NGX_THREAD_POOL)
+done:
+#endif
+
         if (send - prev_send == sent) {
             complete = 1;
         }
@@ -376,3 +420,125 @@ ngx_linux_sendfile_chain(ngx_connection_t *c, ngx_chain_t *in, off_t limit)
         in = cl;
     }
 }
+
+
+#if (NGX_THREAD_POOL)
+
+/*
+ * NGX_DONE  - the task is posted, or is still running
+ * NGX_OK    - the task is complete, "sent" is set
+ * NGX_ERROR - an error
+ */
+
+static ngx_int_t
+ngx_linux_sendfile_thread(ngx_connection_t *c, ngx_buf_t *file, size_t size,
+    off_t *sent)
+{
+    ngx_thread_task_t         *task;
+    ngx_linux_sendfile_ctx_t  *ctx;
+
+    ngx_log_debug3(NGX_LOG_DEBUG_EVENT, c->log, 0,
+                   "linux sendfile thread: %d, %uz, %O",
+                   file->file->fd, size, file->file_pos);
+
+    task = c->sendfile_task;
+
+    if (task == NULL) {
+        task = ngx_thread_task_alloc(c->pool,
+                                     sizeof(ngx_linux_sendfile_ctx_t));
+        if (task == NULL) {
+            return NGX_ERROR;
+        }
+
+        task->handler = ngx_linux_sendfile_thread_handler;
+
+        c->sendfile_task = task;
+    }
+
+    ctx = task->ctx;
+
+    if (task->event.complete) {
+        task->event.complete = 0;
+
+        if (ctx->err == NGX_EAGAIN) {
+            *sent = 0;
+            return NGX_OK;
+        }
+
+        if (ctx->err) {
+            c->write->error = 1;
+            ngx_connection_error(c, ctx->err, "sendfile() failed");
+            return NGX_ERROR;
+        }
+
+        if (ctx->sent == 0) {
+            ngx_log_error(NGX_LOG_ALERT, c->log, 0,
+                          "sendfile() reported that \"%s\" was truncated",
+                          file->file->name.data);
+            return NGX_ERROR;
+        }
+
+        *sent = ctx->sent;
+
+        return NGX_OK;
+    }
+
+    if (task->event.active) {
+
+        /*
+         * tolerate repeated calls while the task is running, they can
+         * happen due to subrequests or a write event on the connection
+         */
+
+        return NGX_DONE;
+    }
+
+    ctx->file = file;
+    ctx->socket = c->fd;
+    ctx->size = size;
+
+    if (file->file->thread_handler(task, file->file) != NGX_OK) {
+        return NGX_ERROR;
+    }
+
+    return NGX_DONE;
+}
+
+
+static void
+ngx_linux_sendfile_thread_handler(void *data, ngx_log_t *log)
+{
+    ngx_linux_sendfile_ctx_t *ctx = data;
+
+    ssize_t     n;
+    ngx_buf_t  *file;
+#if (NGX_HAVE_SENDFILE64)
+    off_t       offset;
+#else
+    int32_t     offset;
+#endif
+
+    ngx_log_debug0(NGX_LOG_DEBUG_CORE, log, 0,
+                   "linux sendfile thread handler");
+
+    file = ctx->file;
+    offset = file->file_pos;
+
+again:
+
+    n = sendfile(ctx->socket, file->file->fd, &offset, ctx->size);
+
+    if (n == -1) {
+        ctx->err = ngx_errno;
+
+        if (ctx->err == NGX_EINTR) {
+            goto again;
+        }
+
+    } else {
+        ctx->sent = n;
+        ctx->err = 0;
+    }
+}
+
+#endif